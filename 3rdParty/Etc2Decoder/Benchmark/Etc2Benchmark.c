@@ -0,0 +1,354 @@
+// BC transcoding benchmark.
+//
+// Generates synthetic ETC, EAC and ASTC textures, then for each of them measures decoding to RGBA8 and
+// transcoding to BC blocks, and the quality of the transcoded texture against the decoded one. Prints the
+// results as JSON:
+//   decode     - decode_etc_texture or decode_astc_texture, in megapixels per second
+//   transcode  - transcode_texture_to_bc, in megapixels per second
+//   psnr       - of the transcoded texture (decoded with decode_bc_texture) against the decoded one, over the
+//                channels the format has
+//   bytes      - of the RGBA8 texture and of the transcoded one
+// A last result times start_decode_job on a mipmapped ETC2 RGB8 texture:
+//   preview    - milliseconds until the levels up to 128x128 are decoded
+//   total      - milliseconds until all levels are decoded
+// Two kinds of content are generated: "smooth" blocks follow gradients like typical artwork, "random" blocks are
+// random bits and show the worst case. Each ETC and EAC texture is also decoded and transcoded again with the SIMD
+// block drawing disabled:
+//   simd       - "exact" if the output matches the SIMD output byte for byte, "differs" if not, "none" if there
+//                is no SIMD code for the format or the CPU
+// The run fails if a transcode fails, the PSNR of smooth content is below 30 dB or the SIMD and scalar outputs
+// differ.
+//
+// Usage: Etc2Benchmark [--quick] [--size N] [--repeat N] [--threads N]
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "../texgenpack.h"
+#include "../decode.h"
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t random_state = 12345;
+
+static int random_int(int n) {
+	random_state = random_state * 1664525 + 1013904223;
+	return (int)((random_state >> 8) % (uint32_t)n);
+}
+
+static void put_bits(unsigned char *bitstring, int offset, int count, unsigned int value) {
+	for (int i = 0; i < count; i++) {
+		int bit = offset + i;
+		bitstring[bit >> 3] = (bitstring[bit >> 3] & ~(1 << (bit & 7))) | (((value >> i) & 1) << (bit & 7));
+	}
+}
+
+// A slowly varying value in 0..255 for block (bx, by) and channel c.
+
+static int gradient(int bx, int by, int c) {
+	return (int)(127.5 + 127.5 * sin(bx * (0.05 + c * 0.02) + by * (0.03 + c * 0.01) + c));
+}
+
+// ETC1 differential mode block with a ramp of intensity modifiers along x.
+
+static void make_smooth_etc1_block(int bx, int by, unsigned char *bitstring) {
+	// Modifier indices from the most negative to the most positive.
+	static const int ramp[4] = { 3, 2, 0, 1 };
+	for (int c = 0; c < 3; c++)
+		bitstring[c] = ((gradient(bx, by, c) >> 3) << 3) | (random_int(3) == 0 ? 7 : 0);
+	bitstring[3] = (random_int(3) << 5) | (random_int(3) << 2) | 2 | random_int(2);
+	unsigned int msb = 0, lsb = 0;
+	for (int x = 0; x < 4; x++)
+		for (int y = 0; y < 4; y++) {
+			int index = ramp[x];
+			msb |= (unsigned int)(index >> 1) << (x * 4 + y);
+			lsb |= (unsigned int)(index & 1) << (x * 4 + y);
+		}
+	bitstring[4] = msb >> 8;
+	bitstring[5] = msb & 0xFF;
+	bitstring[6] = lsb >> 8;
+	bitstring[7] = lsb & 0xFF;
+}
+
+// EAC block (alpha or R11) around a base value with a ramp of modifiers along y.
+
+static void make_smooth_eac_block(int base, unsigned char *bitstring) {
+	// Modifier indices from the most negative to the most positive.
+	static const int ramp[4] = { 2, 0, 4, 6 };
+	bitstring[0] = base;
+	bitstring[1] = ((1 + random_int(2)) << 4) | random_int(16);
+	uint64_t indices = 0;
+	for (int x = 0; x < 4; x++)
+		for (int y = 0; y < 4; y++)
+			indices |= (uint64_t)ramp[y] << (45 - (x * 4 + y) * 3);
+	for (int i = 0; i < 6; i++)
+		bitstring[2 + i] = (indices >> ((5 - i) * 8)) & 0xFF;
+}
+
+// Single partition ASTC block with an RGBA endpoint pair and a 4x4 grid of 2-bit weights.
+
+static void make_smooth_astc_block(int bx, int by, unsigned char *bitstring) {
+	memset(bitstring, 0, 16);
+	put_bits(bitstring, 0, 11, 0x042);
+	put_bits(bitstring, 13, 4, 12);
+	for (int c = 0; c < 4; c++) {
+		int base = c == 3 ? 255 - gradient(bx, by, c) / 4 : gradient(bx, by, c);
+		int spread = 8 + random_int(24);
+		put_bits(bitstring, 17 + 16 * c, 8, base > spread ? base - spread : 0);
+		put_bits(bitstring, 25 + 16 * c, 8, base + spread < 255 ? base + spread : 255);
+	}
+	for (int i = 0; i < 16; i++) {
+		int weight = i & 3;
+		for (int k = 0; k < 2; k++)
+			put_bits(bitstring, 127 - (2 * i + k), 1, (weight >> k) & 1);
+	}
+}
+
+typedef struct {
+	const char *name;
+	int format;
+	int block_width;
+	int block_height;
+	int block_size;
+	// Channels compared for the PSNR: 3 for RGB, 4 for RGBA, 1 and 2 for R and RG.
+	int channels;
+} BenchmarkFormat;
+
+static const BenchmarkFormat formats[] = {
+	{ "ETC1", TEXTURE_TYPE_ETC1, 4, 4, 8, 3 },
+	{ "ETC2_RGB8", TEXTURE_TYPE_ETC2_RGB8, 4, 4, 8, 3 },
+	{ "ETC2_PUNCHTHROUGH", TEXTURE_TYPE_ETC2_PUNCHTHROUGH, 4, 4, 8, 4 },
+	{ "ETC2_EAC", TEXTURE_TYPE_ETC2_EAC, 4, 4, 16, 4 },
+	{ "R11_EAC", TEXTURE_TYPE_R11_EAC, 4, 4, 8, 1 },
+	{ "RG11_EAC", TEXTURE_TYPE_RG11_EAC, 4, 4, 16, 2 },
+	{ "ASTC_4X4", TEXTURE_TYPE_RGBA_ASTC_4X4, 4, 4, 16, 4 },
+	{ "ASTC_6X6", TEXTURE_TYPE_RGBA_ASTC_6X6, 6, 6, 16, 4 },
+	{ "ASTC_8X8", TEXTURE_TYPE_RGBA_ASTC_8X8, 8, 8, 16, 4 },
+};
+
+static void make_texture(const BenchmarkFormat *format, int smooth, int blocks_x, int blocks_y, unsigned char *src) {
+	for (int by = 0; by < blocks_y; by++)
+		for (int bx = 0; bx < blocks_x; bx++) {
+			unsigned char *bitstring = src + ((size_t)by * blocks_x + bx) * format->block_size;
+			if (!smooth) {
+				for (int i = 0; i < format->block_size; i++)
+					bitstring[i] = random_int(256);
+				continue;
+			}
+			switch (format->format) {
+			case TEXTURE_TYPE_ETC1:
+			case TEXTURE_TYPE_ETC2_RGB8:
+				make_smooth_etc1_block(bx, by, bitstring);
+				break;
+			case TEXTURE_TYPE_ETC2_PUNCHTHROUGH:
+				make_smooth_etc1_block(bx, by, bitstring);
+				// Clear the opaque bit on some blocks, which makes the pixels with index 2 transparent.
+				if (random_int(4) == 0)
+					bitstring[3] &= ~2;
+				break;
+			case TEXTURE_TYPE_ETC2_EAC:
+				make_smooth_eac_block(gradient(bx, by, 3), bitstring);
+				make_smooth_etc1_block(bx, by, bitstring + 8);
+				break;
+			case TEXTURE_TYPE_R11_EAC:
+				make_smooth_eac_block(gradient(bx, by, 0), bitstring);
+				break;
+			case TEXTURE_TYPE_RG11_EAC:
+				make_smooth_eac_block(gradient(bx, by, 0), bitstring);
+				make_smooth_eac_block(gradient(bx, by, 1), bitstring + 8);
+				break;
+			default:
+				make_smooth_astc_block(bx, by, bitstring);
+				break;
+			}
+		}
+}
+
+static int decode_texture(const BenchmarkFormat *format, const unsigned char *src, unsigned char *dst, int size,
+	int threads) {
+	if (format->format & TEXTURE_TYPE_ASTC_BIT)
+		return decode_astc_texture(src, dst, size, size, size * 4, format->format, threads);
+	return decode_etc_texture(src, dst, size, size, size * 4, format->format, threads);
+}
+
+static double compute_psnr(const unsigned char *a, const unsigned char *b, int pixels, int channels) {
+	double error = 0;
+	for (int i = 0; i < pixels; i++)
+		for (int c = 0; c < channels; c++) {
+			double d = (double)a[i * 4 + c] - b[i * 4 + c];
+			error += d * d;
+		}
+	error /= (double)pixels * channels;
+	return error == 0 ? 99.0 : 10.0 * log10(255.0 * 255.0 / error);
+}
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t done;
+	double start;
+	double preview_time;
+	double total_time;
+	int preview_level;
+	int levels_decoded;
+	int finished;
+} JobTiming;
+
+static void job_callback(void *data, int level, int result) {
+	JobTiming *timing = (JobTiming *)data;
+	pthread_mutex_lock(&timing->mutex);
+	if (level == timing->preview_level)
+		timing->preview_time = now() - timing->start;
+	if (level < 0) {
+		timing->total_time = now() - timing->start;
+		timing->levels_decoded = result;
+		timing->finished = 1;
+		pthread_cond_signal(&timing->done);
+	}
+	pthread_mutex_unlock(&timing->mutex);
+}
+
+// Decode all mip levels of a size x size ETC2 RGB8 texture with a decode job, returns 0 if not all levels decode.
+
+static int time_decode_job(int size, int threads, double *preview_time, double *total_time) {
+	DecodeJobLevel levels[32];
+	int level_count = 0, preview_level = 0;
+	for (int w = size, h = size;; w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1) {
+		int blocks_x = (w + 3) / 4, blocks_y = (h + 3) / 4;
+		unsigned char *src = malloc((size_t)blocks_x * blocks_y * 8);
+		make_texture(&formats[1], 1, blocks_x, blocks_y, src);
+		levels[level_count].src = src;
+		levels[level_count].dst = malloc((size_t)w * h * 4);
+		levels[level_count].width = w;
+		levels[level_count].height = h;
+		levels[level_count].pitch = w * 4;
+		if (w > 128 || h > 128)
+			preview_level = level_count + 1;
+		level_count++;
+		if (w == 1 && h == 1)
+			break;
+	}
+	JobTiming timing;
+	pthread_mutex_init(&timing.mutex, NULL);
+	pthread_cond_init(&timing.done, NULL);
+	timing.preview_level = preview_level;
+	timing.preview_time = 0;
+	timing.finished = 0;
+	timing.levels_decoded = 0;
+	pthread_mutex_lock(&timing.mutex);
+	timing.start = now();
+	if (start_decode_job(levels, level_count, TEXTURE_TYPE_ETC2_RGB8, TEXTURE_TYPE_UNCOMPRESSED_RGBA8, threads,
+		job_callback, &timing) != NULL)
+		while (!timing.finished)
+			pthread_cond_wait(&timing.done, &timing.mutex);
+	pthread_mutex_unlock(&timing.mutex);
+	pthread_mutex_destroy(&timing.mutex);
+	pthread_cond_destroy(&timing.done);
+	for (int i = 0; i < level_count; i++) {
+		free((void *)levels[i].src);
+		free(levels[i].dst);
+	}
+	*preview_time = timing.preview_time;
+	*total_time = timing.total_time;
+	return timing.finished && timing.levels_decoded == level_count;
+}
+
+int main(int argc, char **argv) {
+	int size = 1024, repeat = 5, threads = 1;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--quick")) {
+			size = 256;
+			repeat = 1;
+		}
+		else if (!strcmp(argv[i], "--size") && i + 1 < argc)
+			size = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--repeat") && i + 1 < argc)
+			repeat = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+			threads = atoi(argv[++i]);
+		else {
+			fprintf(stderr, "Usage: %s [--quick] [--size N] [--repeat N] [--threads N]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (size < 1 || repeat < 1) {
+		fprintf(stderr, "--size and --repeat must be positive\n");
+		return 2;
+	}
+	int failed = 0;
+	size_t pixels = (size_t)size * size;
+	unsigned char *decoded = malloc(pixels * 4);
+	unsigned char *transcoded_decoded = malloc(pixels * 4);
+	unsigned char *transcoded = malloc(((size_t)size + 3) / 4 * ((size + 3) / 4) * 16);
+	unsigned char *scalar_transcoded = malloc(((size_t)size + 3) / 4 * ((size + 3) / 4) * 16);
+	int simd = set_etc_simd_enabled(1);
+	printf("{\n\t\"size\": %d,\n\t\"threads\": %d,\n\t\"results\": [\n", size, threads);
+	int count = sizeof(formats) / sizeof(formats[0]);
+	for (int f = 0; f < count; f++)
+		for (int smooth = 1; smooth >= 0; smooth--) {
+			const BenchmarkFormat *format = &formats[f];
+			int blocks_x = (size + format->block_width - 1) / format->block_width;
+			int blocks_y = (size + format->block_height - 1) / format->block_height;
+			unsigned char *src = malloc((size_t)blocks_x * blocks_y * format->block_size);
+			make_texture(format, smooth, blocks_x, blocks_y, src);
+			double decode_time = 1e30, transcode_time = 1e30;
+			for (int r = 0; r < repeat; r++) {
+				double start = now();
+				decode_texture(format, src, decoded, size, threads);
+				double t = now() - start;
+				if (t < decode_time)
+					decode_time = t;
+				start = now();
+				if (!transcode_texture_to_bc(src, transcoded, size, size, format->format, threads))
+					failed = 1;
+				t = now() - start;
+				if (t < transcode_time)
+					transcode_time = t;
+			}
+			int bc_format = get_bc_transcode_format(format->format);
+			int bc_block_size = bc_format == TEXTURE_TYPE_DXT1 || bc_format == TEXTURE_TYPE_DXT1A ||
+				bc_format == TEXTURE_TYPE_RGTC1 ? 8 : 16;
+			size_t transcoded_bytes = (size_t)((size + 3) / 4) * ((size + 3) / 4) * bc_block_size;
+			const char *simd_result = "none";
+			if (simd && !(format->format & TEXTURE_TYPE_ASTC_BIT)) {
+				// The last SIMD decode and transcode against scalar ones, transcoded_decoded is free until below.
+				set_etc_simd_enabled(0);
+				decode_texture(format, src, transcoded_decoded, size, threads);
+				int exact = !memcmp(decoded, transcoded_decoded, pixels * 4);
+				if (!transcode_texture_to_bc(src, scalar_transcoded, size, size, format->format, threads))
+					failed = 1;
+				exact = exact && !memcmp(transcoded, scalar_transcoded, transcoded_bytes);
+				set_etc_simd_enabled(1);
+				if (!exact)
+					failed = 1;
+				simd_result = exact ? "exact" : "differs";
+			}
+			decode_bc_texture(transcoded, transcoded_decoded, size, size, size * 4, bc_format, threads);
+			double psnr = compute_psnr(decoded, transcoded_decoded, (int)pixels, format->channels);
+			if (smooth && psnr < 30.0)
+				failed = 1;
+			printf("\t\t{ \"format\": \"%s\", \"content\": \"%s\", \"decode\": %.1f, \"transcode\": %.1f, "
+				"\"psnr\": %.2f, \"bytes\": [%zu, %zu], \"simd\": \"%s\" },\n", format->name,
+				smooth ? "smooth" : "random", pixels / decode_time * 1e-6, pixels / transcode_time * 1e-6, psnr,
+				pixels * 4, transcoded_bytes, simd_result);
+			free(src);
+		}
+	double preview_time, total_time;
+	if (!time_decode_job(size, threads, &preview_time, &total_time))
+		failed = 1;
+	printf("\t\t{ \"format\": \"ETC2_RGB8\", \"content\": \"mipmapped\", \"job\": { \"preview\": %.2f, "
+		"\"total\": %.2f } }\n", preview_time * 1e3, total_time * 1e3);
+	printf("\t],\n\t\"failed\": %s\n}\n", failed ? "true" : "false");
+	free(decoded);
+	free(transcoded_decoded);
+	free(transcoded);
+	free(scalar_transcoded);
+	return failed;
+}
@@ -0,0 +1,2 @@
+#!/bin/sh
+gcc -O2 -std=c99 -D_POSIX_C_SOURCE=199309L Benchmark/Etc2Benchmark.c etc2.c etc2_simd.c dxtc.c rgtc.c astc.c bcenc.c texture.c parallel.c job.c -lpthread -lm -o Etc2Benchmark
@@ -1,2 +1,2 @@
 #!/bin/sh
- gcc -dynamiclib etc2.c -o libEtc2Decoder.dylib
\ No newline at end of file
+ gcc -dynamiclib etc2.c etc2_simd.c dxtc.c rgtc.c astc.c bcenc.c texture.c parallel.c job.c -o libEtc2Decoder.dylib
\ No newline at end of file
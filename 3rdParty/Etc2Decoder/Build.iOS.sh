@@ -1,10 +1,12 @@
 #!/bin/sh
 mkdir ios_build
 cd ios_build
-xcrun -sdk iphoneos clang -O3 -c -arch armv7 ../etc2.c -o etc2_armv7.o
-xcrun -sdk iphoneos clang -O3 -c -arch arm64 ../etc2.c -o etc2_arm64.o
-ar -crs libEtc2_armv7.a etc2_armv7.o
-ar -crs libEtc2_arm64.a etc2_arm64.o
+for arch in armv7 arm64; do
+	for source in etc2 etc2_simd dxtc rgtc astc bcenc texture parallel job; do
+		xcrun -sdk iphoneos clang -O3 -c -arch $arch ../$source.c -o ${source}_$arch.o
+	done
+	ar -crs libEtc2_$arch.a etc2_$arch.o etc2_simd_$arch.o dxtc_$arch.o rgtc_$arch.o astc_$arch.o bcenc_$arch.o texture_$arch.o parallel_$arch.o job_$arch.o
+done
 lipo -create libEtc2_armv7.a libEtc2_arm64.a -output libEtc2Decoder.a
 mv libEtc2Decoder.a ..
 cd ..
\ No newline at end of file
@@ -0,0 +1,798 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "texgenpack.h"
+#include "decode.h"
+#include "packing.h"
+
+// LDR decoding of 2D ASTC blocks. Written for this library against the prototypes the upstream texgenpack decode.h
+// declares for astc.c; the code itself isn't taken from texgenpack.
+//
+// Blocks that an LDR decoder has to treat as errors (HDR endpoint modes, HDR void extent blocks and reserved or out
+// of range encodings) are drawn in the error color, opaque magenta.
+
+#define ASTC_MAX_BLOCK_PIXELS 144
+#define ASTC_MAX_WEIGHTS 64
+
+// Block footprints, indexed by the ASTC block type (the low four bits of the texture type).
+
+static const unsigned char astc_block_size_table[14][2] = {
+	{ 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 }, { 8, 8 },
+	{ 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+};
+
+// Return the ASTC block type for a footprint, or -1 if there is none.
+
+int match_astc_block_size(int w, int h) {
+	for (int i = 0; i < 14; i++)
+		if (astc_block_size_table[i][0] == w && astc_block_size_table[i][1] == h)
+			return i;
+	return - 1;
+}
+
+int get_astc_block_size_width(int astc_block_type) {
+	return astc_block_size_table[astc_block_type][0];
+}
+
+int get_astc_block_size_height(int astc_block_type) {
+	return astc_block_size_table[astc_block_type][1];
+}
+
+// The number of trits, quints and bits of the integer sequence encoding ranges, from 0..1 up to 0..255.
+// Weights use the first 12 ranges.
+
+static const unsigned char ise_ranges[21][3] = {
+	{ 0, 0, 1 }, { 1, 0, 0 }, { 0, 0, 2 }, { 0, 1, 0 }, { 1, 0, 1 }, { 0, 0, 3 }, { 0, 1, 1 },
+	{ 1, 0, 2 }, { 0, 0, 4 }, { 0, 1, 2 }, { 1, 0, 3 }, { 0, 0, 5 }, { 0, 1, 3 }, { 1, 0, 4 },
+	{ 0, 0, 6 }, { 0, 1, 4 }, { 1, 0, 5 }, { 0, 0, 7 }, { 0, 1, 5 }, { 1, 0, 6 }, { 0, 0, 8 }
+};
+
+static int get_ise_bit_count(int count, int range) {
+	int bits = count * ise_ranges[range][2];
+	if (ise_ranges[range][0])
+		bits += (8 * count + 4) / 5;
+	else if (ise_ranges[range][1])
+		bits += (7 * count + 2) / 3;
+	return bits;
+}
+
+// The block is handled as two little-endian 64-bit words.
+
+static void load_block_bits(const unsigned char *bitstring, uint64_t *words) {
+	words[0] = 0;
+	words[1] = 0;
+	for (int i = 7; i >= 0; i--) {
+		words[0] = (words[0] << 8) | bitstring[i];
+		words[1] = (words[1] << 8) | bitstring[i + 8];
+	}
+}
+
+// Read count (at most 32) bits at offset; bits past the end of the block read as zero.
+
+static unsigned int get_bits(const uint64_t *words, int offset, int count) {
+	if (count == 0 || offset >= 128)
+		return 0;
+	uint64_t value = words[offset >> 6] >> (offset & 63);
+	if (offset < 64 && (offset & 63) != 0 && (offset & 63) + count > 64)
+		value |= words[1] << (64 - (offset & 63));
+	return (unsigned int)(value & ((UINT64_C(1) << count) - 1));
+}
+
+// Clear all bits from offset on, so that a truncated integer sequence reads zeros beyond its end.
+
+static void clear_bits_from(uint64_t *words, int offset) {
+	if (offset < 64) {
+		words[0] &= offset == 0 ? 0 : ~UINT64_C(0) >> (64 - offset);
+		words[1] = 0;
+	}
+	else if (offset < 128)
+		words[1] &= offset == 64 ? 0 : ~UINT64_C(0) >> (128 - offset);
+}
+
+static uint64_t reverse_bits64(uint64_t x) {
+	x = ((x >> 1) & UINT64_C(0x5555555555555555)) | ((x & UINT64_C(0x5555555555555555)) << 1);
+	x = ((x >> 2) & UINT64_C(0x3333333333333333)) | ((x & UINT64_C(0x3333333333333333)) << 2);
+	x = ((x >> 4) & UINT64_C(0x0F0F0F0F0F0F0F0F)) | ((x & UINT64_C(0x0F0F0F0F0F0F0F0F)) << 4);
+	x = ((x >> 8) & UINT64_C(0x00FF00FF00FF00FF)) | ((x & UINT64_C(0x00FF00FF00FF00FF)) << 8);
+	x = ((x >> 16) & UINT64_C(0x0000FFFF0000FFFF)) | ((x & UINT64_C(0x0000FFFF0000FFFF)) << 16);
+	return (x >> 32) | (x << 32);
+}
+
+// Unpack the five trits encoded in the 8 bits T.
+
+static void decode_trits(int T, int *t) {
+	int C;
+	if (((T >> 2) & 7) == 7) {
+		C = (((T >> 5) & 7) << 2) | (T & 3);
+		t[4] = 2;
+		t[3] = 2;
+	}
+	else {
+		C = T & 0x1F;
+		if (((T >> 5) & 3) == 3) {
+			t[4] = 2;
+			t[3] = (T >> 7) & 1;
+		}
+		else {
+			t[4] = (T >> 7) & 1;
+			t[3] = (T >> 5) & 3;
+		}
+	}
+	if ((C & 3) == 3) {
+		t[2] = 2;
+		t[1] = (C >> 4) & 1;
+		t[0] = (((C >> 3) & 1) << 1) | (((C >> 2) & 1) & !((C >> 3) & 1));
+	}
+	else if (((C >> 2) & 3) == 3) {
+		t[2] = 2;
+		t[1] = 2;
+		t[0] = C & 3;
+	}
+	else {
+		t[2] = (C >> 4) & 1;
+		t[1] = (C >> 2) & 3;
+		t[0] = (C & 2) | ((C & 1) & !((C >> 1) & 1));
+	}
+}
+
+// Unpack the three quints encoded in the 7 bits Q.
+
+static void decode_quints(int Q, int *q) {
+	if (((Q >> 1) & 3) == 3 && ((Q >> 5) & 3) == 0) {
+		q[2] = ((Q & 1) << 2) | ((((Q >> 4) & 1) & !(Q & 1)) << 1) | (((Q >> 3) & 1) & !(Q & 1));
+		q[1] = 4;
+		q[0] = 4;
+		return;
+	}
+	int C;
+	if (((Q >> 1) & 3) == 3) {
+		q[2] = 4;
+		C = (((Q >> 3) & 3) << 3) | ((~(Q >> 5) & 3) << 1) | (Q & 1);
+	}
+	else {
+		q[2] = (Q >> 5) & 3;
+		C = Q & 0x1F;
+	}
+	if ((C & 7) == 5) {
+		q[1] = 4;
+		q[0] = (C >> 3) & 3;
+	}
+	else {
+		q[1] = (C >> 3) & 3;
+		q[0] = C & 7;
+	}
+}
+
+// Decode count integers of the given range starting at offset. Each value is returned as its trit or quint
+// (if any) shifted left by the number of bits, ORed with the bits.
+
+static void decode_ise(const uint64_t *words, int offset, int count, int range, int *values) {
+	int bits = ise_ranges[range][2];
+	if (ise_ranges[range][0]) {
+		for (int i = 0; i < count; i += 5) {
+			int m[5], t[5];
+			int T;
+			m[0] = get_bits(words, offset, bits);
+			T = get_bits(words, offset + bits, 2);
+			offset += bits + 2;
+			m[1] = get_bits(words, offset, bits);
+			T |= get_bits(words, offset + bits, 2) << 2;
+			offset += bits + 2;
+			m[2] = get_bits(words, offset, bits);
+			T |= get_bits(words, offset + bits, 1) << 4;
+			offset += bits + 1;
+			m[3] = get_bits(words, offset, bits);
+			T |= get_bits(words, offset + bits, 2) << 5;
+			offset += bits + 2;
+			m[4] = get_bits(words, offset, bits);
+			T |= get_bits(words, offset + bits, 1) << 7;
+			offset += bits + 1;
+			decode_trits(T, t);
+			for (int j = 0; j < 5 && i + j < count; j++)
+				values[i + j] = (t[j] << bits) | m[j];
+		}
+	}
+	else if (ise_ranges[range][1]) {
+		for (int i = 0; i < count; i += 3) {
+			int m[3], q[3];
+			int Q;
+			m[0] = get_bits(words, offset, bits);
+			Q = get_bits(words, offset + bits, 3);
+			offset += bits + 3;
+			m[1] = get_bits(words, offset, bits);
+			Q |= get_bits(words, offset + bits, 2) << 3;
+			offset += bits + 2;
+			m[2] = get_bits(words, offset, bits);
+			Q |= get_bits(words, offset + bits, 2) << 5;
+			offset += bits + 2;
+			decode_quints(Q, q);
+			for (int j = 0; j < 3 && i + j < count; j++)
+				values[i + j] = (q[j] << bits) | m[j];
+		}
+	}
+	else
+		for (int i = 0; i < count; i++) {
+			values[i] = get_bits(words, offset, bits);
+			offset += bits;
+		}
+}
+
+static int replicate_bits(int value, int bits, int to_bits) {
+	int result = 0;
+	for (int filled = 0; filled < to_bits; filled += bits) {
+		int shift = to_bits - filled - bits;
+		result |= shift >= 0 ? value << shift : value >> - shift;
+	}
+	return result;
+}
+
+// Unquantize a color endpoint value to the range 0..255.
+
+static int unquantize_color_value(int value, int range) {
+	int bits = ise_ranges[range][2];
+	int m = value & ((1 << bits) - 1);
+	if (!ise_ranges[range][0] && !ise_ranges[range][1])
+		return replicate_bits(m, bits, 8);
+	int d = value >> bits;
+	int A = (m & 1) ? 0x1FF : 0;
+	int b = (m >> 1) & 1;
+	int c = (m >> 2) & 1;
+	int e = (m >> 3) & 1;
+	int f = (m >> 4) & 1;
+	int g = (m >> 5) & 1;
+	int B = 0;
+	int C;
+	if (ise_ranges[range][0])
+		switch (bits) {
+		case 1:
+			C = 204;
+			break;
+		case 2:
+			C = 93;
+			B = (b << 8) | (b << 4) | (b << 2) | (b << 1);
+			break;
+		case 3:
+			C = 44;
+			B = (c << 8) | (b << 7) | (c << 3) | (b << 2) | (c << 1) | b;
+			break;
+		case 4:
+			C = 22;
+			B = (e << 8) | (c << 7) | (b << 6) | (e << 2) | (c << 1) | b;
+			break;
+		case 5:
+			C = 11;
+			B = (f << 8) | (e << 7) | (c << 6) | (b << 5) | (f << 1) | e;
+			break;
+		default:
+			C = 5;
+			B = (g << 8) | (f << 7) | (e << 6) | (c << 5) | (b << 4) | g;
+			break;
+		}
+	else
+		switch (bits) {
+		case 1:
+			C = 113;
+			break;
+		case 2:
+			C = 54;
+			B = (b << 8) | (b << 3) | (b << 2);
+			break;
+		case 3:
+			C = 26;
+			B = (c << 8) | (b << 7) | (c << 2) | (b << 1) | c;
+			break;
+		case 4:
+			C = 13;
+			B = (e << 8) | (c << 7) | (b << 6) | (e << 1) | c;
+			break;
+		default:
+			C = 6;
+			B = (f << 8) | (e << 7) | (c << 6) | (b << 5) | f;
+			break;
+		}
+	int T = (d * C + B) ^ A;
+	return (A & 0x80) | (T >> 2);
+}
+
+// Unquantize a weight to the range 0..64.
+
+static int unquantize_weight(int value, int range) {
+	int bits = ise_ranges[range][2];
+	int m = value & ((1 << bits) - 1);
+	int result;
+	if (!ise_ranges[range][0] && !ise_ranges[range][1])
+		result = replicate_bits(m, bits, 6);
+	else if (bits == 0)
+		// The ranges 0..2 and 0..4 map straight to evenly spaced weights.
+		return ise_ranges[range][0] ? value * 32 : value * 16;
+	else {
+		int d = value >> bits;
+		int A = (m & 1) ? 0x7F : 0;
+		int b = (m >> 1) & 1;
+		int c = (m >> 2) & 1;
+		int B = 0;
+		int C;
+		if (ise_ranges[range][0])
+			switch (bits) {
+			case 1:
+				C = 50;
+				break;
+			case 2:
+				C = 23;
+				B = (b << 6) | (b << 2) | b;
+				break;
+			default:
+				C = 11;
+				B = (c << 6) | (b << 5) | (c << 1) | b;
+				break;
+			}
+		else if (bits == 1)
+			C = 28;
+		else {
+			C = 13;
+			B = (b << 6) | (b << 1);
+		}
+		int T = (d * C + B) ^ A;
+		result = (A & 0x20) | (T >> 2);
+	}
+	if (result > 32)
+		result++;
+	return result;
+}
+
+static int clamp255(int x) {
+	return x < 0 ? 0 : (x > 255 ? 255 : x);
+}
+
+static void bit_transfer_signed(int *a, int *b) {
+	*b >>= 1;
+	*b |= *a & 0x80;
+	*a >>= 1;
+	*a &= 0x3F;
+	if (*a & 0x20)
+		*a -= 0x40;
+}
+
+static void blue_contract(int *color) {
+	color[0] = (color[0] + color[2]) >> 1;
+	color[1] = (color[1] + color[2]) >> 1;
+}
+
+static void set_color(int *color, int r, int g, int b, int a) {
+	color[0] = r;
+	color[1] = g;
+	color[2] = b;
+	color[3] = a;
+}
+
+// Decode the two RGBA endpoints of a partition from its unquantized color values. Returns 0 for the HDR modes.
+
+static int decode_endpoints(int mode, const int *v, int *e0, int *e1) {
+	switch (mode) {
+	case 0:
+		// Luminance, direct.
+		set_color(e0, v[0], v[0], v[0], 0xFF);
+		set_color(e1, v[1], v[1], v[1], 0xFF);
+		break;
+	case 1: {
+		// Luminance, base + offset.
+		int l0 = (v[0] >> 2) | (v[1] & 0xC0);
+		int l1 = l0 + (v[1] & 0x3F);
+		set_color(e0, l0, l0, l0, 0xFF);
+		set_color(e1, l1, l1, l1, 0xFF);
+		break;
+		}
+	case 4:
+		// Luminance + alpha, direct.
+		set_color(e0, v[0], v[0], v[0], v[2]);
+		set_color(e1, v[1], v[1], v[1], v[3]);
+		break;
+	case 5: {
+		// Luminance + alpha, base + offset.
+		int l0 = v[0], l1 = v[1], a0 = v[2], a1 = v[3];
+		bit_transfer_signed(&l1, &l0);
+		bit_transfer_signed(&a1, &a0);
+		set_color(e0, l0, l0, l0, a0);
+		set_color(e1, l0 + l1, l0 + l1, l0 + l1, a0 + a1);
+		break;
+		}
+	case 6:
+		// RGB, base + scale.
+		set_color(e0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, 0xFF);
+		set_color(e1, v[0], v[1], v[2], 0xFF);
+		break;
+	case 8:
+	case 12: {
+		// RGB(A), direct.
+		int a0 = mode == 12 ? v[6] : 0xFF;
+		int a1 = mode == 12 ? v[7] : 0xFF;
+		if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+			set_color(e0, v[0], v[2], v[4], a0);
+			set_color(e1, v[1], v[3], v[5], a1);
+		}
+		else {
+			set_color(e0, v[1], v[3], v[5], a1);
+			set_color(e1, v[0], v[2], v[4], a0);
+			blue_contract(e0);
+			blue_contract(e1);
+		}
+		break;
+		}
+	case 9:
+	case 13: {
+		// RGB(A), base + offset.
+		int r0 = v[0], r1 = v[1], g0 = v[2], g1 = v[3], b0 = v[4], b1 = v[5];
+		int a0 = 0xFF, a1 = 0;
+		bit_transfer_signed(&r1, &r0);
+		bit_transfer_signed(&g1, &g0);
+		bit_transfer_signed(&b1, &b0);
+		if (mode == 13) {
+			a0 = v[6];
+			a1 = v[7];
+			bit_transfer_signed(&a1, &a0);
+		}
+		if (r1 + g1 + b1 >= 0) {
+			set_color(e0, r0, g0, b0, a0);
+			set_color(e1, r0 + r1, g0 + g1, b0 + b1, a0 + a1);
+		}
+		else {
+			set_color(e0, r0 + r1, g0 + g1, b0 + b1, a0 + a1);
+			set_color(e1, r0, g0, b0, a0);
+			blue_contract(e0);
+			blue_contract(e1);
+		}
+		break;
+		}
+	case 10:
+		// RGB, base + scale, plus two alphas.
+		set_color(e0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, v[4]);
+		set_color(e1, v[0], v[1], v[2], v[5]);
+		break;
+	default:
+		return 0;
+	}
+	for (int i = 0; i < 4; i++) {
+		e0[i] = clamp255(e0[i]);
+		e1[i] = clamp255(e1[i]);
+	}
+	return 1;
+}
+
+static uint32_t hash52(uint32_t p) {
+	p ^= p >> 15;
+	p -= p << 17;
+	p += p << 7;
+	p += p << 4;
+	p ^= p >> 5;
+	p += p << 16;
+	p ^= p >> 7;
+	p ^= p >> 3;
+	p ^= p << 6;
+	p ^= p >> 17;
+	return p;
+}
+
+// Return the partition of the pixel at (x, y) for the given partition index (seed).
+
+static int select_partition(int seed, int x, int y, int partition_count, int small_block) {
+	if (small_block) {
+		x <<= 1;
+		y <<= 1;
+	}
+	seed += (partition_count - 1) * 1024;
+	uint32_t rnum = hash52(seed);
+	int s[8];
+	for (int i = 0; i < 8; i++) {
+		s[i] = (rnum >> (i * 4)) & 0xF;
+		s[i] *= s[i];
+	}
+	int sh1, sh2;
+	if (seed & 1) {
+		sh1 = (seed & 2) ? 4 : 5;
+		sh2 = partition_count == 3 ? 6 : 5;
+	}
+	else {
+		sh1 = partition_count == 3 ? 6 : 5;
+		sh2 = (seed & 2) ? 4 : 5;
+	}
+	// The z coordinate is zero for 2D blocks, so the seeds multiplying it are not needed.
+	int a = (((s[0] >> sh1) * x + (s[1] >> sh2) * y) + (int)(rnum >> 14)) & 0x3F;
+	int b = (((s[2] >> sh1) * x + (s[3] >> sh2) * y) + (int)(rnum >> 10)) & 0x3F;
+	int c = (((s[4] >> sh1) * x + (s[5] >> sh2) * y) + (int)(rnum >> 6)) & 0x3F;
+	int d = (((s[6] >> sh1) * x + (s[7] >> sh2) * y) + (int)(rnum >> 2)) & 0x3F;
+	if (partition_count < 4)
+		d = 0;
+	if (partition_count < 3)
+		c = 0;
+	if (a >= b && a >= c && a >= d)
+		return 0;
+	if (b >= c && b >= d)
+		return 1;
+	if (c >= d)
+		return 2;
+	return 3;
+}
+
+// Decode the weight grid dimensions, dual plane flag and weight range from the block mode. Returns 0 for the
+// reserved block modes.
+
+static int decode_block_mode(int block_mode, int *grid_width, int *grid_height, int *dual_plane, int *weight_range) {
+	int R = (block_mode >> 4) & 1;
+	int H = (block_mode >> 9) & 1;
+	int D = (block_mode >> 10) & 1;
+	int A = (block_mode >> 5) & 3;
+	if ((block_mode & 3) != 0) {
+		R |= (block_mode & 3) << 1;
+		int B = (block_mode >> 7) & 3;
+		switch ((block_mode >> 2) & 3) {
+		case 0:
+			*grid_width = B + 4;
+			*grid_height = A + 2;
+			break;
+		case 1:
+			*grid_width = B + 8;
+			*grid_height = A + 2;
+			break;
+		case 2:
+			*grid_width = A + 2;
+			*grid_height = B + 8;
+			break;
+		default:
+			B &= 1;
+			if (block_mode & 0x100) {
+				*grid_width = B + 2;
+				*grid_height = A + 2;
+			}
+			else {
+				*grid_width = A + 2;
+				*grid_height = B + 6;
+			}
+			break;
+		}
+	}
+	else {
+		R |= ((block_mode >> 2) & 3) << 1;
+		if (((block_mode >> 2) & 3) == 0)
+			return 0;
+		int B = (block_mode >> 9) & 3;
+		switch ((block_mode >> 7) & 3) {
+		case 0:
+			*grid_width = 12;
+			*grid_height = A + 2;
+			break;
+		case 1:
+			*grid_width = A + 2;
+			*grid_height = 12;
+			break;
+		case 2:
+			*grid_width = A + 6;
+			*grid_height = B + 6;
+			D = 0;
+			H = 0;
+			break;
+		default:
+			if (A == 0) {
+				*grid_width = 6;
+				*grid_height = 10;
+			}
+			else if (A == 1) {
+				*grid_width = 10;
+				*grid_height = 6;
+			}
+			else
+				return 0;
+			break;
+		}
+	}
+	*dual_plane = D;
+	*weight_range = R - 2 + 6 * H;
+	return 1;
+}
+
+// Bilinearly infill the weights of one plane from the weight grid to the block pixels.
+
+static void infill_weights(const int *weights, int plane, int plane_count, int grid_width, int grid_height,
+	int block_width, int block_height, int *pixel_weights) {
+	int ds = (1024 + block_width / 2) / (block_width - 1);
+	int dt = (1024 + block_height / 2) / (block_height - 1);
+	for (int t = 0; t < block_height; t++)
+		for (int s = 0; s < block_width; s++) {
+			int gs = (ds * s * (grid_width - 1) + 32) >> 6;
+			int gt = (dt * t * (grid_height - 1) + 32) >> 6;
+			int js = gs >> 4;
+			int fs = gs & 0xF;
+			int jt = gt >> 4;
+			int ft = gt & 0xF;
+			int w11 = (fs * ft + 8) >> 4;
+			int w10 = ft - w11;
+			int w01 = fs - w11;
+			int w00 = 16 - fs - ft + w11;
+			int v0 = js + jt * grid_width;
+			// The weights of grid points past the edge are always zero.
+			int p00 = weights[v0 * plane_count + plane];
+			int p01 = js + 1 < grid_width ? weights[(v0 + 1) * plane_count + plane] : 0;
+			int p10 = jt + 1 < grid_height ? weights[(v0 + grid_width) * plane_count + plane] : 0;
+			int p11 = js + 1 < grid_width && jt + 1 < grid_height ?
+				weights[(v0 + grid_width + 1) * plane_count + plane] : 0;
+			pixel_weights[t * block_width + s] = (p00 * w00 + p01 * w01 + p10 * w10 + p11 * w11 + 8) >> 4;
+		}
+}
+
+// Convert an interpolated 16-bit component to 8 bits. For sRGB the top 8 bits are used.
+
+static int astc_unorm16_to_unorm8(int value, int srgb) {
+	if (srgb)
+		return value >> 8;
+	return (value * 255 + 32767) / 65535;
+}
+
+static int draw_error_block(unsigned int *image_buffer, int pixel_count) {
+	for (int i = 0; i < pixel_count; i++)
+		image_buffer[i] = pack_rgba(0xFF, 0, 0xFF, 0xFF);
+	return 0;
+}
+
+static int draw_void_extent_block(const uint64_t *words, unsigned int *image_buffer, int pixel_count, int srgb) {
+	// HDR void extent blocks and blocks with the reserved bits not set are errors in LDR mode.
+	if (get_bits(words, 9, 1) || get_bits(words, 10, 2) != 3)
+		return draw_error_block(image_buffer, pixel_count);
+	int s_min = get_bits(words, 12, 13);
+	int s_max = get_bits(words, 25, 13);
+	int t_min = get_bits(words, 38, 13);
+	int t_max = get_bits(words, 51, 13);
+	int all_ones = s_min == 0x1FFF && s_max == 0x1FFF && t_min == 0x1FFF && t_max == 0x1FFF;
+	if (!all_ones && (s_min >= s_max || t_min >= t_max))
+		return draw_error_block(image_buffer, pixel_count);
+	unsigned int pixel = pack_rgba(
+		astc_unorm16_to_unorm8(get_bits(words, 64, 16), srgb),
+		astc_unorm16_to_unorm8(get_bits(words, 80, 16), srgb),
+		astc_unorm16_to_unorm8(get_bits(words, 96, 16), srgb),
+		astc_unorm16_to_unorm8(get_bits(words, 112, 16), srgb));
+	for (int i = 0; i < pixel_count; i++)
+		image_buffer[i] = pixel;
+	return 1;
+}
+
+// Draw a 128-bit ASTC block. flags is the ASTC texture type (one of the TEXTURE_TYPE_RGBA_ASTC_* types, optionally
+// with TEXTURE_TYPE_SRGB_BIT), which determines the block footprint; the pixels are stored row by row. Returns 0 if
+// the block was drawn in the error color.
+
+int draw_block_rgba_astc(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	int astc_block_type = flags & 0xF;
+	if (astc_block_type >= 14)
+		return 0;
+	int block_width = astc_block_size_table[astc_block_type][0];
+	int block_height = astc_block_size_table[astc_block_type][1];
+	int pixel_count = block_width * block_height;
+	int srgb = (flags & TEXTURE_TYPE_SRGB_BIT) != 0;
+	uint64_t words[2];
+	load_block_bits(bitstring, words);
+	int block_mode = get_bits(words, 0, 11);
+	if ((block_mode & 0x1FF) == 0x1FC)
+		return draw_void_extent_block(words, image_buffer, pixel_count, srgb);
+
+	int grid_width, grid_height, dual_plane, weight_range;
+	if (!decode_block_mode(block_mode, &grid_width, &grid_height, &dual_plane, &weight_range))
+		return draw_error_block(image_buffer, pixel_count);
+	int partition_count = get_bits(words, 11, 2) + 1;
+	int weight_count = grid_width * grid_height * (dual_plane + 1);
+	if (weight_count > ASTC_MAX_WEIGHTS || grid_width > block_width || grid_height > block_height ||
+	(dual_plane && partition_count == 4))
+		return draw_error_block(image_buffer, pixel_count);
+	int weight_bits = get_ise_bit_count(weight_count, weight_range);
+	if (weight_bits < 24 || weight_bits > 96)
+		return draw_error_block(image_buffer, pixel_count);
+
+	// The color endpoint modes, and the bits between the configuration and the weights available for the colors.
+	int modes[4];
+	int seed = 0;
+	int color_offset;
+	int below_weights = 128 - weight_bits;
+	if (partition_count == 1) {
+		modes[0] = get_bits(words, 13, 4);
+		color_offset = 17;
+	}
+	else {
+		seed = get_bits(words, 13, 10);
+		int encoded_modes = get_bits(words, 23, 6);
+		if ((encoded_modes & 3) == 0)
+			for (int i = 0; i < partition_count; i++)
+				modes[i] = encoded_modes >> 2;
+		else {
+			// The remaining mode bits are stored right below the weights.
+			int extra_bits = 3 * partition_count - 4;
+			below_weights -= extra_bits;
+			encoded_modes |= get_bits(words, below_weights, extra_bits) << 6;
+			int base_class = (encoded_modes & 3) - 1;
+			for (int i = 0; i < partition_count; i++)
+				modes[i] = ((base_class + ((encoded_modes >> (2 + i)) & 1)) << 2) |
+					((encoded_modes >> (2 + partition_count + 2 * i)) & 3);
+		}
+		color_offset = 29;
+	}
+	int plane2_component = - 1;
+	if (dual_plane) {
+		below_weights -= 2;
+		plane2_component = get_bits(words, below_weights, 2);
+	}
+	int color_value_count = 0;
+	for (int i = 0; i < partition_count; i++)
+		color_value_count += ((modes[i] >> 2) + 1) * 2;
+	if (color_value_count > 18)
+		return draw_error_block(image_buffer, pixel_count);
+	int color_bits = below_weights - color_offset;
+	int color_range = - 1;
+	for (int range = 20; range >= 0; range--)
+		if (get_ise_bit_count(color_value_count, range) <= color_bits) {
+			color_range = range;
+			break;
+		}
+	// At least the range 0..5 is required.
+	if (color_range < 4)
+		return draw_error_block(image_buffer, pixel_count);
+
+	uint64_t color_words[2] = { words[0], words[1] };
+	clear_bits_from(color_words, color_offset + get_ise_bit_count(color_value_count, color_range));
+	int color_values[18];
+	decode_ise(color_words, color_offset, color_value_count, color_range, color_values);
+	for (int i = 0; i < color_value_count; i++)
+		color_values[i] = unquantize_color_value(color_values[i], color_range);
+	int endpoints[4][2][4];
+	const int *v = color_values;
+	for (int i = 0; i < partition_count; i++) {
+		if (!decode_endpoints(modes[i], v, endpoints[i][0], endpoints[i][1]))
+			return draw_error_block(image_buffer, pixel_count);
+		v += ((modes[i] >> 2) + 1) * 2;
+		// Expand the endpoints to 16 bits.
+		for (int j = 0; j < 2; j++)
+			for (int c = 0; c < 4; c++)
+				endpoints[i][j][c] = srgb ? (endpoints[i][j][c] << 8) | 0x80 : endpoints[i][j][c] * 257;
+	}
+
+	// The weights are stored bit-reversed from the top of the block down.
+	uint64_t weight_words[2] = { reverse_bits64(words[1]), reverse_bits64(words[0]) };
+	clear_bits_from(weight_words, weight_bits);
+	int weights[ASTC_MAX_WEIGHTS];
+	decode_ise(weight_words, 0, weight_count, weight_range, weights);
+	for (int i = 0; i < weight_count; i++)
+		weights[i] = unquantize_weight(weights[i], weight_range);
+	int pixel_weights[2][ASTC_MAX_BLOCK_PIXELS];
+	for (int plane = 0; plane <= dual_plane; plane++)
+		infill_weights(weights, plane, dual_plane + 1, grid_width, grid_height, block_width, block_height,
+			pixel_weights[plane]);
+
+	int small_block = pixel_count < 31;
+	for (int y = 0; y < block_height; y++)
+		for (int x = 0; x < block_width; x++) {
+			int i = y * block_width + x;
+			int partition = partition_count > 1 ? select_partition(seed, x, y, partition_count, small_block) : 0;
+			int color[4];
+			for (int c = 0; c < 4; c++) {
+				int w = c == plane2_component ? pixel_weights[1][i] : pixel_weights[0][i];
+				int value = (endpoints[partition][0][c] * (64 - w) + endpoints[partition][1][c] * w + 32) >> 6;
+				color[c] = astc_unorm16_to_unorm8(value, srgb);
+			}
+			image_buffer[i] = pack_rgba(color[0], color[1], color[2], color[3]);
+		}
+	return 1;
+}
+
+// Decode an ASTC texture (with its blocks in texture->pixels) to an RGBA8 image covering the whole blocks.
+
+void convert_astc_texture_to_image(Texture *texture, Image *image) {
+	int block_width = texture->block_width;
+	int block_height = texture->block_height;
+	image->width = texture->width;
+	image->height = texture->height;
+	image->extended_width = (texture->width + block_width - 1) / block_width * block_width;
+	image->extended_height = (texture->height + block_height - 1) / block_height * block_height;
+	image->alpha_bits = 8;
+	image->nu_components = 4;
+	image->bits_per_component = 8;
+	image->is_signed = 0;
+	image->srgb = (texture->type & TEXTURE_TYPE_SRGB_BIT) != 0;
+	image->is_half_float = 0;
+	image->pixels = (unsigned int *)malloc((size_t)image->extended_width * image->extended_height * 4);
+	decode_astc_texture((const unsigned char *)texture->pixels, (unsigned char *)image->pixels, image->extended_width,
+		image->extended_height, image->extended_width * 4, texture->type, 0);
+}
@@ -0,0 +1,378 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "texgenpack.h"
+#include "decode.h"
+#include "packing.h"
+
+// Fast BC1 to BC5 block encoding, for transcoding decoded ETC, EAC and ASTC blocks. Color endpoints are fitted along
+// the principal axis of the block and refined once by least squares; alpha and single channel blocks pick the better
+// of the eight and six level modes. There is no exhaustive endpoint search, so quality is below that of an offline
+// compressor.
+
+// The components of the colors are weighted equally.
+
+static int color_distance(const int *a, const int *b) {
+	int dr = a[0] - b[0];
+	int dg = a[1] - b[1];
+	int db = a[2] - b[2];
+	return dr * dr + dg * dg + db * db;
+}
+
+static int quantize_565(const float *color) {
+	int c[3];
+	static const int max[3] = { 31, 63, 31 };
+	for (int i = 0; i < 3; i++) {
+		float v = color[i] < 0 ? 0 : (color[i] > 255.0f ? 255.0f : color[i]);
+		c[i] = (int)(v * max[i] * (1.0f / 255.0f) + 0.5f);
+	}
+	return (c[0] << 11) | (c[1] << 5) | c[2];
+}
+
+static void expand_565(int color, int *c) {
+	int r = (color & 0xF800) >> 11;
+	int g = (color & 0x07E0) >> 5;
+	int b = color & 0x001F;
+	c[0] = (r << 3) | (r >> 2);
+	c[1] = (g << 2) | (g >> 4);
+	c[2] = (b << 3) | (b >> 2);
+}
+
+// Compute the palette of a DXT color block the way draw_dxt_color_block does; three color mode is used when
+// color0 <= color1.
+
+static void get_dxt_palette(int color0, int color1, int palette[4][3]) {
+	expand_565(color0, palette[0]);
+	expand_565(color1, palette[1]);
+	for (int i = 0; i < 3; i++)
+		if (color0 > color1) {
+			palette[2][i] = (2 * palette[0][i] + palette[1][i] + 1) / 3;
+			palette[3][i] = (palette[0][i] + 2 * palette[1][i] + 1) / 3;
+		}
+		else {
+			palette[2][i] = (palette[0][i] + palette[1][i] + 1) / 2;
+			palette[3][i] = 0;
+		}
+}
+
+// Pick the palette entry for the pixels in mask (the others get index 3) by projecting them onto the line between
+// the endpoints, and return the total error.
+
+static int select_dxt_indices(const int (*colors)[3], int mask, int color0, int color1, unsigned int *indices) {
+	// Palette indices in the order of their position from color0 to color1.
+	static const int order4[4] = { 0, 2, 3, 1 };
+	static const int order3[3] = { 0, 2, 1 };
+	int palette[4][3];
+	get_dxt_palette(color0, color1, palette);
+	int steps = color0 > color1 ? 3 : 2;
+	const int *order = color0 > color1 ? order4 : order3;
+	int direction[3];
+	for (int c = 0; c < 3; c++)
+		direction[c] = palette[1][c] - palette[0][c];
+	int length = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+	float scale = length > 0 ? (float)steps / length : 0.0f;
+	int error = 0;
+	*indices = 0;
+	for (int i = 0; i < 16; i++) {
+		int index = 3;
+		if (mask & (1 << i)) {
+			index = 0;
+			if (length > 0) {
+				int dot = (colors[i][0] - palette[0][0]) * direction[0] + (colors[i][1] - palette[0][1]) * direction[1] +
+					(colors[i][2] - palette[0][2]) * direction[2];
+				int position = (int)(dot * scale + 0.5f);
+				position = dot < 0 ? 0 : (position > steps ? steps : position);
+				index = order[position];
+			}
+			error += color_distance(colors[i], palette[index]);
+		}
+		*indices |= (unsigned int)index << (i * 2);
+	}
+	return error;
+}
+
+// Solve for the endpoints that best fit the pixels in mask given their indices, by least squares.
+// Returns 0 if the system is degenerate.
+
+static int refine_dxt_endpoints(const int (*colors)[3], int mask, unsigned int indices, int four_color, float *end0,
+float *end1) {
+	static const float weights4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	static const float weights3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+	const float *weights = four_color ? weights4 : weights3;
+	float aa = 0, ab = 0, bb = 0;
+	float ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++) {
+		int index = (indices >> (i * 2)) & 3;
+		if (!(mask & (1 << i)) || (!four_color && index == 3))
+			continue;
+		float t = weights[index];
+		float s = 1.0f - t;
+		aa += s * s;
+		ab += s * t;
+		bb += t * t;
+		for (int c = 0; c < 3; c++) {
+			ax[c] += s * colors[i][c];
+			bx[c] += t * colors[i][c];
+		}
+	}
+	float det = aa * bb - ab * ab;
+	if (det < 1e-4f && det > - 1e-4f)
+		return 0;
+	det = 1.0f / det;
+	for (int c = 0; c < 3; c++) {
+		end0[c] = (ax[c] * bb - bx[c] * ab) * det;
+		end1[c] = (bx[c] * aa - ax[c] * ab) * det;
+	}
+	return 1;
+}
+
+// Encode the color part of a DXT block from the pixels in mask. In four color mode (always used for DXT3/DXT5
+// blocks) color0 > color1 unless the block is a single color; otherwise the pixels not in mask get index 3
+// (transparent black) in three color mode.
+
+static void encode_dxt_color_block(const unsigned int *pixels, int mask, int four_color_mode, unsigned char *bitstring) {
+	int colors[16][3];
+	float mean[3] = { 0, 0, 0 };
+	int count = 0;
+	int min[3] = { 255, 255, 255 }, max[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++) {
+		colors[i][0] = pixel_get_r(pixels[i]);
+		colors[i][1] = pixel_get_g(pixels[i]);
+		colors[i][2] = pixel_get_b(pixels[i]);
+		if (!(mask & (1 << i)))
+			continue;
+		for (int c = 0; c < 3; c++) {
+			mean[c] += colors[i][c];
+			if (colors[i][c] < min[c])
+				min[c] = colors[i][c];
+			if (colors[i][c] > max[c])
+				max[c] = colors[i][c];
+		}
+		count++;
+	}
+	int color0, color1;
+	unsigned int indices;
+	if (count == 0) {
+		// Fully transparent.
+		color0 = color1 = 0;
+		indices = 0xFFFFFFFF;
+	}
+	else {
+		for (int c = 0; c < 3; c++)
+			mean[c] /= count;
+		// Principal axis by power iteration on the covariance matrix, starting from the bounding box diagonal.
+		float cov[6] = { 0, 0, 0, 0, 0, 0 };
+		for (int i = 0; i < 16; i++) {
+			if (!(mask & (1 << i)))
+				continue;
+			float r = colors[i][0] - mean[0];
+			float g = colors[i][1] - mean[1];
+			float b = colors[i][2] - mean[2];
+			cov[0] += r * r;
+			cov[1] += r * g;
+			cov[2] += r * b;
+			cov[3] += g * g;
+			cov[4] += g * b;
+			cov[5] += b * b;
+		}
+		float axis[3] = { (float)(max[0] - min[0]), (float)(max[1] - min[1]), (float)(max[2] - min[2]) };
+		for (int iteration = 0; iteration < 4; iteration++) {
+			float x = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+			float y = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+			float z = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+			float m = x * x + y * y + z * z;
+			if (m < 1e-6f)
+				break;
+			// Rescale to keep the values in range; the length of the axis does not matter.
+			float largest = x < 0 ? - x : x;
+			if ((y < 0 ? - y : y) > largest)
+				largest = y < 0 ? - y : y;
+			if ((z < 0 ? - z : z) > largest)
+				largest = z < 0 ? - z : z;
+			largest = 1.0f / largest;
+			axis[0] = x * largest;
+			axis[1] = y * largest;
+			axis[2] = z * largest;
+		}
+		// The pixels at the extremes along the axis, inset slightly, make the initial endpoints.
+		float min_dot = 1e30f, max_dot = - 1e30f;
+		int min_pixel = 0, max_pixel = 0;
+		for (int i = 0; i < 16; i++) {
+			if (!(mask & (1 << i)))
+				continue;
+			float dot = colors[i][0] * axis[0] + colors[i][1] * axis[1] + colors[i][2] * axis[2];
+			if (dot < min_dot) {
+				min_dot = dot;
+				min_pixel = i;
+			}
+			if (dot > max_dot) {
+				max_dot = dot;
+				max_pixel = i;
+			}
+		}
+		float end0[3], end1[3];
+		for (int c = 0; c < 3; c++) {
+			float inset = (colors[max_pixel][c] - colors[min_pixel][c]) / 16.0f;
+			end0[c] = colors[max_pixel][c] - inset;
+			end1[c] = colors[min_pixel][c] + inset;
+		}
+		color0 = quantize_565(end0);
+		color1 = quantize_565(end1);
+		int four_color = four_color_mode || mask == 0xFFFF;
+		if (four_color ? color0 < color1 : color0 > color1) {
+			int t = color0;
+			color0 = color1;
+			color1 = t;
+		}
+		int error = select_dxt_indices(colors, mask, color0, color1, &indices);
+		if (error > 0 && refine_dxt_endpoints(colors, mask, indices, color0 > color1, end0, end1)) {
+			int refined0 = quantize_565(end0);
+			int refined1 = quantize_565(end1);
+			if (four_color ? refined0 < refined1 : refined0 > refined1) {
+				int t = refined0;
+				refined0 = refined1;
+				refined1 = t;
+			}
+			unsigned int refined_indices;
+			int refined_error = select_dxt_indices(colors, mask, refined0, refined1, &refined_indices);
+			if (refined_error < error) {
+				color0 = refined0;
+				color1 = refined1;
+				indices = refined_indices;
+			}
+		}
+	}
+	bitstring[0] = color0 & 0xFF;
+	bitstring[1] = color0 >> 8;
+	bitstring[2] = color1 & 0xFF;
+	bitstring[3] = color1 >> 8;
+	bitstring[4] = indices & 0xFF;
+	bitstring[5] = (indices >> 8) & 0xFF;
+	bitstring[6] = (indices >> 16) & 0xFF;
+	bitstring[7] = indices >> 24;
+}
+
+// Select the level of a DXT5 alpha block for each value from its position between the endpoints, and return the
+// total error.
+
+static int select_dxt5_alpha_indices(const unsigned char *values, int alpha0, int alpha1, uint64_t *indices) {
+	int levels[8];
+	get_dxt5_alpha_levels(alpha0, alpha1, levels);
+	float scale = alpha0 > alpha1 ? 7.0f / (alpha0 - alpha1) : (alpha0 < alpha1 ? 5.0f / (alpha1 - alpha0) : 0.0f);
+	int error = 0;
+	*indices = 0;
+	for (int i = 0; i < 16; i++) {
+		int v = values[i];
+		int index;
+		if (alpha0 > alpha1) {
+			// Eight levels from alpha0 down to alpha1.
+			int position = (int)((alpha0 - v) * scale + 0.5f);
+			position = v >= alpha0 ? 0 : (position > 7 ? 7 : position);
+			index = position == 0 ? 0 : (position == 7 ? 1 : position + 1);
+		}
+		else if (v <= alpha0)
+			// Below the six levels from alpha0 up to alpha1: alpha0 or the extra level 0.
+			index = alpha0 - v <= v ? 0 : 6;
+		else if (v >= alpha1)
+			index = v - alpha1 <= 255 - v ? 1 : 7;
+		else {
+			int position = (int)((v - alpha0) * scale + 0.5f);
+			index = position == 0 ? 0 : (position == 5 ? 1 : position + 1);
+		}
+		error += (v - levels[index]) * (v - levels[index]);
+		*indices |= (uint64_t)index << (i * 3);
+	}
+	return error;
+}
+
+// Encode 16 8-bit values as a DXT5 alpha (unsigned RGTC1) block.
+
+static void encode_dxt5_alpha_block(const unsigned char *values, unsigned char *bitstring) {
+	int min = 255, max = 0;
+	// The range without the values 0 and 255, which the six level mode has as extra levels.
+	int inner_min = 255, inner_max = 0;
+	for (int i = 0; i < 16; i++) {
+		if (values[i] < min)
+			min = values[i];
+		if (values[i] > max)
+			max = values[i];
+		if (values[i] != 0 && values[i] < inner_min)
+			inner_min = values[i];
+		if (values[i] != 255 && values[i] > inner_max)
+			inner_max = values[i];
+	}
+	int alpha0, alpha1;
+	uint64_t indices;
+	if (min == max) {
+		alpha0 = alpha1 = min;
+		indices = 0;
+	}
+	else {
+		alpha0 = max;
+		alpha1 = min;
+		int error = select_dxt5_alpha_indices(values, alpha0, alpha1, &indices);
+		if (error > 0 && (min == 0 || max == 255)) {
+			if (inner_min > inner_max)
+				inner_min = inner_max = min == 0 ? max : min;
+			uint64_t six_level_indices;
+			int six_level_error = select_dxt5_alpha_indices(values, inner_min, inner_max, &six_level_indices);
+			if (six_level_error < error) {
+				alpha0 = inner_min;
+				alpha1 = inner_max;
+				indices = six_level_indices;
+			}
+		}
+	}
+	bitstring[0] = alpha0;
+	bitstring[1] = alpha1;
+	for (int i = 0; i < 6; i++)
+		bitstring[2 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+// Encode a block of 16 RGBA8 pixels as 64-bit DXT1 data, ignoring alpha.
+
+void encode_block4x4_dxt1_fast(const unsigned int *pixels, unsigned char *bitstring) {
+	encode_dxt_color_block(pixels, 0xFFFF, 0, bitstring);
+}
+
+// Encode a block of 16 RGBA8 pixels as 64-bit DXT1 data with one bit alpha; pixels with alpha below 128 become
+// transparent black.
+
+void encode_block4x4_dxt1a_fast(const unsigned int *pixels, unsigned char *bitstring) {
+	int mask = 0;
+	for (int i = 0; i < 16; i++)
+		if (pixel_get_a(pixels[i]) >= 128)
+			mask |= 1 << i;
+	encode_dxt_color_block(pixels, mask, 0, bitstring);
+}
+
+// Encode a block of 16 RGBA8 pixels as 128-bit DXT5 data.
+
+void encode_block4x4_dxt5_fast(const unsigned int *pixels, unsigned char *bitstring) {
+	unsigned char alpha[16];
+	for (int i = 0; i < 16; i++)
+		alpha[i] = pixel_get_a(pixels[i]);
+	encode_dxt5_alpha_block(alpha, bitstring);
+	encode_dxt_color_block(pixels, 0xFFFF, 1, &bitstring[8]);
+}
+
+// Encode the red components of a block of 16 RGBA8 pixels as 64-bit RGTC1 data.
+
+void encode_block4x4_rgtc1_fast(const unsigned int *pixels, unsigned char *bitstring) {
+	unsigned char red[16];
+	for (int i = 0; i < 16; i++)
+		red[i] = pixel_get_r(pixels[i]);
+	encode_dxt5_alpha_block(red, bitstring);
+}
+
+// Encode the red and green components of a block of 16 RGBA8 pixels as 128-bit RGTC2 data.
+
+void encode_block4x4_rgtc2_fast(const unsigned int *pixels, unsigned char *bitstring) {
+	unsigned char red[16], green[16];
+	for (int i = 0; i < 16; i++) {
+		red[i] = pixel_get_r(pixels[i]);
+		green[i] = pixel_get_g(pixels[i]);
+	}
+	encode_dxt5_alpha_block(red, bitstring);
+	encode_dxt5_alpha_block(green, &bitstring[8]);
+}
@@ -63,6 +63,35 @@ void block4x4_etc2_eac_set_mode(unsigned char *bitstring, int flags);
 void optimize_block_alpha_etc2_punchthrough(unsigned char *bitstring, unsigned char *alpha_values);
 void optimize_block_alpha_etc2_eac(unsigned char *bitstring, unsigned char *alpha_values, int flags);
 
+// Set whether the ETC1 and ETC2 RGB8 decoders may use the SIMD block drawing functions (the default).
+// Returns 1 if SIMD decoding is in use afterwards.
+int set_etc_simd_enabled(int enabled);
+
+// Functions defined in etc2_simd.c.
+
+// Draw the pixels of a block from its expanded base colors; the output is the same as that of the scalar code.
+typedef struct {
+	// base_colors holds the RGB colors of the two subblocks.
+	void (*draw_subblocks)(const int *base_colors, int table_codeword1, int table_codeword2, int flipbit,
+		unsigned int pixel_index_word, unsigned int *image_buffer);
+	// base_colors holds the two RGB base colors, mode is 0 for T mode and 1 for H mode.
+	void (*draw_T_or_H_mode)(const int *base_colors, int distance, int mode, unsigned int pixel_index_word,
+		unsigned int *image_buffer);
+	// colors holds the RGB colors O, H and V.
+	void (*draw_planar_mode)(const int *colors, unsigned int *image_buffer);
+} EtcSimdFunctions;
+
+// Return the block drawing functions for the SIMD instruction set of this CPU, or NULL if there are none.
+const EtcSimdFunctions *get_etc_simd_functions(void);
+
+// Functions defined in parallel.c.
+
+typedef void (*parallel_rows_function)(void *data, int begin, int end);
+int get_number_of_processors(void);
+// Call function over [0, rows) split into contiguous ranges of at least min_rows_per_thread rows,
+// using up to threads threads including the calling one.
+void parallel_for_rows(int rows, int threads, int min_rows_per_thread, parallel_rows_function function, void *data);
+
 // Functions defined in dxtc.c.
 
 int draw_block4x4_dxt1(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
@@ -70,13 +99,18 @@ int draw_block4x4_dxt1a(const unsigned char *bitstring, unsigned int *image_buff
 int draw_block4x4_dxt3(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
 int draw_block4x4_dxt5(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
 void optimize_block_alpha_dxt3(unsigned char *bitstring, unsigned char *alpha_values);
+// Decode the eight levels of a DXT5 alpha (or RGTC1) block from its endpoints.
+void get_dxt5_alpha_levels(int alpha0, int alpha1, int *levels);
 
 // Functions defined in astc.c
 
+// Draw an LDR ASTC block of the footprint given by flags, which is the ASTC texture type (TEXTURE_TYPE_RGBA_ASTC_*
+// or TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_*). Error blocks are drawn in opaque magenta and return 0.
 int draw_block_rgba_astc(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
 void convert_astc_texture_to_image(Texture *texture, Image *image);
 void decompress_astc_file(const char *filename, Image *image);
 void compress_image_to_astc_texture(Image *image, int texture_type, Texture *texture);
+// ASTC block types index the footprints from 4x4 (0) to 12x12 (13), in the order of the texture types.
 int match_astc_block_size(int w, int h);
 int get_astc_block_size_width(int astc_block_type);
 int get_astc_block_size_height(int astc_block_type);
@@ -100,7 +134,71 @@ int draw_block4x4_signed_rgtc1(const unsigned char *bitstring, unsigned int *ima
 int draw_block4x4_rgtc2(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
 int draw_block4x4_signed_rgtc2(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
 
-// Function defined in texture.c.
+// Functions defined in bcenc.c.
+
+// Fast encoding of a block of 16 RGBA8 pixels (as drawn by the decoding functions) for transcoding. DXT1 ignores
+// alpha, DXT1A makes pixels with alpha below 128 transparent, RGTC1 and RGTC2 take the red and green components.
+void encode_block4x4_dxt1_fast(const unsigned int *pixels, unsigned char *bitstring);
+void encode_block4x4_dxt1a_fast(const unsigned int *pixels, unsigned char *bitstring);
+void encode_block4x4_dxt5_fast(const unsigned int *pixels, unsigned char *bitstring);
+void encode_block4x4_rgtc1_fast(const unsigned int *pixels, unsigned char *bitstring);
+void encode_block4x4_rgtc2_fast(const unsigned int *pixels, unsigned char *bitstring);
+
+// Functions defined in texture.c.
+
+// Decode a whole ETC1, ETC2 or EAC texture of the given texture type (any of the TEXTURE_TYPE_ETC*, *_R11_EAC and
+// *_RG11_EAC types) to pixels of dst_format. Rows of blocks are split across threads (threads <= 0 selects the
+// number of processors) and written straight into dst, pitch bytes apart; partial blocks at the right and bottom
+// edges are clipped. dst_format is TEXTURE_TYPE_UNCOMPRESSED_RGBA8 for all types; the R11 and RG11 types can also be
+// decoded to (SIGNED_)R8 and (SIGNED_)RG8 respectively. The signed types produce signed normalized bytes, with alpha
+// 0x7F when decoding to RGBA8. Returns 0 for an unsupported combination of types.
+int decode_etc_texture_to_format(const unsigned char *src, unsigned char *dst, int width, int height, int pitch,
+	int format, int dst_format, int threads);
+// Same as above, decoding to RGBA8.
+int decode_etc_texture(const unsigned char *src, unsigned char *dst, int width, int height, int pitch, int format, int threads);
+// The same for the BC1 to BC5 texture types (TEXTURE_TYPE_DXT* and *RGTC*), where the RGTC1 and RGTC2 types can
+// also be decoded to (SIGNED_)R8 and (SIGNED_)RG8 respectively.
+int decode_bc_texture_to_format(const unsigned char *src, unsigned char *dst, int width, int height, int pitch,
+	int format, int dst_format, int threads);
+int decode_bc_texture(const unsigned char *src, unsigned char *dst, int width, int height, int pitch, int format, int threads);
+// The same for the LDR ASTC texture types of all 2D footprints, decoding to RGBA8.
+int decode_astc_texture(const unsigned char *src, unsigned char *dst, int width, int height, int pitch, int format, int threads);
+// Return the BC texture type transcode_texture_to_bc produces for an unsigned ETC, EAC or ASTC texture type:
+// TEXTURE_TYPE_DXT1 for ETC1 and ETC2 RGB8, DXT1A for punch-through alpha, DXT5 for ETC2 EAC and ASTC, RGTC1 and
+// RGTC2 for R11 and RG11 EAC. Returns 0 for the other types.
+int get_bc_transcode_format(int format);
+// Transcode a whole texture to 4x4 blocks of get_bc_transcode_format(format), stored row by row in dst. Each block
+// is decoded and re-encoded with the fast BC encoders, across threads like the decoding functions. Returns 0 for an
+// unsupported type or if memory runs out.
+int transcode_texture_to_bc(const unsigned char *src, unsigned char *dst, int width, int height, int format,
+	int threads);
+
+// Functions defined in job.c.
+
+// One mip level of a texture decoded by a job: src holds its blocks, dst receives the pixels (pitch bytes per row)
+// or the transcoded blocks.
+typedef struct {
+	const unsigned char *src;
+	unsigned char *dst;
+	int width;
+	int height;
+	int pitch;
+} DecodeJobLevel;
+
+typedef struct DecodeJob DecodeJob;
+// Called from the decoding thread after each level with its index and 1 for success or 0 for failure, then once
+// with level -1 and the number of levels decoded when the job is over. The job is freed after that last call
+// returns.
+typedef void (*decode_job_function)(void *data, int level, int result);
+// Start decoding the levels of a texture in the background, smallest level first, each across threads like the
+// whole texture decoders. dst_format is one of the uncompressed types decode_*_texture_to_format take, or
+// get_bc_transcode_format(format) to transcode. The levels array is copied, the memory it points to must stay valid
+// until the last callback. Returns NULL for an unsupported combination of types or when a thread can't be started,
+// in which case the callback is never called.
+DecodeJob *start_decode_job(const DecodeJobLevel *levels, int level_count, int format, int dst_format, int threads,
+	decode_job_function callback, void *data);
+// Skip the levels of a job not started yet. The last callback still comes, the job must not be used after it.
+void cancel_decode_job(DecodeJob *job);
 
 int draw_block4x4_uncompressed(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
 int draw_block4x4_argb8(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "texgenpack.h"
+#include "decode.h"
+#include "packing.h"
+
+// DXT1, DXT1A, DXT3 and DXT5 (BC1 to BC3) block decoding. Written for this library against the prototypes the
+// upstream texgenpack decode.h declares for dxtc.c; the code itself isn't taken from texgenpack.
+
+// Expand the two RGB565 endpoint colors of a DXT color block to 8 bits per component by bit replication.
+
+static void get_dxt_endpoints(const unsigned char *bitstring, int *color0, int *color1) {
+	int colors[2];
+	colors[0] = bitstring[0] | (bitstring[1] << 8);
+	colors[1] = bitstring[2] | (bitstring[3] << 8);
+	for (int i = 0; i < 2; i++) {
+		int *c = i == 0 ? color0 : color1;
+		int r = (colors[i] & 0xF800) >> 11;
+		int g = (colors[i] & 0x07E0) >> 5;
+		int b = colors[i] & 0x001F;
+		c[0] = (r << 3) | (r >> 2);
+		c[1] = (g << 2) | (g >> 4);
+		c[2] = (b << 3) | (b >> 2);
+	}
+}
+
+// Draw the color part of a DXT block (the 64 bits at bitstring). In four color mode, which DXT3 and DXT5 always
+// use, the two intermediate colors lie at 1/3 and 2/3 between the endpoints; otherwise the third color is the average
+// of the endpoints and the fourth one is black with alpha black_alpha. Interpolated components are rounded to
+// nearest.
+
+static void draw_dxt_color_block(const unsigned char *bitstring, unsigned int *image_buffer, int four_color_mode,
+	int black_alpha) {
+	int color0[3], color1[3];
+	get_dxt_endpoints(bitstring, color0, color1);
+	unsigned int colors[4];
+	colors[0] = pack_rgb_alpha_0xff(color0[0], color0[1], color0[2]);
+	colors[1] = pack_rgb_alpha_0xff(color1[0], color1[1], color1[2]);
+	int c0 = bitstring[0] | (bitstring[1] << 8);
+	int c1 = bitstring[2] | (bitstring[3] << 8);
+	if (four_color_mode || c0 > c1) {
+		colors[2] = pack_rgb_alpha_0xff(
+			(2 * color0[0] + color1[0] + 1) / 3,
+			(2 * color0[1] + color1[1] + 1) / 3,
+			(2 * color0[2] + color1[2] + 1) / 3);
+		colors[3] = pack_rgb_alpha_0xff(
+			(color0[0] + 2 * color1[0] + 1) / 3,
+			(color0[1] + 2 * color1[1] + 1) / 3,
+			(color0[2] + 2 * color1[2] + 1) / 3);
+	}
+	else {
+		colors[2] = pack_rgb_alpha_0xff(
+			(color0[0] + color1[0] + 1) / 2,
+			(color0[1] + color1[1] + 1) / 2,
+			(color0[2] + color1[2] + 1) / 2);
+		colors[3] = pack_rgba(0, 0, 0, black_alpha);
+	}
+	unsigned int pixel_indices = bitstring[4] | (bitstring[5] << 8) | (bitstring[6] << 16) |
+		((unsigned int)bitstring[7] << 24);
+	for (int i = 0; i < 16; i++)
+		image_buffer[i] = colors[(pixel_indices >> (i * 2)) & 3];
+}
+
+// Draw a 4x4 pixel block using 64-bit DXT1 compression data. The fourth color of three color mode blocks is
+// opaque black.
+
+int draw_block4x4_dxt1(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	draw_dxt_color_block(bitstring, image_buffer, 0, 0xFF);
+	return 1;
+}
+
+// Draw a 4x4 pixel block using 64-bit DXT1 compression data with one bit alpha. The fourth color of three color
+// mode blocks is transparent black.
+
+int draw_block4x4_dxt1a(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	draw_dxt_color_block(bitstring, image_buffer, 0, 0);
+	return 1;
+}
+
+// Draw a 4x4 pixel block using 128-bit DXT3 compression data (4-bit explicit alpha followed by a DXT1 color block).
+
+int draw_block4x4_dxt3(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	draw_dxt_color_block(&bitstring[8], image_buffer, 1, 0xFF);
+	for (int i = 0; i < 16; i++) {
+		int alpha = (bitstring[i >> 1] >> ((i & 1) * 4)) & 0xF;
+		*((unsigned char *)&image_buffer[i] + alpha_byte_offset) = alpha * 17;
+	}
+	return 1;
+}
+
+// Decode the eight alpha levels of a DXT5 alpha block (the same as an unsigned RGTC1 block) from its two 8-bit
+// endpoints, rounding interpolated values to nearest.
+
+void get_dxt5_alpha_levels(int alpha0, int alpha1, int *levels) {
+	levels[0] = alpha0;
+	levels[1] = alpha1;
+	if (alpha0 > alpha1)
+		for (int i = 1; i < 7; i++)
+			levels[i + 1] = ((7 - i) * alpha0 + i * alpha1 + 3) / 7;
+	else {
+		for (int i = 1; i < 5; i++)
+			levels[i + 1] = ((5 - i) * alpha0 + i * alpha1 + 2) / 5;
+		levels[6] = 0;
+		levels[7] = 0xFF;
+	}
+}
+
+// Draw a 4x4 pixel block using 128-bit DXT5 compression data (an interpolated alpha block followed by a DXT1 color
+// block).
+
+int draw_block4x4_dxt5(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	draw_dxt_color_block(&bitstring[8], image_buffer, 1, 0xFF);
+	int levels[8];
+	get_dxt5_alpha_levels(bitstring[0], bitstring[1], levels);
+	uint64_t alpha_indices = (uint64_t)bitstring[2] | ((uint64_t)bitstring[3] << 8) | ((uint64_t)bitstring[4] << 16) |
+		((uint64_t)bitstring[5] << 24) | ((uint64_t)bitstring[6] << 32) | ((uint64_t)bitstring[7] << 40);
+	for (int i = 0; i < 16; i++)
+		*((unsigned char *)&image_buffer[i] + alpha_byte_offset) = levels[(alpha_indices >> (i * 3)) & 7];
+	return 1;
+}
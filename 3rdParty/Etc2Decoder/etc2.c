@@ -138,6 +138,21 @@ static int complement3bit(int x) {
 	return x;
 }
 
+// The SIMD block drawing functions, unless disabled with set_etc_simd_enabled().
+
+static int etc_simd_disabled = 0;
+
+static const EtcSimdFunctions *etc_simd(void) {
+	if (etc_simd_disabled)
+		return NULL;
+	return get_etc_simd_functions();
+}
+
+int set_etc_simd_enabled(int enabled) {
+	etc_simd_disabled = !enabled;
+	return etc_simd() != NULL;
+}
+
 // Define some macros to speed up ETC1 decoding.
 
 #define do_flipbit0_pixel0to7(val) \
@@ -252,6 +267,16 @@ int draw_block4x4_etc1(const unsigned char *bitstring, unsigned int *image_buffe
 	int table_codeword2 = (bitstring[3] & 28) >> 2;
 	unsigned int pixel_index_word = ((unsigned int)bitstring[4] << 24) | ((unsigned int)bitstring[5] << 16) |
 		((unsigned int)bitstring[6] << 8) | bitstring[7];
+	const EtcSimdFunctions *simd = etc_simd();
+	if (simd) {
+		int base_colors[6] = {
+			base_color_subblock1_R, base_color_subblock1_G, base_color_subblock1_B,
+			base_color_subblock2_R, base_color_subblock2_G, base_color_subblock2_B
+		};
+		simd->draw_subblocks(base_colors, table_codeword1, table_codeword2, flipbit, pixel_index_word,
+			image_buffer);
+		return 1;
+	}
 #if 1
 	if (flipbit == 0) {
 		do_flipbit0_pixel0to7(0);
@@ -360,18 +385,6 @@ static void draw_block4x4_rgb8_etc2_T_or_H_mode(const unsigned char *bitstring,
 		base_color2_B |= base_color2_B >> 4;
 		// index = (da << 1) | db
 		distance = etc2_distance_table[((bitstring[3] & 0x0C) >> 1) | (bitstring[3] & 0x1)];
-		paint_color_R[0] = base_color1_R;
-		paint_color_G[0] = base_color1_G;
-		paint_color_B[0] = base_color1_B;
-		paint_color_R[2] = base_color2_R;
-		paint_color_G[2] = base_color2_G;
-		paint_color_B[2] = base_color2_B;
-		paint_color_R[1] = clamp(base_color2_R + distance);
-		paint_color_G[1] = clamp(base_color2_G + distance);
-		paint_color_B[1] = clamp(base_color2_B + distance);
-		paint_color_R[3] = clamp(base_color2_R - distance);
-		paint_color_G[3] = clamp(base_color2_G - distance);
-		paint_color_B[3] = clamp(base_color2_B - distance);
 	}
 	else {
 		// H mode.
@@ -397,6 +410,32 @@ static void draw_block4x4_rgb8_etc2_T_or_H_mode(const unsigned char *bitstring,
 		else
 			bit = 0;
 		distance = etc2_distance_table[(bitstring[3] & 0x04) | ((bitstring[3] & 0x01) << 1) | bit];
+	}
+	unsigned int pixel_index_word = ((unsigned int)bitstring[4] << 24) | ((unsigned int)bitstring[5] << 16) |
+		((unsigned int)bitstring[6] << 8) | bitstring[7];
+	const EtcSimdFunctions *simd = etc_simd();
+	if (simd) {
+		int base_colors[6] = { base_color1_R, base_color1_G, base_color1_B, base_color2_R, base_color2_G, base_color2_B };
+		simd->draw_T_or_H_mode(base_colors, distance, mode, pixel_index_word, image_buffer);
+		return;
+	}
+	if (mode == 0) {
+		// T mode.
+		paint_color_R[0] = base_color1_R;
+		paint_color_G[0] = base_color1_G;
+		paint_color_B[0] = base_color1_B;
+		paint_color_R[2] = base_color2_R;
+		paint_color_G[2] = base_color2_G;
+		paint_color_B[2] = base_color2_B;
+		paint_color_R[1] = clamp(base_color2_R + distance);
+		paint_color_G[1] = clamp(base_color2_G + distance);
+		paint_color_B[1] = clamp(base_color2_B + distance);
+		paint_color_R[3] = clamp(base_color2_R - distance);
+		paint_color_G[3] = clamp(base_color2_G - distance);
+		paint_color_B[3] = clamp(base_color2_B - distance);
+	}
+	else {
+		// H mode.
 		paint_color_R[0] = clamp(base_color1_R + distance);
 		paint_color_G[0] = clamp(base_color1_G + distance);
 		paint_color_B[0] = clamp(base_color1_B + distance);
@@ -410,8 +449,6 @@ static void draw_block4x4_rgb8_etc2_T_or_H_mode(const unsigned char *bitstring,
 		paint_color_G[3] = clamp(base_color2_G - distance);
 		paint_color_B[3] = clamp(base_color2_B - distance);
 	}
-	unsigned int pixel_index_word = ((unsigned int)bitstring[4] << 24) | ((unsigned int)bitstring[5] << 16) |
-		((unsigned int)bitstring[6] << 8) | bitstring[7];
 	for (int i = 0; i < 16; i++) {
 		int pixel_index = ((pixel_index_word & (1 << i)) >> i)			// Least significant bit.
 			| ((pixel_index_word & (0x10000 << i)) >> (16 + i - 1));	// Most significant bit.
@@ -443,6 +480,12 @@ static void draw_block4x4_rgb8_etc2_planar_mode(const unsigned char *bitstring,
 	RV = (RV << 2) | ((RV & 0x30) >> 4);
 	GV = (GV << 1) | ((GV & 0x40) >> 6);
 	BV = (BV << 2) | ((BV & 0x30) >> 4);
+	const EtcSimdFunctions *simd = etc_simd();
+	if (simd) {
+		int colors[9] = { RO, GO, BO, RH, GH, BH, RV, GV, BV };
+		simd->draw_planar_mode(colors, image_buffer);
+		return;
+	}
 	for (int y = 0; y < 4; y++)
 		for (int x = 0; x < 4; x++) {
 			int r = clamp((x * (RH - RO) + y * (RV - RO) + 4 * RO + 2) >> 2);
@@ -1094,10 +1137,13 @@ static unsigned int replicate_11bits_signed_to_16bits(int value) {
 // zero, in the last 16 bits in memory if offset is 1.
 
 int decode_block4x4_11bits_signed(uint64_t qword, unsigned int *image_buffer, int offset, int flags) {
-	int base_codeword = (char)((qword & 0xFF00000000000000) >> 56);		// Signed 8 bits.
-	if (base_codeword == - 128 /* && (flags & ENCODE_BIT) */)
-		// Not allowed in encoding. Decoder should handle it but we don't do that yet.
-		return 0;
+	int base_codeword = (signed char)((qword & 0xFF00000000000000) >> 56);	// Signed 8 bits.
+	if (base_codeword == - 128) {
+		// Not allowed in encoding. A decoder has to treat it as -127.
+		if (flags & ENCODE_BIT)
+			return 0;
+		base_codeword = - 127;
+	}
 	int base_codeword_times_8 = base_codeword << 3;				// Arithmetic shift.
 	int modifier_index = (qword & 0x000F000000000000) >> 48;
 	int *modifier_table = eac_modifier_table[modifier_index];
@@ -0,0 +1,325 @@
+#include <stdint.h>
+#include "texgenpack.h"
+#include "decode.h"
+
+// SIMD versions of the per-pixel part of the ETC1 and ETC2 RGB8 decoders. The block header is still parsed
+// by the scalar code in etc2.c; these functions get the expanded base colors and produce exactly the same
+// pixels. Individual, differential, T and H mode blocks become a palette of at most eight colors, computed
+// with 16-bit adds and an unsigned saturating pack (which is the clamp to 0-255), that is then indexed with
+// a byte shuffle. Planar mode blocks are interpolated in 16-bit lanes and packed the same way.
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ETC_SIMD_NEON
+#include <arm_neon.h>
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ETC_SIMD_X86
+#define ETC_TARGET_SSE41 __attribute__((target("ssse3,sse4.1")))
+#define ETC_TARGET_AVX2 __attribute__((target("ssse3,sse4.1,avx,avx2")))
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#define ETC_SIMD_X86
+#define ETC_TARGET_SSE41
+#define ETC_TARGET_AVX2
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(ETC_SIMD_NEON) || defined(ETC_SIMD_X86)
+
+// modifier_table from etc2.c with each modifier repeated for the R, G and B lanes of a palette entry.
+
+static const int16_t modifier_vectors[8][16] = {
+	{ 2, 2, 2, 0, 8, 8, 8, 0, -2, -2, -2, 0, -8, -8, -8, 0 },
+	{ 5, 5, 5, 0, 17, 17, 17, 0, -5, -5, -5, 0, -17, -17, -17, 0 },
+	{ 9, 9, 9, 0, 29, 29, 29, 0, -9, -9, -9, 0, -29, -29, -29, 0 },
+	{ 13, 13, 13, 0, 42, 42, 42, 0, -13, -13, -13, 0, -42, -42, -42, 0 },
+	{ 18, 18, 18, 0, 60, 60, 60, 0, -18, -18, -18, 0, -60, -60, -60, 0 },
+	{ 24, 24, 24, 0, 80, 80, 80, 0, -24, -24, -24, 0, -80, -80, -80, 0 },
+	{ 33, 33, 33, 0, 106, 106, 106, 0, -33, -33, -33, 0, -106, -106, -106, 0 },
+	{ 47, 47, 47, 0, 183, 183, 183, 0, -47, -47, -47, 0, -183, -183, -183, 0 }
+};
+
+// Pixels are stored column by column in the pixel index word: pixel (x, y) uses bit x * 4 + y for the
+// least significant index bit and bit x * 4 + y + 16 for the most significant one. These are the shift
+// counts and masks of the least significant bits for the four pixels of each row.
+
+static const uint32_t pixel_index_shifts[4][4] = {
+	{ 0, 4, 8, 12 },
+	{ 1, 5, 9, 13 },
+	{ 2, 6, 10, 14 },
+	{ 3, 7, 11, 15 }
+};
+
+static const uint32_t pixel_index_bits[4][4] = {
+	{ 1 << 0, 1 << 4, 1 << 8, 1 << 12 },
+	{ 1 << 1, 1 << 5, 1 << 9, 1 << 13 },
+	{ 1 << 2, 1 << 6, 1 << 10, 1 << 14 },
+	{ 1 << 3, 1 << 7, 1 << 11, 1 << 15 }
+};
+
+// Palette offset of the second subblock for each pixel of a row: columns 2 and 3 when the flip bit is 0,
+// rows 2 and 3 when it is 1. T and H mode blocks use the third, all zero, entry.
+
+static const uint32_t subblock_offsets[3][4][4] = {
+	{ { 0, 0, 4, 4 }, { 0, 0, 4, 4 }, { 0, 0, 4, 4 }, { 0, 0, 4, 4 } },
+	{ { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 4, 4, 4, 4 }, { 4, 4, 4, 4 } },
+	{ { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 } }
+};
+
+#endif
+
+#ifdef ETC_SIMD_X86
+
+// Palette entries 0 to 3 are in palette_lo, 4 to 7 in palette_hi.
+
+ETC_TARGET_SSE41 static void draw_palette_sse41(__m128i palette_lo, __m128i palette_hi, unsigned int pixel_index_word,
+	int subblocks, unsigned int *image_buffer) {
+	__m128i word = _mm_set1_epi32((int)pixel_index_word);
+	__m128i one = _mm_set1_epi32(1);
+	__m128i three = _mm_set1_epi32(3);
+	for (int y = 0; y < 4; y++) {
+		__m128i lsb_mask = _mm_loadu_si128((const __m128i *)pixel_index_bits[y]);
+		__m128i msb_mask = _mm_slli_epi32(lsb_mask, 16);
+		__m128i lsb = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(word, lsb_mask), lsb_mask), one);
+		__m128i msb = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(word, msb_mask), msb_mask), _mm_set1_epi32(2));
+		__m128i entry = _mm_or_si128(_mm_or_si128(lsb, msb),
+			_mm_loadu_si128((const __m128i *)subblock_offsets[subblocks][y]));
+		// Byte shuffle selecting the four bytes of the entry; the low four bits address within a half.
+		__m128i selector = _mm_add_epi32(_mm_mullo_epi32(entry, _mm_set1_epi32(0x04040404)),
+			_mm_set1_epi32(0x03020100));
+		__m128i pixels = _mm_blendv_epi8(_mm_shuffle_epi8(palette_lo, selector),
+			_mm_shuffle_epi8(palette_hi, selector), _mm_cmpgt_epi32(entry, three));
+		_mm_storeu_si128((__m128i *)(image_buffer + y * 4), pixels);
+	}
+}
+
+ETC_TARGET_AVX2 static void draw_palette_avx2(__m128i palette_lo, __m128i palette_hi, unsigned int pixel_index_word,
+	int subblocks, unsigned int *image_buffer) {
+	__m256i palette = _mm256_inserti128_si256(_mm256_castsi128_si256(palette_lo), palette_hi, 1);
+	__m256i word = _mm256_set1_epi32((int)pixel_index_word);
+	__m256i one = _mm256_set1_epi32(1);
+	__m256i two = _mm256_set1_epi32(2);
+	__m256i fifteen = _mm256_set1_epi32(15);
+	for (int y = 0; y < 4; y += 2) {
+		__m256i shifts = _mm256_loadu_si256((const __m256i *)pixel_index_shifts[y]);
+		__m256i lsb = _mm256_and_si256(_mm256_srlv_epi32(word, shifts), one);
+		__m256i msb = _mm256_and_si256(_mm256_srlv_epi32(word, _mm256_add_epi32(shifts, fifteen)), two);
+		__m256i entry = _mm256_or_si256(_mm256_or_si256(lsb, msb),
+			_mm256_loadu_si256((const __m256i *)subblock_offsets[subblocks][y]));
+		_mm256_storeu_si256((__m256i *)(image_buffer + y * 4), _mm256_permutevar8x32_epi32(palette, entry));
+	}
+}
+
+// Four palette entries (16 bytes) for subblock base color base_R, base_G, base_B and table codeword.
+
+#define SUBBLOCK_PALETTE_SSE(base_R, base_G, base_B, table_codeword) \
+	_mm_packus_epi16( \
+		_mm_add_epi16(_mm_setr_epi16(base_R, base_G, base_B, 0xFF, base_R, base_G, base_B, 0xFF), \
+			_mm_loadu_si128((const __m128i *)&modifier_vectors[table_codeword][0])), \
+		_mm_add_epi16(_mm_setr_epi16(base_R, base_G, base_B, 0xFF, base_R, base_G, base_B, 0xFF), \
+			_mm_loadu_si128((const __m128i *)&modifier_vectors[table_codeword][8])))
+
+// Palette of the four T or H mode paint colors.
+
+#define T_OR_H_PALETTE_SSE(base_colors, distance, mode) \
+	(mode == 0 ? \
+	_mm_packus_epi16( \
+		_mm_add_epi16(_mm_setr_epi16(base_colors[0], base_colors[1], base_colors[2], 0xFF, \
+			base_colors[3], base_colors[4], base_colors[5], 0xFF), \
+			_mm_setr_epi16(0, 0, 0, 0, distance, distance, distance, 0)), \
+		_mm_sub_epi16(_mm_setr_epi16(base_colors[3], base_colors[4], base_colors[5], 0xFF, \
+			base_colors[3], base_colors[4], base_colors[5], 0xFF), \
+			_mm_setr_epi16(0, 0, 0, 0, distance, distance, distance, 0))) : \
+	_mm_packus_epi16( \
+		_mm_add_epi16(_mm_setr_epi16(base_colors[0], base_colors[1], base_colors[2], 0xFF, \
+			base_colors[0], base_colors[1], base_colors[2], 0xFF), \
+			_mm_setr_epi16(distance, distance, distance, 0, - distance, - distance, - distance, 0)), \
+		_mm_add_epi16(_mm_setr_epi16(base_colors[3], base_colors[4], base_colors[5], 0xFF, \
+			base_colors[3], base_colors[4], base_colors[5], 0xFF), \
+			_mm_setr_epi16(distance, distance, distance, 0, - distance, - distance, - distance, 0))))
+
+ETC_TARGET_SSE41 static void draw_subblocks_sse41(const int *base_colors, int table_codeword1, int table_codeword2,
+	int flipbit, unsigned int pixel_index_word, unsigned int *image_buffer) {
+	draw_palette_sse41(
+		SUBBLOCK_PALETTE_SSE(base_colors[0], base_colors[1], base_colors[2], table_codeword1),
+		SUBBLOCK_PALETTE_SSE(base_colors[3], base_colors[4], base_colors[5], table_codeword2),
+		pixel_index_word, flipbit, image_buffer);
+}
+
+ETC_TARGET_AVX2 static void draw_subblocks_avx2(const int *base_colors, int table_codeword1, int table_codeword2,
+	int flipbit, unsigned int pixel_index_word, unsigned int *image_buffer) {
+	draw_palette_avx2(
+		SUBBLOCK_PALETTE_SSE(base_colors[0], base_colors[1], base_colors[2], table_codeword1),
+		SUBBLOCK_PALETTE_SSE(base_colors[3], base_colors[4], base_colors[5], table_codeword2),
+		pixel_index_word, flipbit, image_buffer);
+}
+
+ETC_TARGET_SSE41 static void draw_T_or_H_mode_sse41(const int *base_colors, int distance, int mode,
+	unsigned int pixel_index_word, unsigned int *image_buffer) {
+	__m128i palette = T_OR_H_PALETTE_SSE(base_colors, distance, mode);
+	draw_palette_sse41(palette, palette, pixel_index_word, 2, image_buffer);
+}
+
+ETC_TARGET_AVX2 static void draw_T_or_H_mode_avx2(const int *base_colors, int distance, int mode,
+	unsigned int pixel_index_word, unsigned int *image_buffer) {
+	__m128i palette = T_OR_H_PALETTE_SSE(base_colors, distance, mode);
+	draw_palette_avx2(palette, palette, pixel_index_word, 2, image_buffer);
+}
+
+// colors holds the 8-bit O, H and V colors. Each lane computes (x * (H - O) + y * (V - O) + 4 * O + 2) >> 2
+// for one component of one pixel; the alpha lanes yield (4 * 0xFF + 2) >> 2 = 0xFF.
+
+ETC_TARGET_SSE41 static void draw_planar_mode_sse41(const int *colors, unsigned int *image_buffer) {
+	int dHR = colors[3] - colors[0], dHG = colors[4] - colors[1], dHB = colors[5] - colors[2];
+	__m128i dH2 = _mm_setr_epi16(2 * dHR, 2 * dHG, 2 * dHB, 0, 2 * dHR, 2 * dHG, 2 * dHB, 0);
+	__m128i dV = _mm_setr_epi16(colors[6] - colors[0], colors[7] - colors[1], colors[8] - colors[2], 0,
+		colors[6] - colors[0], colors[7] - colors[1], colors[8] - colors[2], 0);
+	__m128i row = _mm_setr_epi16(4 * colors[0] + 2, 4 * colors[1] + 2, 4 * colors[2] + 2, 4 * 0xFF + 2,
+		4 * colors[0] + 2 + dHR, 4 * colors[1] + 2 + dHG, 4 * colors[2] + 2 + dHB, 4 * 0xFF + 2);
+	for (int y = 0; y < 4; y++) {
+		__m128i left = _mm_srai_epi16(row, 2);
+		__m128i right = _mm_srai_epi16(_mm_add_epi16(row, dH2), 2);
+		_mm_storeu_si128((__m128i *)(image_buffer + y * 4), _mm_packus_epi16(left, right));
+		row = _mm_add_epi16(row, dV);
+	}
+}
+
+static const EtcSimdFunctions sse41_functions = {
+	draw_subblocks_sse41, draw_T_or_H_mode_sse41, draw_planar_mode_sse41
+};
+
+static const EtcSimdFunctions avx2_functions = {
+	draw_subblocks_avx2, draw_T_or_H_mode_avx2, draw_planar_mode_sse41
+};
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+static int cpu_simd_level(void) {
+	int regs[4];
+	__cpuid(regs, 0);
+	int max_leaf = regs[0];
+	__cpuid(regs, 1);
+	// SSSE3 and SSE4.1.
+	if ((regs[2] & 0x00080200) != 0x00080200)
+		return 0;
+	// AVX2 needs OSXSAVE, AVX and the OS saving the YMM registers.
+	if (max_leaf < 7 || (regs[2] & 0x18000000) != 0x18000000 || (_xgetbv(0) & 6) != 6)
+		return 1;
+	__cpuidex(regs, 7, 0);
+	return (regs[1] & 0x20) ? 2 : 1;
+}
+
+const EtcSimdFunctions *get_etc_simd_functions(void) {
+	static int level = -1;
+	if (level < 0)
+		level = cpu_simd_level();
+	return level == 2 ? &avx2_functions : level == 1 ? &sse41_functions : NULL;
+}
+
+#else
+
+const EtcSimdFunctions *get_etc_simd_functions(void) {
+	if (__builtin_cpu_supports("avx2"))
+		return &avx2_functions;
+	if (__builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1"))
+		return &sse41_functions;
+	return NULL;
+}
+
+#endif
+
+#elif defined(ETC_SIMD_NEON)
+
+static void draw_palette_neon(uint8x8x4_t palette, unsigned int pixel_index_word, int subblocks,
+	unsigned int *image_buffer) {
+	uint32x4_t word = vdupq_n_u32(pixel_index_word);
+	uint32x4_t one = vdupq_n_u32(1);
+	uint32x4_t two = vdupq_n_u32(2);
+	for (int y = 0; y < 4; y++) {
+		uint32x4_t lsb_mask = vld1q_u32(pixel_index_bits[y]);
+		uint32x4_t msb_mask = vshlq_n_u32(lsb_mask, 16);
+		uint32x4_t entry = vorrq_u32(vorrq_u32(vandq_u32(vtstq_u32(word, lsb_mask), one),
+			vandq_u32(vtstq_u32(word, msb_mask), two)), vld1q_u32(subblock_offsets[subblocks][y]));
+		uint8x16_t selector = vreinterpretq_u8_u32(vmlaq_u32(vdupq_n_u32(0x03020100), entry,
+			vdupq_n_u32(0x04040404)));
+		uint8x8_t left = vtbl4_u8(palette, vget_low_u8(selector));
+		uint8x8_t right = vtbl4_u8(palette, vget_high_u8(selector));
+		vst1q_u32(image_buffer + y * 4, vreinterpretq_u32_u8(vcombine_u8(left, right)));
+	}
+}
+
+static uint8x8_t subblock_palette_half_neon(int base_R, int base_G, int base_B, const int16_t *modifiers) {
+	int16_t base[4] = { (int16_t)base_R, (int16_t)base_G, (int16_t)base_B, 0xFF };
+	int16x4_t base_vector = vld1_s16(base);
+	return vqmovun_s16(vaddq_s16(vcombine_s16(base_vector, base_vector), vld1q_s16(modifiers)));
+}
+
+static void draw_subblocks_neon(const int *base_colors, int table_codeword1, int table_codeword2,
+	int flipbit, unsigned int pixel_index_word, unsigned int *image_buffer) {
+	uint8x8x4_t palette;
+	palette.val[0] = subblock_palette_half_neon(base_colors[0], base_colors[1], base_colors[2],
+		&modifier_vectors[table_codeword1][0]);
+	palette.val[1] = subblock_palette_half_neon(base_colors[0], base_colors[1], base_colors[2],
+		&modifier_vectors[table_codeword1][8]);
+	palette.val[2] = subblock_palette_half_neon(base_colors[3], base_colors[4], base_colors[5],
+		&modifier_vectors[table_codeword2][0]);
+	palette.val[3] = subblock_palette_half_neon(base_colors[3], base_colors[4], base_colors[5],
+		&modifier_vectors[table_codeword2][8]);
+	draw_palette_neon(palette, pixel_index_word, flipbit, image_buffer);
+}
+
+static void draw_T_or_H_mode_neon(const int *base_colors, int distance, int mode,
+	unsigned int pixel_index_word, unsigned int *image_buffer) {
+	// Base color and signed distance of the four paint colors.
+	int16_t bases[16], offsets[16];
+	static const int paint_base[2][4] = { { 0, 3, 3, 3 }, { 0, 0, 3, 3 } };
+	static const int paint_sign[2][4] = { { 0, 1, 0, -1 }, { 1, -1, 1, -1 } };
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 3; j++) {
+			bases[i * 4 + j] = (int16_t)base_colors[paint_base[mode][i] + j];
+			offsets[i * 4 + j] = (int16_t)(paint_sign[mode][i] * distance);
+		}
+		bases[i * 4 + 3] = 0xFF;
+		offsets[i * 4 + 3] = 0;
+	}
+	uint8x8x4_t palette;
+	palette.val[0] = vqmovun_s16(vaddq_s16(vld1q_s16(bases), vld1q_s16(offsets)));
+	palette.val[1] = vqmovun_s16(vaddq_s16(vld1q_s16(bases + 8), vld1q_s16(offsets + 8)));
+	palette.val[2] = palette.val[0];
+	palette.val[3] = palette.val[1];
+	draw_palette_neon(palette, pixel_index_word, 2, image_buffer);
+}
+
+static void draw_planar_mode_neon(const int *colors, unsigned int *image_buffer) {
+	int dHR = colors[3] - colors[0], dHG = colors[4] - colors[1], dHB = colors[5] - colors[2];
+	int16_t dH2_lanes[8] = { 2 * dHR, 2 * dHG, 2 * dHB, 0, 2 * dHR, 2 * dHG, 2 * dHB, 0 };
+	int16_t dV_lanes[8] = { colors[6] - colors[0], colors[7] - colors[1], colors[8] - colors[2], 0,
+		colors[6] - colors[0], colors[7] - colors[1], colors[8] - colors[2], 0 };
+	int16_t row_lanes[8] = { 4 * colors[0] + 2, 4 * colors[1] + 2, 4 * colors[2] + 2, 4 * 0xFF + 2,
+		4 * colors[0] + 2 + dHR, 4 * colors[1] + 2 + dHG, 4 * colors[2] + 2 + dHB, 4 * 0xFF + 2 };
+	int16x8_t dH2 = vld1q_s16(dH2_lanes);
+	int16x8_t dV = vld1q_s16(dV_lanes);
+	int16x8_t row = vld1q_s16(row_lanes);
+	for (int y = 0; y < 4; y++) {
+		uint8x8_t left = vqmovun_s16(vshrq_n_s16(row, 2));
+		uint8x8_t right = vqmovun_s16(vshrq_n_s16(vaddq_s16(row, dH2), 2));
+		vst1q_u32(image_buffer + y * 4, vreinterpretq_u32_u8(vcombine_u8(left, right)));
+		row = vaddq_s16(row, dV);
+	}
+}
+
+static const EtcSimdFunctions neon_functions = {
+	draw_subblocks_neon, draw_T_or_H_mode_neon, draw_planar_mode_neon
+};
+
+const EtcSimdFunctions *get_etc_simd_functions(void) {
+	return &neon_functions;
+}
+
+#else
+
+const EtcSimdFunctions *get_etc_simd_functions(void) {
+	return NULL;
+}
+
+#endif
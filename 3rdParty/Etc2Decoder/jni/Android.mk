@@ -18,6 +18,6 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE    := libEtc2Decoder
 LOCAL_CFLAGS    := -Werror -O3
-LOCAL_SRC_FILES := ../etc2.c
+LOCAL_SRC_FILES := ../etc2.c ../etc2_simd.c ../dxtc.c ../rgtc.c ../astc.c ../bcenc.c ../texture.c ../parallel.c ../job.c
 
 include $(BUILD_SHARED_LIBRARY)
@@ -0,0 +1,194 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include "texgenpack.h"
+#include "decode.h"
+
+// Decoding of whole mipmapped textures in the background.
+//
+// The levels of all running jobs are decoded by a single dispatcher thread, each level split across
+// threads with parallel_for_rows. It always takes the smallest remaining level of any job, so every
+// texture gets its small mip levels first and a big level of one texture does not hold back the small
+// levels of the others. The dispatcher exits when no levels are left and is started again by the next
+// job.
+
+struct DecodeJob {
+	DecodeJobLevel *levels;
+	int level_count;
+	int format;
+	int dst_format;
+	int threads;
+	decode_job_function callback;
+	void *data;
+	// Index of the next level to decode, counting down to -1 after level 0.
+	int next_level;
+	int levels_decoded;
+	int cancelled;
+	struct DecodeJob *next;
+};
+
+#ifdef _WIN32
+static SRWLOCK job_lock = SRWLOCK_INIT;
+#define lock_jobs() AcquireSRWLockExclusive(&job_lock)
+#define unlock_jobs() ReleaseSRWLockExclusive(&job_lock)
+#else
+static pthread_mutex_t job_lock = PTHREAD_MUTEX_INITIALIZER;
+#define lock_jobs() pthread_mutex_lock(&job_lock)
+#define unlock_jobs() pthread_mutex_unlock(&job_lock)
+#endif
+
+// The jobs not finished yet, guarded by job_lock like the fields of the jobs they reach.
+static DecodeJob *jobs = NULL;
+static int dispatcher_running = 0;
+
+static int decode_level(const DecodeJobLevel *level, int format, int dst_format, int threads) {
+	if (dst_format != 0 && dst_format == get_bc_transcode_format(format)) {
+		if (level->width <= 0 || level->height <= 0)
+			return 1;
+		return transcode_texture_to_bc(level->src, level->dst, level->width, level->height, format, threads);
+	}
+	if (format & TEXTURE_TYPE_ASTC_BIT) {
+		if (dst_format != TEXTURE_TYPE_UNCOMPRESSED_RGBA8)
+			return 0;
+		return decode_astc_texture(level->src, level->dst, level->width, level->height, level->pitch, format,
+			threads);
+	}
+	// Each of these rejects the types of the other one.
+	if (decode_etc_texture_to_format(level->src, level->dst, level->width, level->height, level->pitch, format,
+		dst_format, threads))
+		return 1;
+	return decode_bc_texture_to_format(level->src, level->dst, level->width, level->height, level->pitch, format,
+		dst_format, threads);
+}
+
+// Take the smallest level left in the running jobs, or unlink a job with no levels left (or cancelled), in
+// which case *level is -1. Returns NULL when there are no jobs. Called with job_lock held.
+
+static DecodeJob *take_next_level(int *level) {
+	DecodeJob *best = NULL;
+	long long best_size = 0;
+	for (DecodeJob **link = &jobs; *link != NULL; link = &(*link)->next) {
+		DecodeJob *job = *link;
+		if (job->cancelled || job->next_level < 0) {
+			*link = job->next;
+			*level = -1;
+			return job;
+		}
+		const DecodeJobLevel *next = &job->levels[job->next_level];
+		long long size = (long long)next->width * next->height;
+		if (best == NULL || size < best_size) {
+			best = job;
+			best_size = size;
+		}
+	}
+	if (best != NULL)
+		*level = best->next_level--;
+	return best;
+}
+
+static void run_dispatcher(void) {
+	for (;;) {
+		int level;
+		lock_jobs();
+		DecodeJob *job = take_next_level(&level);
+		if (job == NULL)
+			dispatcher_running = 0;
+		unlock_jobs();
+		if (job == NULL)
+			return;
+		if (level < 0) {
+			// Unlinked, so nothing else touches the job any more.
+			job->callback(job->data, -1, job->levels_decoded);
+			free(job->levels);
+			free(job);
+			continue;
+		}
+		int result = decode_level(&job->levels[level], job->format, job->dst_format, job->threads);
+		// Only the dispatcher writes levels_decoded.
+		job->levels_decoded += result;
+		job->callback(job->data, level, result);
+	}
+}
+
+#ifdef _WIN32
+static DWORD WINAPI dispatcher_thread(LPVOID arg) {
+	run_dispatcher();
+	return 0;
+}
+#else
+static void *dispatcher_thread(void *arg) {
+	run_dispatcher();
+	return NULL;
+}
+#endif
+
+// Start the dispatcher thread unless it is running. Called with job_lock held.
+
+static int start_dispatcher(void) {
+	if (dispatcher_running)
+		return 1;
+#ifdef _WIN32
+	HANDLE handle = CreateThread(NULL, 0, dispatcher_thread, NULL, 0, NULL);
+	if (handle == NULL)
+		return 0;
+	CloseHandle(handle);
+#else
+	pthread_t handle;
+	if (pthread_create(&handle, NULL, dispatcher_thread, NULL) != 0)
+		return 0;
+	pthread_detach(handle);
+#endif
+	dispatcher_running = 1;
+	return 1;
+}
+
+DecodeJob *start_decode_job(const DecodeJobLevel *levels, int level_count, int format, int dst_format, int threads,
+	decode_job_function callback, void *data) {
+	if (level_count <= 0 || callback == NULL)
+		return NULL;
+	// Decoding an empty level checks the combination of types without touching memory.
+	DecodeJobLevel empty;
+	memset(&empty, 0, sizeof(empty));
+	if (!decode_level(&empty, format, dst_format, threads))
+		return NULL;
+	DecodeJob *job = (DecodeJob *)malloc(sizeof(DecodeJob));
+	if (job == NULL)
+		return NULL;
+	job->levels = (DecodeJobLevel *)malloc(sizeof(DecodeJobLevel) * level_count);
+	if (job->levels == NULL) {
+		free(job);
+		return NULL;
+	}
+	memcpy(job->levels, levels, sizeof(DecodeJobLevel) * level_count);
+	job->level_count = level_count;
+	job->format = format;
+	job->dst_format = dst_format;
+	job->threads = threads;
+	job->callback = callback;
+	job->data = data;
+	job->next_level = level_count - 1;
+	job->levels_decoded = 0;
+	job->cancelled = 0;
+	lock_jobs();
+	if (!start_dispatcher()) {
+		unlock_jobs();
+		free(job->levels);
+		free(job);
+		return NULL;
+	}
+	job->next = jobs;
+	jobs = job;
+	unlock_jobs();
+	return job;
+}
+
+void cancel_decode_job(DecodeJob *job) {
+	lock_jobs();
+	job->cancelled = 1;
+	unlock_jobs();
+}
@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#include "texgenpack.h"
+#include "decode.h"
+
+// Splitting [0, rows) across worker threads for the whole-texture decoders.
+// Each worker gets one contiguous range, the calling thread decodes the first
+// one itself.
+
+#define MAX_THREADS 64
+
+typedef struct {
+	parallel_rows_function function;
+	void *data;
+	int begin;
+	int end;
+} RowRange;
+
+#ifdef _WIN32
+static DWORD WINAPI row_range_thread(LPVOID arg) {
+	RowRange *range = (RowRange *)arg;
+	range->function(range->data, range->begin, range->end);
+	return 0;
+}
+#else
+static void *row_range_thread(void *arg) {
+	RowRange *range = (RowRange *)arg;
+	range->function(range->data, range->begin, range->end);
+	return NULL;
+}
+#endif
+
+int get_number_of_processors(void) {
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? n : 1;
+#endif
+}
+
+void parallel_for_rows(int rows, int threads, int min_rows_per_thread, parallel_rows_function function, void *data) {
+	if (rows <= 0)
+		return;
+	if (threads <= 0)
+		threads = get_number_of_processors();
+	if (min_rows_per_thread < 1)
+		min_rows_per_thread = 1;
+	if (threads > rows / min_rows_per_thread)
+		threads = rows / min_rows_per_thread;
+	if (threads > MAX_THREADS)
+		threads = MAX_THREADS;
+	if (threads <= 1) {
+		function(data, 0, rows);
+		return;
+	}
+	RowRange ranges[MAX_THREADS];
+#ifdef _WIN32
+	HANDLE handles[MAX_THREADS];
+#else
+	pthread_t handles[MAX_THREADS];
+#endif
+	int started[MAX_THREADS];
+	for (int i = 0; i < threads; i++) {
+		ranges[i].function = function;
+		ranges[i].data = data;
+		ranges[i].begin = (int)((long long)rows * i / threads);
+		ranges[i].end = (int)((long long)rows * (i + 1) / threads);
+	}
+	for (int i = 1; i < threads; i++) {
+#ifdef _WIN32
+		handles[i] = CreateThread(NULL, 0, row_range_thread, &ranges[i], 0, NULL);
+		started[i] = handles[i] != NULL;
+#else
+		started[i] = pthread_create(&handles[i], NULL, row_range_thread, &ranges[i]) == 0;
+#endif
+	}
+	function(data, ranges[0].begin, ranges[0].end);
+	for (int i = 1; i < threads; i++) {
+		// A thread that could not be started has its range decoded here.
+		if (!started[i]) {
+			function(data, ranges[i].begin, ranges[i].end);
+			continue;
+		}
+#ifdef _WIN32
+		WaitForSingleObject(handles[i], INFINITE);
+		CloseHandle(handles[i]);
+#else
+		pthread_join(handles[i], NULL);
+#endif
+	}
+}
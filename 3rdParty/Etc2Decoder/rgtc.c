@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "texgenpack.h"
+#include "decode.h"
+#include "packing.h"
+
+// RGTC1 and RGTC2 (BC4 and BC5) block decoding. Written for this library against the prototypes the upstream
+// texgenpack decode.h declares for rgtc.c; the code itself isn't taken from texgenpack.
+//
+// The unsigned RGTC formats produce 8-bit components, with the missing components set to 0 and alpha to 0xFF.
+// The signed formats produce 16-bit signed components in the same layout as the signed EAC formats (red in the
+// first and green in the last 16 bits in memory of each pixel).
+
+static uint64_t get_rgtc_pixel_indices(const unsigned char *bitstring) {
+	return (uint64_t)bitstring[2] | ((uint64_t)bitstring[3] << 8) | ((uint64_t)bitstring[4] << 16) |
+		((uint64_t)bitstring[5] << 24) | ((uint64_t)bitstring[6] << 32) | ((uint64_t)bitstring[7] << 40);
+}
+
+// Decode the 16 8-bit values of a 64-bit unsigned RGTC block.
+
+static void decode_block4x4_rgtc(const unsigned char *bitstring, unsigned char *values) {
+	int levels[8];
+	get_dxt5_alpha_levels(bitstring[0], bitstring[1], levels);
+	uint64_t pixel_indices = get_rgtc_pixel_indices(bitstring);
+	for (int i = 0; i < 16; i++)
+		values[i] = levels[(pixel_indices >> (i * 3)) & 7];
+}
+
+// Convert the signed 8-bit value value_times_den / den to a signed 16-bit value, rounding to nearest.
+
+static int signed_rgtc_level(int value_times_den, int den) {
+	int n = value_times_den * 32767;
+	int d = den * 127;
+	return (n + (n >= 0 ? d / 2 : - d / 2)) / d;
+}
+
+// Decode the 16 signed 16-bit values of a 64-bit signed RGTC block into the given half of each pixel.
+
+static void decode_block4x4_signed_rgtc(const unsigned char *bitstring, unsigned int *image_buffer, int offset) {
+	int red0 = (signed char)bitstring[0];
+	int red1 = (signed char)bitstring[1];
+	// -128 has to be treated as -127.
+	if (red0 == - 128)
+		red0 = - 127;
+	if (red1 == - 128)
+		red1 = - 127;
+	int levels[8];
+	levels[0] = signed_rgtc_level(red0, 1);
+	levels[1] = signed_rgtc_level(red1, 1);
+	if (red0 > red1)
+		for (int i = 1; i < 7; i++)
+			levels[i + 1] = signed_rgtc_level((7 - i) * red0 + i * red1, 7);
+	else {
+		for (int i = 1; i < 5; i++)
+			levels[i + 1] = signed_rgtc_level((5 - i) * red0 + i * red1, 5);
+		levels[6] = - 32767;
+		levels[7] = 32767;
+	}
+	uint64_t pixel_indices = get_rgtc_pixel_indices(bitstring);
+	for (int i = 0; i < 16; i++)
+		*((unsigned short *)&image_buffer[i] + offset) = (unsigned short)levels[(pixel_indices >> (i * 3)) & 7];
+}
+
+// Draw a 4x4 pixel block using 64-bit RGTC1 compression data.
+
+int draw_block4x4_rgtc1(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	unsigned char red[16];
+	decode_block4x4_rgtc(bitstring, red);
+	for (int i = 0; i < 16; i++)
+		image_buffer[i] = pack_rgb_alpha_0xff(red[i], 0, 0);
+	return 1;
+}
+
+// Draw a 4x4 pixel block using 64-bit SIGNED_RGTC1 compression data.
+
+int draw_block4x4_signed_rgtc1(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	memset(image_buffer, 0, 64);
+	decode_block4x4_signed_rgtc(bitstring, image_buffer, 0);
+	return 1;
+}
+
+// Draw a 4x4 pixel block using 128-bit RGTC2 compression data.
+
+int draw_block4x4_rgtc2(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	unsigned char red[16], green[16];
+	decode_block4x4_rgtc(bitstring, red);
+	decode_block4x4_rgtc(&bitstring[8], green);
+	for (int i = 0; i < 16; i++)
+		image_buffer[i] = pack_rgb_alpha_0xff(red[i], green[i], 0);
+	return 1;
+}
+
+// Draw a 4x4 pixel block using 128-bit SIGNED_RGTC2 compression data.
+
+int draw_block4x4_signed_rgtc2(const unsigned char *bitstring, unsigned int *image_buffer, int flags) {
+	decode_block4x4_signed_rgtc(bitstring, image_buffer, 0);
+	decode_block4x4_signed_rgtc(&bitstring[8], image_buffer, 1);
+	return 1;
+}
@@ -99,6 +99,19 @@ typedef struct {
 #define TEXTURE_TYPE_RGBA_ASTC_12X10			0x800C
 #define TEXTURE_TYPE_RGBA_ASTC_12X12			0x800D
 #define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_4X4		0x9000
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_5X4		0x9001
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_5X5		0x9002
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_6X5		0x9003
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_6X6		0x9004
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_8X5		0x9005
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_8X6		0x9006
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_8X8		0x9007
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_10X5		0x9008
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_10X6		0x9009
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_10X8		0x900A
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_10X10		0x900B
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_12X10		0x900C
+#define TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_12X12		0x900D
 
 #define TEXTURE_TYPE_ALPHA_BIT				0x0020
 #define TEXTURE_TYPE_ETC_BIT				0x0100
@@ -0,0 +1,416 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "texgenpack.h"
+#include "decode.h"
+#include "packing.h"
+
+// Whole texture decoding.
+
+typedef int (*draw_block_function)(const unsigned char *bitstring, unsigned int *image_buffer, int flags);
+
+enum {
+	BLOCK_TEXTURE_FAMILY_ETC,
+	BLOCK_TEXTURE_FAMILY_BC,
+	BLOCK_TEXTURE_FAMILY_ASTC
+};
+
+// The largest block footprint (ASTC 12x12) in pixels.
+#define MAX_BLOCK_PIXELS 144
+
+typedef struct {
+	int texture_type;
+	int family;
+	int block_width;
+	int block_height;
+	int block_size;
+	draw_block_function draw_block;
+	int flags;
+	// Number of channels for R8 and RG8 output (1 or 2), 0 for the formats that can only be decoded to RGBA8.
+	int channels;
+	// Whether the blocks are drawn with 16-bit components (R11 and RG11 EAC, signed RGTC), the channels being in
+	// the first and last 16 bits in memory of each pixel. Otherwise the blocks are drawn as RGBA8.
+	int sixteen_bit;
+	int is_signed;
+} BlockTextureType;
+
+static const BlockTextureType block_texture_types[] = {
+	// ETC2 RGB8 is a superset of ETC1, so both go through the same decoder.
+	{ TEXTURE_TYPE_ETC1, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 8, draw_block4x4_etc2_rgb8, ETC2_MODE_ALLOWED_ALL, 0, 0, 0 },
+	{ TEXTURE_TYPE_ETC2_RGB8, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 8, draw_block4x4_etc2_rgb8, ETC2_MODE_ALLOWED_ALL, 0, 0, 0 },
+	{ TEXTURE_TYPE_ETC2_SRGB8, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 8, draw_block4x4_etc2_rgb8, ETC2_MODE_ALLOWED_ALL, 0, 0, 0 },
+	{ TEXTURE_TYPE_ETC2_PUNCHTHROUGH, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 8, draw_block4x4_etc2_punchthrough, ETC2_PUNCHTHROUGH_MODE_ALLOWED_ALL, 0, 0, 0 },
+	{ TEXTURE_TYPE_ETC2_SRGB_PUNCHTHROUGH, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 8, draw_block4x4_etc2_punchthrough, ETC2_PUNCHTHROUGH_MODE_ALLOWED_ALL, 0, 0, 0 },
+	{ TEXTURE_TYPE_ETC2_EAC, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 16, draw_block4x4_etc2_eac, ETC2_MODE_ALLOWED_ALL, 0, 0, 0 },
+	{ TEXTURE_TYPE_ETC2_SRGB_EAC, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 16, draw_block4x4_etc2_eac, ETC2_MODE_ALLOWED_ALL, 0, 0, 0 },
+	{ TEXTURE_TYPE_R11_EAC, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 8, draw_block4x4_r11_eac, 0, 1, 1, 0 },
+	{ TEXTURE_TYPE_RG11_EAC, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 16, draw_block4x4_rg11_eac, 0, 2, 1, 0 },
+	{ TEXTURE_TYPE_SIGNED_R11_EAC, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 8, draw_block4x4_signed_r11_eac, 0, 1, 1, 1 },
+	{ TEXTURE_TYPE_SIGNED_RG11_EAC, BLOCK_TEXTURE_FAMILY_ETC, 4, 4, 16, draw_block4x4_signed_rg11_eac, 0, 2, 1, 1 },
+	{ TEXTURE_TYPE_DXT1, BLOCK_TEXTURE_FAMILY_BC, 4, 4, 8, draw_block4x4_dxt1, 0, 0, 0, 0 },
+	{ TEXTURE_TYPE_DXT1A, BLOCK_TEXTURE_FAMILY_BC, 4, 4, 8, draw_block4x4_dxt1a, 0, 0, 0, 0 },
+	{ TEXTURE_TYPE_DXT3, BLOCK_TEXTURE_FAMILY_BC, 4, 4, 16, draw_block4x4_dxt3, 0, 0, 0, 0 },
+	{ TEXTURE_TYPE_DXT5, BLOCK_TEXTURE_FAMILY_BC, 4, 4, 16, draw_block4x4_dxt5, 0, 0, 0, 0 },
+	{ TEXTURE_TYPE_RGTC1, BLOCK_TEXTURE_FAMILY_BC, 4, 4, 8, draw_block4x4_rgtc1, 0, 1, 0, 0 },
+	{ TEXTURE_TYPE_RGTC2, BLOCK_TEXTURE_FAMILY_BC, 4, 4, 16, draw_block4x4_rgtc2, 0, 2, 0, 0 },
+	{ TEXTURE_TYPE_SIGNED_RGTC1, BLOCK_TEXTURE_FAMILY_BC, 4, 4, 8, draw_block4x4_signed_rgtc1, 0, 1, 1, 1 },
+	{ TEXTURE_TYPE_SIGNED_RGTC2, BLOCK_TEXTURE_FAMILY_BC, 4, 4, 16, draw_block4x4_signed_rgtc2, 0, 2, 1, 1 },
+	// The ASTC block decoder takes the texture type as flags, which selects the footprint and sRGB decoding.
+#define ASTC_TEXTURE_TYPES(w, h) \
+	{ TEXTURE_TYPE_RGBA_ASTC_##w##X##h, BLOCK_TEXTURE_FAMILY_ASTC, w, h, 16, draw_block_rgba_astc, \
+		TEXTURE_TYPE_RGBA_ASTC_##w##X##h, 0, 0, 0 }, \
+	{ TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_##w##X##h, BLOCK_TEXTURE_FAMILY_ASTC, w, h, 16, draw_block_rgba_astc, \
+		TEXTURE_TYPE_SRGB8_ALPHA8_ASTC_##w##X##h, 0, 0, 0 },
+	ASTC_TEXTURE_TYPES(4, 4)
+	ASTC_TEXTURE_TYPES(5, 4)
+	ASTC_TEXTURE_TYPES(5, 5)
+	ASTC_TEXTURE_TYPES(6, 5)
+	ASTC_TEXTURE_TYPES(6, 6)
+	ASTC_TEXTURE_TYPES(8, 5)
+	ASTC_TEXTURE_TYPES(8, 6)
+	ASTC_TEXTURE_TYPES(8, 8)
+	ASTC_TEXTURE_TYPES(10, 5)
+	ASTC_TEXTURE_TYPES(10, 6)
+	ASTC_TEXTURE_TYPES(10, 8)
+	ASTC_TEXTURE_TYPES(10, 10)
+	ASTC_TEXTURE_TYPES(12, 10)
+	ASTC_TEXTURE_TYPES(12, 12)
+#undef ASTC_TEXTURE_TYPES
+};
+
+typedef struct {
+	const unsigned char *src;
+	unsigned char *dst;
+	int width;
+	int height;
+	int pitch;
+	const BlockTextureType *type;
+	int dst_pixel_size;
+} BlockTexture;
+
+static const BlockTextureType *find_block_texture_type(int texture_type, int family) {
+	int count = sizeof(block_texture_types) / sizeof(block_texture_types[0]);
+	for (int i = 0; i < count; i++)
+		if (block_texture_types[i].texture_type == texture_type && block_texture_types[i].family == family)
+			return &block_texture_types[i];
+	return NULL;
+}
+
+// Convert 16-bit unsigned and signed values to 8-bit unsigned and signed normalized values, rounding to nearest.
+
+static unsigned char unorm16_to_unorm8(unsigned int value) {
+	return (value * 255 + 32767) / 65535;
+}
+
+static unsigned char snorm16_to_snorm8(int value) {
+	if (value < - 32767)
+		value = - 32767;
+	return (unsigned char)(signed char)((value * 127 + (value >= 0 ? 16383 : - 16383)) / 32767);
+}
+
+// Convert the pixels of a block drawn with 16-bit components to R8, RG8 or RGBA8 pixels. For RGBA8 the missing
+// channels are set to 0 and alpha to 1.
+
+static void convert_16bit_block(const BlockTexture *texture, const unsigned int *block, unsigned char *pixels) {
+	const BlockTextureType *type = texture->type;
+	for (int i = 0; i < type->block_width * type->block_height; i++) {
+		const unsigned short *values = (const unsigned short *)&block[i];
+		unsigned char *pixel = pixels + i * texture->dst_pixel_size;
+		for (int c = 0; c < type->channels; c++)
+			if (type->is_signed)
+				pixel[c] = snorm16_to_snorm8((short)values[c]);
+			else
+				pixel[c] = unorm16_to_unorm8(values[c]);
+		if (texture->dst_pixel_size == 4) {
+			if (type->channels == 1)
+				pixel[1] = 0;
+			pixel[2] = 0;
+			pixel[3] = type->is_signed ? 0x7F : 0xFF;
+		}
+	}
+}
+
+// Extract the R or RG channels of the pixels of a block drawn as RGBA8.
+
+static void extract_8bit_channels(const BlockTexture *texture, const unsigned int *block, unsigned char *pixels) {
+	const BlockTextureType *type = texture->type;
+	for (int i = 0; i < type->block_width * type->block_height; i++) {
+		unsigned char *pixel = pixels + i * texture->dst_pixel_size;
+		pixel[0] = pixel_get_r(block[i]);
+		if (texture->dst_pixel_size == 2)
+			pixel[1] = pixel_get_g(block[i]);
+	}
+}
+
+static void decode_block_rows(void *data, int begin, int end) {
+	BlockTexture *texture = (BlockTexture *)data;
+	const BlockTextureType *type = texture->type;
+	int block_width = type->block_width;
+	int block_height = type->block_height;
+	int blocks_per_row = (texture->width + block_width - 1) / block_width;
+	int pixel_size = texture->dst_pixel_size;
+	int convert = type->sixteen_bit || pixel_size != 4;
+	unsigned int block[MAX_BLOCK_PIXELS];
+	unsigned char converted[MAX_BLOCK_PIXELS * 4];
+	const unsigned char *pixels = convert ? converted : (const unsigned char *)block;
+	for (int by = begin; by < end; by++) {
+		const unsigned char *bitstring = texture->src + (size_t)by * blocks_per_row * type->block_size;
+		unsigned char *row = texture->dst + (size_t)by * block_height * texture->pitch;
+		int h = texture->height - by * block_height;
+		if (h > block_height)
+			h = block_height;
+		for (int bx = 0; bx < blocks_per_row; bx++) {
+			type->draw_block(bitstring, block, type->flags);
+			if (type->sixteen_bit)
+				convert_16bit_block(texture, block, converted);
+			else if (pixel_size != 4)
+				extract_8bit_channels(texture, block, converted);
+			int w = texture->width - bx * block_width;
+			if (w > block_width)
+				w = block_width;
+			for (int y = 0; y < h; y++)
+				memcpy(row + (size_t)y * texture->pitch + bx * block_width * pixel_size,
+					pixels + y * block_width * pixel_size, w * pixel_size);
+			bitstring += type->block_size;
+		}
+	}
+}
+
+static int decode_block_texture(const unsigned char *src, unsigned char *dst, int width, int height, int pitch,
+	const BlockTextureType *type, int dst_format, int threads) {
+	BlockTexture texture;
+	texture.type = type;
+	// R8 and RG8 output is only possible for the formats with that many channels and the same signedness.
+	switch (dst_format) {
+	case TEXTURE_TYPE_UNCOMPRESSED_RGBA8:
+		texture.dst_pixel_size = 4;
+		break;
+	case TEXTURE_TYPE_UNCOMPRESSED_R8:
+	case TEXTURE_TYPE_UNCOMPRESSED_SIGNED_R8:
+		if (type->channels != 1 || type->is_signed != (dst_format == TEXTURE_TYPE_UNCOMPRESSED_SIGNED_R8))
+			return 0;
+		texture.dst_pixel_size = 1;
+		break;
+	case TEXTURE_TYPE_UNCOMPRESSED_RG8:
+	case TEXTURE_TYPE_UNCOMPRESSED_SIGNED_RG8:
+		if (type->channels != 2 || type->is_signed != (dst_format == TEXTURE_TYPE_UNCOMPRESSED_SIGNED_RG8))
+			return 0;
+		texture.dst_pixel_size = 2;
+		break;
+	default:
+		return 0;
+	}
+	if (width <= 0 || height <= 0)
+		return 1;
+	texture.src = src;
+	texture.dst = dst;
+	texture.width = width;
+	texture.height = height;
+	texture.pitch = pitch;
+	// A few block rows per thread, so tiny mip levels are not worth a thread.
+	parallel_for_rows((height + type->block_height - 1) / type->block_height, threads, 8, decode_block_rows, &texture);
+	return 1;
+}
+
+int decode_etc_texture_to_format(const unsigned char *src, unsigned char *dst, int width, int height, int pitch,
+	int format, int dst_format, int threads) {
+	const BlockTextureType *type = find_block_texture_type(format, BLOCK_TEXTURE_FAMILY_ETC);
+	if (type == NULL)
+		return 0;
+	return decode_block_texture(src, dst, width, height, pitch, type, dst_format, threads);
+}
+
+int decode_etc_texture(const unsigned char *src, unsigned char *dst, int width, int height, int pitch, int format, int threads) {
+	return decode_etc_texture_to_format(src, dst, width, height, pitch, format, TEXTURE_TYPE_UNCOMPRESSED_RGBA8, threads);
+}
+
+int decode_bc_texture_to_format(const unsigned char *src, unsigned char *dst, int width, int height, int pitch,
+	int format, int dst_format, int threads) {
+	const BlockTextureType *type = find_block_texture_type(format, BLOCK_TEXTURE_FAMILY_BC);
+	if (type == NULL)
+		return 0;
+	return decode_block_texture(src, dst, width, height, pitch, type, dst_format, threads);
+}
+
+int decode_bc_texture(const unsigned char *src, unsigned char *dst, int width, int height, int pitch, int format, int threads) {
+	return decode_bc_texture_to_format(src, dst, width, height, pitch, format, TEXTURE_TYPE_UNCOMPRESSED_RGBA8, threads);
+}
+
+int decode_astc_texture(const unsigned char *src, unsigned char *dst, int width, int height, int pitch, int format, int threads) {
+	const BlockTextureType *type = find_block_texture_type(format, BLOCK_TEXTURE_FAMILY_ASTC);
+	if (type == NULL)
+		return 0;
+	return decode_block_texture(src, dst, width, height, pitch, type, TEXTURE_TYPE_UNCOMPRESSED_RGBA8, threads);
+}
+
+// Whole texture transcoding to BC formats.
+
+typedef void (*encode_block4x4_function)(const unsigned int *pixels, unsigned char *bitstring);
+
+typedef struct {
+	// The source texture, drawn as RGBA8.
+	BlockTexture texture;
+	int bc_block_size;
+	encode_block4x4_function encode_block;
+	// Set when a thread could not allocate its buffer.
+	int failed;
+} BlockTranscode;
+
+static int get_bc_transcode_format_for_type(const BlockTextureType *type) {
+	if (type->is_signed)
+		return 0;
+	if (type->family == BLOCK_TEXTURE_FAMILY_ASTC)
+		return TEXTURE_TYPE_DXT5;
+	switch (type->texture_type) {
+	case TEXTURE_TYPE_ETC1:
+	case TEXTURE_TYPE_ETC2_RGB8:
+	case TEXTURE_TYPE_ETC2_SRGB8:
+		return TEXTURE_TYPE_DXT1;
+	case TEXTURE_TYPE_ETC2_PUNCHTHROUGH:
+	case TEXTURE_TYPE_ETC2_SRGB_PUNCHTHROUGH:
+		return TEXTURE_TYPE_DXT1A;
+	case TEXTURE_TYPE_ETC2_EAC:
+	case TEXTURE_TYPE_ETC2_SRGB_EAC:
+		return TEXTURE_TYPE_DXT5;
+	case TEXTURE_TYPE_R11_EAC:
+		return TEXTURE_TYPE_RGTC1;
+	case TEXTURE_TYPE_RG11_EAC:
+		return TEXTURE_TYPE_RGTC2;
+	default:
+		return 0;
+	}
+}
+
+static const BlockTextureType *find_transcodable_texture_type(int texture_type) {
+	const BlockTextureType *type = find_block_texture_type(texture_type, BLOCK_TEXTURE_FAMILY_ETC);
+	if (type == NULL)
+		type = find_block_texture_type(texture_type, BLOCK_TEXTURE_FAMILY_ASTC);
+	if (type == NULL || get_bc_transcode_format_for_type(type) == 0)
+		return NULL;
+	return type;
+}
+
+// Draw a row of source blocks as RGBA8 into pixels, which is blocks_per_row * block_width pixels wide.
+
+static void draw_block_row_rgba8(const BlockTexture *texture, int by, unsigned int *pixels) {
+	const BlockTextureType *type = texture->type;
+	int block_width = type->block_width;
+	int block_height = type->block_height;
+	int blocks_per_row = (texture->width + block_width - 1) / block_width;
+	int row_width = blocks_per_row * block_width;
+	unsigned int block[MAX_BLOCK_PIXELS];
+	unsigned int converted[MAX_BLOCK_PIXELS];
+	const unsigned int *block_pixels = type->sixteen_bit ? converted : block;
+	const unsigned char *bitstring = texture->src + (size_t)by * blocks_per_row * type->block_size;
+	for (int bx = 0; bx < blocks_per_row; bx++) {
+		type->draw_block(bitstring, block, type->flags);
+		if (type->sixteen_bit)
+			convert_16bit_block(texture, block, (unsigned char *)converted);
+		for (int y = 0; y < block_height; y++)
+			memcpy(pixels + (size_t)y * row_width + bx * block_width, block_pixels + y * block_width,
+				block_width * 4);
+		bitstring += type->block_size;
+	}
+}
+
+static void transcode_block_rows(void *data, int begin, int end) {
+	BlockTranscode *transcode = (BlockTranscode *)data;
+	const BlockTexture *texture = &transcode->texture;
+	const BlockTextureType *type = texture->type;
+	int block_height = type->block_height;
+	int row_width = (texture->width + type->block_width - 1) / type->block_width * type->block_width;
+	int bc_blocks_per_row = (texture->width + 3) / 4;
+	// A row of 4x4 blocks overlaps at most two rows of source blocks (which are at least 4 pixels high), so the
+	// last two source block rows drawn are kept.
+	unsigned int *rows[2];
+	int row_indices[2] = { - 1, - 1 };
+	rows[0] = (unsigned int *)malloc((size_t)row_width * block_height * 4 * 2);
+	if (rows[0] == NULL) {
+		transcode->failed = 1;
+		return;
+	}
+	rows[1] = rows[0] + (size_t)row_width * block_height;
+	int next_slot = 0;
+	unsigned int pixels[16];
+	for (int by = begin; by < end; by++) {
+		const unsigned int *pixel_rows[4];
+		for (int y = 0; y < 4; y++) {
+			// Pixels past the edges repeat the last row and column, which keeps the edge blocks easy to encode.
+			int ty = by * 4 + y;
+			if (ty >= texture->height)
+				ty = texture->height - 1;
+			int row_index = ty / block_height;
+			int slot = row_indices[0] == row_index ? 0 : (row_indices[1] == row_index ? 1 : - 1);
+			if (slot < 0) {
+				slot = next_slot;
+				next_slot ^= 1;
+				draw_block_row_rgba8(texture, row_index, rows[slot]);
+				row_indices[slot] = row_index;
+			}
+			else
+				next_slot = slot ^ 1;
+			pixel_rows[y] = rows[slot] + (size_t)(ty - row_index * block_height) * row_width;
+		}
+		unsigned char *bitstring = texture->dst + (size_t)by * bc_blocks_per_row * transcode->bc_block_size;
+		for (int bx = 0; bx < bc_blocks_per_row; bx++) {
+			for (int x = 0; x < 4; x++) {
+				int tx = bx * 4 + x;
+				if (tx >= texture->width)
+					tx = texture->width - 1;
+				for (int y = 0; y < 4; y++)
+					pixels[y * 4 + x] = pixel_rows[y][tx];
+			}
+			transcode->encode_block(pixels, bitstring);
+			bitstring += transcode->bc_block_size;
+		}
+	}
+	free(rows[0]);
+}
+
+int get_bc_transcode_format(int format) {
+	const BlockTextureType *type = find_transcodable_texture_type(format);
+	return type == NULL ? 0 : get_bc_transcode_format_for_type(type);
+}
+
+int transcode_texture_to_bc(const unsigned char *src, unsigned char *dst, int width, int height, int format,
+	int threads) {
+	const BlockTextureType *type = find_transcodable_texture_type(format);
+	if (type == NULL)
+		return 0;
+	BlockTranscode transcode;
+	switch (get_bc_transcode_format_for_type(type)) {
+	case TEXTURE_TYPE_DXT1:
+		transcode.encode_block = encode_block4x4_dxt1_fast;
+		transcode.bc_block_size = 8;
+		break;
+	case TEXTURE_TYPE_DXT1A:
+		transcode.encode_block = encode_block4x4_dxt1a_fast;
+		transcode.bc_block_size = 8;
+		break;
+	case TEXTURE_TYPE_DXT5:
+		transcode.encode_block = encode_block4x4_dxt5_fast;
+		transcode.bc_block_size = 16;
+		break;
+	case TEXTURE_TYPE_RGTC1:
+		transcode.encode_block = encode_block4x4_rgtc1_fast;
+		transcode.bc_block_size = 8;
+		break;
+	default:
+		transcode.encode_block = encode_block4x4_rgtc2_fast;
+		transcode.bc_block_size = 16;
+		break;
+	}
+	if (width <= 0 || height <= 0)
+		return 1;
+	transcode.texture.src = src;
+	transcode.texture.dst = dst;
+	transcode.texture.width = width;
+	transcode.texture.height = height;
+	transcode.texture.pitch = 0;
+	transcode.texture.type = type;
+	transcode.texture.dst_pixel_size = 4;
+	transcode.failed = 0;
+	// Encoding costs more than decoding, so fewer rows per thread are worth it.
+	parallel_for_rows((height + 3) / 4, threads, 4, transcode_block_rows, &transcode);
+	return !transcode.failed;
+}
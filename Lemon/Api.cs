@@ -42,14 +42,65 @@ namespace Lemon
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern void OggDispose(IntPtr vorbisFile);
 		
+		// All decoder memory in one arena from the next open on (0 for the default size), negative for the heap
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggSetArena(IntPtr vorbisFile, int bytes);
+
+		// Only verify the checksum of the first page after an open or seek; for our own asset bundles
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggSetTrusted(IntPtr vorbisFile, int trusted);
+
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern int OggOpen(int datasource, IntPtr vorbisFile, FileSystem callbacks);
 		
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggOpenMemory(IntPtr data, int length, IntPtr vorbisFile);
+
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern int OggRead(IntPtr vorbisFile, IntPtr buffer, int length, ref int bitstream);
 		
+		// Planar: channel i occupies samples values from buffer + i * samples
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggReadFloat(IntPtr vorbisFile, IntPtr buffer, int samples, ref int bitstream);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggReadFixed(IntPtr vorbisFile, IntPtr buffer, int samples, ref int bitstream);
+
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern void OggResetToBeginning(IntPtr vorbisFile);
+
+		// Gapless loop for OggRead, in samples; end 0 means the end of the stream
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggSetLoop(IntPtr vorbisFile, long start, long end);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggSetLoopFromComments(IntPtr vorbisFile);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggClearLoop(IntPtr vorbisFile);
+
+		// Readies the loop's second decoder after a wrap, so the next wrap doesn't seek inside OggRead
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggPrimeLoop(IntPtr vorbisFile);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggSeekPcm(IntPtr vorbisFile, long sample);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggSeekTime(IntPtr vorbisFile, double seconds);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern long OggTellPcm(IntPtr vorbisFile);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern long OggGetPcmLength(IntPtr vorbisFile);
+
+		// Seek index as (granulepos, offset) pairs; returns the number of values needed
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggGetPageIndex(IntPtr vorbisFile, [Out] long[] pairs, int count);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggSetPageIndex(IntPtr vorbisFile, long[] pairs, int count);
 		
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern int OggGetFrequency(IntPtr vorbisFile);
@@ -57,6 +108,91 @@ namespace Lemon
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern int OggGetChannels(IntPtr vorbisFile);
 
+		// Decoded PCM cache
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OggPcmCacheCreate(int budget);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggPcmCacheDispose(IntPtr cache);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OggPcmCacheAcquire(IntPtr cache, string key);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OggPcmCacheInsert(IntPtr cache, string key, IntPtr data, int length);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OggPcmCacheAdopt(IntPtr cache, string key, IntPtr pcm, int size, int channels, int frequency);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggPcmCacheGetUsed(IntPtr cache);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggPcmRelease(IntPtr entry);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OggPcmGetData(IntPtr entry);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggPcmGetSize(IntPtr entry);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggPcmGetChannels(IntPtr entry);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggPcmGetFrequency(IntPtr entry);
+
+		// Batch decoding
+		[StructLayout(LayoutKind.Sequential)]
+		public struct OggBatchItem
+		{
+			public IntPtr Data;
+			public int Length;
+			public IntPtr Pcm;
+			public int Capacity;
+			public int Size;
+			public int Samples;
+			public int Channels;
+			public int Frequency;
+			public int Error;
+		}
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggDecodeBatch([In, Out] OggBatchItem[] items, int count, int threads);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggBatchFree(IntPtr pcm);
+
+		// Software mixer; voices pull from OggVorbis_File handles the caller keeps open. Zero when out of memory
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OggMixerCreate(int frequency, int maxVoices);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggMixerDispose(IntPtr mixer);
+
+		// Returns the voice index, or -1 when all voices are busy or out of memory
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggMixerAddVoice(IntPtr mixer, IntPtr vorbisFile, float gain, float pan, float pitch);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggMixerSetVoice(IntPtr mixer, int index, float gain, float pan, float pitch);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggMixerPauseVoice(IntPtr mixer, int index, int paused);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggMixerIsVoicePlaying(IntPtr mixer, int index);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OggMixerRemoveVoice(IntPtr mixer, int index);
+
+		// Stereo interleaved 16 bit output
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggMixerRender(IntPtr mixer, [Out] short[] output, int frames);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OggMixerRenderToWav(IntPtr mixer, string path, int frames);
+
 		// Theora
 		[StructLayout(LayoutKind.Sequential)]
 		public struct TheoraImagePlane
@@ -67,12 +203,47 @@ namespace Lemon
 			public IntPtr Data;
 		}
 
+		[StructLayout(LayoutKind.Sequential)]
+		public struct OgvFrameStats
+		{
+			public int BytesRead;
+			public int PacketBytes;
+			public int CodedFragments;
+			public int TotalFragments;
+			public int Keyframe;
+			public int Dupframe;
+			public double ReadMs;
+			public double UnpackMs;
+			public double DcUnpredictMs;
+			public double ReconMs;
+			public double LoopFilterMs;
+			public double PostprocessMs;
+		}
+
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern IntPtr OgvCreate(int datasource, FileSystem callbacks);
 
+		// Parses the clip where it lies; data must stay pinned until OgvDispose
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OgvCreateMemory(IntPtr data, int length);
+
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern IntPtr OgvDispose(IntPtr ogv);
 
+		// The pool may be shared between threads; it isn't locked while a pooled decoder reads its headers
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OgvPoolCreate(int capacity);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OgvPoolDispose(IntPtr pool);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern IntPtr OgvCreatePooled(IntPtr pool, int datasource, FileSystem callbacks);
+
+		// Resets to checking every page when a pooled decoder is reused
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OgvSetTrusted(IntPtr ogv, int trusted);
+
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern TheoraImagePlane OgvGetBuffer(IntPtr ogv, int plane);
 
@@ -88,7 +259,22 @@ namespace Lemon
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern double OgvGetPlaybackTime(IntPtr ogv);
 
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern int OgvEnableStats(IntPtr ogv, int enable);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void OgvGetFrameStats(IntPtr ogv, out OgvFrameStats stats);
+
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
 		public static extern void DecodeRGBX8(IntPtr dst_ptr, IntPtr y_ptr, IntPtr u_ptr, IntPtr v_ptr, int width, int height, int y_span, int uv_span, int dst_span, int dither);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void DecodeRGBX8Scaled(IntPtr dst_ptr, IntPtr y_ptr, IntPtr u_ptr, IntPtr v_ptr, int width, int height, int y_span, int uv_span, int dst_span, int scale_shift);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void DecodeRGB565(IntPtr dst_ptr, IntPtr y_ptr, IntPtr u_ptr, IntPtr v_ptr, int width, int height, int y_span, int uv_span, int dst_span, int dither);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		public static extern void DecodeRGBA4444(IntPtr dst_ptr, IntPtr y_ptr, IntPtr u_ptr, IntPtr v_ptr, IntPtr a_ptr, int width, int height, int y_span, int uv_span, int a_span, int dst_span, IntPtr alpha_table, int dither);
 	}
 }
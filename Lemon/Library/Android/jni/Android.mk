@@ -14,8 +14,13 @@ LOCAL_C_INCLUDES := $(LOCAL_PATH)/Include
 
 LOCAL_SRC_FILES := OggDecoder.c \
 	OgvDecoder.c \
+	OggMixer.c \
+	OggBatch.c \
+	OggPcmCache.c \
 	TheoraDecoder.c \
+	Threading.c \
 	Ogg/bitwise.c \
+	Ogg/crc.c \
 	Ogg/framing.c \
 	Theora/apiwrapper.c \
 	Theora/bitpack.c \
@@ -39,12 +44,15 @@ LOCAL_SRC_FILES := OggDecoder.c \
 	Theora/tokenize.c \
 	Theora/arm/armcpu.c \
 	Theora/arm/armstate.c \
+	Tremor/alloc.c \
 	Tremor/block.c \
 	Tremor/codebook.c \
+	Tremor/cpu.c \
 	Tremor/floor0.c \
 	Tremor/floor1.c \
 	Tremor/mapping0.c \
 	Tremor/mdct.c \
+	Tremor/mdct_sse2.c \
 	Tremor/registry.c \
 	Tremor/res012.c \
 	Tremor/sharedbook.c \
@@ -53,9 +61,19 @@ LOCAL_SRC_FILES := OggDecoder.c \
 	Tremor/vorbis_info.c \
 	Tremor/window.c \
 	yuv2rgb/yuv2rgb16tab.c \
+	yuv2rgb/yuv420rgb565c.c \
 	yuv2rgb/yuv420rgb8888c.c \
+	yuv2rgb/yuv420rgb8888scalec.c \
+	yuv2rgb/yuv420rgba4444c.c \
 	yuv2rgb/yuv422rgb8888c.c \
 	yuv2rgb/yuv422rgb888c.c \
 	yuv2rgb/yuv444rgb8888c.c
 
+# Tremor's NEON MDCT is picked at runtime, so only that file may assume NEON
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_SRC_FILES += Tremor/mdct_neon.c.neon
+else
+LOCAL_SRC_FILES += Tremor/mdct_neon.c
+endif
+
 include $(BUILD_SHARED_LIBRARY)
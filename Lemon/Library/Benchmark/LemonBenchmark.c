@@ -0,0 +1,1447 @@
+// Ogv decode and colour conversion benchmark.
+//
+// Encodes a set of synthetic clips with the in-tree Theora encoder, then
+// measures each stage of playback separately and prints the results as JSON:
+//   open     - OgvCreate + OgvDispose on an in-memory stream (header parse),
+//              also pooled and through OgvCreateMemory, which has to decode
+//              as many frames as OgvCreate
+//   demux    - every packet of each clip through ogg_sync_buffer and
+//              stream buffers, and framed in place with zero-copy streams;
+//              fails the run if the packets differ
+//   decode   - th_decode_packetin per frame
+//   ycbcr    - th_decode_ycbcr_out per frame
+//   convert  - every colour conversion path, per frame
+//   stages   - TH_DECCTL_SET_STATS breakdown of decode, from a separate pass
+//              so the extra clock reads don't skew the decode figure
+//   imdct    - Tremor's inverse MDCT, C path against the one picked for this
+//              CPU; also checks that windowing, overlap/add and the MDCT give
+//              bit-identical output on both, and fails the run if they don't
+//   crc      - Ogg page CRC byte at a time, slicing-by-8 and with carry-less
+//              multiplies where the CPU has them, in MB/s; fails the run if
+//              they disagree on any length or alignment
+//   vorbis   - Huffman decode with the residue codebooks of each --vorbis
+//              file, through the lookup tables and by plain bisection of
+//              the codeword list; fails the run if the two disagree. Also
+//              opens, decodes a second of and closes each file with the
+//              decoder on the heap and in an arena, counting the heap
+//              allocations each way; fails the run if the PCM differs.
+//              Then walks the pages of each file with and without
+//              ogg_sync_set_trusted, and fails the run if a trusted decode
+//              or page walk differs from a checked one, or if decoding
+//              through read callbacks differs from the zero-copy path
+//   mixer    - OggMixer with many voices of the first --vorbis file, per
+//              second of output; also checks that a voice at unity gain,
+//              centre pan and pitch 1 comes out exactly as decoded, and can
+//              write the mix to --wav
+//
+// Usage: LemonBenchmark [--quick] [--frames N] [--repeat N] [--output file]
+//                       [--vorbis file]... [--wav file]
+
+#include <math.h>
+#include <time.h>
+#include "Lemon.h"
+#include <theora/theoraenc.h>
+#include "yuv2rgb/yuv2rgb.h"
+#include "Tremor/dsp.h"
+#include "Tremor/mdct.h"
+#include "Tremor/window.h"
+#include "Tremor/codec_internal.h"
+#include "Tremor/backends.h"
+#include "Ogg/crc.h"
+#include "Ogg/crctable.h"
+
+typedef struct OgvDecoder OgvDecoder;
+typedef struct OgvPool OgvPool;
+
+OgvDecoder* OgvCreate(void* dataSource, ov_callbacks callbacks);
+void OgvDispose(OgvDecoder* ogv);
+OgvPool* OgvPoolCreate(int capacity);
+void OgvPoolDispose(OgvPool* pool);
+OgvDecoder* OgvCreatePooled(OgvPool* pool, void* dataSource, ov_callbacks callbacks);
+OgvDecoder* OgvCreateMemory(const char* data, int length);
+int OgvDecodeFrame(OgvDecoder* ogv);
+typedef struct OggMixer OggMixer;
+
+OggVorbis_File* OggCreate();
+void OggDispose(OggVorbis_File* vf);
+int OggOpen(void* dataSource, OggVorbis_File* vf, ov_callbacks callbacks);
+int OggOpenMemory(const char* data, int length, OggVorbis_File* vf);
+void OggSetArena(OggVorbis_File* vf, int bytes);
+void OggSetTrusted(OggVorbis_File* vf, int trusted);
+int OggRead(OggVorbis_File* vf, char* buffer, int length, int* bitstream);
+int OggSetLoop(OggVorbis_File* vf, ogg_int64_t start, ogg_int64_t end);
+int OggPrimeLoop(OggVorbis_File* vf);
+OggMixer* OggMixerCreate(int frequency, int maxVoices);
+void OggMixerDispose(OggMixer* mixer);
+int OggMixerAddVoice(OggMixer* mixer, OggVorbis_File* vf, float gain, float pan, float pitch);
+void OggMixerRemoveVoice(OggMixer* mixer, int index);
+int OggMixerRender(OggMixer* mixer, short* output, int frames);
+int OggMixerRenderToWav(OggMixer* mixer, const char* path, int frames);
+void DecodeRGBX8(uint8_t* dst_ptr, const uint8_t* y_ptr, const uint8_t* u_ptr, const uint8_t* v_ptr,
+	int32_t width, int32_t height, int32_t y_span, int32_t uv_span, int32_t dst_span, int32_t dither);
+void DecodeRGBX8Scaled(uint8_t* dst_ptr, const uint8_t* y_ptr, const uint8_t* u_ptr, const uint8_t* v_ptr,
+	int32_t width, int32_t height, int32_t y_span, int32_t uv_span, int32_t dst_span, int32_t scale_shift);
+void DecodeRGB565(uint8_t* dst_ptr, const uint8_t* y_ptr, const uint8_t* u_ptr, const uint8_t* v_ptr,
+	int32_t width, int32_t height, int32_t y_span, int32_t uv_span, int32_t dst_span, int32_t dither);
+void DecodeRGBA4444(uint8_t* dst_ptr, const uint8_t* y_ptr, const uint8_t* u_ptr, const uint8_t* v_ptr,
+	const uint8_t* a_ptr, int32_t width, int32_t height, int32_t y_span, int32_t uv_span, int32_t a_span,
+	int32_t dst_span, const uint8_t* alpha_table, int32_t dither);
+
+typedef struct
+{
+	const char* name;
+	int width;
+	int height;
+} ClipDesc;
+
+static const ClipDesc Clips[] = {
+	{ "qcif", 176, 144 },
+	{ "360p", 640, 360 },
+	{ "720p", 1280, 720 },
+};
+
+#define CLIP_COUNT (int)(sizeof(Clips) / sizeof(Clips[0]))
+
+typedef struct
+{
+	unsigned char* data;
+	long size;
+	long capacity;
+} ByteBuffer;
+
+typedef struct
+{
+	const unsigned char* data;
+	long size;
+	long position;
+} MemorySource;
+
+typedef struct
+{
+	const char* name;
+	int bytesPerPixel;
+	void (*convert)(uint8_t* dst, th_ycbcr_buffer ycbcr, int dstSpan);
+} ConversionPath;
+
+static void ConvertRGBX8(uint8_t* dst, th_ycbcr_buffer ycbcr, int dstSpan)
+{
+	DecodeRGBX8(dst, ycbcr[0].data, ycbcr[1].data, ycbcr[2].data,
+		ycbcr[0].width, ycbcr[0].height, ycbcr[0].stride, ycbcr[1].stride, dstSpan, 0);
+}
+
+static void ConvertRGBX8Half(uint8_t* dst, th_ycbcr_buffer ycbcr, int dstSpan)
+{
+	DecodeRGBX8Scaled(dst, ycbcr[0].data, ycbcr[1].data, ycbcr[2].data,
+		ycbcr[0].width, ycbcr[0].height, ycbcr[0].stride, ycbcr[1].stride, dstSpan, 1);
+}
+
+static void ConvertRGBX8Quarter(uint8_t* dst, th_ycbcr_buffer ycbcr, int dstSpan)
+{
+	DecodeRGBX8Scaled(dst, ycbcr[0].data, ycbcr[1].data, ycbcr[2].data,
+		ycbcr[0].width, ycbcr[0].height, ycbcr[0].stride, ycbcr[1].stride, dstSpan, 2);
+}
+
+static void ConvertRGB565(uint8_t* dst, th_ycbcr_buffer ycbcr, int dstSpan)
+{
+	DecodeRGB565(dst, ycbcr[0].data, ycbcr[1].data, ycbcr[2].data,
+		ycbcr[0].width, ycbcr[0].height, ycbcr[0].stride, ycbcr[1].stride, dstSpan, 1);
+}
+
+// The clips have no alpha stream, so the luma plane stands in for it.
+static void ConvertRGBA4444(uint8_t* dst, th_ycbcr_buffer ycbcr, int dstSpan)
+{
+	DecodeRGBA4444(dst, ycbcr[0].data, ycbcr[1].data, ycbcr[2].data, ycbcr[0].data,
+		ycbcr[0].width, ycbcr[0].height, ycbcr[0].stride, ycbcr[1].stride, ycbcr[0].stride,
+		dstSpan, NULL, 1);
+}
+
+static const ConversionPath ConversionPaths[] = {
+	{ "RGBX8", 4, ConvertRGBX8 },
+	{ "RGBX8/2", 4, ConvertRGBX8Half },
+	{ "RGBX8/4", 4, ConvertRGBX8Quarter },
+	{ "RGB565", 2, ConvertRGB565 },
+	{ "RGBA4444", 2, ConvertRGBA4444 },
+};
+
+#define CONVERSION_PATH_COUNT (int)(sizeof(ConversionPaths) / sizeof(ConversionPaths[0]))
+
+static double Now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void BufferAppend(ByteBuffer* buffer, const unsigned char* data, long size)
+{
+	if (buffer->size + size > buffer->capacity) {
+		buffer->capacity = (buffer->size + size) * 2;
+		buffer->data = (unsigned char*)realloc(buffer->data, buffer->capacity);
+	}
+	memcpy(buffer->data + buffer->size, data, size);
+	buffer->size += size;
+}
+
+static void WritePages(ByteBuffer* out, ogg_stream_state* os, int flush)
+{
+	ogg_page page;
+	while (flush ? ogg_stream_flush(os, &page) : ogg_stream_pageout(os, &page)) {
+		BufferAppend(out, page.header, page.header_len);
+		BufferAppend(out, page.body, page.body_len);
+	}
+}
+
+// Moving diagonal pattern with a bit of texture, so inter frames carry
+// motion vectors and residue rather than being all-skip.
+static void FillFrame(th_ycbcr_buffer ycbcr, int frame)
+{
+	int x, y;
+	for (y = 0; y < ycbcr[0].height; y++) {
+		unsigned char* row = ycbcr[0].data + y * ycbcr[0].stride;
+		for (x = 0; x < ycbcr[0].width; x++) {
+			row[x] = (unsigned char)((x + y + frame * 3) ^ ((x * y) >> 6));
+		}
+	}
+	for (y = 0; y < ycbcr[1].height; y++) {
+		unsigned char* u = ycbcr[1].data + y * ycbcr[1].stride;
+		unsigned char* v = ycbcr[2].data + y * ycbcr[2].stride;
+		for (x = 0; x < ycbcr[1].width; x++) {
+			u[x] = (unsigned char)(128 + (x - frame) % 64);
+			v[x] = (unsigned char)(96 + (y + frame) % 64);
+		}
+	}
+}
+
+static int EncodeClip(const ClipDesc* clip, int frames, ByteBuffer* out)
+{
+	th_info info;
+	th_comment comment;
+	th_enc_ctx* enc;
+	th_ycbcr_buffer ycbcr;
+	ogg_stream_state os;
+	ogg_packet packet;
+	unsigned char* planes;
+	int frameWidth, frameHeight, i, ret;
+
+	frameWidth = (clip->width + 15) & ~15;
+	frameHeight = (clip->height + 15) & ~15;
+	th_info_init(&info);
+	info.frame_width = frameWidth;
+	info.frame_height = frameHeight;
+	info.pic_width = clip->width;
+	info.pic_height = clip->height;
+	info.fps_numerator = 30;
+	info.fps_denominator = 1;
+	info.pixel_fmt = TH_PF_420;
+	info.quality = 48;
+	info.keyframe_granule_shift = 6;
+	enc = th_encode_alloc(&info);
+	th_info_clear(&info);
+	if (enc == NULL) {
+		return -1;
+	}
+	th_comment_init(&comment);
+	ogg_stream_init(&os, 1);
+	while ((ret = th_encode_flushheader(enc, &comment, &packet)) > 0) {
+		ogg_stream_packetin(&os, &packet);
+		if (packet.b_o_s) {
+			WritePages(out, &os, 1);
+		}
+	}
+	WritePages(out, &os, 1);
+
+	planes = (unsigned char*)malloc(frameWidth * frameHeight * 3 / 2);
+	ycbcr[0].width = frameWidth;
+	ycbcr[0].height = frameHeight;
+	ycbcr[0].stride = frameWidth;
+	ycbcr[0].data = planes;
+	ycbcr[1].width = ycbcr[2].width = frameWidth / 2;
+	ycbcr[1].height = ycbcr[2].height = frameHeight / 2;
+	ycbcr[1].stride = ycbcr[2].stride = frameWidth / 2;
+	ycbcr[1].data = planes + frameWidth * frameHeight;
+	ycbcr[2].data = ycbcr[1].data + frameWidth * frameHeight / 4;
+	for (i = 0; i < frames && ret >= 0; i++) {
+		FillFrame(ycbcr, i);
+		ret = th_encode_ycbcr_in(enc, ycbcr);
+		while (ret >= 0 && th_encode_packetout(enc, i == frames - 1, &packet) > 0) {
+			ogg_stream_packetin(&os, &packet);
+			WritePages(out, &os, 0);
+		}
+	}
+	WritePages(out, &os, 1);
+	free(planes);
+	ogg_stream_clear(&os);
+	th_comment_clear(&comment);
+	th_encode_free(enc);
+	return ret < 0 ? -1 : 0;
+}
+
+static size_t MemoryRead(void* ptr, size_t size, size_t nmemb, void* dataSource)
+{
+	MemorySource* source = (MemorySource*)dataSource;
+	long bytes = (long)(size * nmemb);
+	if (bytes > source->size - source->position) {
+		bytes = source->size - source->position;
+	}
+	memcpy(ptr, source->data + source->position, bytes);
+	source->position += bytes;
+	return bytes;
+}
+
+static int MemorySeek(void* dataSource, ogg_int64_t offset, int whence)
+{
+	MemorySource* source = (MemorySource*)dataSource;
+	long base = whence == SEEK_END ? source->size : whence == SEEK_CUR ? source->position : 0;
+	if (base + offset < 0 || base + offset > source->size) {
+		return -1;
+	}
+	source->position = (long)(base + offset);
+	return 0;
+}
+
+static int MemoryClose(void* dataSource)
+{
+	return 0;
+}
+
+static long MemoryTell(void* dataSource)
+{
+	return ((MemorySource*)dataSource)->position;
+}
+
+static const ov_callbacks MemoryCallbacks = { MemoryRead, MemorySeek, MemoryClose, MemoryTell };
+
+// Frames decoded through read callbacks or in place, -1 if they differ
+static int CountFrames(const ByteBuffer* clip)
+{
+	MemorySource source = { clip->data, clip->size, 0 };
+	OgvDecoder* ogv = OgvCreate(&source, MemoryCallbacks);
+	OgvDecoder* inPlace = OgvCreateMemory((const char*)clip->data, (int)clip->size);
+	int frames = 0, a, b;
+	if (ogv == NULL || inPlace == NULL) {
+		frames = -1;
+	}
+	while (frames >= 0) {
+		a = OgvDecodeFrame(ogv);
+		b = OgvDecodeFrame(inPlace);
+		if (a != b) {
+			frames = -1;
+		} else if (a < 0) {
+			break;
+		} else {
+			frames++;
+		}
+	}
+	if (ogv) {
+		OgvDispose(ogv);
+	}
+	if (inPlace) {
+		OgvDispose(inPlace);
+	}
+	return frames;
+}
+
+static double BenchmarkOpenMemory(const ByteBuffer* clip, int repeat)
+{
+	OgvDecoder* ogv;
+	double start;
+	int i;
+	start = Now();
+	for (i = 0; i < repeat; i++) {
+		ogv = OgvCreateMemory((const char*)clip->data, (int)clip->size);
+		if (ogv == NULL) {
+			return -1;
+		}
+		OgvDispose(ogv);
+	}
+	return (Now() - start) / repeat;
+}
+
+static double BenchmarkOpen(const ByteBuffer* clip, int repeat, OgvPool* pool)
+{
+	MemorySource source;
+	OgvDecoder* ogv;
+	double start;
+	int i;
+	start = Now();
+	for (i = 0; i < repeat; i++) {
+		source.data = clip->data;
+		source.size = clip->size;
+		source.position = 0;
+		ogv = pool ? OgvCreatePooled(pool, &source, MemoryCallbacks) : OgvCreate(&source, MemoryCallbacks);
+		if (ogv == NULL) {
+			return -1;
+		}
+		OgvDispose(ogv);
+	}
+	return (Now() - start) / repeat;
+}
+
+typedef struct
+{
+	long packets;
+	long bytes;
+	uint32_t sum;
+} DemuxResult;
+
+// Reads every packet of the clip's streams, either feeding the sync state
+// in chunks as a file would or framing the clip where it lies. result, if
+// given, gets a checksum of the packets.
+static int Demux(const ByteBuffer* clip, int zeroCopy, DemuxResult* result)
+{
+	ogg_sync_state sync;
+	ogg_stream_state streams[4];
+	ogg_page page;
+	ogg_packet packet;
+	long position = 0, i;
+	int streamCount = 0, s, ret;
+
+	if (result) {
+		memset(result, 0, sizeof(*result));
+	}
+	ogg_sync_init(&sync);
+	if (zeroCopy) {
+		ogg_sync_wrap(&sync, clip->data, (long)clip->size);
+	}
+	for (;;) {
+		ret = ogg_sync_pageout(&sync, &page);
+		if (ret == 0) {
+			long bytes = clip->size - position < 4096 ? clip->size - position : 4096;
+			if (zeroCopy || bytes == 0) {
+				break;
+			}
+			memcpy(ogg_sync_buffer(&sync, 4096), clip->data + position, bytes);
+			ogg_sync_wrote(&sync, bytes);
+			position += bytes;
+			continue;
+		}
+		if (ret < 0) {
+			continue;
+		}
+		for (s = 0; s < streamCount && streams[s].serialno != ogg_page_serialno(&page); s++);
+		if (s == streamCount) {
+			if (streamCount == 4) {
+				continue;
+			}
+			ogg_stream_init(&streams[streamCount], ogg_page_serialno(&page));
+			ogg_stream_set_zerocopy(&streams[streamCount], zeroCopy);
+			streamCount++;
+		}
+		ogg_stream_pagein(&streams[s], &page);
+		while (ogg_stream_packetout(&streams[s], &packet) == 1) {
+			if (result == NULL) {
+				continue;
+			}
+			result->packets++;
+			result->bytes += packet.bytes;
+			for (i = 0; i < packet.bytes; i++) {
+				result->sum = result->sum * 31 + packet.packet[i];
+			}
+		}
+	}
+	for (s = 0; s < streamCount; s++) {
+		ogg_stream_clear(&streams[s]);
+	}
+	ogg_sync_clear(&sync);
+	return 0;
+}
+
+// Time per pass with the chunked and in-place framing; fails if the two
+// disagree on any packet
+static int BenchmarkDemux(const ByteBuffer* clip, int repeat, double* copyMs, double* zeroCopyMs)
+{
+	DemuxResult copied, inPlace;
+	double t;
+	int r;
+	Demux(clip, 0, &copied);
+	Demux(clip, 1, &inPlace);
+	if (copied.packets == 0 || copied.packets != inPlace.packets ||
+		copied.bytes != inPlace.bytes || copied.sum != inPlace.sum) {
+		return -1;
+	}
+	t = Now();
+	for (r = 0; r < repeat; r++) {
+		Demux(clip, 0, NULL);
+	}
+	*copyMs = (Now() - t) / repeat;
+	t = Now();
+	for (r = 0; r < repeat; r++) {
+		Demux(clip, 1, NULL);
+	}
+	*zeroCopyMs = (Now() - t) / repeat;
+	return 0;
+}
+
+typedef struct
+{
+	int frames;
+	double decodeMs;
+	double ycbcrMs;
+	double convertMs[CONVERSION_PATH_COUNT];
+	int keyframes;
+	int dupframes;
+	double codedRatio;
+	double unpackMs;
+	double dcUnpredictMs;
+	double reconMs;
+	double loopFilterMs;
+	double postprocessMs;
+} DecodeResult;
+
+static ogg_int64_t StatsClock(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ogg_int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Demuxes the clip with plain libogg/libtheora calls so that each stage can
+// be timed on its own.
+static int BenchmarkDecode(const ByteBuffer* clip, int repeat, DecodeResult* result)
+{
+	ogg_sync_state sync;
+	ogg_stream_state stream;
+	ogg_page page;
+	ogg_packet packet;
+	th_info info;
+	th_comment comment;
+	th_setup_info* setup = NULL;
+	th_dec_ctx* ctx;
+	th_ycbcr_buffer ycbcr;
+	ogg_packet* packets = NULL;
+	int packetCount = 0, packetCapacity = 0;
+	int headers = 1, i, r, p;
+	uint8_t* rgb;
+	double t;
+
+	memset(result, 0, sizeof(*result));
+	th_info_init(&info);
+	th_comment_init(&comment);
+	ogg_sync_init(&sync);
+	memcpy(ogg_sync_buffer(&sync, clip->size), clip->data, clip->size);
+	ogg_sync_wrote(&sync, clip->size);
+	while (ogg_sync_pageout(&sync, &page) == 1) {
+		if (ogg_page_bos(&page)) {
+			ogg_stream_init(&stream, ogg_page_serialno(&page));
+		}
+		ogg_stream_pagein(&stream, &page);
+		while (ogg_stream_packetout(&stream, &packet) == 1) {
+			if (headers && th_decode_headerin(&info, &comment, &setup, &packet) > 0) {
+				continue;
+			}
+			headers = 0;
+			if (packetCount == packetCapacity) {
+				packetCapacity = packetCapacity ? packetCapacity * 2 : 64;
+				packets = (ogg_packet*)realloc(packets, packetCapacity * sizeof(ogg_packet));
+			}
+			// Packet data points into the stream state, so keep a copy
+			packets[packetCount] = packet;
+			packets[packetCount].packet = (unsigned char*)malloc(packet.bytes);
+			memcpy(packets[packetCount].packet, packet.packet, packet.bytes);
+			packetCount++;
+		}
+	}
+	ogg_stream_clear(&stream);
+	ogg_sync_clear(&sync);
+
+	rgb = (uint8_t*)malloc(info.frame_width * info.frame_height * 4);
+	for (r = 0; r < repeat; r++) {
+		ctx = th_decode_alloc(&info, setup);
+		if (ctx == NULL) {
+			break;
+		}
+		for (i = 0; i < packetCount; i++) {
+			t = Now();
+			th_decode_packetin(ctx, &packets[i], NULL);
+			result->decodeMs += Now() - t;
+			t = Now();
+			th_decode_ycbcr_out(ctx, ycbcr);
+			result->ycbcrMs += Now() - t;
+			for (p = 0; p < CONVERSION_PATH_COUNT; p++) {
+				const ConversionPath* path = &ConversionPaths[p];
+				t = Now();
+				path->convert(rgb, ycbcr, ycbcr[0].width * path->bytesPerPixel);
+				result->convertMs[p] += Now() - t;
+			}
+		}
+		th_decode_free(ctx);
+	}
+	ctx = th_decode_alloc(&info, setup);
+	if (ctx != NULL) {
+		th_dec_stats stats;
+		th_stats_callback cb = { &stats, StatsClock };
+		th_decode_ctl(ctx, TH_DECCTL_SET_STATS, &cb, sizeof(cb));
+		for (i = 0; i < packetCount; i++) {
+			th_decode_packetin(ctx, &packets[i], NULL);
+			result->keyframes += stats.keyframe;
+			result->dupframes += stats.dupframe;
+			result->codedRatio += stats.nfrags ? (double)stats.ncoded_frags / stats.nfrags : 0;
+			result->unpackMs += stats.unpack_ticks * 1e-6;
+			result->dcUnpredictMs += stats.dc_unpredict_ticks * 1e-6;
+			result->reconMs += stats.recon_ticks * 1e-6;
+			result->loopFilterMs += stats.loop_filter_ticks * 1e-6;
+			result->postprocessMs += stats.postprocess_ticks * 1e-6;
+		}
+		th_decode_free(ctx);
+	}
+	result->frames = packetCount;
+	if (packetCount > 0 && repeat > 0) {
+		result->decodeMs /= packetCount * repeat;
+		result->ycbcrMs /= packetCount * repeat;
+		for (p = 0; p < CONVERSION_PATH_COUNT; p++) {
+			result->convertMs[p] /= packetCount * repeat;
+		}
+		result->codedRatio /= packetCount;
+		result->unpackMs /= packetCount;
+		result->dcUnpredictMs /= packetCount;
+		result->reconMs /= packetCount;
+		result->loopFilterMs /= packetCount;
+		result->postprocessMs /= packetCount;
+	}
+	for (i = 0; i < packetCount; i++) {
+		free(packets[i].packet);
+	}
+	free(packets);
+	free(rgb);
+	th_setup_free(setup);
+	th_comment_clear(&comment);
+	th_info_clear(&info);
+	return packetCount > 0 ? 0 : -1;
+}
+
+#define IMDCT_MIN_SIZE 64
+#define IMDCT_MAX_SIZE 8192
+
+static unsigned int RandomState = 1;
+
+static ogg_int32_t RandomSample(void)
+{
+	RandomState = RandomState * 1103515245 + 12345;
+	// Roughly the range floor * residue products reach in real streams
+	return (ogg_int32_t)(RandomState >> 7) - (1 << 24);
+}
+
+static void FillRandom(ogg_int32_t* data, int n)
+{
+	int i;
+	for (i = 0; i < n; i++) {
+		data[i] = RandomSample();
+	}
+}
+
+// Runs the same input through the C and the selected DSP paths and returns
+// the number of stages whose output differed.
+static int CheckImdct(const vorbis_dsp_vtable* c, const vorbis_dsp_vtable* simd)
+{
+	static const long blocksizes[][2] = { { 256, 2048 }, { 64, 8192 }, { 512, 512 } };
+	ogg_int32_t* input = (ogg_int32_t*)malloc(sizeof(ogg_int32_t) * IMDCT_MAX_SIZE);
+	ogg_int32_t* a = (ogg_int32_t*)malloc(sizeof(ogg_int32_t) * IMDCT_MAX_SIZE);
+	ogg_int32_t* b = (ogg_int32_t*)malloc(sizeof(ogg_int32_t) * IMDCT_MAX_SIZE);
+	int n, i, seed, lW, W, nW, mismatches = 0;
+
+	for (n = IMDCT_MIN_SIZE; n <= IMDCT_MAX_SIZE; n *= 2) {
+		for (seed = 0; seed < 8; seed++) {
+			FillRandom(input, n / 2);
+			memcpy(a, input, sizeof(ogg_int32_t) * n / 2);
+			memcpy(b, input, sizeof(ogg_int32_t) * n / 2);
+			mdct_backward(c, n, a, a);
+			mdct_backward(simd, n, b, b);
+			if (memcmp(a, b, sizeof(ogg_int32_t) * n)) {
+				fprintf(stderr, "imdct: mdct_backward mismatch at n=%d\n", n);
+				mismatches++;
+				break;
+			}
+		}
+		FillRandom(a, n);
+		memcpy(b, a, sizeof(ogg_int32_t) * n);
+		FillRandom(input, n);
+		c->overlap_add(a, input, n);
+		simd->overlap_add(b, input, n);
+		if (memcmp(a, b, sizeof(ogg_int32_t) * n)) {
+			fprintf(stderr, "imdct: overlap_add mismatch at n=%d\n", n);
+			mismatches++;
+		}
+	}
+	for (i = 0; i < (int)(sizeof(blocksizes) / sizeof(blocksizes[0])); i++) {
+		long sizes[2];
+		const void* window[2];
+		sizes[0] = blocksizes[i][0];
+		sizes[1] = blocksizes[i][1];
+		window[0] = _vorbis_window(0, (int)sizes[0] / 2);
+		window[1] = _vorbis_window(0, (int)sizes[1] / 2);
+		for (W = 0; W < 2; W++) {
+			for (lW = 0; lW < 2; lW++) {
+				for (nW = 0; nW < 2; nW++) {
+					// A short block only ever sits between short blocks
+					if (W == 0 && (lW || nW)) {
+						continue;
+					}
+					FillRandom(a, (int)sizes[W]);
+					memcpy(b, a, sizeof(ogg_int32_t) * sizes[W]);
+					c->apply_window(a, window, sizes, lW, W, nW);
+					simd->apply_window(b, window, sizes, lW, W, nW);
+					if (memcmp(a, b, sizeof(ogg_int32_t) * sizes[W])) {
+						fprintf(stderr, "imdct: apply_window mismatch at %ld/%ld %d%d%d\n",
+							sizes[0], sizes[1], lW, W, nW);
+						mismatches++;
+					}
+				}
+			}
+		}
+	}
+	free(input);
+	free(a);
+	free(b);
+	return mismatches;
+}
+
+// Microseconds per mdct_backward of size n.
+static double BenchmarkImdct(const vorbis_dsp_vtable* vt, int n, int repeat)
+{
+	ogg_int32_t* data = (ogg_int32_t*)malloc(sizeof(ogg_int32_t) * n);
+	int i, iterations = repeat * (1 << 20) / n;
+	double t;
+	FillRandom(data, n / 2);
+	t = Now();
+	for (i = 0; i < iterations; i++) {
+		mdct_backward(vt, n, data, data);
+		// Keep the values in range; the cost doesn't depend on them
+		data[i & (n / 2 - 1)] >>= 8;
+	}
+	t = Now() - t;
+	free(data);
+	return t * 1000.0 / iterations;
+}
+
+#define MAX_VORBIS_FILES 8
+#define CODEBOOK_BITS_BYTES 16384
+
+#define CRC_BUFFER_BYTES (64 * 1024)
+#define CRC_CHECK_BYTES 1024
+
+// What framing.c used to do, as the reference
+static ogg_uint32_t CrcBytewise(ogg_uint32_t crc, const unsigned char* buffer, long n)
+{
+	long i;
+	for (i = 0; i < n; i++) {
+		crc = (crc << 8) ^ crc_lookup[0][((crc >> 24) & 0xff) ^ buffer[i]];
+	}
+	return crc;
+}
+
+// Every length up to CRC_CHECK_BYTES from every alignment mod 16, through
+// the tables and through simd if there is one, each continuing from a
+// nonzero crc. Returns the number of mismatches.
+static int CheckCrc(ogg_crc_func simd)
+{
+	unsigned char buffer[CRC_CHECK_BYTES + 16];
+	int i, n, offset, mismatches = 0;
+	for (i = 0; i < (int)sizeof(buffer); i++) {
+		buffer[i] = (unsigned char)(RandomSample() >> 8);
+	}
+	for (offset = 0; offset < 16; offset++) {
+		for (n = 0; n <= CRC_CHECK_BYTES; n++) {
+			ogg_uint32_t start = (ogg_uint32_t)n * 0x9e3779b9u;
+			ogg_uint32_t expected = CrcBytewise(start, buffer + offset, n);
+			if (_ogg_crc_update_c(start, buffer + offset, n) != expected) {
+				mismatches++;
+			}
+			if (simd && simd(start, buffer + offset, n) != expected) {
+				mismatches++;
+			}
+		}
+	}
+	if (mismatches > 0) {
+		fprintf(stderr, "crc: %d mismatches against the byte at a time CRC\n", mismatches);
+	}
+	return mismatches;
+}
+
+// Keeps the benchmark loops from being optimised away
+static volatile ogg_uint32_t crcSink;
+
+// MB/s over a buffer the size of a large video page.
+static double BenchmarkCrc(ogg_crc_func crc, int repeat)
+{
+	unsigned char* buffer = (unsigned char*)malloc(CRC_BUFFER_BYTES);
+	ogg_uint32_t sum = 0;
+	double t;
+	int i;
+	for (i = 0; i < CRC_BUFFER_BYTES; i++) {
+		buffer[i] = (unsigned char)i;
+	}
+	repeat *= 20;
+	t = Now();
+	for (i = 0; i < repeat; i++) {
+		sum += crc(sum, buffer, CRC_BUFFER_BYTES);
+	}
+	t = Now() - t;
+	crcSink = sum;
+	free(buffer);
+	return (double)CRC_BUFFER_BYTES * repeat / 1000.0 / t;
+}
+
+typedef struct
+{
+	int books;
+	double oneLookupShare;
+	double tableNsPerWord;
+	double bisectNsPerWord;
+} CodebookResult;
+
+// Decodes codewords from bits until it runs out and returns how many there
+// were, storing the entries when entries isn't NULL.
+static long DecodeCodewords(codebook* book, unsigned char* bits, long* entries)
+{
+	oggpack_buffer b;
+	long count = 0, entry;
+	oggpack_readinit(&b, bits, CODEBOOK_BITS_BYTES);
+	while ((entry = vorbis_book_decode(book, &b)) >= 0) {
+		if (entries) {
+			entries[count] = entry;
+		}
+		count++;
+	}
+	return count;
+}
+
+// Random bits pick each codeword at the rate its length implies, as a
+// well-fitted book sees in real residue, so every residue book of the file
+// decodes the same random buffer both ways.
+static int BenchmarkCodebooks(const char* path, int repeat, CodebookResult* result)
+{
+	OggVorbis_File vf;
+	codec_setup_info* ci;
+	unsigned char* bits;
+	long* tableEntries;
+	long* bisectEntries;
+	char residueBook[256];
+	double tableMs = 0, bisectMs = 0, t;
+	long words = 0;
+	short pcm[4096];
+	int i, j, k, r, acc, bitstream, mismatch = 0;
+	FILE* file = fopen(path, "rb");
+
+	memset(result, 0, sizeof(*result));
+	if (file == NULL || ov_open(file, &vf, NULL, 0) < 0) {
+		if (file) {
+			fclose(file);
+		}
+		return -1;
+	}
+	// The decode-side books are only built for the first packet
+	ov_read(&vf, (char*)pcm, sizeof(pcm), &bitstream);
+	ci = (codec_setup_info*)vf.vi->codec_setup;
+	if (ci->fullbooks == NULL) {
+		ov_clear(&vf);
+		return -1;
+	}
+	memset(residueBook, 0, sizeof(residueBook));
+	for (i = 0; i < ci->residues; i++) {
+		vorbis_info_residue0* info = (vorbis_info_residue0*)ci->residue_param[i];
+		residueBook[info->groupbook] = 1;
+		for (j = 0, acc = 0; j < info->partitions; j++) {
+			for (k = 0; k < 8; k++) {
+				if (info->secondstages[j] & (1 << k)) {
+					residueBook[info->booklist[acc++]] = 1;
+				}
+			}
+		}
+	}
+
+	bits = (unsigned char*)malloc(CODEBOOK_BITS_BYTES);
+	tableEntries = (long*)malloc(sizeof(long) * CODEBOOK_BITS_BYTES * 8);
+	bisectEntries = (long*)malloc(sizeof(long) * CODEBOOK_BITS_BYTES * 8);
+	for (i = 0; i < ci->books; i++) {
+		codebook* book = &ci->fullbooks[i];
+		codebook bisect = *book;
+		long count;
+		if (!residueBook[i] || book->used_entries == 0) {
+			continue;
+		}
+		bisect.dec_table = NULL;
+		for (j = 0; j < CODEBOOK_BITS_BYTES; j++) {
+			bits[j] = (unsigned char)(RandomSample() >> 8);
+		}
+		count = DecodeCodewords(book, bits, tableEntries);
+		if (DecodeCodewords(&bisect, bits, bisectEntries) != count ||
+			memcmp(tableEntries, bisectEntries, sizeof(long) * count)) {
+			fprintf(stderr, "vorbis: codebook %d of %s decodes differently through the tables\n", i, path);
+			mismatch = 1;
+		}
+		t = Now();
+		for (r = 0; r < repeat; r++) {
+			DecodeCodewords(book, bits, NULL);
+		}
+		tableMs += Now() - t;
+		t = Now();
+		for (r = 0; r < repeat; r++) {
+			DecodeCodewords(&bisect, bits, NULL);
+		}
+		bisectMs += Now() - t;
+		words += count * repeat;
+		for (j = 0; j < book->used_entries; j++) {
+			if (book->dec_codelengths[j] <= book->dec_tablen) {
+				result->oneLookupShare += ldexp(1.0, -book->dec_codelengths[j]);
+			}
+		}
+		result->books++;
+	}
+	if (result->books > 0) {
+		result->oneLookupShare /= result->books;
+		result->tableNsPerWord = tableMs * 1000000.0 / words;
+		result->bisectNsPerWord = bisectMs * 1000000.0 / words;
+	}
+	free(bits);
+	free(tableEntries);
+	free(bisectEntries);
+	ov_clear(&vf);
+	return mismatch ? -1 : 0;
+}
+
+#define MIXER_VOICES 32
+
+typedef struct
+{
+	int frequency;
+	int unityExact;
+	int halfGainExact;
+	int pitchExact;
+	double msPerSecond;
+} MixerResult;
+
+static int ReadFile(const char* path, ByteBuffer* buffer)
+{
+	FILE* file = fopen(path, "rb");
+	unsigned char chunk[16384];
+	size_t n;
+	if (file == NULL) {
+		return -1;
+	}
+	while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+		BufferAppend(buffer, chunk, (long)n);
+	}
+	fclose(file);
+	return 0;
+}
+
+// Reads exactly frames frames of 16 bit PCM, short only at the end.
+static int ReadPcm(OggVorbis_File* vf, short* pcm, int frames)
+{
+	int frame = vf->vi->channels * 2, used = 0, bitstream, bytes;
+	while (used < frames * frame &&
+		(bytes = OggRead(vf, (char*)pcm + used, frames * frame - used, &bitstream)) > 0) {
+		used += bytes;
+	}
+	return used / frame;
+}
+
+static int BenchmarkMixer(const char* path, int seconds, const char* wavPath, MixerResult* result)
+{
+	ByteBuffer file = { NULL, 0, 0 };
+	OggVorbis_File* decoders[MIXER_VOICES];
+	OggVorbis_File* reference;
+	OggMixer* mixer;
+	short* mixed;
+	short* decoded;
+	int i, channels, frames, done, ret = 0;
+	double t;
+
+	memset(result, 0, sizeof(*result));
+	if (ReadFile(path, &file) < 0) {
+		return -1;
+	}
+	for (i = 0; i < MIXER_VOICES; i++) {
+		decoders[i] = OggCreate();
+		if (OggOpenMemory((const char*)file.data, (int)file.size, decoders[i]) < 0) {
+			ret = -1;
+		}
+	}
+	reference = OggCreate();
+	if (ret < 0 || OggOpenMemory((const char*)file.data, (int)file.size, reference) < 0) {
+		ret = -1;
+		goto out;
+	}
+	channels = reference->vi->channels;
+	result->frequency = reference->vi->rate;
+	frames = result->frequency;
+	mixer = OggMixerCreate(result->frequency, MIXER_VOICES);
+	mixed = (short*)malloc(sizeof(short) * 2 * frames);
+	decoded = (short*)malloc(sizeof(short) * channels * frames);
+
+	// A neutral voice must be a plain copy of the decoder's output
+	OggMixerRemoveVoice(mixer, OggMixerAddVoice(mixer, decoders[0], 1, 0, 1));
+	OggMixerAddVoice(mixer, decoders[0], 1, 0, 1);
+	OggMixerRender(mixer, mixed, frames);
+	done = ReadPcm(reference, decoded, frames);
+	result->unityExact = 1;
+	for (i = 0; i < frames * 2 && result->unityExact; i++) {
+		// Past the end of a short clip the voice is silent
+		short expected = i < done * 2 ? decoded[channels == 2 ? i : i / 2] : 0;
+		result->unityExact = mixed[i] == expected;
+	}
+	OggMixerRemoveVoice(mixer, 0);
+
+	// At half gain odd samples land on .5, which rounds away from zero on
+	// every path
+	OggMixerAddVoice(mixer, decoders[1], 0.5f, 0, 1);
+	OggMixerRender(mixer, mixed, frames);
+	result->halfGainExact = 1;
+	for (i = 0; i < frames * 2 && result->halfGainExact; i++) {
+		int sample = i < done * 2 ? decoded[channels == 2 ? i : i / 2] : 0;
+		int expected = sample < 0 ? -((1 - sample) / 2) : (sample + 1) / 2;
+		result->halfGainExact = mixed[i] == expected;
+	}
+	OggMixerRemoveVoice(mixer, 0);
+
+	// Below unity pitch every frame is interpolated, and the vectorized
+	// batches must give what the scalar formula does
+	OggMixerAddVoice(mixer, decoders[2], 1, 0, 0.75f);
+	OggMixerRender(mixer, mixed, frames);
+	result->pitchExact = 1;
+	for (i = 0; i < frames * 2 && result->pitchExact; i++) {
+		double position = i / 2 * 0.75;
+		int index = (int)position, c = channels == 2 ? i % 2 : 0;
+		float t = (float)(position - index), v;
+		if (index + 1 >= done) {
+			break;
+		}
+		v = decoded[index * channels + c] + (decoded[(index + 1) * channels + c] - decoded[index * channels + c]) * t;
+		result->pitchExact = mixed[i] == (short)(v < 0 ? v - 0.5f : v + 0.5f);
+	}
+	OggMixerRemoveVoice(mixer, 0);
+
+	// The busy case: every voice at its own gain, pan and pitch
+	for (i = 0; i < MIXER_VOICES; i++) {
+		OggMixerAddVoice(mixer, decoders[i], 0.1f, (float)(i % 9 - 4) / 4, 0.5f + (float)i / MIXER_VOICES);
+	}
+	t = Now();
+	for (i = 0; i < seconds; i++) {
+		OggMixerRender(mixer, mixed, frames);
+	}
+	result->msPerSecond = (Now() - t) / seconds;
+	if (wavPath && OggMixerRenderToWav(mixer, wavPath, frames * seconds) < 0) {
+		fprintf(stderr, "Can't write %s\n", wavPath);
+		ret = -1;
+	}
+	if (!result->unityExact) {
+		fprintf(stderr, "mixer: a neutral voice doesn't match the decoder output\n");
+		ret = -1;
+	}
+	if (!result->pitchExact) {
+		fprintf(stderr, "mixer: a pitched voice interpolates differently\n");
+		ret = -1;
+	}
+	if (!result->halfGainExact) {
+		fprintf(stderr, "mixer: a voice at half gain rounds differently\n");
+		ret = -1;
+	}
+	free(mixed);
+	free(decoded);
+	OggMixerDispose(mixer);
+out:
+	for (i = 0; i < MIXER_VOICES; i++) {
+		OggDispose(decoders[i]);
+	}
+	OggDispose(reference);
+	free(file.data);
+	return ret;
+}
+
+typedef struct
+{
+	int arenaExact;
+	double heapAllocs;
+	double arenaAllocs;
+	double heapMs;
+	double arenaMs;
+	int trustedExact;
+	int inPlaceExact;
+	double checkedPagesMs;
+	double trustedPagesMs;
+} ArenaResult;
+
+static long allocationCount;
+
+static void* CountingMalloc(size_t bytes)
+{
+	allocationCount++;
+	return malloc(bytes);
+}
+
+static void* CountingRealloc(void* ptr, size_t bytes)
+{
+	allocationCount++;
+	return realloc(ptr, bytes);
+}
+
+// Open, a second of decode and close, with the decoder's memory in an
+// arena or not; returns the decoded frames
+static int DecodeSecond(const ByteBuffer* file, int arenaBytes, int trusted, short* pcm, int frames)
+{
+	OggVorbis_File* vf = OggCreate();
+	int done = 0;
+	OggSetArena(vf, arenaBytes);
+	OggSetTrusted(vf, trusted);
+	if (OggOpenMemory((const char*)file->data, (int)file->size, vf) == 0) {
+		done = ReadPcm(vf, pcm, frames);
+	}
+	OggDispose(vf);
+	return done;
+}
+
+// Demuxes the whole file into pages; returns the page count and the sum
+// of the body lengths in *bytes
+static int WalkPages(const ByteBuffer* file, int trusted, long* bytes)
+{
+	ogg_sync_state sync;
+	ogg_page page;
+	int pages = 0;
+	*bytes = 0;
+	ogg_sync_init(&sync);
+	ogg_sync_set_trusted(&sync, trusted);
+	memcpy(ogg_sync_buffer(&sync, (long)file->size), file->data, file->size);
+	ogg_sync_wrote(&sync, (long)file->size);
+	while (ogg_sync_pageout(&sync, &page) == 1) {
+		pages++;
+		*bytes += page.body_len;
+	}
+	ogg_sync_clear(&sync);
+	return pages;
+}
+
+// A second of decode as DecodeSecond, but copied in through read callbacks
+static int DecodeSecondCallbacks(const ByteBuffer* file, short* pcm, int frames)
+{
+	OggVorbis_File* vf = OggCreate();
+	MemorySource source = { file->data, file->size, 0 };
+	int done = 0;
+	if (OggOpen(&source, vf, MemoryCallbacks) == 0) {
+		done = ReadPcm(vf, pcm, frames);
+	}
+	OggDispose(vf);
+	return done;
+}
+
+static int BenchmarkArena(const char* path, int repeat, ArenaResult* result)
+{
+	vorbis_allocator counting = { CountingMalloc, CountingRealloc, free };
+	ByteBuffer file = { NULL, 0, 0 };
+	short* heapPcm;
+	short* arenaPcm;
+	int frames = 48000 * 2, heapFrames, arenaFrames, trustedFrames, pages, r;
+	long bodyBytes, trustedBodyBytes;
+	double t;
+
+	memset(result, 0, sizeof(*result));
+	if (ReadFile(path, &file) < 0) {
+		return -1;
+	}
+	heapPcm = (short*)malloc(sizeof(short) * frames * 2);
+	arenaPcm = (short*)malloc(sizeof(short) * frames * 2);
+	frames /= 2;
+	vorbis_set_allocator(&counting);
+	allocationCount = 0;
+	heapFrames = DecodeSecond(&file, -1, 0, heapPcm, frames);
+	result->heapAllocs = (double)allocationCount;
+	allocationCount = 0;
+	arenaFrames = DecodeSecond(&file, 0, 0, arenaPcm, frames);
+	result->arenaAllocs = (double)allocationCount;
+	vorbis_set_allocator(NULL);
+	result->arenaExact = heapFrames > 0 && heapFrames == arenaFrames &&
+		!memcmp(heapPcm, arenaPcm, sizeof(short) * heapFrames * 2);
+
+	t = Now();
+	for (r = 0; r < repeat; r++) {
+		DecodeSecond(&file, -1, 0, heapPcm, frames);
+	}
+	result->heapMs = (Now() - t) / repeat;
+	t = Now();
+	for (r = 0; r < repeat; r++) {
+		DecodeSecond(&file, 0, 0, arenaPcm, frames);
+	}
+	result->arenaMs = (Now() - t) / repeat;
+
+	result->inPlaceExact = DecodeSecondCallbacks(&file, arenaPcm, frames) == heapFrames &&
+		!memcmp(heapPcm, arenaPcm, sizeof(short) * heapFrames * 2);
+	trustedFrames = DecodeSecond(&file, -1, 1, arenaPcm, frames);
+	pages = WalkPages(&file, 0, &bodyBytes);
+	result->trustedExact = trustedFrames == heapFrames &&
+		!memcmp(heapPcm, arenaPcm, sizeof(short) * heapFrames * 2) &&
+		WalkPages(&file, 1, &trustedBodyBytes) == pages && trustedBodyBytes == bodyBytes;
+	t = Now();
+	for (r = 0; r < repeat; r++) {
+		WalkPages(&file, 0, &bodyBytes);
+	}
+	result->checkedPagesMs = (Now() - t) / repeat;
+	t = Now();
+	for (r = 0; r < repeat; r++) {
+		WalkPages(&file, 1, &bodyBytes);
+	}
+	result->trustedPagesMs = (Now() - t) / repeat;
+	free(heapPcm);
+	free(arenaPcm);
+	free(file.data);
+	if (!result->arenaExact) {
+		fprintf(stderr, "vorbis: %s decodes differently from an arena\n", path);
+		return -1;
+	}
+	if (!result->inPlaceExact) {
+		fprintf(stderr, "vorbis: %s decodes differently through callbacks\n", path);
+		return -1;
+	}
+	if (!result->trustedExact) {
+		fprintf(stderr, "vorbis: %s reads differently as trusted input\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+// Loop points off page boundaries, played a few times round
+#define LOOP_START 12345
+#define LOOP_WRAPS 3
+
+// Plays a loop from the start of the file and counts the samples that
+// differ from the file played straight through, -1 if it can't be played.
+// The spare decoder is readied after every other chunk, so wraps happen
+// both ways, and chunks are longer than the loop start block, so the
+// decoder swapped in reads in the chunk that wrapped.
+static int CheckLoopSeam(const ByteBuffer* file, int callbacks, const short* reference, int end)
+{
+	OggVorbis_File* vf = OggCreate();
+	MemorySource source = { file->data, file->size, 0 };
+	int length = end - LOOP_START, total = end + LOOP_WRAPS * length;
+	int chunk = 12000, done = 0, mismatches = 0, channels, n, i, c;
+	short* pcm;
+	int ret = callbacks ? OggOpen(&source, vf, MemoryCallbacks) :
+		OggOpenMemory((const char*)file->data, (int)file->size, vf);
+	if (ret < 0 || OggSetLoop(vf, LOOP_START, end) < 0) {
+		OggDispose(vf);
+		return -1;
+	}
+	channels = vf->vi->channels;
+	pcm = (short*)malloc(sizeof(short) * chunk * channels);
+	while (done < total) {
+		n = ReadPcm(vf, pcm, chunk < total - done ? chunk : total - done);
+		if (n <= 0) {
+			mismatches = -1;
+			break;
+		}
+		for (i = 0; i < n; i++) {
+			int frame = done + i;
+			const short* expected = reference + (size_t)channels *
+				(frame < end ? frame : LOOP_START + (frame - end) % length);
+			for (c = 0; c < channels; c++) {
+				mismatches += pcm[i * channels + c] != expected[c];
+			}
+		}
+		if (done / chunk % 2 == 0 && OggPrimeLoop(vf) < 0) {
+			mismatches = -1;
+			break;
+		}
+		done += n;
+	}
+	free(pcm);
+	OggDispose(vf);
+	return mismatches;
+}
+
+// Seams of a loop played from memory and through callbacks; returns the
+// differing samples or -1
+static int CheckLoopSeams(const char* path)
+{
+	ByteBuffer file = { NULL, 0, 0 };
+	OggVorbis_File* vf;
+	short* reference;
+	int end = 0, mismatches = -1, callbacks, result;
+	if (ReadFile(path, &file) < 0) {
+		return -1;
+	}
+	vf = OggCreate();
+	if (OggOpenMemory((const char*)file.data, (int)file.size, vf) == 0) {
+		// Two seconds of loop after the intro, or what the file has
+		end = LOOP_START + vf->vi->rate * 2;
+		reference = (short*)malloc(sizeof(short) * end * vf->vi->channels);
+		end = ReadPcm(vf, reference, end);
+		mismatches = end > LOOP_START ? 0 : -1;
+		for (callbacks = 0; callbacks < 2 && mismatches >= 0; callbacks++) {
+			result = CheckLoopSeam(&file, callbacks, reference, end);
+			mismatches = result < 0 ? -1 : mismatches + result;
+		}
+		free(reference);
+	}
+	OggDispose(vf);
+	free(file.data);
+	if (mismatches != 0) {
+		fprintf(stderr, "vorbis: %s loops with a seam (%d)\n", path, mismatches);
+	}
+	return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+	int frames = 120, repeat = 5, clipCount = CLIP_COUNT;
+	const char* outputPath = NULL;
+	const char* vorbisPaths[MAX_VORBIS_FILES];
+	const char* wavPath = NULL;
+	int vorbisCount = 0;
+	FILE* out = stdout;
+	OgvPool* pool;
+	vorbis_dsp_vtable cDsp, simdDsp;
+	ogg_crc_func crcSimd;
+	int i, p, n, mismatches, failed = 0;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--quick")) {
+			frames = 8;
+			repeat = 1;
+			clipCount = 1;
+		} else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+			frames = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+			repeat = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+			outputPath = argv[++i];
+		} else if (!strcmp(argv[i], "--vorbis") && i + 1 < argc && vorbisCount < MAX_VORBIS_FILES) {
+			vorbisPaths[vorbisCount++] = argv[++i];
+		} else if (!strcmp(argv[i], "--wav") && i + 1 < argc) {
+			wavPath = argv[++i];
+		} else {
+			fprintf(stderr, "Usage: %s [--quick] [--frames N] [--repeat N] [--output file] [--vorbis file]... [--wav file]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (frames < 1 || repeat < 1) {
+		fprintf(stderr, "--frames and --repeat must be positive\n");
+		return 2;
+	}
+	if (outputPath && (out = fopen(outputPath, "w")) == NULL) {
+		fprintf(stderr, "Can't open %s\n", outputPath);
+		return 1;
+	}
+
+	pool = OgvPoolCreate(1);
+	fprintf(out, "{\n  \"frames\": %d,\n  \"repeat\": %d,\n  \"clips\": [", frames, repeat);
+	for (i = 0; i < clipCount; i++) {
+		const ClipDesc* clip = &Clips[i];
+		ByteBuffer encoded = { NULL, 0, 0 };
+		DecodeResult result;
+		double openMs, openPooledMs, openMemoryMs, demuxMs, demuxZeroCopyMs;
+		if (EncodeClip(clip, frames, &encoded) < 0) {
+			fprintf(stderr, "Failed to encode %s clip\n", clip->name);
+			failed = 1;
+			break;
+		}
+		openMs = BenchmarkOpen(&encoded, repeat * 10, NULL);
+		openPooledMs = BenchmarkOpen(&encoded, repeat * 10, pool);
+		openMemoryMs = BenchmarkOpenMemory(&encoded, repeat * 10);
+		if (openMs < 0 || openPooledMs < 0 || BenchmarkDecode(&encoded, repeat, &result) < 0) {
+			fprintf(stderr, "Failed to decode %s clip\n", clip->name);
+			free(encoded.data);
+			failed = 1;
+			break;
+		}
+		if (openMemoryMs < 0 || CountFrames(&encoded) < 0 ||
+			BenchmarkDemux(&encoded, repeat * 10, &demuxMs, &demuxZeroCopyMs) < 0) {
+			fprintf(stderr, "demux: %s clip reads differently in place\n", clip->name);
+			free(encoded.data);
+			failed = 1;
+			break;
+		}
+		fprintf(out, "%s\n    {\n", i ? "," : "");
+		fprintf(out, "      \"name\": \"%s\",\n      \"width\": %d,\n      \"height\": %d,\n",
+			clip->name, clip->width, clip->height);
+		fprintf(out, "      \"bytes\": %ld,\n      \"decodedFrames\": %d,\n", encoded.size, result.frames);
+		fprintf(out, "      \"openMs\": %.4f,\n      \"openPooledMs\": %.4f,\n      \"openMemoryMs\": %.4f,\n",
+			openMs, openPooledMs, openMemoryMs);
+		fprintf(out, "      \"demuxMs\": %.4f,\n      \"demuxZeroCopyMs\": %.4f,\n", demuxMs, demuxZeroCopyMs);
+		fprintf(out, "      \"decodeMsPerFrame\": %.4f,\n      \"ycbcrMsPerFrame\": %.4f,\n",
+			result.decodeMs, result.ycbcrMs);
+		fprintf(out, "      \"convertMsPerFrame\": {");
+		for (p = 0; p < CONVERSION_PATH_COUNT; p++) {
+			fprintf(out, "%s\n        \"%s\": %.4f", p ? "," : "", ConversionPaths[p].name, result.convertMs[p]);
+		}
+		fprintf(out, "\n      },\n");
+		fprintf(out, "      \"keyframes\": %d,\n      \"dupframes\": %d,\n      \"codedRatio\": %.4f,\n",
+			result.keyframes, result.dupframes, result.codedRatio);
+		fprintf(out, "      \"stagesMsPerFrame\": {\n");
+		fprintf(out, "        \"unpack\": %.4f,\n        \"dcUnpredict\": %.4f,\n        \"recon\": %.4f,\n",
+			result.unpackMs, result.dcUnpredictMs, result.reconMs);
+		fprintf(out, "        \"loopFilter\": %.4f,\n        \"postprocess\": %.4f\n      }\n    }",
+			result.loopFilterMs, result.postprocessMs);
+		free(encoded.data);
+	}
+	fprintf(out, "\n  ],\n");
+	_vorbis_dsp_init(&cDsp, 0);
+	_vorbis_dsp_init(&simdDsp, _vorbis_cpu_flags());
+	mismatches = CheckImdct(&cDsp, &simdDsp);
+	if (mismatches > 0) {
+		failed = 1;
+	}
+	fprintf(out, "  \"imdct\": {\n    \"cpuFlags\": %u,\n    \"bitExact\": %s,\n    \"usPerTransform\": [",
+		(unsigned)_vorbis_cpu_flags(), mismatches ? "false" : "true");
+	for (n = IMDCT_MIN_SIZE; n <= IMDCT_MAX_SIZE; n *= 2) {
+		fprintf(out, "%s\n      { \"n\": %d, \"c\": %.3f, \"simd\": %.3f }", n > IMDCT_MIN_SIZE ? "," : "",
+			n, BenchmarkImdct(&cDsp, n, repeat), BenchmarkImdct(&simdDsp, n, repeat));
+	}
+	fprintf(out, "\n    ]\n  },\n");
+	crcSimd = _ogg_crc_simd();
+	mismatches = CheckCrc(crcSimd);
+	if (mismatches > 0) {
+		failed = 1;
+	}
+	fprintf(out, "  \"crc\": {\n    \"simd\": %s,\n    \"bitExact\": %s,\n",
+		crcSimd ? "true" : "false", mismatches ? "false" : "true");
+	fprintf(out, "    \"mbPerSecond\": { \"bytewise\": %.0f, \"table\": %.0f",
+		BenchmarkCrc(CrcBytewise, repeat), BenchmarkCrc(_ogg_crc_update_c, repeat));
+	if (crcSimd) {
+		fprintf(out, ", \"simd\": %.0f", BenchmarkCrc(crcSimd, repeat));
+	}
+	fprintf(out, " }\n  },\n  \"vorbis\": [");
+	for (i = 0; i < vorbisCount; i++) {
+		CodebookResult result;
+		ArenaResult arena;
+		if (BenchmarkCodebooks(vorbisPaths[i], repeat, &result) < 0) {
+			fprintf(stderr, "Failed to check codebooks of %s\n", vorbisPaths[i]);
+			failed = 1;
+		}
+		if (BenchmarkArena(vorbisPaths[i], repeat, &arena) < 0) {
+			failed = 1;
+		}
+		mismatches = CheckLoopSeams(vorbisPaths[i]);
+		if (mismatches != 0) {
+			failed = 1;
+		}
+		fprintf(out, "%s\n    {\n      \"path\": \"%s\",\n      \"residueBooks\": %d,\n", i ? "," : "",
+			vorbisPaths[i], result.books);
+		fprintf(out, "      \"oneLookupShare\": %.4f,\n", result.oneLookupShare);
+		fprintf(out, "      \"tableNsPerWord\": %.2f,\n      \"bisectNsPerWord\": %.2f,\n",
+			result.tableNsPerWord, result.bisectNsPerWord);
+		fprintf(out, "      \"heapAllocs\": %.0f,\n      \"arenaAllocs\": %.0f,\n", arena.heapAllocs, arena.arenaAllocs);
+		fprintf(out, "      \"heapMs\": %.3f,\n      \"arenaMs\": %.3f,\n      \"arenaExact\": %s,\n",
+			arena.heapMs, arena.arenaMs, arena.arenaExact ? "true" : "false");
+		fprintf(out, "      \"inPlaceExact\": %s,\n", arena.inPlaceExact ? "true" : "false");
+		fprintf(out, "      \"loopSeamExact\": %s,\n", mismatches ? "false" : "true");
+		fprintf(out, "      \"checkedPagesMs\": %.3f,\n      \"trustedPagesMs\": %.3f,\n      \"trustedExact\": %s\n    }",
+			arena.checkedPagesMs, arena.trustedPagesMs, arena.trustedExact ? "true" : "false");
+	}
+	fprintf(out, "%s]", vorbisCount ? "\n  " : "");
+	if (vorbisCount > 0) {
+		MixerResult result;
+		if (BenchmarkMixer(vorbisPaths[0], repeat * 2, wavPath, &result) < 0) {
+			fprintf(stderr, "Failed to mix %s\n", vorbisPaths[0]);
+			failed = 1;
+		}
+		fprintf(out, ",\n  \"mixer\": {\n    \"voices\": %d,\n    \"frequency\": %d,\n", MIXER_VOICES, result.frequency);
+		fprintf(out, "    \"unityExact\": %s,\n    \"halfGainExact\": %s,\n",
+			result.unityExact ? "true" : "false", result.halfGainExact ? "true" : "false");
+		fprintf(out, "    \"pitchExact\": %s,\n    \"msPerSecond\": %.3f\n  }",
+			result.pitchExact ? "true" : "false", result.msPerSecond);
+	}
+	fprintf(out, "\n}\n");
+	OgvPoolDispose(pool);
+	if (outputPath) {
+		fclose(out);
+	}
+	return failed;
+}
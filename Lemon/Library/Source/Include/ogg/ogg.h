@@ -55,6 +55,10 @@ typedef struct {
   long    body_storage;          /* storage elements allocated */
   long    body_fill;             /* elements stored; fill mark */
   long    body_returned;         /* elements of fill returned */
+  unsigned char   *body_ref;     /* if set, fill from body_copied on is
+                                    read in place from the last page */
+  long    body_copied;           /* elements of fill in body_data */
+  int     zerocopy;              /* pages outlive their packets */
 
 
   int     *lacing_vals;      /* The values that will go to the segment table */
@@ -111,6 +115,10 @@ typedef struct {
   int unsynced;
   int headerbytes;
   int bodybytes;
+
+  int trusted;      /* skip checksums of pages read in sequence */
+  int in_sequence;  /* the next page starts where the last one ended */
+  int wrapped;      /* data belongs to the caller, see ogg_sync_wrap */
 } ogg_sync_state;
 
 /* Ogg BITSTREAM PRIMITIVES: bitstream ************************/
@@ -170,6 +178,9 @@ extern int      ogg_sync_clear(ogg_sync_state *oy);
 extern int      ogg_sync_reset(ogg_sync_state *oy);
 extern int      ogg_sync_destroy(ogg_sync_state *oy);
 extern int      ogg_sync_check(ogg_sync_state *oy);
+extern int      ogg_sync_set_trusted(ogg_sync_state *oy,int trusted);
+extern int      ogg_sync_wrap(ogg_sync_state *oy,const unsigned char *data,
+                              long bytes);
 
 extern char    *ogg_sync_buffer(ogg_sync_state *oy, long size);
 extern int      ogg_sync_wrote(ogg_sync_state *oy, long bytes);
@@ -178,6 +189,7 @@ extern int      ogg_sync_pageout(ogg_sync_state *oy, ogg_page *og);
 extern int      ogg_stream_pagein(ogg_stream_state *os, ogg_page *og);
 extern int      ogg_stream_packetout(ogg_stream_state *os,ogg_packet *op);
 extern int      ogg_stream_packetpeek(ogg_stream_state *os,ogg_packet *op);
+extern int      ogg_stream_set_zerocopy(ogg_stream_state *os,int zerocopy);
 
 /* Ogg BITSTREAM PRIMITIVES: general ***************************/
 
@@ -100,6 +100,19 @@ extern "C" {
 #define TH_DECCTL_SET_TELEMETRY_QI (13)
 /**Enables telemetry and sets the bitstream breakdown visualization mode */
 #define TH_DECCTL_SET_TELEMETRY_BITS (15)
+/**Enables or disables per-frame decode statistics.
+ * This is a Lemon extension.
+ * Once enabled, every call to th_decode_packetin() overwrites the
+ *  #th_dec_stats structure passed here with the figures for that packet.
+ * Pass a #th_stats_callback with th_stats_callback#stats set to
+ *  <tt>NULL</tt> to disable collection again.
+ *
+ * \param[in]  _buf #th_stats_callback: The statistics parameters.
+ * \retval TH_EFAULT  \a _dec_ctx or \a _buf is <tt>NULL</tt>, or
+ *                     th_stats_callback#stats is set without a clock.
+ * \retval TH_EINVAL  \a _buf_sz is not
+ *                     <tt>sizeof(th_stats_callback)</tt>.*/
+#define TH_DECCTL_SET_STATS (17)
 /*@}*/
 
 
@@ -149,6 +162,48 @@ typedef struct{
 
 
 
+/**A monotonic clock used to time the decoding stages.
+ * The unit is up to the application; all stage times in #th_dec_stats are
+ *  differences of values returned by this function.*/
+typedef ogg_int64_t (*th_stats_clock_func)(void);
+
+/**Statistics for a single packet, filled in by th_decode_packetin() when
+ *  enabled with #TH_DECCTL_SET_STATS.*/
+typedef struct{
+  /**The size of the packet in bytes.*/
+  long        packet_bytes;
+  /**The number of coded fragments in all three planes.*/
+  long        ncoded_frags;
+  /**The total number of fragments in all three planes.*/
+  long        nfrags;
+  /**Non-zero if this was a key frame.*/
+  int         keyframe;
+  /**Non-zero if the packet had no coded blocks (#TH_DUPFRAME).*/
+  int         dupframe;
+  /**Time spent unpacking the frame header, modes, motion vectors and
+      coefficient tokens.*/
+  ogg_int64_t unpack_ticks;
+  /**Time spent undoing DC prediction.*/
+  ogg_int64_t dc_unpredict_ticks;
+  /**Time spent on inverse transforms, motion compensation and copying
+      uncoded fragments.*/
+  ogg_int64_t recon_ticks;
+  /**Time spent in the loop filter and filling reference frame borders.*/
+  ogg_int64_t loop_filter_ticks;
+  /**Time spent in out-of-loop deblocking and deringing.*/
+  ogg_int64_t postprocess_ticks;
+}th_dec_stats;
+
+/**The statistics parameters to pass to #TH_DECCTL_SET_STATS.*/
+typedef struct{
+  /**Where to store the statistics, or <tt>NULL</tt> to disable them.*/
+  th_dec_stats        *stats;
+  /**The clock used to measure stage times.*/
+  th_stats_clock_func  clock;
+}th_stats_callback;
+
+
+
 /**\name Decoder state
    The following data structures are opaque, and their contents are not
     publicly defined by this API.
@@ -254,6 +309,28 @@ extern int th_decode_headerin(th_info *_info,th_comment *_tc,
  * \retval NULL If the decoding parameters were invalid.*/
 extern th_dec_ctx *th_decode_alloc(const th_info *_info,
  const th_setup_info *_setup);
+/**Re-initializes an existing decoder instance for a new stream.
+ * This is a Lemon extension: the reference frame buffers and fragment arrays
+ *  allocated by th_decode_alloc() are kept, and only the per-stream tables
+ *  are reloaded from \a _setup.
+ * It is intended for pooling decoders across many short clips.
+ * The new stream must have exactly the same frame size, picture region and
+ *  pixel format as the one the decoder was allocated for.
+ * All other decoder settings (post-processing level, striped decode
+ *  callback, statistics) are returned to their defaults.
+ * \param _dec   A #th_dec_ctx handle.
+ * \param _info  A #th_info struct filled via th_decode_headerin().
+ * \param _setup A #th_setup_info handle returned via
+ *                th_decode_headerin().
+ * \retval 0         Success.
+ * \retval TH_EFAULT \a _dec, \a _info or \a _setup was <tt>NULL</tt>, or
+ *                    memory could not be allocated.
+ *                   The decoder must be freed with th_decode_free().
+ * \retval TH_EINVAL The geometry of \a _info does not match the decoder,
+ *                    or its parameters were invalid.
+ *                   The decoder is left untouched.*/
+extern int th_decode_reset(th_dec_ctx *_dec,const th_info *_info,
+ const th_setup_info *_setup);
 /**Releases all storage used for the decoder setup information.
  * This should be called after you no longer want to create any decoders for
  *  a stream whose headers you have parsed with th_decode_headerin().
@@ -44,6 +44,15 @@ typedef struct {
   long   (*tell_func)  (void *datasource);
 } ov_callbacks;
 
+/* One page of the seek index: a page of the first link carrying a
+   granulepos, and whether it is the next such page after the entry
+   before it, so that the pair brackets every sample in between */
+typedef struct {
+  ogg_int64_t granulepos;
+  ogg_int64_t offset;
+  int         follows;
+} ov_page_entry;
+
 #define  NOTOPEN   0
 #define  PARTOPEN  1
 #define  OPENED    2
@@ -83,6 +92,22 @@ typedef struct OggVorbis_File {
 
   ov_callbacks callbacks;
 
+  /* granulepos -> offset index of single link streams, filled in as
+     pages are read in sequence, so that seeks can skip the bisection */
+  ov_page_entry   *page_index;
+  int              page_index_count;
+  int              page_index_storage;
+  ogg_int64_t      page_index_run; /* offset+1 of the page last indexed
+                                      in sequence, 0 after a seek */
+
+  /* set by ov_open_arena_callbacks: all of the codec's memory for this
+     file, released in one go by ov_clear */
+  struct vorbis_arena *arena;
+
+  /* set by ov_open_memory: the whole file, framed in place */
+  const unsigned char *memory;
+  ogg_int64_t      memory_bytes;
+
 } OggVorbis_File;
 
 extern int ov_clear(OggVorbis_File *vf);
@@ -90,6 +115,13 @@ extern int ov_open(FILE *f,OggVorbis_File *vf,const char *initial,long ibytes);
 extern int ov_open_callbacks(void *datasource, OggVorbis_File *vf,
 		const char *initial, long ibytes, ov_callbacks callbacks);
 
+extern int ov_open_arena_callbacks(void *datasource, OggVorbis_File *vf,
+		const char *initial, long ibytes, ov_callbacks callbacks,
+		long arena_bytes);
+
+extern int ov_open_memory(const char *data, long bytes, OggVorbis_File *vf,
+		long arena_bytes);
+
 extern int ov_test(FILE *f,OggVorbis_File *vf,const char *initial,long ibytes);
 extern int ov_test_callbacks(void *datasource, OggVorbis_File *vf,
 		const char *initial, long ibytes, ov_callbacks callbacks);
@@ -111,6 +143,11 @@ extern int ov_pcm_seek_page(OggVorbis_File *vf,ogg_int64_t pos);
 extern int ov_time_seek(OggVorbis_File *vf,ogg_int64_t pos);
 extern int ov_time_seek_page(OggVorbis_File *vf,ogg_int64_t pos);
 
+extern int ov_page_index_get(OggVorbis_File *vf,ogg_int64_t *pairs,
+                             int count);
+extern int ov_page_index_set(OggVorbis_File *vf,const ogg_int64_t *pairs,
+                             int count);
+
 extern ogg_int64_t ov_raw_tell(OggVorbis_File *vf);
 extern ogg_int64_t ov_pcm_tell(OggVorbis_File *vf);
 extern ogg_int64_t ov_time_tell(OggVorbis_File *vf);
@@ -121,6 +158,15 @@ extern vorbis_comment *ov_comment(OggVorbis_File *vf,int link);
 extern long ov_read(OggVorbis_File *vf,char *buffer,int length,
 		    int *bitstream);
 
+/* Planar output: full scale of ov_read_fixed samples is OV_FIXED_ONE */
+#define OV_FIXED_BITS 24
+#define OV_FIXED_ONE (1<<OV_FIXED_BITS)
+
+extern long ov_read_fixed(OggVorbis_File *vf,ogg_int32_t **pcm_channels,
+			  int samples,int *bitstream);
+extern long ov_read_float(OggVorbis_File *vf,float **pcm_channels,
+			  int samples,int *bitstream);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -14,3 +14,6 @@
 #else
     #define LEMON_API
 #endif
+
+// Lemon's own error codes, clear of the OV_E* range
+#define OGG_ENOSPACE -1001
@@ -0,0 +1,239 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE Ogg CONTAINER SOURCE CODE.              *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis SOURCE CODE IS (C) COPYRIGHT 1994-2010             *
+ * by the Xiph.Org Foundation http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: the Ogg page CRC
+
+ The CRC is the remainder of the page, times x^32, modulo the
+ generator P = x^32 + 0x04c11db7, bits taken most significant first.
+
+ The table version eats eight bytes per step (slicing-by-8).  The
+ SIMD version keeps 128 bit chunks of the message and folds each one
+ forward onto the next: a chunk H*x^64+L that stands d bits before
+ another is worth H*(x^(d+64) mod P) + L*(x^d mod P) there, two
+ carry-less multiplies.  What's left at the end is 16 bytes plus a
+ tail, which go through the tables.
+
+ ********************************************************************/
+
+#include <string.h>
+#include "crc.h"
+#include "crctable.h"
+
+ogg_uint32_t _ogg_crc_update_c(ogg_uint32_t crc,
+                               const unsigned char *buffer,long n){
+  while(n>=8){
+    crc^=(ogg_uint32_t)buffer[0]<<24|(ogg_uint32_t)buffer[1]<<16|
+      (ogg_uint32_t)buffer[2]<<8|buffer[3];
+    crc=crc_lookup[7][crc>>24]^crc_lookup[6][(crc>>16)&0xff]^
+      crc_lookup[5][(crc>>8)&0xff]^crc_lookup[4][crc&0xff]^
+      crc_lookup[3][buffer[4]]^crc_lookup[2][buffer[5]]^
+      crc_lookup[1][buffer[6]]^crc_lookup[0][buffer[7]];
+    buffer+=8;
+    n-=8;
+  }
+  while(n-->0)
+    crc=(crc<<8)^crc_lookup[0][(crc>>24)^*buffer++];
+  return crc;
+}
+
+/* x^d mod P for the fold distances: 512 bits (four chunks at a time)
+   and 128 bits (one) */
+#define CRC_K576 0x8833794cU
+#define CRC_K512 0xe6228b11U
+#define CRC_K192 0xc5b9cd4cU
+#define CRC_K128 0xe8a45605U
+
+/* below this the tables win */
+#define CRC_SIMD_MIN 64
+
+#if defined(_M_X64) || defined(__x86_64__) || \
+  defined(_M_IX86) || defined(__i386__)
+#define OGG_CRC_CLMUL
+#if defined(_MSC_VER)
+# include <intrin.h>
+# define OGG_CLMUL_TARGET
+#else
+# include <cpuid.h>
+# define OGG_CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+#endif
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+/* big-endian: the first byte of the message in the top bits */
+#define LOAD(p) _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p)),swap)
+#define FOLD(x,k) _mm_xor_si128(_mm_clmulepi64_si128(x,k,0x11), \
+                                _mm_clmulepi64_si128(x,k,0x00))
+
+static OGG_CLMUL_TARGET ogg_uint32_t
+_ogg_crc_update_clmul(ogg_uint32_t crc,const unsigned char *buffer,long n){
+  const __m128i swap=_mm_set_epi8(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+  const __m128i k4=_mm_set_epi32(0,(int)CRC_K576,0,(int)CRC_K512);
+  const __m128i k1=_mm_set_epi32(0,(int)CRC_K192,0,(int)CRC_K128);
+  __m128i x0,x1,x2,x3;
+  unsigned char last[16];
+  if(n<CRC_SIMD_MIN)return _ogg_crc_update_c(crc,buffer,n);
+
+  /* the running crc counts as the first four bytes */
+  x0=_mm_xor_si128(LOAD(buffer),
+                   _mm_slli_si128(_mm_cvtsi32_si128((int)crc),12));
+  x1=LOAD(buffer+16);
+  x2=LOAD(buffer+32);
+  x3=LOAD(buffer+48);
+  buffer+=64;
+  n-=64;
+  while(n>=64){
+    x0=_mm_xor_si128(FOLD(x0,k4),LOAD(buffer));
+    x1=_mm_xor_si128(FOLD(x1,k4),LOAD(buffer+16));
+    x2=_mm_xor_si128(FOLD(x2,k4),LOAD(buffer+32));
+    x3=_mm_xor_si128(FOLD(x3,k4),LOAD(buffer+48));
+    buffer+=64;
+    n-=64;
+  }
+  x0=_mm_xor_si128(FOLD(x0,k1),x1);
+  x0=_mm_xor_si128(FOLD(x0,k1),x2);
+  x0=_mm_xor_si128(FOLD(x0,k1),x3);
+  while(n>=16){
+    x0=_mm_xor_si128(FOLD(x0,k1),LOAD(buffer));
+    buffer+=16;
+    n-=16;
+  }
+  _mm_storeu_si128((__m128i *)last,_mm_shuffle_epi8(x0,swap));
+  crc=_ogg_crc_update_c(0,last,16);
+  return _ogg_crc_update_c(crc,buffer,n);
+}
+
+static int _ogg_crc_has_clmul(void){
+  unsigned int regs[4]={0,0,0,0};
+#if defined(_MSC_VER)
+  __cpuid((int *)regs,1);
+#else
+  if(!__get_cpuid(1,&regs[0],&regs[1],&regs[2],&regs[3]))return 0;
+#endif
+  /* PCLMULQDQ and SSSE3 */
+  return (regs[2]&(1<<1)) && (regs[2]&(1<<9));
+}
+
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define OGG_CRC_PMULL
+#if defined(__linux__)
+# include <sys/auxv.h>
+# ifndef HWCAP_PMULL
+#  define HWCAP_PMULL (1<<4)
+# endif
+#endif
+#if defined(__clang__)
+# define OGG_PMULL_TARGET __attribute__((target("crypto")))
+#elif defined(__GNUC__)
+# define OGG_PMULL_TARGET __attribute__((target("+crypto")))
+#else
+# define OGG_PMULL_TARGET
+#endif
+#include <arm_neon.h>
+
+static OGG_PMULL_TARGET uint8x16_t _ogg_crc_load(const unsigned char *p){
+  uint8x16_t v=vrev64q_u8(vld1q_u8(p));
+  return vextq_u8(v,v,8);
+}
+
+static OGG_PMULL_TARGET uint8x16_t _ogg_crc_fold(uint8x16_t x,poly64x2_t k){
+  poly64x2_t v=vreinterpretq_p64_u8(x);
+  poly128_t h=vmull_high_p64(v,k);
+  poly128_t l=vmull_p64(vgetq_lane_p64(v,0),vgetq_lane_p64(k,0));
+  return veorq_u8(vreinterpretq_u8_p128(h),vreinterpretq_u8_p128(l));
+}
+
+#define LOAD(p) _ogg_crc_load(p)
+#define FOLD(x,k) _ogg_crc_fold(x,k)
+
+static OGG_PMULL_TARGET ogg_uint32_t
+_ogg_crc_update_pmull(ogg_uint32_t crc,const unsigned char *buffer,long n){
+  static const uint64_t k4v[2]={CRC_K512,CRC_K576};
+  static const uint64_t k1v[2]={CRC_K128,CRC_K192};
+  const poly64x2_t k4=vreinterpretq_p64_u64(vld1q_u64(k4v));
+  const poly64x2_t k1=vreinterpretq_p64_u64(vld1q_u64(k1v));
+  uint8x16_t x0,x1,x2,x3,r;
+  unsigned char last[16];
+  if(n<CRC_SIMD_MIN)return _ogg_crc_update_c(crc,buffer,n);
+
+  /* the running crc counts as the first four bytes */
+  x0=veorq_u8(LOAD(buffer),vreinterpretq_u8_u64(
+                vcombine_u64(vcreate_u64(0),vcreate_u64((uint64_t)crc<<32))));
+  x1=LOAD(buffer+16);
+  x2=LOAD(buffer+32);
+  x3=LOAD(buffer+48);
+  buffer+=64;
+  n-=64;
+  while(n>=64){
+    x0=veorq_u8(FOLD(x0,k4),LOAD(buffer));
+    x1=veorq_u8(FOLD(x1,k4),LOAD(buffer+16));
+    x2=veorq_u8(FOLD(x2,k4),LOAD(buffer+32));
+    x3=veorq_u8(FOLD(x3,k4),LOAD(buffer+48));
+    buffer+=64;
+    n-=64;
+  }
+  x0=veorq_u8(FOLD(x0,k1),x1);
+  x0=veorq_u8(FOLD(x0,k1),x2);
+  x0=veorq_u8(FOLD(x0,k1),x3);
+  while(n>=16){
+    x0=veorq_u8(FOLD(x0,k1),LOAD(buffer));
+    buffer+=16;
+    n-=16;
+  }
+  r=vrev64q_u8(x0);
+  vst1q_u8(last,vextq_u8(r,r,8));
+  crc=_ogg_crc_update_c(0,last,16);
+  return _ogg_crc_update_c(crc,buffer,n);
+}
+
+static int _ogg_crc_has_pmull(void){
+#if defined(__linux__)
+  return (getauxval(AT_HWCAP)&HWCAP_PMULL)!=0;
+#elif defined(__APPLE__) || defined(_M_ARM64)
+  /* every 64 bit Apple and Windows ARM device has the crypto extension */
+  return 1;
+#else
+  return 0;
+#endif
+}
+#endif
+
+ogg_crc_func _ogg_crc_simd(void){
+#if defined(OGG_CRC_CLMUL)
+  if(_ogg_crc_has_clmul())return _ogg_crc_update_clmul;
+#elif defined(OGG_CRC_PMULL)
+  if(_ogg_crc_has_pmull())return _ogg_crc_update_pmull;
+#endif
+  return NULL;
+}
+
+static ogg_uint32_t _ogg_crc_update_first(ogg_uint32_t crc,
+                                          const unsigned char *buffer,
+                                          long n);
+
+/* Starts out pointing at _ogg_crc_update_first, which picks the real
+   one on the first call.  Threads racing there all store the same
+   pointer, so no lock is needed. */
+static ogg_crc_func _ogg_crc_best=_ogg_crc_update_first;
+
+static ogg_uint32_t _ogg_crc_update_first(ogg_uint32_t crc,
+                                          const unsigned char *buffer,
+                                          long n){
+  ogg_crc_func simd=_ogg_crc_simd();
+  _ogg_crc_best=simd?simd:_ogg_crc_update_c;
+  return _ogg_crc_best(crc,buffer,n);
+}
+
+ogg_uint32_t _ogg_crc_update(ogg_uint32_t crc,
+                             const unsigned char *buffer,long n){
+  return _ogg_crc_best(crc,buffer,n);
+}
@@ -0,0 +1,38 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE Ogg CONTAINER SOURCE CODE.              *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis SOURCE CODE IS (C) COPYRIGHT 1994-2010             *
+ * by the Xiph.Org Foundation http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: the Ogg page CRC
+
+ ********************************************************************/
+
+#ifndef _OGG_CRC_H_
+#define _OGG_CRC_H_
+
+#include <ogg/ogg.h>
+
+typedef ogg_uint32_t (*ogg_crc_func)(ogg_uint32_t crc,
+                                     const unsigned char *buffer,long n);
+
+/* Continues crc over n more bytes, with the fastest code this CPU
+   has.  Start a page from 0. */
+extern ogg_uint32_t _ogg_crc_update(ogg_uint32_t crc,
+                                    const unsigned char *buffer,long n);
+
+/* slicing-by-8 over the tables in crctable.h */
+extern ogg_uint32_t _ogg_crc_update_c(ogg_uint32_t crc,
+                                      const unsigned char *buffer,long n);
+
+/* carry-less multiply folding (PCLMULQDQ or PMULL), or NULL when this
+   CPU doesn't have it */
+extern ogg_crc_func _ogg_crc_simd(void);
+
+#endif
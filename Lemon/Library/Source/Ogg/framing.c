@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ogg/ogg.h>
+#include "crc.h"
 
 /* A complete description of Ogg framing exists in docs/framing.html */
 
@@ -95,94 +96,6 @@ int ogg_page_packets(const ogg_page *og){
   return(count);
 }
 
-
-#if 0
-/* helper to initialize lookup for direct-table CRC (illustrative; we
-   use the static init below) */
-
-static ogg_uint32_t _ogg_crc_entry(unsigned long index){
-  int           i;
-  unsigned long r;
-
-  r = index << 24;
-  for (i=0; i<8; i++)
-    if (r & 0x80000000UL)
-      r = (r << 1) ^ 0x04c11db7; /* The same as the ethernet generator
-                                    polynomial, although we use an
-                                    unreflected alg and an init/final
-                                    of 0, not 0xffffffff */
-    else
-       r<<=1;
- return (r & 0xffffffffUL);
-}
-#endif
-
-static const ogg_uint32_t crc_lookup[256]={
-  0x00000000,0x04c11db7,0x09823b6e,0x0d4326d9,
-  0x130476dc,0x17c56b6b,0x1a864db2,0x1e475005,
-  0x2608edb8,0x22c9f00f,0x2f8ad6d6,0x2b4bcb61,
-  0x350c9b64,0x31cd86d3,0x3c8ea00a,0x384fbdbd,
-  0x4c11db70,0x48d0c6c7,0x4593e01e,0x4152fda9,
-  0x5f15adac,0x5bd4b01b,0x569796c2,0x52568b75,
-  0x6a1936c8,0x6ed82b7f,0x639b0da6,0x675a1011,
-  0x791d4014,0x7ddc5da3,0x709f7b7a,0x745e66cd,
-  0x9823b6e0,0x9ce2ab57,0x91a18d8e,0x95609039,
-  0x8b27c03c,0x8fe6dd8b,0x82a5fb52,0x8664e6e5,
-  0xbe2b5b58,0xbaea46ef,0xb7a96036,0xb3687d81,
-  0xad2f2d84,0xa9ee3033,0xa4ad16ea,0xa06c0b5d,
-  0xd4326d90,0xd0f37027,0xddb056fe,0xd9714b49,
-  0xc7361b4c,0xc3f706fb,0xceb42022,0xca753d95,
-  0xf23a8028,0xf6fb9d9f,0xfbb8bb46,0xff79a6f1,
-  0xe13ef6f4,0xe5ffeb43,0xe8bccd9a,0xec7dd02d,
-  0x34867077,0x30476dc0,0x3d044b19,0x39c556ae,
-  0x278206ab,0x23431b1c,0x2e003dc5,0x2ac12072,
-  0x128e9dcf,0x164f8078,0x1b0ca6a1,0x1fcdbb16,
-  0x018aeb13,0x054bf6a4,0x0808d07d,0x0cc9cdca,
-  0x7897ab07,0x7c56b6b0,0x71159069,0x75d48dde,
-  0x6b93dddb,0x6f52c06c,0x6211e6b5,0x66d0fb02,
-  0x5e9f46bf,0x5a5e5b08,0x571d7dd1,0x53dc6066,
-  0x4d9b3063,0x495a2dd4,0x44190b0d,0x40d816ba,
-  0xaca5c697,0xa864db20,0xa527fdf9,0xa1e6e04e,
-  0xbfa1b04b,0xbb60adfc,0xb6238b25,0xb2e29692,
-  0x8aad2b2f,0x8e6c3698,0x832f1041,0x87ee0df6,
-  0x99a95df3,0x9d684044,0x902b669d,0x94ea7b2a,
-  0xe0b41de7,0xe4750050,0xe9362689,0xedf73b3e,
-  0xf3b06b3b,0xf771768c,0xfa325055,0xfef34de2,
-  0xc6bcf05f,0xc27dede8,0xcf3ecb31,0xcbffd686,
-  0xd5b88683,0xd1799b34,0xdc3abded,0xd8fba05a,
-  0x690ce0ee,0x6dcdfd59,0x608edb80,0x644fc637,
-  0x7a089632,0x7ec98b85,0x738aad5c,0x774bb0eb,
-  0x4f040d56,0x4bc510e1,0x46863638,0x42472b8f,
-  0x5c007b8a,0x58c1663d,0x558240e4,0x51435d53,
-  0x251d3b9e,0x21dc2629,0x2c9f00f0,0x285e1d47,
-  0x36194d42,0x32d850f5,0x3f9b762c,0x3b5a6b9b,
-  0x0315d626,0x07d4cb91,0x0a97ed48,0x0e56f0ff,
-  0x1011a0fa,0x14d0bd4d,0x19939b94,0x1d528623,
-  0xf12f560e,0xf5ee4bb9,0xf8ad6d60,0xfc6c70d7,
-  0xe22b20d2,0xe6ea3d65,0xeba91bbc,0xef68060b,
-  0xd727bbb6,0xd3e6a601,0xdea580d8,0xda649d6f,
-  0xc423cd6a,0xc0e2d0dd,0xcda1f604,0xc960ebb3,
-  0xbd3e8d7e,0xb9ff90c9,0xb4bcb610,0xb07daba7,
-  0xae3afba2,0xaafbe615,0xa7b8c0cc,0xa379dd7b,
-  0x9b3660c6,0x9ff77d71,0x92b45ba8,0x9675461f,
-  0x8832161a,0x8cf30bad,0x81b02d74,0x857130c3,
-  0x5d8a9099,0x594b8d2e,0x5408abf7,0x50c9b640,
-  0x4e8ee645,0x4a4ffbf2,0x470cdd2b,0x43cdc09c,
-  0x7b827d21,0x7f436096,0x7200464f,0x76c15bf8,
-  0x68860bfd,0x6c47164a,0x61043093,0x65c52d24,
-  0x119b4be9,0x155a565e,0x18197087,0x1cd86d30,
-  0x029f3d35,0x065e2082,0x0b1d065b,0x0fdc1bec,
-  0x3793a651,0x3352bbe6,0x3e119d3f,0x3ad08088,
-  0x2497d08d,0x2056cd3a,0x2d15ebe3,0x29d4f654,
-  0xc5a92679,0xc1683bce,0xcc2b1d17,0xc8ea00a0,
-  0xd6ad50a5,0xd26c4d12,0xdf2f6bcb,0xdbee767c,
-  0xe3a1cbc1,0xe760d676,0xea23f0af,0xeee2ed18,
-  0xf0a5bd1d,0xf464a0aa,0xf9278673,0xfde69bc4,
-  0x89b8fd09,0x8d79e0be,0x803ac667,0x84fbdbd0,
-  0x9abc8bd5,0x9e7d9662,0x933eb0bb,0x97ffad0c,
-  0xafb010b1,0xab710d06,0xa6322bdf,0xa2f33668,
-  0xbcb4666d,0xb8757bda,0xb5365d03,0xb1f740b4};
-
 /* init the encode/decode logical stream state */
 
 int ogg_stream_init(ogg_stream_state *os,int serialno){
@@ -273,14 +186,11 @@ static int _os_lacing_expand(ogg_stream_state *os,int needed){
   return 0;
 }
 
-/* checksum the page */
-/* Direct table CRC; note that this will be faster in the future if we
-   perform the checksum simultaneously with other copies */
+/* checksum the page; see crc.c */
 
 void ogg_page_checksum_set(ogg_page *og){
   if(og){
     ogg_uint32_t crc_reg=0;
-    int i;
 
     /* safety; needed for API behavior, but not framing code */
     og->header[22]=0;
@@ -288,10 +198,8 @@ void ogg_page_checksum_set(ogg_page *og){
     og->header[24]=0;
     og->header[25]=0;
 
-    for(i=0;i<og->header_len;i++)
-      crc_reg=(crc_reg<<8)^crc_lookup[((crc_reg >> 24)&0xff)^og->header[i]];
-    for(i=0;i<og->body_len;i++)
-      crc_reg=(crc_reg<<8)^crc_lookup[((crc_reg >> 24)&0xff)^og->body[i]];
+    crc_reg=_ogg_crc_update(crc_reg,og->header,og->header_len);
+    crc_reg=_ogg_crc_update(crc_reg,og->body,og->body_len);
 
     og->header[22]=(unsigned char)(crc_reg&0xff);
     og->header[23]=(unsigned char)((crc_reg>>8)&0xff);
@@ -588,7 +496,7 @@ int ogg_sync_init(ogg_sync_state *oy){
 /* clear non-flat storage within */
 int ogg_sync_clear(ogg_sync_state *oy){
   if(oy){
-    if(oy->data)_ogg_free(oy->data);
+    if(oy->data && !oy->wrapped)_ogg_free(oy->data);
     memset(oy,0,sizeof(*oy));
   }
   return(0);
@@ -607,8 +515,40 @@ int ogg_sync_check(ogg_sync_state *oy){
   return 0;
 }
 
+/* Trusted input (our own asset bundles, say) only has the checksum of
+   the first page after a sync point verified; the ones that follow it
+   are taken as they are. */
+int ogg_sync_set_trusted(ogg_sync_state *oy,int trusted){
+  if(ogg_sync_check(oy)) return -1;
+  oy->trusted=trusted!=0;
+  return 0;
+}
+
+/* Frames a contiguous source (a file in memory or mapped) in place,
+   instead of copying it through ogg_sync_buffer.  The data is never
+   written to and must outlive the state and every page taken from it.
+   Calling it again repositions, eg after a seek; ogg_sync_reset drops
+   what is left, and ogg_sync_buffer and ogg_sync_wrote fail on a
+   wrapped state. */
+int ogg_sync_wrap(ogg_sync_state *oy,const unsigned char *data,long bytes){
+  if(ogg_sync_check(oy)) return -1;
+  if(oy->data && !oy->wrapped)_ogg_free(oy->data);
+
+  oy->data=(unsigned char *)data;
+  oy->storage=bytes;
+  oy->fill=bytes;
+  oy->returned=0;
+  oy->unsynced=0;
+  oy->in_sequence=0;
+  oy->headerbytes=0;
+  oy->bodybytes=0;
+  oy->wrapped=1;
+  return 0;
+}
+
 char *ogg_sync_buffer(ogg_sync_state *oy, long size){
   if(ogg_sync_check(oy)) return NULL;
+  if(oy->wrapped) return NULL;
 
   /* first, clear out any space that has been previously returned */
   if(oy->returned){
@@ -641,6 +581,7 @@ char *ogg_sync_buffer(ogg_sync_state *oy, long size){
 
 int ogg_sync_wrote(ogg_sync_state *oy, long bytes){
   if(ogg_sync_check(oy))return -1;
+  if(oy->wrapped)return -1;
   if(oy->fill+bytes>oy->storage)return -1;
   oy->fill+=bytes;
   return(0);
@@ -670,6 +611,10 @@ long ogg_sync_pageseek(ogg_sync_state *oy,ogg_page *og){
     /* verify capture pattern */
     if(memcmp(page,"OggS",4))goto sync_fail;
 
+    /* trusted input has no checksum to catch a bad header later on, so
+       reject an unknown stream structure version or header flags here */
+    if(oy->trusted && (page[4]!=0 || (page[5]&~7)))goto sync_fail;
+
     headerbytes=page[26]+27;
     if(bytes<headerbytes)return(0); /* not enough for header + seg table */
 
@@ -682,30 +627,29 @@ long ogg_sync_pageseek(ogg_sync_state *oy,ogg_page *og){
 
   if(oy->bodybytes+oy->headerbytes>bytes)return(0);
 
-  /* The whole test page is buffered.  Verify the checksum */
-  {
-    /* Grab the checksum bytes, set the header field to zero */
-    char chksum[4];
-    ogg_page log;
-
-    memcpy(chksum,page+22,4);
-    memset(page+22,0,4);
-
-    /* set up a temp page struct and recompute the checksum */
-    log.header=page;
-    log.header_len=oy->headerbytes;
-    log.body=page+oy->headerbytes;
-    log.body_len=oy->bodybytes;
-    ogg_page_checksum_set(&log);
+  /* The whole test page is buffered.  Verify the checksum, unless the
+     input is trusted and this page starts right where the last one
+     ended; the first page after init, a reset or lost sync is always
+     checked so that a stray capture pattern isn't taken for a page */
+  if(!oy->trusted || !oy->in_sequence){
+    /* Recompute it with the checksum field taken as zero.  Done in
+       pieces rather than by zeroing the field in place, as wrapped
+       data may be read only. */
+    static const unsigned char zero[4]={0,0,0,0};
+    ogg_uint32_t crc_reg;
+
+    crc_reg=_ogg_crc_update(0,page,22);
+    crc_reg=_ogg_crc_update(crc_reg,zero,4);
+    crc_reg=_ogg_crc_update(crc_reg,page+26,oy->headerbytes-26);
+    crc_reg=_ogg_crc_update(crc_reg,page+oy->headerbytes,oy->bodybytes);
 
     /* Compare */
-    if(memcmp(chksum,page+22,4)){
+    if(page[22]!=(unsigned char)(crc_reg&0xff) ||
+       page[23]!=(unsigned char)((crc_reg>>8)&0xff) ||
+       page[24]!=(unsigned char)((crc_reg>>16)&0xff) ||
+       page[25]!=(unsigned char)((crc_reg>>24)&0xff)){
       /* D'oh.  Mismatch! Corrupt page (or miscapture and not a page
-         at all) */
-      /* replace the computed checksum with the one actually read in */
-      memcpy(page+22,chksum,4);
-
-      /* Bad checksum. Lose sync */
+         at all).  Bad checksum. Lose sync */
       goto sync_fail;
     }
   }
@@ -723,6 +667,7 @@ long ogg_sync_pageseek(ogg_sync_state *oy,ogg_page *og){
     }
 
     oy->unsynced=0;
+    oy->in_sequence=1;
     oy->returned+=(bytes=oy->headerbytes+oy->bodybytes);
     oy->headerbytes=0;
     oy->bodybytes=0;
@@ -733,6 +678,7 @@ long ogg_sync_pageseek(ogg_sync_state *oy,ogg_page *og){
 
   oy->headerbytes=0;
   oy->bodybytes=0;
+  oy->in_sequence=0;
 
   /* search for possible capture */
   next=memchr(page+1,'O',bytes-1);
@@ -811,12 +757,34 @@ int ogg_stream_pagein(ogg_stream_state *os, ogg_page *og){
 
     /* body data */
     if(br){
+      if(os->body_ref && br>=os->body_copied){
+        os->body_ref+=br-os->body_copied;
+        os->body_copied=0;
+      }else{
+        long keep=(os->body_ref?os->body_copied:os->body_fill)-br;
+        if(keep)
+          memmove(os->body_data,os->body_data+br,keep);
+        if(os->body_ref)os->body_copied=keep;
+      }
       os->body_fill-=br;
-      if(os->body_fill)
-        memmove(os->body_data,os->body_data+br,os->body_fill);
       os->body_returned=0;
     }
 
+    /* whatever is still unread on the last page goes into the buffer,
+       in front of the new one: normally just the start of a packet
+       that continues on this page */
+    if(os->body_ref){
+      long bytes=os->body_fill-os->body_copied;
+      os->body_fill=os->body_copied;
+      if(bytes){
+        if(_os_body_expand(os,bytes)) return -1;
+        memcpy(os->body_data+os->body_fill,os->body_ref,bytes);
+        os->body_fill+=bytes;
+      }
+      os->body_ref=NULL;
+      os->body_copied=0;
+    }
+
     if(lr){
       /* segment table */
       if(os->lacing_fill-lr){
@@ -872,9 +840,33 @@ int ogg_stream_pagein(ogg_stream_state *os, ogg_page *og){
   }
 
   if(bodysize){
-    if(_os_body_expand(os,bodysize)) return -1;
-    memcpy(os->body_data+os->body_fill,body,bodysize);
-    os->body_fill+=bodysize;
+    long copy=bodysize;
+
+    if(os->zerocopy){
+      /* only the bytes finishing a packet already partly buffered need
+         to be copied next to it; from the first packet that starts on
+         this page on, packets are read straight out of the page */
+      copy=0;
+      if(os->lacing_fill>os->lacing_packet){
+        int i;
+        for(i=segptr;i<segments;i++){
+          int val=header[27+i];
+          copy+=val;
+          if(val<255)break;
+        }
+      }
+    }
+
+    if(copy){
+      if(_os_body_expand(os,copy)) return -1;
+      memcpy(os->body_data+os->body_fill,body,copy);
+      os->body_fill+=copy;
+    }
+    if(copy<bodysize){
+      os->body_ref=body+copy;
+      os->body_copied=os->body_fill;
+      os->body_fill+=bodysize-copy;
+    }
   }
 
   {
@@ -922,6 +914,7 @@ int ogg_sync_reset(ogg_sync_state *oy){
   oy->fill=0;
   oy->returned=0;
   oy->unsynced=0;
+  oy->in_sequence=0;
   oy->headerbytes=0;
   oy->bodybytes=0;
   return(0);
@@ -932,6 +925,8 @@ int ogg_stream_reset(ogg_stream_state *os){
 
   os->body_fill=0;
   os->body_returned=0;
+  os->body_ref=NULL;
+  os->body_copied=0;
 
   os->lacing_fill=0;
   os->lacing_packet=0;
@@ -994,7 +989,10 @@ static int _packetout(ogg_stream_state *os,ogg_packet *op,int adv){
     if(op){
       op->e_o_s=eos;
       op->b_o_s=bos;
-      op->packet=os->body_data+os->body_returned;
+      if(os->body_ref && os->body_returned>=os->body_copied)
+        op->packet=os->body_ref+(os->body_returned-os->body_copied);
+      else
+        op->packet=os->body_data+os->body_returned;
       op->packetno=os->packetno;
       op->granulepos=os->granule_vals[ptr];
       op->bytes=bytes;
@@ -1019,6 +1017,16 @@ int ogg_stream_packetpeek(ogg_stream_state *os,ogg_packet *op){
   return _packetout(os,op,0);
 }
 
+/* For pages that stay valid until all of their packets have been read
+   and the next page is submitted, as those of a wrapped ogg_sync_state
+   do: packets then point into the pages, and only those continued from
+   one page to the next are copied to be made contiguous. */
+int ogg_stream_set_zerocopy(ogg_stream_state *os,int zerocopy){
+  if(ogg_stream_check(os)) return -1;
+  os->zerocopy=zerocopy!=0;
+  return 0;
+}
+
 void ogg_packet_clear(ogg_packet *op) {
   _ogg_free(op->packet);
   memset(op, 0, sizeof(*op));
@@ -0,0 +1,100 @@
+#include "Lemon.h"
+#include "Threading.h"
+
+// Whole-file decoding of many sounds at once, for prewarming caches on
+// level load. Items are independent, so workers just claim the next
+// undecoded one until the list runs out; a long sound only holds up its
+// own worker.
+
+typedef struct
+{
+	// In: the encoded file, kept alive by the caller for the call
+	const char* data;
+	int length;
+	// In/out: a caller buffer of capacity bytes, or NULL to have one
+	// allocated, which is then owned by the caller (see OggBatchFree)
+	char* pcm;
+	int capacity;
+	// Out
+	int size;
+	int samples;
+	int channels;
+	int frequency;
+	// Out: 0, an OV_E* code or OGG_ENOSPACE (pcm then holds what fitted)
+	int error;
+} OggBatchItem;
+
+typedef struct
+{
+	OggBatchItem* items;
+	int count;
+	volatile int next;
+	volatile int failed;
+} OggBatchJob;
+
+int OggDecodeMemory(const char* data, int length, char* buffer, int capacity,
+	char** pcm, int* size, int* channels, int* frequency);
+
+static void OggBatchDecodeItem(OggBatchItem* item)
+{
+	char* pcm;
+	int ret = OggDecodeMemory(item->data, item->length, item->pcm, item->capacity,
+		&pcm, &item->size, &item->channels, &item->frequency);
+	item->error = ret < 0 ? ret : 0;
+	if (pcm != NULL) {
+		item->pcm = pcm;
+	}
+	item->samples = item->channels > 0 ? item->size / (item->channels * 2) : 0;
+}
+
+static void OggBatchWorker(void* arg)
+{
+	OggBatchJob* job = (OggBatchJob*)arg;
+	int index;
+	while ((index = LemonAtomicIncrement(&job->next) - 1) < job->count) {
+		OggBatchItem* item = &job->items[index];
+		OggBatchDecodeItem(item);
+		if (item->error != 0) {
+			LemonAtomicIncrement(&job->failed);
+		}
+	}
+}
+
+// Decodes count items on up to threads workers (0 or less means one per
+// core), the calling thread being one of them. Returns the number of items
+// that failed; see each item's error.
+LEMON_API int OggDecodeBatch(OggBatchItem* items, int count, int threads)
+{
+	LemonThread* workers;
+	int i, started = 0;
+	OggBatchJob job;
+	job.items = items;
+	job.count = count;
+	job.next = 0;
+	job.failed = 0;
+	if (threads <= 0) {
+		threads = LemonCpuCount();
+	}
+	if (threads > count) {
+		threads = count;
+	}
+	workers = threads > 1 ? (LemonThread*)malloc(sizeof(LemonThread) * (threads - 1)) : NULL;
+	for (i = 0; i < threads - 1; i++) {
+		// If a thread can't be started the others just take more items
+		if (LemonThreadStart(&workers[started], OggBatchWorker, &job) == 0) {
+			started++;
+		}
+	}
+	OggBatchWorker(&job);
+	for (i = 0; i < started; i++) {
+		LemonThreadJoin(workers[i]);
+	}
+	free(workers);
+	return job.failed;
+}
+
+// Frees PCM that OggDecodeBatch allocated.
+LEMON_API void OggBatchFree(char* pcm)
+{
+	free(pcm);
+}
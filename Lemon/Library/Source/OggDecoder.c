@@ -1,28 +1,542 @@
 #include "Lemon.h"
 
+// Samples decoded ahead from the loop start; see OggSetLoop
+#define OGG_LOOP_BLOCK_SAMPLES 8192
+// How close to the loop end the spare decoder is opened. Well above what
+// one read asks for, so the open happens a read or more before the seam
+#define OGG_LOOP_SPARE_SAMPLES (4 * OGG_LOOP_BLOCK_SAMPLES)
+
+typedef struct
+{
+	int enabled;
+	ogg_int64_t start;
+	ogg_int64_t end;
+	// 16 bit PCM from start on, played on each wrap while the decoder is
+	// repositioned past it
+	char* block;
+	int blockSize;
+	// Read position in block, blockSize when the decoder is playing
+	int blockPosition;
+	// The whole loop fits in block, so the decoder isn't needed after a wrap
+	int blockOnly;
+	// Second decoder on the same data, swapped in at each wrap so that the
+	// read reaching the seam doesn't have to seek. Opened on nearing the
+	// loop end and kept from then on. Primed means positioned at start
+	// plus the block, see OggPrimeLoop
+	OggVorbis_File spare;
+	int spareOpen;
+	int sparePrimed;
+	// The spare couldn't be opened, so wraps seek instead
+	int spareFailed;
+} OggLoop;
+
+// What OggCreate hands out. vf comes first, so the handle is an
+// OggVorbis_File* for every entry point; only OggRead and the loop
+// functions need the rest.
+typedef struct
+{
+	OggVorbis_File vf;
+	OggLoop loop;
+	// Initial arena size for the next open, negative to use the heap
+	int arenaBytes;
+	// Skip page checksums, see OggSetTrusted
+	int trusted;
+} OggFile;
+
 LEMON_API OggVorbis_File* OggCreate()
 {
-	return (OggVorbis_File*)malloc(sizeof(OggVorbis_File));
+	OggFile* file = (OggFile*)calloc(1, sizeof(OggFile));
+	file->arenaBytes = -1;
+	return &file->vf;
+}
+
+// Makes the next OggOpen or OggOpenMemory put all of the decoder's memory
+// in one arena of bytes (0 for Tremor's default size), which OggDispose
+// frees in one go. Negative goes back to separate heap allocations.
+LEMON_API void OggSetArena(OggVorbis_File* vf, int bytes)
+{
+	((OggFile*)vf)->arenaBytes = bytes;
+}
+
+// For files from our own asset bundles: page checksums are only verified
+// on the first page after opening or seeking, the rest are taken as read.
+// A malformed page header still makes the decoder resync. Takes effect
+// right away and stays on for later opens.
+LEMON_API void OggSetTrusted(OggVorbis_File* vf, int trusted)
+{
+	OggLoop* loop = &((OggFile*)vf)->loop;
+	((OggFile*)vf)->trusted = trusted;
+	ogg_sync_set_trusted(&vf->oy, trusted);
+	if (loop->spareOpen) {
+		ogg_sync_set_trusted(&loop->spare.oy, trusted);
+	}
 }
 
+static int OggOpenWith(void* dataSource, OggVorbis_File* vf, ov_callbacks callbacks, int arenaBytes)
+{
+	if (arenaBytes < 0) {
+		return ov_open_callbacks(dataSource, vf, NULL, 0, callbacks);
+	}
+	return ov_open_arena_callbacks(dataSource, vf, NULL, 0, callbacks, arenaBytes);
+}
+
+LEMON_API void OggClearLoop(OggVorbis_File* vf);
+
 LEMON_API void OggDispose(OggVorbis_File* vf)
 {
+	OggClearLoop(vf);
 	ov_clear(vf);
 	free(vf);
 }
 
 LEMON_API int OggOpen(void* dataSource, OggVorbis_File* vf, ov_callbacks callbacks)
 {
-	return ov_open_callbacks(dataSource, vf, NULL, 0, callbacks);
+	OggFile* file = (OggFile*)vf;
+	int ret = OggOpenWith(dataSource, vf, callbacks, file->arenaBytes);
+	if (ret == 0) {
+		ogg_sync_set_trusted(&vf->oy, file->trusted);
+	}
+	return ret;
 }
 
+// Opens an Ogg/Vorbis file held entirely in memory. Pages are parsed
+// where they lie and packets decoded straight from them, so nothing is
+// copied and no callbacks go back into managed code. data must stay
+// valid (and pinned, if it is managed memory) until OggDispose.
+LEMON_API int OggOpenMemory(const char* data, int length, OggVorbis_File* vf)
+{
+	OggFile* file = (OggFile*)vf;
+	int ret = ov_open_memory(data, length, vf, file->arenaBytes);
+	if (ret == 0) {
+		ogg_sync_set_trusted(&vf->oy, file->trusted);
+	}
+	return ret;
+}
+
+// Decodes a whole in-memory file to interleaved 16 bit PCM. If buffer is
+// given the output goes there and OGG_ENOSPACE is returned when it is too
+// small (holding as much as fitted); otherwise a buffer is allocated with
+// malloc. On success *pcm, *size, *channels and *frequency are set.
+int OggDecodeMemory(const char* data, int length, char* buffer, int capacity,
+	char** pcm, int* size, int* channels, int* frequency)
+{
+	OggVorbis_File vf;
+	ogg_int64_t samples;
+	int ret, bitstream, bytes, used = 0, total = 0;
+	int owned = buffer == NULL;
+	char* grown;
+	*pcm = NULL;
+	*size = 0;
+	*channels = 0;
+	*frequency = 0;
+	// Open to close in one arena: no heap traffic per decoded file
+	ret = ov_open_memory(data, length, &vf, 0);
+	if (ret < 0) {
+		return ret;
+	}
+	*channels = vf.vi->channels;
+	*frequency = vf.vi->rate;
+	if (owned) {
+		samples = ov_pcm_total(&vf, -1);
+		total = samples > 0 ? (int)samples * vf.vi->channels * 2 : 0;
+		capacity = total > 0 ? total : 64 * 1024;
+		buffer = (char*)malloc(capacity);
+		if (buffer == NULL) {
+			ov_clear(&vf);
+			return OV_EFAULT;
+		}
+	}
+	for (;;) {
+		if (used == capacity) {
+			if (!owned) {
+				// Distinguish "exactly full" from "more to come"
+				char probe[4096];
+				bytes = ov_read(&vf, probe, sizeof(probe), &bitstream);
+				ret = bytes > 0 ? OGG_ENOSPACE : bytes;
+				break;
+			}
+			if (used == total) {
+				// All the samples the stream declares; don't grow just to see the end
+				ret = 0;
+				break;
+			}
+			grown = (char*)realloc(buffer, (size_t)capacity * 2);
+			if (grown == NULL) {
+				ret = OV_EFAULT;
+				break;
+			}
+			buffer = grown;
+			capacity *= 2;
+		}
+		bytes = ov_read(&vf, buffer + used, capacity - used, &bitstream);
+		if (bytes <= 0) {
+			ret = bytes;
+			break;
+		}
+		used += bytes;
+	}
+	ov_clear(&vf);
+	if (ret < 0 && owned) {
+		free(buffer);
+		return ret;
+	}
+	if (owned && used < capacity) {
+		// Cached sounds are budgeted by size, so don't keep the slack
+		grown = (char*)realloc(buffer, used > 0 ? used : 1);
+		if (grown != NULL) {
+			buffer = grown;
+		}
+	}
+	*pcm = buffer;
+	*size = used;
+	return ret;
+}
+
+// Decoders reading through callbacks share the data source, so one that
+// is about to read again after the other has moved the stream is put back
+// where its framer left off. Files in memory have no stream position.
+static int OggRestoreStream(OggVorbis_File* vf)
+{
+	if (vf->memory || vf->datasource == NULL || vf->callbacks.seek_func == NULL) {
+		return 0;
+	}
+	if (vf->callbacks.seek_func(vf->datasource, vf->offset + vf->oy.fill - vf->oy.returned, SEEK_SET) == -1) {
+		return OV_EREAD;
+	}
+	return 0;
+}
+
+// Exchanges the active decoder and the spare. The callbacks stay put, so
+// that only vf, never the spare, closes the data source.
+static void OggSwapDecoders(OggVorbis_File* vf, OggVorbis_File* spare)
+{
+	OggVorbis_File swap = *vf;
+	ov_callbacks callbacks = vf->callbacks;
+	*vf = *spare;
+	*spare = swap;
+	spare->callbacks = vf->callbacks;
+	vf->callbacks = callbacks;
+	// Initialized blocks point back at their own dsp state
+	if (vf->vb.vd != NULL) {
+		vf->vb.vd = &vf->vd;
+	}
+	if (spare->vb.vd != NULL) {
+		spare->vb.vd = &spare->vd;
+	}
+}
+
+static int OggOpenSpare(OggVorbis_File* vf, OggLoop* loop);
+
+// Opens the spare decoder once vf is close enough to the loop end to need
+// it soon, unless the loop has no use for one.
+static int OggNeedSpare(OggVorbis_File* vf, OggLoop* loop)
+{
+	if (!loop->enabled || loop->blockOnly || loop->spareOpen || loop->spareFailed) {
+		return 0;
+	}
+	// While the block plays vf stands past it, not where playback is
+	if (loop->blockPosition < loop->blockSize || loop->end - ov_pcm_tell(vf) > OGG_LOOP_SPARE_SAMPLES) {
+		return 0;
+	}
+	return OggOpenSpare(vf, loop);
+}
+
+// Positions the spare decoder of a loop at the end of the start block, so
+// that the next wrap only swaps decoders, and opens the spare first when
+// the loop end is near. OggRead does both itself when needed, but that
+// puts an open or a seek in a read; calling this after reads, outside of
+// the time critical path, avoids it. Does nothing when the spare is ready,
+// not needed yet or there is no loop. Returns 0 or an OV_E* code.
+LEMON_API int OggPrimeLoop(OggVorbis_File* vf)
+{
+	OggLoop* loop = &((OggFile*)vf)->loop;
+	int ret;
+	if (!loop->spareOpen) {
+		return OggNeedSpare(vf, loop);
+	}
+	if (loop->sparePrimed) {
+		return 0;
+	}
+	ret = OggRestoreStream(&loop->spare);
+	if (ret == 0) {
+		ret = ov_pcm_seek(&loop->spare, loop->start + loop->blockSize / (vf->vi->channels * 2));
+	}
+	if (ret == 0) {
+		loop->sparePrimed = 1;
+	}
+	// Even if the seek failed the stream is left wherever it got
+	if (OggRestoreStream(vf) < 0 && ret == 0) {
+		ret = OV_EREAD;
+	}
+	return ret;
+}
+
+static int OggWrapLoop(OggVorbis_File* vf, OggLoop* loop)
+{
+	int ret;
+	loop->blockPosition = 0;
+	if (loop->blockOnly) {
+		return 0;
+	}
+	if (!loop->spareOpen) {
+		return ov_pcm_seek(vf, loop->start + loop->blockSize / (vf->vi->channels * 2));
+	}
+	ret = OggPrimeLoop(vf);
+	if (ret < 0) {
+		return ret;
+	}
+	OggSwapDecoders(vf, &loop->spare);
+	loop->sparePrimed = 0;
+	return OggRestoreStream(vf);
+}
+
+// With a loop set (see OggSetLoop) this never reports the end of the
+// stream: reaching the loop end continues with the loop start block.
 LEMON_API int OggRead(OggVorbis_File* vf, char* buffer, int length, int* bitstream)
 {
-	return ov_read(vf, buffer, length, bitstream);
+	OggLoop* loop = &((OggFile*)vf)->loop;
+	int frame, bytes, ret;
+	ogg_int64_t left;
+	if (!loop->enabled) {
+		return ov_read(vf, buffer, length, bitstream);
+	}
+	if (loop->blockPosition < loop->blockSize) {
+		bytes = loop->blockSize - loop->blockPosition;
+		if (bytes > length) {
+			bytes = length;
+		}
+		memcpy(buffer, loop->block + loop->blockPosition, bytes);
+		loop->blockPosition += bytes;
+		if (loop->blockPosition == loop->blockSize && loop->blockOnly) {
+			loop->blockPosition = 0;
+		}
+		return bytes;
+	}
+	ret = OggNeedSpare(vf, loop);
+	if (ret < 0) {
+		return ret;
+	}
+	frame = vf->vi->channels * 2;
+	left = (loop->end - ov_pcm_tell(vf)) * frame;
+	if (left < frame) {
+		ret = OggWrapLoop(vf, loop);
+		return ret < 0 ? ret : OggRead(vf, buffer, length, bitstream);
+	}
+	if (length > left) {
+		length = (int)left;
+	}
+	bytes = ov_read(vf, buffer, length, bitstream);
+	if (bytes == 0 && length >= frame) {
+		// The stream ended short of the loop end
+		ret = OggWrapLoop(vf, loop);
+		return ret < 0 ? ret : OggRead(vf, buffer, length, bitstream);
+	}
+	return bytes;
+}
+
+LEMON_API void OggClearLoop(OggVorbis_File* vf)
+{
+	OggLoop* loop = &((OggFile*)vf)->loop;
+	free(loop->block);
+	if (loop->spareOpen) {
+		ov_clear(&loop->spare);
+	}
+	memset(loop, 0, sizeof(*loop));
+}
+
+// Opens the spare decoder of a loop on the data of vf and primes it. The
+// spare never closes the data source, OggDispose leaves that to vf. If it
+// can't be opened the wraps seek vf instead.
+static int OggOpenSpare(OggVorbis_File* vf, OggLoop* loop)
+{
+	OggFile* file = (OggFile*)vf;
+	ov_callbacks callbacks = vf->callbacks;
+	int ret;
+	if (vf->memory) {
+		ret = ov_open_memory((const char*)vf->memory, vf->memory_bytes, &loop->spare, file->arenaBytes);
+	} else {
+		callbacks.close_func = NULL;
+		ret = callbacks.seek_func(vf->datasource, 0, SEEK_SET) == -1 ? OV_EREAD :
+			OggOpenWith(vf->datasource, &loop->spare, callbacks, file->arenaBytes);
+	}
+	if (ret < 0) {
+		loop->spareFailed = 1;
+		return OggRestoreStream(vf);
+	}
+	ogg_sync_set_trusted(&loop->spare.oy, file->trusted);
+	loop->spareOpen = 1;
+	return OggPrimeLoop(vf);
+}
+
+// Makes OggRead loop from sample start up to, but not including, sample
+// end (0 meaning the end of the stream) with no gap at the seam. Playback
+// goes on from the current position, so anything before start plays once
+// as an intro. The first samples of the loop are decoded here, and each
+// wrap plays them while a second decoder, already positioned past them,
+// takes over, so the seam stays sample accurate and costs no seek (see
+// OggPrimeLoop). That decoder is only opened within
+// OGG_LOOP_SPARE_SAMPLES of the loop end: until then a loop costs the
+// block (32 KB for stereo), from then on a second decoder as well. Needs a
+// seekable stream; returns 0 or an OV_E* code.
+LEMON_API int OggSetLoop(OggVorbis_File* vf, ogg_int64_t start, ogg_int64_t end)
+{
+	OggLoop* loop = &((OggFile*)vf)->loop;
+	ogg_int64_t position = ov_pcm_tell(vf);
+	ogg_int64_t total = ov_pcm_total(vf, -1);
+	ogg_int64_t samples;
+	int frame = vf->vi->channels * 2;
+	int bitstream, bytes, used = 0, ret;
+	if (total < 0) {
+		return (int)total;
+	}
+	if (end <= 0 || end > total) {
+		end = total;
+	}
+	if (start < 0 || start >= end) {
+		return OV_EINVAL;
+	}
+	OggClearLoop(vf);
+	samples = end - start;
+	if (samples > OGG_LOOP_BLOCK_SAMPLES) {
+		samples = OGG_LOOP_BLOCK_SAMPLES;
+	}
+	loop->block = (char*)malloc((size_t)samples * frame);
+	if (loop->block == NULL) {
+		return OV_EFAULT;
+	}
+	ret = ov_pcm_seek(vf, start);
+	while (ret == 0 && used < samples * frame) {
+		bytes = ov_read(vf, loop->block + used, (int)samples * frame - used, &bitstream);
+		if (bytes <= 0) {
+			ret = bytes < 0 ? bytes : OV_EREAD;
+			break;
+		}
+		used += bytes;
+	}
+	if (ret == 0) {
+		ret = ov_pcm_seek(vf, position);
+	}
+	if (ret < 0) {
+		OggClearLoop(vf);
+		return ret;
+	}
+	loop->enabled = 1;
+	loop->start = start;
+	loop->end = end;
+	loop->blockSize = used;
+	loop->blockPosition = used;
+	loop->blockOnly = start + samples >= end;
+	return 0;
+}
+
+static ogg_int64_t OggParseSamples(const char* text)
+{
+	ogg_int64_t value = 0;
+	if (text == NULL || *text < '0' || *text > '9') {
+		return -1;
+	}
+	while (*text >= '0' && *text <= '9') {
+		value = value * 10 + (*text++ - '0');
+	}
+	return *text == 0 ? value : -1;
+}
+
+// Sets the loop from the LOOPSTART and either LOOPEND or LOOPLENGTH
+// comments, in samples, as written by common loop tagging tools. Returns
+// 1 if the file has them, 0 if not, or an OV_E* code.
+LEMON_API int OggSetLoopFromComments(OggVorbis_File* vf)
+{
+	vorbis_comment* vc = ov_comment(vf, -1);
+	ogg_int64_t start, end = 0, length;
+	int ret;
+	if (vc == NULL) {
+		return 0;
+	}
+	start = OggParseSamples(vorbis_comment_query(vc, (char*)"LOOPSTART", 0));
+	if (start < 0) {
+		return 0;
+	}
+	if (vorbis_comment_query(vc, (char*)"LOOPEND", 0) != NULL) {
+		end = OggParseSamples(vorbis_comment_query(vc, (char*)"LOOPEND", 0));
+	} else if ((length = OggParseSamples(vorbis_comment_query(vc, (char*)"LOOPLENGTH", 0))) > 0) {
+		end = start + length;
+	}
+	if (end < 0) {
+		return OV_EBADHEADER;
+	}
+	ret = OggSetLoop(vf, start, end);
+	return ret < 0 ? ret : 1;
+}
+
+// Planar reads into one buffer: channel i occupies samples values starting
+// at buffer + i * samples. Return the number of samples per channel read.
+#define OGG_MAX_CHANNELS 256
+
+LEMON_API int OggReadFloat(OggVorbis_File* vf, float* buffer, int samples, int* bitstream)
+{
+	float* channels[OGG_MAX_CHANNELS];
+	int i;
+	for (i = 0; i < vf->vi->channels && i < OGG_MAX_CHANNELS; i++) {
+		channels[i] = buffer + i * samples;
+	}
+	return ov_read_float(vf, channels, samples, bitstream);
+}
+
+// Samples are fixed point with full scale at 1 << 24, and are not clipped.
+LEMON_API int OggReadFixed(OggVorbis_File* vf, ogg_int32_t* buffer, int samples, int* bitstream)
+{
+	ogg_int32_t* channels[OGG_MAX_CHANNELS];
+	int i;
+	for (i = 0; i < vf->vi->channels && i < OGG_MAX_CHANNELS; i++) {
+		channels[i] = buffer + i * samples;
+	}
+	return ov_read_fixed(vf, channels, samples, bitstream);
+}
+
+// Sample accurate seek. Pages seen during playback and earlier seeks are
+// indexed, so a jump into audio already played takes one read of the
+// page before the target instead of a bisection over the stream.
+LEMON_API int OggSeekPcm(OggVorbis_File* vf, ogg_int64_t sample)
+{
+	OggLoop* loop = &((OggFile*)vf)->loop;
+	loop->blockPosition = loop->blockSize;
+	return ov_pcm_seek(vf, sample);
+}
+
+LEMON_API int OggSeekTime(OggVorbis_File* vf, double seconds)
+{
+	return OggSeekPcm(vf, (ogg_int64_t)(seconds * vf->vi->rate + 0.5));
+}
+
+LEMON_API ogg_int64_t OggTellPcm(OggVorbis_File* vf)
+{
+	return ov_pcm_tell(vf);
+}
+
+LEMON_API ogg_int64_t OggGetPcmLength(OggVorbis_File* vf)
+{
+	return ov_pcm_total(vf, -1);
+}
+
+// The seek index as (granulepos, offset) pairs, for keeping in a sidecar
+// file so that the next run can seek fast from the start. Writes at most
+// count values and returns how many are needed.
+LEMON_API int OggGetPageIndex(OggVorbis_File* vf, ogg_int64_t* pairs, int count)
+{
+	return ov_page_index_get(vf, pairs, count);
+}
+
+// Loads an index from OggGetPageIndex. Returns 0 or an OV_E* code; an
+// index that turns out not to match the stream is dropped on first use.
+LEMON_API int OggSetPageIndex(OggVorbis_File* vf, const ogg_int64_t* pairs, int count)
+{
+	return ov_page_index_set(vf, pairs, count);
 }
 
 LEMON_API void OggResetToBeginning(OggVorbis_File* vf)
 {
+	OggLoop* loop = &((OggFile*)vf)->loop;
+	loop->blockPosition = loop->blockSize;
 	ov_raw_seek(vf, 0);
 }
 
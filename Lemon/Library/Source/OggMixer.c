@@ -0,0 +1,480 @@
+#include "Lemon.h"
+#include "Threading.h"
+
+// Software mixer: pulls 16 bit PCM from any number of Ogg decoders, applies
+// per-voice gain, pan and pitch, and sums everything into one interleaved
+// stereo 16 bit stream. One output buffer then replaces a streaming source
+// per sound.
+//
+// Voices read through OggRead, so loop points set with OggSetLoop apply.
+// Render runs on the audio thread; the voice functions may be called from
+// any other thread and only wait for the block being mixed.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIXER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MIXER_NEON
+#include <arm_neon.h>
+#endif
+
+// Output frames mixed per pass; gain and pan changes ramp across one pass
+#define MIXER_BLOCK 256
+// Source frames decoded per refill
+#define MIXER_SOURCE_FRAMES 1024
+#define MIXER_MAX_PITCH 8.0f
+
+enum
+{
+	MIXER_VOICE_FREE,
+	MIXER_VOICE_PLAYING,
+	MIXER_VOICE_PAUSED,
+	MIXER_VOICE_FINISHED,
+};
+
+typedef struct
+{
+	OggVorbis_File* vf;
+	int state;
+	int channels;
+	int frequency;
+	float gain;
+	float pan;
+	float pitch;
+	// Channel gains reached at the end of the last block, ramped from
+	float left;
+	float right;
+	// Decoded source frames; the frame at position and the one after are
+	// interpolated for each output frame
+	short* source;
+	int sourceFrames;
+	double position;
+	int ended;
+} OggMixerVoice;
+
+typedef struct
+{
+	LemonMutex lock;
+	int frequency;
+	int voiceCount;
+	OggMixerVoice* voices;
+	float bus[MIXER_BLOCK * 2];
+	float voiceOutput[MIXER_BLOCK * 2];
+} OggMixer;
+
+int OggRead(OggVorbis_File* vf, char* buffer, int length, int* bitstream);
+
+// Creates a mixer rendering stereo at frequency with room for maxVoices.
+// Returns NULL if the arguments are invalid or memory runs out.
+LEMON_API OggMixer* OggMixerCreate(int frequency, int maxVoices)
+{
+	OggMixer* mixer;
+	if (frequency <= 0 || maxVoices <= 0) {
+		return NULL;
+	}
+	mixer = (OggMixer*)calloc(1, sizeof(OggMixer));
+	if (mixer == NULL) {
+		return NULL;
+	}
+	mixer->voices = (OggMixerVoice*)calloc(maxVoices, sizeof(OggMixerVoice));
+	if (mixer->voices == NULL) {
+		free(mixer);
+		return NULL;
+	}
+	mixer->voiceCount = maxVoices;
+	mixer->frequency = frequency;
+	LemonMutexInit(&mixer->lock);
+	return mixer;
+}
+
+// Frees the mixer. The decoders stay open; they belong to the caller.
+LEMON_API void OggMixerDispose(OggMixer* mixer)
+{
+	int i;
+	for (i = 0; i < mixer->voiceCount; i++) {
+		free(mixer->voices[i].source);
+	}
+	LemonMutexDestroy(&mixer->lock);
+	free(mixer->voices);
+	free(mixer);
+}
+
+static void OggMixerVoiceGains(const OggMixerVoice* voice, float* left, float* right)
+{
+	// Pan is a balance: it only ever turns one side down
+	*left = voice->gain * (voice->pan > 0 ? 1 - voice->pan : 1);
+	*right = voice->gain * (voice->pan < 0 ? 1 + voice->pan : 1);
+}
+
+// Starts playing vf, a mono or stereo decoder from OggCreate, from its
+// current position. vf must stay open until the voice is removed. Returns
+// the voice index, or -1 if every voice is taken, vf has more channels or
+// memory runs out.
+LEMON_API int OggMixerAddVoice(OggMixer* mixer, OggVorbis_File* vf, float gain, float pan, float pitch)
+{
+	int i, result = -1;
+	if (vf->vi->channels > 2) {
+		return -1;
+	}
+	LemonMutexLock(&mixer->lock);
+	for (i = 0; i < mixer->voiceCount; i++) {
+		OggMixerVoice* voice = &mixer->voices[i];
+		if (voice->state == MIXER_VOICE_FREE) {
+			if (voice->source == NULL) {
+				voice->source = (short*)malloc(sizeof(short) * 2 * (MIXER_SOURCE_FRAMES + 1));
+				if (voice->source == NULL) {
+					break;
+				}
+			}
+			voice->vf = vf;
+			voice->channels = vf->vi->channels;
+			voice->frequency = vf->vi->rate;
+			voice->gain = gain;
+			voice->pan = pan < -1 ? -1 : pan > 1 ? 1 : pan;
+			voice->pitch = pitch <= 0 ? 1 : pitch > MIXER_MAX_PITCH ? MIXER_MAX_PITCH : pitch;
+			OggMixerVoiceGains(voice, &voice->left, &voice->right);
+			voice->sourceFrames = 0;
+			voice->position = 0;
+			voice->ended = 0;
+			voice->state = MIXER_VOICE_PLAYING;
+			result = i;
+			break;
+		}
+	}
+	LemonMutexUnlock(&mixer->lock);
+	return result;
+}
+
+// Changes take effect smoothly over the next block.
+LEMON_API void OggMixerSetVoice(OggMixer* mixer, int index, float gain, float pan, float pitch)
+{
+	OggMixerVoice* voice = &mixer->voices[index];
+	LemonMutexLock(&mixer->lock);
+	voice->gain = gain;
+	voice->pan = pan < -1 ? -1 : pan > 1 ? 1 : pan;
+	voice->pitch = pitch <= 0 ? 1 : pitch > MIXER_MAX_PITCH ? MIXER_MAX_PITCH : pitch;
+	LemonMutexUnlock(&mixer->lock);
+}
+
+LEMON_API void OggMixerPauseVoice(OggMixer* mixer, int index, int paused)
+{
+	OggMixerVoice* voice = &mixer->voices[index];
+	LemonMutexLock(&mixer->lock);
+	if (paused && voice->state == MIXER_VOICE_PLAYING) {
+		voice->state = MIXER_VOICE_PAUSED;
+	} else if (!paused && voice->state == MIXER_VOICE_PAUSED) {
+		voice->state = MIXER_VOICE_PLAYING;
+	}
+	LemonMutexUnlock(&mixer->lock);
+}
+
+// Returns 1 while the voice is playing or paused, 0 once its decoder has
+// run out (or failed). Either way it keeps its slot until removed.
+LEMON_API int OggMixerIsVoicePlaying(OggMixer* mixer, int index)
+{
+	int state;
+	LemonMutexLock(&mixer->lock);
+	state = mixer->voices[index].state;
+	LemonMutexUnlock(&mixer->lock);
+	return state == MIXER_VOICE_PLAYING || state == MIXER_VOICE_PAUSED;
+}
+
+// Frees the voice; after this the caller may dispose its decoder.
+LEMON_API void OggMixerRemoveVoice(OggMixer* mixer, int index)
+{
+	LemonMutexLock(&mixer->lock);
+	mixer->voices[index].state = MIXER_VOICE_FREE;
+	mixer->voices[index].vf = NULL;
+	LemonMutexUnlock(&mixer->lock);
+}
+
+// Keeps the frames from the current one on and decodes more after them.
+// At the end of the stream a silent frame is added once, so the last
+// real frame still has something to be interpolated towards.
+static int OggMixerRefill(OggMixerVoice* voice)
+{
+	int frame = voice->channels * 2;
+	int drop = (int)voice->position;
+	int keep, bitstream, bytes;
+	// A high pitch can step past the end of what's decoded
+	if (drop > voice->sourceFrames) {
+		drop = voice->sourceFrames;
+	}
+	keep = voice->sourceFrames - drop;
+	if (keep > 0 && drop > 0) {
+		memmove(voice->source, voice->source + drop * voice->channels, keep * frame);
+	}
+	voice->position -= drop;
+	voice->sourceFrames = keep;
+	if (voice->ended) {
+		return 0;
+	}
+	bytes = OggRead(voice->vf, (char*)(voice->source + keep * voice->channels),
+		(MIXER_SOURCE_FRAMES - keep) * frame, &bitstream);
+	if (bytes <= 0) {
+		memset(voice->source + keep * voice->channels, 0, frame);
+		voice->sourceFrames++;
+		voice->ended = 1;
+	} else {
+		voice->sourceFrames += bytes / frame;
+	}
+	return 1;
+}
+
+#if defined(MIXER_SSE2) || defined(MIXER_NEON)
+// Writes four stereo frames of a + (b - a) * t to output: a, b and t hold
+// eight interleaved stereo values, or four mono ones that go to both sides.
+static void OggMixerLerp(float* output, const float* a, const float* b, const float* t, int channels)
+{
+#if defined(MIXER_SSE2)
+	__m128 lo = _mm_loadu_ps(a);
+	lo = _mm_add_ps(lo, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b), lo), _mm_loadu_ps(t)));
+	if (channels == 2) {
+		__m128 hi = _mm_loadu_ps(a + 4);
+		hi = _mm_add_ps(hi, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + 4), hi), _mm_loadu_ps(t + 4)));
+		_mm_storeu_ps(output, lo);
+		_mm_storeu_ps(output + 4, hi);
+	} else {
+		_mm_storeu_ps(output, _mm_unpacklo_ps(lo, lo));
+		_mm_storeu_ps(output + 4, _mm_unpackhi_ps(lo, lo));
+	}
+#else
+	float32x4_t lo = vld1q_f32(a);
+	lo = vaddq_f32(lo, vmulq_f32(vsubq_f32(vld1q_f32(b), lo), vld1q_f32(t)));
+	if (channels == 2) {
+		float32x4_t hi = vld1q_f32(a + 4);
+		hi = vaddq_f32(hi, vmulq_f32(vsubq_f32(vld1q_f32(b + 4), hi), vld1q_f32(t + 4)));
+		vst1q_f32(output, lo);
+		vst1q_f32(output + 4, hi);
+	} else {
+		float32x4x2_t both = vzipq_f32(lo, lo);
+		vst1q_f32(output, both.val[0]);
+		vst1q_f32(output + 4, both.val[1]);
+	}
+#endif
+}
+#endif
+
+// Resamples up to frames stereo frames of the voice into output and
+// returns how many there were before the voice ran out.
+static int OggMixerPull(OggMixerVoice* voice, float* output, int frames, double step)
+{
+	int i = 0, index;
+	while (i < frames) {
+		while ((int)voice->position + 1 >= voice->sourceFrames) {
+			if (!OggMixerRefill(voice)) {
+				return i;
+			}
+		}
+		if (step == 1.0 && voice->position == (int)voice->position) {
+			// Straight copy, the common case for effects at their own rate
+			const short* s = voice->source + (int)voice->position * voice->channels;
+			int n = voice->sourceFrames - 1 - (int)voice->position;
+			if (n > frames - i) {
+				n = frames - i;
+			}
+			if (voice->channels == 2) {
+				for (index = 0; index < n * 2; index++) {
+					output[i * 2 + index] = s[index];
+				}
+			} else {
+				for (index = 0; index < n; index++) {
+					output[(i + index) * 2] = output[(i + index) * 2 + 1] = s[index];
+				}
+			}
+			voice->position += n;
+			i += n;
+			continue;
+		}
+#if defined(MIXER_SSE2) || defined(MIXER_NEON)
+		// Four frames at a time while they are all decoded. The positions
+		// step as in the loop below and only the interpolation is vectorized,
+		// so the result doesn't depend on where a batch starts.
+		while (i + 4 <= frames) {
+			float a[8], b[8], t[8];
+			double position = voice->position;
+			int k;
+			for (k = 0; k < 4 && (index = (int)position) + 1 < voice->sourceFrames; k++) {
+				const short* s = voice->source + index * voice->channels;
+				if (voice->channels == 2) {
+					a[k * 2] = s[0];
+					a[k * 2 + 1] = s[1];
+					b[k * 2] = s[2];
+					b[k * 2 + 1] = s[3];
+					t[k * 2] = t[k * 2 + 1] = (float)(position - index);
+				} else {
+					a[k] = s[0];
+					b[k] = s[1];
+					t[k] = (float)(position - index);
+				}
+				position += step;
+			}
+			if (k < 4) {
+				break;
+			}
+			voice->position = position;
+			OggMixerLerp(output + i * 2, a, b, t, voice->channels);
+			i += 4;
+		}
+#endif
+		while (i < frames && (index = (int)voice->position) + 1 < voice->sourceFrames) {
+			float t = (float)(voice->position - index);
+			const short* a = voice->source + index * voice->channels;
+			const short* b = a + voice->channels;
+			if (voice->channels == 2) {
+				output[i * 2] = a[0] + (b[0] - a[0]) * t;
+				output[i * 2 + 1] = a[1] + (b[1] - a[1]) * t;
+			} else {
+				output[i * 2] = output[i * 2 + 1] = a[0] + (b[0] - a[0]) * t;
+			}
+			voice->position += step;
+			i++;
+		}
+	}
+	return i;
+}
+
+// bus += input * gain, with the gains ramping linearly from left/right to
+// left + frames * dl, right + frames * dr.
+static void OggMixerAccumulate(float* bus, const float* input, int frames,
+	float left, float right, float dl, float dr)
+{
+	int i = 0;
+#if defined(MIXER_SSE2)
+	__m128 gain = _mm_setr_ps(left, right, left + dl, right + dr);
+	__m128 step = _mm_setr_ps(2 * dl, 2 * dr, 2 * dl, 2 * dr);
+	for (; i + 2 <= frames; i += 2) {
+		__m128 sum = _mm_add_ps(_mm_loadu_ps(bus + i * 2), _mm_mul_ps(_mm_loadu_ps(input + i * 2), gain));
+		_mm_storeu_ps(bus + i * 2, sum);
+		gain = _mm_add_ps(gain, step);
+	}
+#elif defined(MIXER_NEON)
+	const float start[4] = { left, right, left + dl, right + dr };
+	const float delta[4] = { 2 * dl, 2 * dr, 2 * dl, 2 * dr };
+	float32x4_t gain = vld1q_f32(start);
+	float32x4_t step = vld1q_f32(delta);
+	for (; i + 2 <= frames; i += 2) {
+		vst1q_f32(bus + i * 2, vmlaq_f32(vld1q_f32(bus + i * 2), vld1q_f32(input + i * 2), gain));
+		gain = vaddq_f32(gain, step);
+	}
+#endif
+	for (; i < frames; i++) {
+		bus[i * 2] += input[i * 2] * (left + i * dl);
+		bus[i * 2 + 1] += input[i * 2 + 1] * (right + i * dr);
+	}
+}
+
+// Saturates the bus into 16 bit output, rounding half away from zero on
+// every path: each adds 0.5 with the sign of the value and truncates.
+static void OggMixerConvert(short* output, const float* bus, int samples)
+{
+	int i = 0;
+#if defined(MIXER_SSE2)
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 low = _mm_set1_ps(-32768.0f);
+	const __m128 high = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= samples; i += 8) {
+		// Clamped first, so the truncation can't overflow 32 bits
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(bus + i), low), high);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(bus + i + 4), low), high);
+		a = _mm_add_ps(a, _mm_or_ps(_mm_and_ps(a, sign), half));
+		b = _mm_add_ps(b, _mm_or_ps(_mm_and_ps(b, sign), half));
+		_mm_storeu_si128((__m128i*)(output + i), _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b)));
+	}
+#elif defined(MIXER_NEON)
+	const float32x4_t half = vdupq_n_f32(0.5f);
+	for (; i + 8 <= samples; i += 8) {
+		float32x4_t a = vld1q_f32(bus + i);
+		float32x4_t b = vld1q_f32(bus + i + 4);
+		// The conversion truncates and saturates
+		a = vaddq_f32(a, vbslq_f32(vcltq_f32(a, vdupq_n_f32(0)), vnegq_f32(half), half));
+		b = vaddq_f32(b, vbslq_f32(vcltq_f32(b, vdupq_n_f32(0)), vnegq_f32(half), half));
+		vst1q_s16(output + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(a)), vqmovn_s32(vcvtq_s32_f32(b))));
+	}
+#endif
+	for (; i < samples; i++) {
+		float v = bus[i] < -32768.0f ? -32768.0f : bus[i] > 32767.0f ? 32767.0f : bus[i];
+		output[i] = (short)(v < 0 ? v - 0.5f : v + 0.5f);
+	}
+}
+
+// Mixes frames stereo frames into output (2 * frames values). Silence is
+// rendered when nothing plays, so this always fills the whole buffer.
+LEMON_API int OggMixerRender(OggMixer* mixer, short* output, int frames)
+{
+	int done, n, i, pulled;
+	for (done = 0; done < frames; done += n) {
+		n = frames - done < MIXER_BLOCK ? frames - done : MIXER_BLOCK;
+		memset(mixer->bus, 0, sizeof(float) * 2 * n);
+		// The lock is taken per block, so a voice call waits for one block
+		// at most. Only this thread touches the bus.
+		LemonMutexLock(&mixer->lock);
+		for (i = 0; i < mixer->voiceCount; i++) {
+			OggMixerVoice* voice = &mixer->voices[i];
+			float left, right;
+			if (voice->state != MIXER_VOICE_PLAYING) {
+				continue;
+			}
+			pulled = OggMixerPull(voice, mixer->voiceOutput, n,
+				(double)voice->pitch * voice->frequency / mixer->frequency);
+			OggMixerVoiceGains(voice, &left, &right);
+			OggMixerAccumulate(mixer->bus, mixer->voiceOutput, pulled, voice->left, voice->right,
+				(left - voice->left) / n, (right - voice->right) / n);
+			voice->left = left;
+			voice->right = right;
+			if (pulled < n) {
+				voice->state = MIXER_VOICE_FINISHED;
+			}
+		}
+		LemonMutexUnlock(&mixer->lock);
+		OggMixerConvert(output + done * 2, mixer->bus, n * 2);
+	}
+	return frames;
+}
+
+static void OggMixerPut32(unsigned char* p, unsigned int v)
+{
+	p[0] = (unsigned char)v;
+	p[1] = (unsigned char)(v >> 8);
+	p[2] = (unsigned char)(v >> 16);
+	p[3] = (unsigned char)(v >> 24);
+}
+
+// Renders frames frames into a 16 bit stereo WAV file, for checking mixes
+// without an audio device. Returns 0, or -1 if the file can't be written.
+LEMON_API int OggMixerRenderToWav(OggMixer* mixer, const char* path, int frames)
+{
+	unsigned char header[44];
+	short block[MIXER_BLOCK * 2];
+	int done, n, ok;
+	unsigned int dataSize = (unsigned int)frames * 4;
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) {
+		return -1;
+	}
+	memcpy(header, "RIFF", 4);
+	OggMixerPut32(header + 4, 36 + dataSize);
+	memcpy(header + 8, "WAVEfmt ", 8);
+	OggMixerPut32(header + 16, 16);
+	OggMixerPut32(header + 20, 1 | (2 << 16)); // PCM, 2 channels
+	OggMixerPut32(header + 24, mixer->frequency);
+	OggMixerPut32(header + 28, mixer->frequency * 4);
+	OggMixerPut32(header + 32, 4 | (16 << 16)); // block align, bits
+	memcpy(header + 36, "data", 4);
+	OggMixerPut32(header + 40, dataSize);
+	ok = fwrite(header, sizeof(header), 1, file) == 1;
+	for (done = 0; ok && done < frames; done += n) {
+		int i;
+		unsigned char bytes[MIXER_BLOCK * 4];
+		n = frames - done < MIXER_BLOCK ? frames - done : MIXER_BLOCK;
+		OggMixerRender(mixer, block, n);
+		for (i = 0; i < n * 2; i++) {
+			bytes[i * 2] = (unsigned char)block[i];
+			bytes[i * 2 + 1] = (unsigned char)(block[i] >> 8);
+		}
+		ok = fwrite(bytes, n * 4, 1, file) == 1;
+	}
+	ok = fclose(file) == 0 && ok;
+	return ok ? 0 : -1;
+}
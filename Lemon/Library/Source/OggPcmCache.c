@@ -0,0 +1,241 @@
+#include "Lemon.h"
+#include "Threading.h"
+
+// Decoded 16 bit PCM for short, frequently played sounds, so that playing
+// them again costs a memcpy instead of a Vorbis decode.
+//
+// Entries are keyed by asset path and kept in LRU order within a byte
+// budget. Callers get read-only views: every view holds a reference, and
+// the cache holds one more while the entry is cached. An entry evicted
+// while still being played stays alive until its last view is released,
+// so eviction never pulls data from under a channel.
+
+typedef struct OggPcmEntry OggPcmEntry;
+
+struct OggPcmEntry
+{
+	char* key;
+	char* data;
+	int size;
+	int channels;
+	int frequency;
+	volatile int refCount;
+	// LRU list, most recently used first. Only touched under the cache lock
+	OggPcmEntry* prev;
+	OggPcmEntry* next;
+};
+
+typedef struct
+{
+	LemonMutex lock;
+	OggPcmEntry* head;
+	OggPcmEntry* tail;
+	int budget;
+	int used;
+	int count;
+} OggPcmCache;
+
+int OggDecodeMemory(const char* data, int length, char* buffer, int capacity,
+	char** pcm, int* size, int* channels, int* frequency);
+
+static void OggPcmEntryFree(OggPcmEntry* entry)
+{
+	free(entry->key);
+	free(entry->data);
+	free(entry);
+}
+
+static void OggPcmUnlink(OggPcmCache* cache, OggPcmEntry* entry)
+{
+	if (entry->prev) {
+		entry->prev->next = entry->next;
+	} else {
+		cache->head = entry->next;
+	}
+	if (entry->next) {
+		entry->next->prev = entry->prev;
+	} else {
+		cache->tail = entry->prev;
+	}
+	entry->prev = entry->next = NULL;
+	cache->used -= entry->size;
+	cache->count--;
+}
+
+static void OggPcmPushFront(OggPcmCache* cache, OggPcmEntry* entry)
+{
+	entry->prev = NULL;
+	entry->next = cache->head;
+	if (cache->head) {
+		cache->head->prev = entry;
+	} else {
+		cache->tail = entry;
+	}
+	cache->head = entry;
+	cache->used += entry->size;
+	cache->count++;
+}
+
+static OggPcmEntry* OggPcmFind(OggPcmCache* cache, const char* key)
+{
+	OggPcmEntry* entry;
+	for (entry = cache->head; entry; entry = entry->next) {
+		if (!strcmp(entry->key, key)) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+// Drops the cache's reference to the least recently used entries until
+// the budget is met, never evicting keep.
+static void OggPcmTrim(OggPcmCache* cache, OggPcmEntry* keep)
+{
+	while (cache->used > cache->budget && cache->tail && cache->tail != keep) {
+		OggPcmEntry* entry = cache->tail;
+		OggPcmUnlink(cache, entry);
+		if (LemonAtomicDecrement(&entry->refCount) == 0) {
+			OggPcmEntryFree(entry);
+		}
+	}
+}
+
+static OggPcmEntry* OggPcmEntryCreate(const char* key, char* data, int size, int channels, int frequency)
+{
+	OggPcmEntry* entry = (OggPcmEntry*)malloc(sizeof(OggPcmEntry));
+	memset(entry, 0, sizeof(OggPcmEntry));
+	entry->key = (char*)malloc(strlen(key) + 1);
+	strcpy(entry->key, key);
+	entry->data = data;
+	entry->size = size;
+	entry->channels = channels;
+	entry->frequency = frequency;
+	return entry;
+}
+
+// Caches entry under its key and returns a view of it, or returns a view
+// of the entry another thread cached meanwhile, freeing this one.
+static OggPcmEntry* OggPcmPublish(OggPcmCache* cache, OggPcmEntry* entry)
+{
+	OggPcmEntry* existing;
+	entry->refCount = 1;
+	LemonMutexLock(&cache->lock);
+	existing = OggPcmFind(cache, entry->key);
+	if (existing) {
+		OggPcmUnlink(cache, existing);
+		OggPcmPushFront(cache, existing);
+		LemonAtomicIncrement(&existing->refCount);
+		LemonMutexUnlock(&cache->lock);
+		OggPcmEntryFree(entry);
+		return existing;
+	}
+	if (entry->size <= cache->budget) {
+		entry->refCount++;
+		OggPcmPushFront(cache, entry);
+		OggPcmTrim(cache, entry);
+	}
+	LemonMutexUnlock(&cache->lock);
+	return entry;
+}
+
+LEMON_API OggPcmCache* OggPcmCacheCreate(int budget)
+{
+	OggPcmCache* cache = (OggPcmCache*)malloc(sizeof(OggPcmCache));
+	memset(cache, 0, sizeof(OggPcmCache));
+	LemonMutexInit(&cache->lock);
+	cache->budget = budget;
+	return cache;
+}
+
+// Frees every cached entry with its PCM and key, whatever its size. No
+// other thread may use the cache meanwhile, and all views should be
+// released first: a view still outstanding keeps its entry alive until
+// OggPcmRelease, which is then the one to free it.
+LEMON_API void OggPcmCacheDispose(OggPcmCache* cache)
+{
+	while (cache->head) {
+		OggPcmEntry* entry = cache->head;
+		OggPcmUnlink(cache, entry);
+		if (LemonAtomicDecrement(&entry->refCount) == 0) {
+			OggPcmEntryFree(entry);
+		}
+	}
+	LemonMutexDestroy(&cache->lock);
+	free(cache);
+}
+
+// Returns a view of the cached PCM for key, or NULL if it isn't cached.
+// Release the view with OggPcmRelease.
+LEMON_API OggPcmEntry* OggPcmCacheAcquire(OggPcmCache* cache, const char* key)
+{
+	OggPcmEntry* entry;
+	LemonMutexLock(&cache->lock);
+	entry = OggPcmFind(cache, key);
+	if (entry) {
+		OggPcmUnlink(cache, entry);
+		OggPcmPushFront(cache, entry);
+		LemonAtomicIncrement(&entry->refCount);
+	}
+	LemonMutexUnlock(&cache->lock);
+	return entry;
+}
+
+// Decodes an encoded file and caches it under key, returning a view of
+// the result. If another thread cached the same key meanwhile, that entry
+// is returned instead. A sound bigger than the whole budget is still
+// decoded, but the view isn't cached. Returns NULL if decoding fails.
+LEMON_API OggPcmEntry* OggPcmCacheInsert(OggPcmCache* cache, const char* key, const char* data, int length)
+{
+	char* pcm;
+	int size, channels, frequency;
+	// Decode outside the lock, so that other channels can use the cache
+	if (OggDecodeMemory(data, length, NULL, 0, &pcm, &size, &channels, &frequency) < 0) {
+		return NULL;
+	}
+	return OggPcmPublish(cache, OggPcmEntryCreate(key, pcm, size, channels, frequency));
+}
+
+// Same as OggPcmCacheInsert for PCM that is already decoded, e.g. by
+// OggDecodeBatch. The cache takes ownership of pcm, which must come from
+// the library's allocator.
+LEMON_API OggPcmEntry* OggPcmCacheAdopt(OggPcmCache* cache, const char* key, char* pcm, int size, int channels, int frequency)
+{
+	return OggPcmPublish(cache, OggPcmEntryCreate(key, pcm, size, channels, frequency));
+}
+
+// Views are independent of the cache lock, so any thread may release them.
+LEMON_API void OggPcmRelease(OggPcmEntry* entry)
+{
+	if (LemonAtomicDecrement(&entry->refCount) == 0) {
+		OggPcmEntryFree(entry);
+	}
+}
+
+LEMON_API const char* OggPcmGetData(OggPcmEntry* entry)
+{
+	return entry->data;
+}
+
+LEMON_API int OggPcmGetSize(OggPcmEntry* entry)
+{
+	return entry->size;
+}
+
+LEMON_API int OggPcmGetChannels(OggPcmEntry* entry)
+{
+	return entry->channels;
+}
+
+LEMON_API int OggPcmGetFrequency(OggPcmEntry* entry)
+{
+	return entry->frequency;
+}
+
+LEMON_API int OggPcmCacheGetUsed(OggPcmCache* cache)
+{
+	int used;
+	LemonMutexLock(&cache->lock);
+	used = cache->used;
+	LemonMutexUnlock(&cache->lock);
+	return used;
+}
@@ -1,6 +1,14 @@
 #include "Lemon.h"
 #include "yuv2rgb/yuv2rgb.h"
 #include "TheoraDecoder.h"
+#include "Threading.h"
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
 
 typedef struct
 {
@@ -11,49 +19,246 @@ typedef struct
 
 #define MAX_STREAMS 10
 
+typedef struct OgvPool OgvPool;
+
+// Figures for the last OgvDecodeFrame call, see OgvEnableStats.
+// Times are in milliseconds. Colour conversion is done by the caller
+// through DecodeRGBX8 and friends, so it isn't included.
+typedef struct
+{
+	int bytesRead;
+	int packetBytes;
+	int codedFragments;
+	int totalFragments;
+	int keyframe;
+	int dupframe;
+	double readMs;
+	double unpackMs;
+	double dcUnpredictMs;
+	double reconMs;
+	double loopFilterMs;
+	double postprocessMs;
+} OgvFrameStats;
+
 typedef struct
 {
 	TheoraDecoder* videoDecoder;
 	ogg_sync_state state;
 	void* dataSource;
 	ov_callbacks callbacks;
+	// Set by OgvCreateMemory: the whole clip, parsed in place
+	const unsigned char* memory;
 	OgvStream streams[MAX_STREAMS];
 	OgvStream* videoStream;
 	int streamCount;
+	// Number of stream states initialized so far; pooled decoders keep
+	// them between clips and only reset the serial number
+	int streamsAllocated;
 	int fileSize;
+	OgvPool* pool;
+	int statsEnabled;
+	// Data source reads and time spent demuxing during the last frame
+	int frameBytesRead;
+	ogg_int64_t frameReadTicks;
 } OgvDecoder;
 
+// Keeps disposed decoders around so that opening the next clip reuses
+// their sync buffer, stream states and Theora frame buffers instead of
+// going through the heap again. May be used from any thread: the lock is
+// only held while decoders go in and out of idle, never across reads
+// from a data source.
+struct OgvPool
+{
+	LemonMutex lock;
+	OgvDecoder** idle;
+	int idleCount;
+	int capacity;
+};
+
 int OgvReadHeaders(OgvDecoder* ogv);
 int OgvReadPage(OgvDecoder* ogv, ogg_page* page);
 
-LEMON_API OgvDecoder* OgvCreate(void* dataSource, ov_callbacks callbacks)
+static void OgvFree(OgvDecoder* ogv)
+{
+	int i;
+	TheoraDispose(ogv->videoDecoder);
+	for (i = 0; i < ogv->streamsAllocated; i++) {
+		ogg_stream_clear(&ogv->streams[i].state);
+	}
+	ogg_sync_clear(&ogv->state);
+	free(ogv);
+}
+
+static OgvDecoder* OgvAllocate()
 {
 	OgvDecoder* ogv = (OgvDecoder*)malloc(sizeof(OgvDecoder));
 	memset(ogv, 0, sizeof(OgvDecoder));
-	ogv->callbacks = callbacks;
 	ogv->videoDecoder = TheoraCreate();
+	ogg_sync_init(&ogv->state);
+	return ogv;
+}
+
+// Monotonic clock in nanoseconds for the decoder statistics
+static ogg_int64_t OgvClock(void)
+{
+#if defined(_WIN32)
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	if (frequency.QuadPart == 0) {
+		QueryPerformanceFrequency(&frequency);
+	}
+	QueryPerformanceCounter(&counter);
+	return (ogg_int64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#elif defined(__APPLE__)
+	static mach_timebase_info_data_t timebase;
+	if (timebase.denom == 0) {
+		mach_timebase_info(&timebase);
+	}
+	return (ogg_int64_t)(mach_absolute_time() * timebase.numer / timebase.denom);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ogg_int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static int OgvOpen(OgvDecoder* ogv, void* dataSource, ov_callbacks callbacks)
+{
+	ogv->callbacks = callbacks;
+	ogv->statsEnabled = 0;
+	ogv->frameBytesRead = 0;
+	ogv->frameReadTicks = 0;
 	ogv->dataSource = dataSource;
 	ogv->streamCount = 0;
+	ogv->videoStream = NULL;
+	ogg_sync_set_trusted(&ogv->state, 0);
 	callbacks.seek_func(dataSource, 0, SEEK_END);
 	ogv->fileSize = callbacks.tell_func(dataSource);
 	callbacks.seek_func(dataSource, 0, SEEK_SET);
-	ogg_sync_init(&ogv->state);
+	return OgvReadHeaders(ogv);
+}
+
+LEMON_API OgvDecoder* OgvCreate(void* dataSource, ov_callbacks callbacks)
+{
+	OgvDecoder* ogv = OgvAllocate();
+	if (OgvOpen(ogv, dataSource, callbacks) < 0) {
+		OgvFree(ogv);
+		return NULL;
+	}
+	return ogv;
+}
+
+// Skips the checksums of pages that follow on from a verified one, for
+// clips from our own asset bundles. The headers read by OgvCreate are
+// always checked; a pooled decoder goes back to checking on reuse.
+LEMON_API void OgvSetTrusted(OgvDecoder* ogv, int trusted)
+{
+	ogg_sync_set_trusted(&ogv->state, trusted);
+}
+
+// Plays a clip held in memory, which must stay valid (and pinned, if it
+// is managed memory) until OgvDispose. Pages are parsed where they lie
+// and packets decoded straight from them: only packets continued from
+// one page to the next get copied.
+LEMON_API OgvDecoder* OgvCreateMemory(const char* data, int length)
+{
+	OgvDecoder* ogv = OgvAllocate();
+	ogv->memory = (const unsigned char*)data;
+	ogv->fileSize = length;
+	ogg_sync_wrap(&ogv->state, ogv->memory, length);
 	if (OgvReadHeaders(ogv) < 0) {
-		free(ogv);
+		OgvFree(ogv);
 		return NULL;
 	}
 	return ogv;
 }
 
 LEMON_API void OgvDispose(OgvDecoder* ogv)
+{
+	OgvPool* pool = ogv->pool;
+	if (pool) {
+		LemonMutexLock(&pool->lock);
+		if (pool->idleCount < pool->capacity) {
+			pool->idle[pool->idleCount++] = ogv;
+			LemonMutexUnlock(&pool->lock);
+			return;
+		}
+		LemonMutexUnlock(&pool->lock);
+	}
+	OgvFree(ogv);
+}
+
+LEMON_API OgvPool* OgvPoolCreate(int capacity)
+{
+	OgvPool* pool = (OgvPool*)malloc(sizeof(OgvPool));
+	pool->idle = (OgvDecoder**)malloc(sizeof(OgvDecoder*) * (capacity > 0 ? capacity : 1));
+	pool->idleCount = 0;
+	pool->capacity = capacity;
+	LemonMutexInit(&pool->lock);
+	return pool;
+}
+
+// All decoders created from the pool must be disposed before the pool.
+LEMON_API void OgvPoolDispose(OgvPool* pool)
 {
 	int i;
-	TheoraDispose(ogv->videoDecoder);
-	for (i = 0; i < ogv->streamCount; i++) {
-		ogg_stream_clear(&ogv->streams[i].state);
+	for (i = 0; i < pool->idleCount; i++) {
+		OgvFree(pool->idle[i]);
 	}
-	ogg_sync_clear(&ogv->state);
-	free(ogv);
+	LemonMutexDestroy(&pool->lock);
+	free(pool->idle);
+	free(pool);
+}
+
+LEMON_API OgvDecoder* OgvCreatePooled(OgvPool* pool, void* dataSource, ov_callbacks callbacks)
+{
+	OgvDecoder* ogv = NULL;
+	// Only taking the decoder is locked: opening it reads the headers
+	// through the callbacks
+	LemonMutexLock(&pool->lock);
+	if (pool->idleCount > 0) {
+		ogv = pool->idle[--pool->idleCount];
+	}
+	LemonMutexUnlock(&pool->lock);
+	if (ogv != NULL) {
+		ogg_sync_reset(&ogv->state);
+		TheoraReset(ogv->videoDecoder);
+	} else {
+		ogv = OgvAllocate();
+	}
+	ogv->pool = pool;
+	if (OgvOpen(ogv, dataSource, callbacks) < 0) {
+		OgvDispose(ogv);
+		return NULL;
+	}
+	return ogv;
+}
+
+// If the decoder context we got doesn't fit the new stream, borrow one
+// that does from another idle decoder, so TheoraInitialize can reset it
+// rather than allocate a new set of frame buffers.
+static void OgvPoolSelectContext(OgvPool* pool, TheoraDecoder* theora)
+{
+	int i;
+	th_dec_ctx* ctx;
+	th_info ctxInfo;
+	if (TheoraContextMatches(theora, &theora->info)) {
+		return;
+	}
+	LemonMutexLock(&pool->lock);
+	for (i = 0; i < pool->idleCount; i++) {
+		TheoraDecoder* other = pool->idle[i]->videoDecoder;
+		if (TheoraContextMatches(other, &theora->info)) {
+			ctx = theora->ctx;
+			ctxInfo = theora->ctxInfo;
+			theora->ctx = other->ctx;
+			theora->ctxInfo = other->ctxInfo;
+			other->ctx = ctx;
+			other->ctxInfo = ctxInfo;
+			break;
+		}
+	}
+	LemonMutexUnlock(&pool->lock);
 }
 
 int OgvReadHeaders(OgvDecoder* ogv)
@@ -65,10 +270,19 @@ int OgvReadHeaders(OgvDecoder* ogv)
 	while (!ogv->videoDecoder->headerProcessed && !OgvReadPage(ogv, &page)) {
 		serial = ogg_page_serialno(&page);
 		if (ogg_page_bos(&page)) {
-			stream = &ogv->streams[ogv->streamCount++]; 
+			if (ogv->streamCount == MAX_STREAMS) {
+				return -1;
+			}
+			stream = &ogv->streams[ogv->streamCount++];
 			stream->active = 1;
 			stream->serial = serial;
-			ogg_stream_init(&stream->state, serial);
+			if (ogv->streamCount > ogv->streamsAllocated) {
+				ogg_stream_init(&stream->state, serial);
+				ogv->streamsAllocated++;
+			} else {
+				ogg_stream_reset_serialno(&stream->state, serial);
+			}
+			ogg_stream_set_zerocopy(&stream->state, ogv->memory != NULL);
 		}
 		stream = NULL;
 		for (i = 0; i < ogv->streamCount; i++) {
@@ -113,6 +327,9 @@ int OgvReadHeaders(OgvDecoder* ogv)
 		}
 	}
 	if (ogv->videoDecoder->headerProcessed) {
+		if (ogv->pool) {
+			OgvPoolSelectContext(ogv->pool, ogv->videoDecoder);
+		}
 		if (TheoraInitialize(ogv->videoDecoder) < 0) {
 			return -1;
 		}
@@ -125,6 +342,16 @@ int OgvReadPage(OgvDecoder* ogv, ogg_page* page)
 	int bytes;
 	int ret = 0;
 	
+	if (ogv->memory) {
+		// Skips over holes, the only way to run out is the end of the clip
+		while ((ret = ogg_sync_pageout(&ogv->state, page)) != 1) {
+			if (ret == 0) {
+				return -1;
+			}
+		}
+		ogv->frameBytesRead += (int)(page->header_len + page->body_len);
+		return 0;
+	}
 	// If we've hit end of file we still need to continue processing
 	// any remaining pages that we've got buffered.
 	if (ogv->callbacks.tell_func(ogv->dataSource) == ogv->fileSize) {
@@ -144,6 +371,7 @@ int OgvReadPage(OgvDecoder* ogv, ogg_page* page)
 			// End of file. 
 			continue;
 		}
+		ogv->frameBytesRead += bytes;
 		// Update the synchronization layer with the number
 		// of bytes written to the buffer
 		ret = ogg_sync_wrote(&ogv->state, bytes);
@@ -187,8 +415,17 @@ LEMON_API int OgvDecodeFrame(OgvDecoder* ogv)
 	// Decode one frame and display it. If no frame is available we
 	// don't do anything.
 	ogg_packet packet;
+	int ret;
 	memset(&packet, 0, sizeof(packet));
-	if (!OgvReadPacket(ogv, ogv->videoStream, &packet)) {
+	ogv->frameBytesRead = 0;
+	if (ogv->statsEnabled) {
+		ogg_int64_t start = OgvClock();
+		ret = OgvReadPacket(ogv, ogv->videoStream, &packet);
+		ogv->frameReadTicks = OgvClock() - start;
+	} else {
+		ret = OgvReadPacket(ogv, ogv->videoStream, &packet);
+	}
+	if (!ret) {
 		if (TheoraHandlePacket(ogv->videoDecoder, &packet) < 0) {
 			return -1;
 		}
@@ -197,6 +434,32 @@ LEMON_API int OgvDecodeFrame(OgvDecoder* ogv)
 	return -1;
 }
 
+// Turns per-frame statistics on or off. Timing adds a few hundred clock
+// reads per frame, so leave it off unless profiling.
+LEMON_API int OgvEnableStats(OgvDecoder* ogv, int enable)
+{
+	ogv->statsEnabled = enable != 0;
+	ogv->frameReadTicks = 0;
+	return TheoraSetStatsClock(ogv->videoDecoder, enable ? OgvClock : NULL);
+}
+
+LEMON_API void OgvGetFrameStats(OgvDecoder* ogv, OgvFrameStats* stats)
+{
+	const th_dec_stats* theora = &ogv->videoDecoder->stats;
+	stats->bytesRead = ogv->frameBytesRead;
+	stats->packetBytes = (int)theora->packet_bytes;
+	stats->codedFragments = (int)theora->ncoded_frags;
+	stats->totalFragments = (int)theora->nfrags;
+	stats->keyframe = theora->keyframe;
+	stats->dupframe = theora->dupframe;
+	stats->readMs = ogv->frameReadTicks * 1e-6;
+	stats->unpackMs = theora->unpack_ticks * 1e-6;
+	stats->dcUnpredictMs = theora->dc_unpredict_ticks * 1e-6;
+	stats->reconMs = theora->recon_ticks * 1e-6;
+	stats->loopFilterMs = theora->loop_filter_ticks * 1e-6;
+	stats->postprocessMs = theora->postprocess_ticks * 1e-6;
+}
+
 LEMON_API int OgvGetVideoWidth(OgvDecoder* ogv)
 {
 	return ogv->videoDecoder->info.frame_width;
@@ -231,4 +494,61 @@ LEMON_API void DecodeRGBX8(uint8_t *dst_ptr,
 {
 	yuv420_2_rgb8888(dst_ptr, y_ptr, u_ptr, v_ptr, width, height,
 		y_span, uv_span, dst_span, yuv2rgb565_table, dither);
-}
\ No newline at end of file
+}
+
+// Converts at 1/2, 1/4 or 1/8 of the frame size (scale_shift 1..3) for
+// videos shown much smaller than they were encoded. The destination must
+// hold (width >> scale_shift) x (height >> scale_shift) pixels.
+LEMON_API void DecodeRGBX8Scaled(uint8_t *dst_ptr,
+    const uint8_t  *y_ptr,
+    const uint8_t  *u_ptr,
+    const uint8_t  *v_ptr,
+    int32_t   width,
+    int32_t   height,
+    int32_t   y_span,
+    int32_t   uv_span,
+    int32_t   dst_span,
+    int32_t   scale_shift)
+{
+	if (scale_shift < 0 || scale_shift > 3) {
+		return;
+	}
+	yuv420_2_rgb8888_scaled(dst_ptr, y_ptr, u_ptr, v_ptr, width, height,
+		y_span, uv_span, dst_span, yuv2rgb565_table, scale_shift);
+}
+// 16 bit output for memory constrained devices. dst_span is in bytes and
+// the destination holds R5G6B5 pixels with red in the top bits.
+LEMON_API void DecodeRGB565(uint8_t *dst_ptr,
+    const uint8_t  *y_ptr,
+    const uint8_t  *u_ptr,
+    const uint8_t  *v_ptr,
+    int32_t   width,
+    int32_t   height,
+    int32_t   y_span,
+    int32_t   uv_span,
+    int32_t   dst_span,
+    int32_t   dither)
+{
+	yuv420_2_rgb565(dst_ptr, y_ptr, u_ptr, v_ptr, width, height,
+		y_span, uv_span, dst_span, yuv2rgb565_table, dither);
+}
+
+// R4G4B4A4 output for videos with an alpha stream. a_ptr is the luma plane
+// of the alpha video; alpha_table is an optional 256 byte remap.
+LEMON_API void DecodeRGBA4444(uint8_t *dst_ptr,
+    const uint8_t  *y_ptr,
+    const uint8_t  *u_ptr,
+    const uint8_t  *v_ptr,
+    const uint8_t  *a_ptr,
+    int32_t   width,
+    int32_t   height,
+    int32_t   y_span,
+    int32_t   uv_span,
+    int32_t   a_span,
+    int32_t   dst_span,
+    const uint8_t  *alpha_table,
+    int32_t   dither)
+{
+	yuv420_2_rgba4444(dst_ptr, y_ptr, u_ptr, v_ptr, a_ptr, width, height,
+		y_span, uv_span, a_span, dst_span, yuv2rgb565_table, alpha_table, dither);
+}
@@ -155,6 +155,8 @@ struct th_dec_ctx{
   th_ycbcr_buffer        pp_frame_buf;
   /*The striped decode callback function.*/
   th_stripe_callback     stripe_cb;
+  /*Per-packet statistics (a Lemon extension).*/
+  th_stats_callback      stats_cb;
   oc_dec_pipeline_state  pipe;
 # if defined(OC_DEC_USE_VTABLE)
   /*Table for decoder acceleration functions.*/
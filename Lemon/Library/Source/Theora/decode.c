@@ -47,6 +47,25 @@
 /*Maximum valid post-processing level.*/
 #define OC_PP_LEVEL_MAX       (7)
 
+/*Reads the statistics clock into _t, if statistics are enabled.*/
+#define OC_DEC_STATS_START(_dec,_t) \
+  do{ \
+    if((_dec)->stats_cb.stats!=NULL)(_t)=(*(_dec)->stats_cb.clock)(); \
+  } \
+  while(0)
+/*Adds the time elapsed since _t to the given th_dec_stats counter and
+   restarts _t, if statistics are enabled.*/
+#define OC_DEC_STATS_LAP(_dec,_t,_field) \
+  do{ \
+    if((_dec)->stats_cb.stats!=NULL){ \
+      ogg_int64_t now; \
+      now=(*(_dec)->stats_cb.clock)(); \
+      (_dec)->stats_cb.stats->_field+=now-(_t); \
+      (_t)=now; \
+    } \
+  } \
+  while(0)
+
 
 
 /*The mode alphabets for the various mode coding schemes.
@@ -365,11 +384,37 @@ void oc_dec_accel_init_c(oc_dec_ctx *_dec){
 # endif
 }
 
-static int oc_dec_init(oc_dec_ctx *_dec,const th_info *_info,
+/*Loads the per-stream tables from the setup header.
+  Everything initialized here depends only on _setup, not on the frame
+   geometry, so it is shared by oc_dec_init() and th_decode_reset().*/
+static void oc_dec_setup_tables_init(oc_dec_ctx *_dec,
  const th_setup_info *_setup){
   int qti;
   int pli;
   int qi;
+  for(qi=0;qi<64;qi++)for(pli=0;pli<3;pli++)for(qti=0;qti<2;qti++){
+    _dec->state.dequant_tables[qi][pli][qti]=
+     _dec->state.dequant_table_data[qi][pli][qti];
+  }
+  oc_dequant_tables_init(_dec->state.dequant_tables,_dec->pp_dc_scale,
+   &_setup->qinfo);
+  for(qi=0;qi<64;qi++){
+    int qsum;
+    qsum=0;
+    for(qti=0;qti<2;qti++)for(pli=0;pli<3;pli++){
+      qsum+=_dec->state.dequant_tables[qi][pli][qti][12]+
+       _dec->state.dequant_tables[qi][pli][qti][17]+
+       _dec->state.dequant_tables[qi][pli][qti][18]+
+       _dec->state.dequant_tables[qi][pli][qti][24]<<(pli==0);
+    }
+    _dec->pp_sharp_mod[qi]=-(qsum>>11);
+  }
+  memcpy(_dec->state.loop_filter_limits,_setup->qinfo.loop_filter_limits,
+   sizeof(_dec->state.loop_filter_limits));
+}
+
+static int oc_dec_init(oc_dec_ctx *_dec,const th_info *_info,
+ const th_setup_info *_setup){
   int ret;
   ret=oc_state_init(&_dec->state,_info,3);
   if(ret<0)return ret;
@@ -390,25 +435,7 @@ static int oc_dec_init(oc_dec_ctx *_dec,const th_info *_info,
     oc_state_clear(&_dec->state);
     return TH_EFAULT;
   }
-  for(qi=0;qi<64;qi++)for(pli=0;pli<3;pli++)for(qti=0;qti<2;qti++){
-    _dec->state.dequant_tables[qi][pli][qti]=
-     _dec->state.dequant_table_data[qi][pli][qti];
-  }
-  oc_dequant_tables_init(_dec->state.dequant_tables,_dec->pp_dc_scale,
-   &_setup->qinfo);
-  for(qi=0;qi<64;qi++){
-    int qsum;
-    qsum=0;
-    for(qti=0;qti<2;qti++)for(pli=0;pli<3;pli++){
-      qsum+=_dec->state.dequant_tables[qi][pli][qti][12]+
-       _dec->state.dequant_tables[qi][pli][qti][17]+
-       _dec->state.dequant_tables[qi][pli][qti][18]+
-       _dec->state.dequant_tables[qi][pli][qti][24]<<(pli==0);
-    }
-    _dec->pp_sharp_mod[qi]=-(qsum>>11);
-  }
-  memcpy(_dec->state.loop_filter_limits,_setup->qinfo.loop_filter_limits,
-   sizeof(_dec->state.loop_filter_limits));
+  oc_dec_setup_tables_init(_dec,_setup);
   oc_dec_accel_init(_dec);
   _dec->pp_level=OC_PP_LEVEL_DISABLED;
   _dec->dc_qis=NULL;
@@ -416,6 +443,8 @@ static int oc_dec_init(oc_dec_ctx *_dec,const th_info *_info,
   _dec->pp_frame_data=NULL;
   _dec->stripe_cb.ctx=NULL;
   _dec->stripe_cb.stripe_decoded=NULL;
+  _dec->stats_cb.stats=NULL;
+  _dec->stats_cb.clock=NULL;
 #if defined(HAVE_CAIRO)
   _dec->telemetry=0;
   _dec->telemetry_bits=0;
@@ -1975,6 +2004,76 @@ void th_decode_free(th_dec_ctx *_dec){
   }
 }
 
+int th_decode_reset(th_dec_ctx *_dec,const th_info *_info,
+ const th_setup_info *_setup){
+  th_info *info;
+  int      ret;
+  if(_dec==NULL||_info==NULL||_setup==NULL)return TH_EFAULT;
+  info=&_dec->state.info;
+  /*The fragment arrays, border table and reference frame buffers all depend
+     on the frame and picture geometry, so those must match exactly.
+    Note that the stored pic_y has already been flipped by oc_state_init().*/
+  if(_info->frame_width!=info->frame_width||
+   _info->frame_height!=info->frame_height||
+   _info->pic_width!=info->pic_width||_info->pic_height!=info->pic_height||
+   _info->pic_x!=info->pic_x||
+   _info->frame_height-_info->pic_height-_info->pic_y!=info->pic_y||
+   _info->pixel_fmt!=info->pixel_fmt){
+    return TH_EINVAL;
+  }
+  if(_info->colorspace<0||_info->colorspace>=TH_CS_NSPACES||
+   _info->fps_numerator<1||_info->fps_denominator<1){
+    return TH_EINVAL;
+  }
+  oc_huff_trees_clear(_dec->huff_tables);
+  ret=oc_huff_trees_copy(_dec->huff_tables,
+   (const ogg_int16_t *const *)_setup->huff_tables);
+  if(ret<0){
+    /*Leave the context in a state th_decode_free() can still handle.*/
+    memset(_dec->huff_tables,0,sizeof(_dec->huff_tables));
+    return ret;
+  }
+  memcpy(info,_info,sizeof(*info));
+  info->pic_y=_info->frame_height-_info->pic_height-_info->pic_y;
+  if(_info->keyframe_granule_shift<0||_info->keyframe_granule_shift>31){
+    info->keyframe_granule_shift=31;
+  }
+  oc_dec_setup_tables_init(_dec,_setup);
+  /*Forget everything about the previous stream's frames.
+    The reference buffers themselves are kept; the first inter frame without a
+     preceding keyframe will re-initialize them via oc_dec_init_dummy_frame().*/
+  _dec->state.ref_frame_idx[OC_FRAME_GOLD]=
+   _dec->state.ref_frame_idx[OC_FRAME_PREV]=
+   _dec->state.ref_frame_idx[OC_FRAME_GOLD_ORIG]=
+   _dec->state.ref_frame_idx[OC_FRAME_PREV_ORIG]=
+   _dec->state.ref_frame_idx[OC_FRAME_SELF]=
+   _dec->state.ref_frame_idx[OC_FRAME_IO]=-1;
+  _dec->state.ref_frame_data[OC_FRAME_GOLD]=
+   _dec->state.ref_frame_data[OC_FRAME_PREV]=
+   _dec->state.ref_frame_data[OC_FRAME_GOLD_ORIG]=
+   _dec->state.ref_frame_data[OC_FRAME_PREV_ORIG]=
+   _dec->state.ref_frame_data[OC_FRAME_SELF]=
+   _dec->state.ref_frame_data[OC_FRAME_IO]=NULL;
+  _dec->state.frame_type=OC_UNKWN_FRAME;
+  _dec->state.granpos=0;
+  _dec->state.keyframe_num=0;
+  _dec->state.curframe_num=0;
+  _dec->state.granpos_bias=TH_VERSION_CHECK(_info,3,2,1);
+  /*Post-processing state is tracked per stream.*/
+  _ogg_free(_dec->pp_frame_data);
+  _ogg_free(_dec->variances);
+  _ogg_free(_dec->dc_qis);
+  _dec->pp_level=OC_PP_LEVEL_DISABLED;
+  _dec->dc_qis=NULL;
+  _dec->variances=NULL;
+  _dec->pp_frame_data=NULL;
+  _dec->stripe_cb.ctx=NULL;
+  _dec->stripe_cb.stripe_decoded=NULL;
+  _dec->stats_cb.stats=NULL;
+  _dec->stats_cb.clock=NULL;
+  return 0;
+}
+
 int th_decode_ctl(th_dec_ctx *_dec,int _req,void *_buf,
  size_t _buf_sz){
   switch(_req){
@@ -2015,6 +2114,16 @@ int th_decode_ctl(th_dec_ctx *_dec,int _req,void *_buf,
     _dec->stripe_cb.stripe_decoded=cb->stripe_decoded;
     return 0;
   }break;
+  case TH_DECCTL_SET_STATS:{
+    th_stats_callback *cb;
+    if(_dec==NULL||_buf==NULL)return TH_EFAULT;
+    if(_buf_sz!=sizeof(th_stats_callback))return TH_EINVAL;
+    cb=(th_stats_callback *)_buf;
+    if(cb->stats!=NULL&&cb->clock==NULL)return TH_EFAULT;
+    _dec->stats_cb.stats=cb->stats;
+    _dec->stats_cb.clock=cb->clock;
+    return 0;
+  }break;
 #ifdef HAVE_CAIRO
   case TH_DECCTL_SET_TELEMETRY_MBMODE:{
     if(_dec==NULL||_buf==NULL)return TH_EFAULT;
@@ -2741,8 +2850,18 @@ static void oc_render_telemetry(th_dec_ctx *_dec,th_ycbcr_buffer _ycbcr,
 
 int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
  ogg_int64_t *_granpos){
-  int ret;
+  th_dec_stats *stats;
+  ogg_int64_t   stats_t;
+  int           ret;
   if(_dec==NULL||_op==NULL)return TH_EFAULT;
+  stats=_dec->stats_cb.stats;
+  stats_t=0;
+  if(stats!=NULL){
+    memset(stats,0,sizeof(*stats));
+    stats->packet_bytes=_op->bytes;
+    stats->nfrags=(long)_dec->state.nfrags;
+    stats_t=(*_dec->stats_cb.clock)();
+  }
   /*A completely empty packet indicates a dropped frame and is treated exactly
      like an inter frame with no coded blocks.*/
   if(_op->bytes==0){
@@ -2756,6 +2875,10 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
     if(_dec->state.frame_type==OC_INTRA_FRAME)oc_dec_mark_all_intra(_dec);
     else oc_dec_coded_flags_unpack(_dec);
   }
+  if(stats!=NULL){
+    stats->keyframe=_dec->state.frame_type==OC_INTRA_FRAME;
+    stats->ncoded_frags=(long)_dec->state.ntotal_coded_fragis;
+  }
   /*If there have been no reference frames, and we need one, initialize one.*/
   if(_dec->state.frame_type!=OC_INTRA_FRAME&&
    (_dec->state.ref_frame_idx[OC_FRAME_GOLD]<0||
@@ -2770,6 +2893,10 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
      +(_dec->state.curframe_num-_dec->state.keyframe_num);
     _dec->state.curframe_num++;
     if(_granpos!=NULL)*_granpos=_dec->state.granpos;
+    if(stats!=NULL){
+      stats->dupframe=1;
+      OC_DEC_STATS_LAP(_dec,stats_t,unpack_ticks);
+    }
     return TH_DUPFRAME;
   }
   else{
@@ -2822,6 +2949,7 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
     _dec->telemetry_qi_bytes=oc_pack_bytes_left(&_dec->opb);
 #endif
     oc_dec_residual_tokens_unpack(_dec);
+    OC_DEC_STATS_LAP(_dec,stats_t,unpack_ticks);
     /*Update granule position.
       This must be done before the striped decode callbacks so that the
        application knows what to do with the frame data.*/
@@ -2875,7 +3003,9 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
         _dec->pipe.fragy_end[pli]=OC_MINI(fplane->nvfrags,
          _dec->pipe.fragy0[pli]+(_dec->pipe.mcu_nvfrags>>frag_shift));
         oc_dec_dc_unpredict_mcu_plane(_dec,&_dec->pipe,pli);
+        OC_DEC_STATS_LAP(_dec,stats_t,dc_unpredict_ticks);
         oc_dec_frags_recon_mcu_plane(_dec,&_dec->pipe,pli);
+        OC_DEC_STATS_LAP(_dec,stats_t,recon_ticks);
         sdelay=edelay=0;
         if(_dec->pipe.loop_filter){
           sdelay+=notstart;
@@ -2891,6 +3021,7 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
         oc_state_borders_fill_rows(&_dec->state,refi,pli,
          (_dec->pipe.fragy0[pli]-sdelay<<3)-(sdelay<<1),
          (_dec->pipe.fragy_end[pli]-edelay<<3)-(edelay<<1));
+        OC_DEC_STATS_LAP(_dec,stats_t,loop_filter_ticks);
         /*Out-of-loop post-processing.*/
         pp_offset=3*(pli!=0);
         if(_dec->pipe.pp_level>=OC_PP_LEVEL_DEBLOCKY+pp_offset){
@@ -2907,6 +3038,7 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
             oc_dec_dering_frag_rows(_dec,_dec->pp_frame_buf,pli,
              _dec->pipe.fragy0[pli]-sdelay,_dec->pipe.fragy_end[pli]-edelay);
           }
+          OC_DEC_STATS_LAP(_dec,stats_t,postprocess_ticks);
         }
         /*If no post-processing is done, we still need to delay a row for the
            loop filter, thanks to the strange filtering order VP3 chose.*/
@@ -2939,11 +3071,14 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
         (*_dec->stripe_cb.stripe_decoded)(_dec->stripe_cb.ctx,stripe_buf,
          _dec->state.fplanes[0].nvfrags-avail_fragy_end,
          _dec->state.fplanes[0].nvfrags-avail_fragy0);
+        /*Time spent in the application's callback is not ours.*/
+        OC_DEC_STATS_START(_dec,stats_t);
       }
       notstart=1;
     }
     /*Finish filling in the reference frame borders.*/
     for(pli=0;pli<3;pli++)oc_state_borders_fill_caps(&_dec->state,refi,pli);
+    OC_DEC_STATS_LAP(_dec,stats_t,loop_filter_ticks);
     /*Update the reference frame indices.*/
     if(_dec->state.frame_type==OC_INTRA_FRAME){
       /*The new frame becomes both the previous and gold reference frames.*/
@@ -26,14 +26,56 @@ void TheoraDispose(TheoraDecoder* theora)
 	free(theora);
 }
 
+// Prepares the decoder for reading a new stream's headers.
+// The decoder context is kept, so its frame buffers can be reused
+// by TheoraInitialize if the new stream has the same geometry.
+void TheoraReset(TheoraDecoder* theora)
+{
+	th_info_clear(&theora->info);
+	th_comment_clear(&theora->comment);
+	if (theora->setup) {
+		th_setup_free(theora->setup);
+		theora->setup = 0;
+	}
+	theora->granulepos = 0;
+	theora->headerProcessed = 0;
+	theora->statsClock = NULL;
+	memset(theora->buffer, 0, sizeof(theora->buffer));
+	memset(&theora->stats, 0, sizeof(theora->stats));
+	th_info_init(&theora->info);
+	th_comment_init(&theora->comment);
+}
+
+int TheoraContextMatches(TheoraDecoder* theora, const th_info* info)
+{
+	const th_info* ctxInfo = &theora->ctxInfo;
+	return theora->ctx != NULL &&
+		ctxInfo->frame_width == info->frame_width &&
+		ctxInfo->frame_height == info->frame_height &&
+		ctxInfo->pic_width == info->pic_width &&
+		ctxInfo->pic_height == info->pic_height &&
+		ctxInfo->pic_x == info->pic_x &&
+		ctxInfo->pic_y == info->pic_y &&
+		ctxInfo->pixel_fmt == info->pixel_fmt;
+}
+
 int TheoraInitialize(TheoraDecoder* theora)
 {
 	int ret;
 	int ppmax = 0;
-	theora->ctx = th_decode_alloc(&theora->info, theora->setup);
+	// Reuse the existing context when possible; th_decode_reset refuses
+	// (and leaves the context alone) if the geometry differs.
+	if (theora->ctx && th_decode_reset(theora->ctx, &theora->info, theora->setup) != 0) {
+		th_decode_free(theora->ctx);
+		theora->ctx = NULL;
+	}
+	if (theora->ctx == NULL) {
+		theora->ctx = th_decode_alloc(&theora->info, theora->setup);
+	}
 	if (theora->ctx == NULL) {
 		return -1;
 	}
+	theora->ctxInfo = theora->info;
 	ret = th_decode_ctl(theora->ctx, TH_DECCTL_GET_PPLEVEL_MAX, &ppmax, sizeof(ppmax));
 	if (ret != 0) {
 		return -1;
@@ -45,7 +87,22 @@ int TheoraInitialize(TheoraDecoder* theora)
 	if (ret != 0) {
 		return -1;
 	}
-	return 0;
+	return TheoraSetStatsClock(theora, theora->statsClock);
+}
+
+// Enables per-packet statistics in theora->stats, or disables them if
+// clock is NULL. Must be called after TheoraInitialize.
+int TheoraSetStatsClock(TheoraDecoder* theora, th_stats_clock_func clock)
+{
+	th_stats_callback cb;
+	theora->statsClock = clock;
+	memset(&theora->stats, 0, sizeof(theora->stats));
+	if (theora->ctx == NULL) {
+		return 0;
+	}
+	cb.stats = clock ? &theora->stats : NULL;
+	cb.clock = clock;
+	return th_decode_ctl(theora->ctx, TH_DECCTL_SET_STATS, &cb, sizeof(cb)) == 0 ? 0 : -1;
 }
 
 int TheoraHandlePacket(TheoraDecoder* theora, ogg_packet* packet) 
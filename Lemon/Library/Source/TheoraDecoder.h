@@ -7,10 +7,18 @@ typedef struct
 	th_ycbcr_buffer buffer;
 	ogg_int64_t granulepos;
 	int headerProcessed;
+	// Geometry the current ctx was allocated for
+	th_info ctxInfo;
+	// Filled by th_decode_packetin while statsClock is set
+	th_dec_stats stats;
+	th_stats_clock_func statsClock;
 } TheoraDecoder;
 
 TheoraDecoder* TheoraCreate();
+void TheoraReset(TheoraDecoder* theora);
+int TheoraContextMatches(TheoraDecoder* theora, const th_info* info);
 int TheoraInitialize(TheoraDecoder* theora);
+int TheoraSetStatsClock(TheoraDecoder* theora, th_stats_clock_func clock);
 void TheoraDispose(TheoraDecoder* theora);
 int TheoraHandlePacket(TheoraDecoder* theora, ogg_packet* packet);
 int TheoraHandleHeader(TheoraDecoder* theora, ogg_packet* packet);
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include "Threading.h"
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+typedef struct
+{
+	LemonThreadFunc func;
+	void* arg;
+} LemonThreadStartInfo;
+
+#if defined(_WIN32)
+
+static DWORD WINAPI LemonThreadProc(LPVOID param)
+{
+	LemonThreadStartInfo info = *(LemonThreadStartInfo*)param;
+	free(param);
+	info.func(info.arg);
+	return 0;
+}
+
+int LemonThreadStart(LemonThread* thread, LemonThreadFunc func, void* arg)
+{
+	LemonThreadStartInfo* info = (LemonThreadStartInfo*)malloc(sizeof(LemonThreadStartInfo));
+	info->func = func;
+	info->arg = arg;
+	*thread = CreateThread(NULL, 0, LemonThreadProc, info, 0, NULL);
+	if (*thread == NULL) {
+		free(info);
+		return -1;
+	}
+	return 0;
+}
+
+void LemonThreadJoin(LemonThread thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+
+int LemonCpuCount(void)
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+void LemonMutexInit(LemonMutex* mutex)
+{
+	InitializeCriticalSection(mutex);
+}
+
+void LemonMutexDestroy(LemonMutex* mutex)
+{
+	DeleteCriticalSection(mutex);
+}
+
+void LemonMutexLock(LemonMutex* mutex)
+{
+	EnterCriticalSection(mutex);
+}
+
+void LemonMutexUnlock(LemonMutex* mutex)
+{
+	LeaveCriticalSection(mutex);
+}
+
+int LemonAtomicIncrement(volatile int* value)
+{
+	return (int)InterlockedIncrement((volatile LONG*)value);
+}
+
+int LemonAtomicDecrement(volatile int* value)
+{
+	return (int)InterlockedDecrement((volatile LONG*)value);
+}
+
+#else
+
+static void* LemonThreadProc(void* param)
+{
+	LemonThreadStartInfo info = *(LemonThreadStartInfo*)param;
+	free(param);
+	info.func(info.arg);
+	return NULL;
+}
+
+int LemonThreadStart(LemonThread* thread, LemonThreadFunc func, void* arg)
+{
+	LemonThreadStartInfo* info = (LemonThreadStartInfo*)malloc(sizeof(LemonThreadStartInfo));
+	info->func = func;
+	info->arg = arg;
+	if (pthread_create(thread, NULL, LemonThreadProc, info) != 0) {
+		free(info);
+		return -1;
+	}
+	return 0;
+}
+
+void LemonThreadJoin(LemonThread thread)
+{
+	pthread_join(thread, NULL);
+}
+
+int LemonCpuCount(void)
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+}
+
+void LemonMutexInit(LemonMutex* mutex)
+{
+	pthread_mutex_init(mutex, NULL);
+}
+
+void LemonMutexDestroy(LemonMutex* mutex)
+{
+	pthread_mutex_destroy(mutex);
+}
+
+void LemonMutexLock(LemonMutex* mutex)
+{
+	pthread_mutex_lock(mutex);
+}
+
+void LemonMutexUnlock(LemonMutex* mutex)
+{
+	pthread_mutex_unlock(mutex);
+}
+
+int LemonAtomicIncrement(volatile int* value)
+{
+	return __sync_add_and_fetch(value, 1);
+}
+
+int LemonAtomicDecrement(volatile int* value)
+{
+	return __sync_sub_and_fetch(value, 1);
+}
+
+#endif
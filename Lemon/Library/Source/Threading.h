@@ -0,0 +1,33 @@
+// Minimal threading primitives shared by the Lemon sources:
+// Win32 on Windows, pthreads everywhere else.
+
+#ifndef LEMON_THREADING_H
+#define LEMON_THREADING_H
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef CRITICAL_SECTION LemonMutex;
+typedef HANDLE LemonThread;
+#else
+#include <pthread.h>
+typedef pthread_mutex_t LemonMutex;
+typedef pthread_t LemonThread;
+#endif
+
+typedef void (*LemonThreadFunc)(void* arg);
+
+void LemonMutexInit(LemonMutex* mutex);
+void LemonMutexDestroy(LemonMutex* mutex);
+void LemonMutexLock(LemonMutex* mutex);
+void LemonMutexUnlock(LemonMutex* mutex);
+
+// Returns 0 on success
+int LemonThreadStart(LemonThread* thread, LemonThreadFunc func, void* arg);
+void LemonThreadJoin(LemonThread thread);
+int LemonCpuCount(void);
+
+// Both return the new value
+int LemonAtomicIncrement(volatile int* value);
+int LemonAtomicDecrement(volatile int* value);
+
+#endif
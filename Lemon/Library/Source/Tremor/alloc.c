@@ -0,0 +1,275 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis 'TREMOR' CODEC SOURCE CODE.   *
+ *                                                                  *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis 'TREMOR' SOURCE CODE IS (C) COPYRIGHT 1994-2002    *
+ * BY THE Xiph.Org FOUNDATION http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: codec memory: the allocator hook and per-file arenas
+
+ An arena is a stack of blocks in one region (or a short chain of
+ them, should the first fill up), each with a small header linking it
+ to the block below.  Freeing the top block gives its space back, and
+ any freed blocks under it with it; other freed blocks go on a free
+ list for later allocations to reuse, split if they are big enough.
+ That suits the codec: setup builds up, drops its scratch and the raw
+ codebooks once the decode tables exist, and is torn down at once.
+
+ ********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "ivorbiscodec.h"
+#include "alloc.h"
+
+#if defined(_MSC_VER)
+# define VORBIS_TLS __declspec(thread)
+#else
+# define VORBIS_TLS __thread
+#endif
+
+/* every block starts on this boundary, for the SIMD paths */
+#define ARENA_ALIGN 16
+
+typedef struct arena_header{
+  size_t size;     /* usable bytes; bit 0 set while free */
+  size_t previous; /* offset of the block below, or ARENA_NONE */
+} arena_header;
+
+/* kept in the space of a freed block */
+typedef struct arena_free{
+  struct arena_free *next;
+  struct arena_free *prev;
+} arena_free;
+
+#define ARENA_NONE    ((size_t)-1)
+#define ARENA_ROUND(n) (((n)+ARENA_ALIGN-1)&~(size_t)(ARENA_ALIGN-1))
+#define ARENA_HEADER  ARENA_ROUND(sizeof(arena_header))
+#define ARENA_MIN     ARENA_ROUND(sizeof(arena_free))
+
+typedef struct arena_region{
+  struct arena_region *next;
+  char       *base;
+  size_t      size;
+  size_t      used;
+  size_t      top;   /* offset of the topmost block, or ARENA_NONE */
+  arena_free *free;
+} arena_region;
+
+struct vorbis_arena{
+  arena_region *regions; /* the newest, which takes new blocks, first */
+  size_t        region_bytes;
+};
+
+static vorbis_allocator allocator={malloc,realloc,free};
+static VORBIS_TLS vorbis_arena *current;
+
+void vorbis_set_allocator(const vorbis_allocator *a){
+  if(a){
+    allocator=*a;
+  }else{
+    allocator.malloc_func=malloc;
+    allocator.realloc_func=realloc;
+    allocator.free_func=free;
+  }
+}
+
+static arena_region *_region_new(size_t bytes){
+  arena_region *r=(arena_region *)allocator.malloc_func(sizeof(*r)+bytes+ARENA_ALIGN);
+  size_t skew;
+  if(!r)return NULL;
+  r->base=(char *)(r+1);
+  skew=(size_t)r->base&(ARENA_ALIGN-1);
+  if(skew)r->base+=ARENA_ALIGN-skew;
+  r->next=NULL;
+  r->size=bytes;
+  r->used=0;
+  r->top=ARENA_NONE;
+  r->free=NULL;
+  return r;
+}
+
+vorbis_arena *_vorbis_arena_create(size_t bytes){
+  vorbis_arena *a=(vorbis_arena *)allocator.malloc_func(sizeof(*a));
+  if(!a)return NULL;
+  a->region_bytes=bytes;
+  a->regions=_region_new(bytes);
+  if(!a->regions){
+    allocator.free_func(a);
+    return NULL;
+  }
+  return a;
+}
+
+void _vorbis_arena_destroy(vorbis_arena *a){
+  while(a->regions){
+    arena_region *next=a->regions->next;
+    allocator.free_func(a->regions);
+    a->regions=next;
+  }
+  allocator.free_func(a);
+}
+
+vorbis_arena *_vorbis_arena_enter(vorbis_arena *a){
+  vorbis_arena *previous=current;
+  current=a;
+  return previous;
+}
+
+void _vorbis_arena_leave(vorbis_arena *previous){
+  current=previous;
+}
+
+static arena_region *_arena_owner(vorbis_arena *a,void *ptr){
+  arena_region *r;
+  for(r=a->regions;r;r=r->next)
+    if((char *)ptr>=r->base && (char *)ptr<r->base+r->size)return r;
+  return NULL;
+}
+
+#define HEADER(r,offset) ((arena_header *)((r)->base+(offset)))
+#define OFFSET(r,h)      ((size_t)((char *)(h)-(r)->base))
+#define PAYLOAD(h)       ((void *)((char *)(h)+ARENA_HEADER))
+#define BLOCK(ptr)       ((arena_header *)((char *)(ptr)-ARENA_HEADER))
+
+static void _free_link(arena_region *r,arena_header *h){
+  arena_free *f=(arena_free *)PAYLOAD(h);
+  h->size|=1;
+  f->prev=NULL;
+  f->next=r->free;
+  if(r->free)r->free->prev=f;
+  r->free=f;
+}
+
+static void _free_unlink(arena_region *r,arena_header *h){
+  arena_free *f=(arena_free *)PAYLOAD(h);
+  h->size&=~(size_t)1;
+  if(f->prev)f->prev->next=f->next;
+  else r->free=f->next;
+  if(f->next)f->next->prev=f->prev;
+}
+
+/* hands out the first size bytes of free block h, putting the rest
+   back on the free list if it can hold a block of its own */
+static void *_arena_take(arena_region *r,arena_header *h,size_t size){
+  size_t have;
+  _free_unlink(r,h);
+  have=h->size;
+  if(have-size>=ARENA_HEADER+ARENA_MIN){
+    size_t offset=OFFSET(r,h);
+    size_t rest=offset+ARENA_HEADER+size;
+    size_t above=offset+ARENA_HEADER+have;
+    arena_header *tail=HEADER(r,rest);
+    tail->size=have-size-ARENA_HEADER;
+    tail->previous=offset;
+    if(above<r->used)HEADER(r,above)->previous=rest;
+    h->size=size;
+    _free_link(r,tail);
+  }
+  return PAYLOAD(h);
+}
+
+static void *_arena_alloc(vorbis_arena *a,size_t bytes){
+  arena_region *r;
+  size_t size,need;
+  arena_header *h;
+  if(bytes>((size_t)-1)/2)return NULL;
+  size=bytes>ARENA_MIN?ARENA_ROUND(bytes):ARENA_MIN;
+
+  /* first fit from what has been freed */
+  for(r=a->regions;r;r=r->next){
+    arena_free *f;
+    for(f=r->free;f;f=f->next){
+      h=BLOCK(f);
+      if((h->size&~(size_t)1)>=size)return _arena_take(r,h,size);
+    }
+  }
+
+  r=a->regions;
+  need=ARENA_HEADER+size;
+  if(r->size-r->used<need){
+    /* chain on another region, a quarter the size of the first: by
+       now the codebooks are in, and what's left to come is small */
+    size_t bytes=a->region_bytes/4;
+    arena_region *n=_region_new(need>bytes?need:bytes);
+    if(!n)return NULL;
+    n->next=r;
+    a->regions=r=n;
+  }
+  h=HEADER(r,r->used);
+  h->size=size;
+  h->previous=r->top;
+  r->top=r->used;
+  r->used+=need;
+  return PAYLOAD(h);
+}
+
+static void _arena_free(arena_region *r,void *ptr){
+  _free_link(r,BLOCK(ptr));
+  /* pop every freed block off the top */
+  while(r->top!=ARENA_NONE && (HEADER(r,r->top)->size&1)){
+    arena_header *h=HEADER(r,r->top);
+    _free_unlink(r,h);
+    r->used=r->top;
+    r->top=h->previous;
+  }
+}
+
+static void *_arena_realloc(vorbis_arena *a,arena_region *r,void *ptr,
+                            size_t bytes){
+  arena_header *h=BLOCK(ptr);
+  size_t offset=OFFSET(r,h);
+  void *moved;
+  if(bytes<=h->size)return ptr;
+  if(offset==r->top && bytes<=r->size-offset-ARENA_HEADER){
+    /* the top block grows where it is */
+    h->size=ARENA_ROUND(bytes);
+    r->used=offset+ARENA_HEADER+h->size;
+    return ptr;
+  }
+  moved=_arena_alloc(a,bytes);
+  if(!moved)return NULL;
+  memcpy(moved,ptr,h->size);
+  _arena_free(r,ptr);
+  return moved;
+}
+
+void *_vorbis_malloc(size_t bytes){
+  if(current)return _arena_alloc(current,bytes);
+  return allocator.malloc_func(bytes);
+}
+
+void *_vorbis_calloc(size_t count,size_t bytes){
+  void *ptr;
+  if(bytes && count>((size_t)-1)/2/bytes)return NULL;
+  ptr=_vorbis_malloc(count*bytes);
+  if(ptr)memset(ptr,0,count*bytes);
+  return ptr;
+}
+
+void *_vorbis_realloc(void *ptr,size_t bytes){
+  if(current){
+    arena_region *r;
+    if(!ptr)return _arena_alloc(current,bytes);
+    if((r=_arena_owner(current,ptr)))
+      return _arena_realloc(current,r,ptr,bytes);
+  }
+  return allocator.realloc_func(ptr,bytes);
+}
+
+void _vorbis_free(void *ptr){
+  if(current && ptr){
+    arena_region *r=_arena_owner(current,ptr);
+    if(r){
+      _arena_free(r,ptr);
+      return;
+    }
+  }
+  allocator.free_func(ptr);
+}
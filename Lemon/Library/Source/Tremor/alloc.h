@@ -0,0 +1,45 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis 'TREMOR' CODEC SOURCE CODE.   *
+ *                                                                  *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis 'TREMOR' SOURCE CODE IS (C) COPYRIGHT 1994-2002    *
+ * BY THE Xiph.Org FOUNDATION http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: codec memory: the allocator hook and per-file arenas
+
+ os.h points _ogg_malloc and friends here, so every allocation the
+ codec makes goes through vorbis_set_allocator's functions, or into
+ the arena current on this thread if there is one.  vorbisfile makes
+ a file's arena current for the length of each call that allocates.
+
+ ********************************************************************/
+
+#ifndef _V_ALLOC_H_
+#define _V_ALLOC_H_
+
+#include <stddef.h>
+
+typedef struct vorbis_arena vorbis_arena;
+
+extern void *_vorbis_malloc(size_t bytes);
+extern void *_vorbis_calloc(size_t count,size_t bytes);
+extern void *_vorbis_realloc(void *ptr,size_t bytes);
+extern void  _vorbis_free(void *ptr);
+
+/* bytes is the size of the first region; more are chained on if it
+   runs out */
+extern vorbis_arena *_vorbis_arena_create(size_t bytes);
+extern void _vorbis_arena_destroy(vorbis_arena *a);
+
+/* makes a (or no arena, if NULL) current and returns the one that was,
+   to be handed back to _vorbis_arena_leave */
+extern vorbis_arena *_vorbis_arena_enter(vorbis_arena *a);
+extern void _vorbis_arena_leave(vorbis_arena *previous);
+
+#endif
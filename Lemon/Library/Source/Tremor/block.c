@@ -159,6 +159,7 @@ static int _vds_init(vorbis_dsp_state *v,vorbis_info *vi){
   /* Vorbis I uses only window type 0 */
   b->window[0]=_vorbis_window(0,ci->blocksizes[0]/2);
   b->window[1]=_vorbis_window(0,ci->blocksizes[1]/2);
+  _vorbis_dsp_init(&b->dsp,_vorbis_cpu_flags());
 
   /* finish the codebooks */
   if(!ci->fullbooks){
@@ -318,30 +319,26 @@ int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
 	  /* large/large */
 	  ogg_int32_t *pcm=v->pcm[j]+prevCenter;
 	  ogg_int32_t *p=vb->pcm[j];
-	  for(i=0;i<n1;i++)
-	    pcm[i]+=p[i];
+	  b->dsp.overlap_add(pcm,p,n1);
 	}else{
 	  /* large/small */
 	  ogg_int32_t *pcm=v->pcm[j]+prevCenter+n1/2-n0/2;
 	  ogg_int32_t *p=vb->pcm[j];
-	  for(i=0;i<n0;i++)
-	    pcm[i]+=p[i];
+	  b->dsp.overlap_add(pcm,p,n0);
 	}
       }else{
 	if(v->W){
 	  /* small/large */
 	  ogg_int32_t *pcm=v->pcm[j]+prevCenter;
 	  ogg_int32_t *p=vb->pcm[j]+n1/2-n0/2;
-	  for(i=0;i<n0;i++)
-	    pcm[i]+=p[i];
-	  for(;i<n1/2+n0/2;i++)
+	  b->dsp.overlap_add(pcm,p,n0);
+	  for(i=n0;i<n1/2+n0/2;i++)
 	    pcm[i]=p[i];
 	}else{
 	  /* small/small */
 	  ogg_int32_t *pcm=v->pcm[j]+prevCenter;
 	  ogg_int32_t *p=vb->pcm[j];
-	  for(i=0;i<n0;i++)
-	    pcm[i]+=p[i];
+	  b->dsp.overlap_add(pcm,p,n0);
 	}
       }
       
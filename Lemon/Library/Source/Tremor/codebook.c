@@ -152,8 +152,8 @@ static_codebook *vorbis_staticbook_unpack(oggpack_buffer *opb){
    (and one of the first places where carefully thought out design
    turned out to be wrong; Vorbis II and future Ogg codecs should go
    to an MSb bitpacker), but not actually the huge hit it appears to
-   be.  The first-stage decode table catches most words so that
-   bitreverse is not in the main execution path. */
+   be.  The decode tables catch all words but those at the very end
+   of a packet, so that bitreverse is not in the main execution path. */
 
 static ogg_uint32_t bitreverse(ogg_uint32_t x){
   x=    ((x>>16)&0x0000ffff) | ((x<<16)&0xffff0000);
@@ -167,22 +167,33 @@ STIN long decode_packed_entry_number(codebook *book,
 					      oggpack_buffer *b){
   int  read=book->dec_maxlength;
   long lo,hi;
-  long lok = oggpack_look(b,book->dec_firsttablen);
- 
-  if (lok >= 0) {
-    long entry = book->dec_firsttable[lok];
-    if(entry&0x80000000UL){
-      lo=(entry>>15)&0x7fff;
-      hi=book->used_entries-(entry&0x7fff);
-    }else{
-      oggpack_adv(b, book->dec_codelengths[entry-1]);
-      return(entry-1);
+  long lok;
+
+  /* walk the lookup tables (see sharedbook.c); each level looks at the
+     whole word so far, so running short of packet leaves nothing to
+     undo before the search below */
+  if(book->dec_table){
+    const ogg_uint32_t *table=book->dec_table;
+    int shift=0,bits=book->dec_tablen;
+
+    while((lok=oggpack_look(b,shift+bits))>=0){
+      ogg_uint32_t entry=table[(lok>>shift)&((1<<bits)-1)];
+      if(entry&0x80000000UL){
+	table=book->dec_table+((entry&0x7fffffffUL)>>4);
+	shift+=bits;
+	bits=entry&0xf;
+      }else{
+	if(entry==0)break;
+	oggpack_adv(b,entry&0x3f);
+	return(entry>>6);
+      }
     }
-  }else{
-    lo=0;
-    hi=book->used_entries;
   }
 
+  /* end of packet, or a book with no table: bisect */
+  lo=0;
+  hi=book->used_entries;
+
   lok = oggpack_look(b, read);
 
   while(lok<0 && read>1)
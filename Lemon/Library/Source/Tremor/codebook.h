@@ -67,8 +67,9 @@ typedef struct codebook{
 
   int          *dec_index;  
   char         *dec_codelengths;
-  ogg_uint32_t *dec_firsttable;
-  int           dec_firsttablen;
+  ogg_uint32_t *dec_table;     /* multi-level lookup, see sharedbook.c;
+                                  NULL means always bisect codelist */
+  int           dec_tablen;    /* bits indexing the first level */
   int           dec_maxlength;
 
   long     q_min;       /* packed 32 bit float; quant value 0 maps to minval */
@@ -19,6 +19,7 @@
 #define _V_CODECI_H_
 
 #include "codebook.h"
+#include "dsp.h"
 
 typedef void vorbis_look_mapping;
 typedef void vorbis_look_floor;
@@ -47,6 +48,9 @@ typedef struct private_state {
 
   ogg_int64_t sample_count;
 
+  /* MDCT and windowing for this CPU */
+  vorbis_dsp_vtable dsp;
+
 } private_state;
 
 /* codec_setup_info contains all the setup information specific to the
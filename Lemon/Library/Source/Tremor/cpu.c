@@ -0,0 +1,109 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis 'TREMOR' CODEC SOURCE CODE.   *
+ *                                                                  *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis 'TREMOR' SOURCE CODE IS (C) COPYRIGHT 1994-2002    *
+ * BY THE Xiph.Org FOUNDATION http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: CPU feature detection and DSP function selection
+
+ ********************************************************************/
+
+#include "dsp.h"
+#include "window.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+/* SSE2 is part of the x86-64 baseline */
+ogg_uint32_t _vorbis_cpu_flags(void){
+  return VORBIS_CPU_SSE2;
+}
+
+#elif defined(_M_IX86) || defined(__i386__)
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# else
+#  include <cpuid.h>
+# endif
+
+ogg_uint32_t _vorbis_cpu_flags(void){
+  unsigned int regs[4]={0,0,0,0};
+# if defined(_MSC_VER)
+  __cpuid((int *)regs,1);
+# else
+  if(!__get_cpuid(1,&regs[0],&regs[1],&regs[2],&regs[3]))return 0;
+# endif
+  return (regs[3]&(1<<26))?VORBIS_CPU_SSE2:0;
+}
+
+#elif defined(__aarch64__) || defined(_M_ARM64) || \
+  defined(__ARM_NEON) || defined(__ARM_NEON__)
+/* NEON is part of ARMv8, or the whole build already assumes it */
+ogg_uint32_t _vorbis_cpu_flags(void){
+  return VORBIS_CPU_NEON;
+}
+
+#elif defined(__arm__) && defined(__linux__)
+# include <stdio.h>
+# include <string.h>
+
+/* ARMv7 without -mfpu=neon: same /proc/cpuinfo probe as Theora's
+   oc_cpu_flags_get, as /proc/self/auxv is unreliable on Android */
+ogg_uint32_t _vorbis_cpu_flags(void){
+  ogg_uint32_t flags=0;
+  FILE *fin=fopen("/proc/cpuinfo","r");
+  if(fin!=NULL){
+    char buf[512];
+    while(fgets(buf,511,fin)!=NULL){
+      if(memcmp(buf,"Features",8)==0){
+        char *p=strstr(buf," neon");
+        if(p!=NULL&&(p[5]==' '||p[5]=='\n'))flags|=VORBIS_CPU_NEON;
+      }
+    }
+    fclose(fin);
+  }
+  return flags;
+}
+
+#else
+ogg_uint32_t _vorbis_cpu_flags(void){
+  return 0;
+}
+#endif
+
+void _vorbis_dsp_init(vorbis_dsp_vtable *vt,ogg_uint32_t cpu_flags){
+  vt->mdct_presymmetry=mdct_presymmetry_c;
+  vt->mdct_butterfly_generic=mdct_butterfly_generic_c;
+  vt->mdct_bitreverse=mdct_bitreverse_c;
+  vt->mdct_postrotate=mdct_postrotate_c;
+  vt->apply_window=_vorbis_apply_window;
+  vt->overlap_add=_vorbis_overlap_add_c;
+#if !defined(_LOW_ACCURACY_)
+# if defined(_M_X64) || defined(__x86_64__) || \
+  defined(_M_IX86) || defined(__i386__)
+  if(cpu_flags&VORBIS_CPU_SSE2){
+    vt->mdct_presymmetry=mdct_presymmetry_sse2;
+    vt->mdct_butterfly_generic=mdct_butterfly_generic_sse2;
+    vt->mdct_bitreverse=mdct_bitreverse_sse2;
+    vt->mdct_postrotate=mdct_postrotate_sse2;
+    vt->apply_window=_vorbis_apply_window_sse2;
+    vt->overlap_add=_vorbis_overlap_add_sse2;
+  }
+# elif defined(__arm__) || defined(__aarch64__) || \
+  defined(_M_ARM) || defined(_M_ARM64)
+  if(cpu_flags&VORBIS_CPU_NEON){
+    vt->mdct_presymmetry=mdct_presymmetry_neon;
+    vt->mdct_butterfly_generic=mdct_butterfly_generic_neon;
+    vt->mdct_bitreverse=mdct_bitreverse_neon;
+    vt->mdct_postrotate=mdct_postrotate_neon;
+    vt->apply_window=_vorbis_apply_window_neon;
+    vt->overlap_add=_vorbis_overlap_add_neon;
+  }
+# endif
+#endif
+}
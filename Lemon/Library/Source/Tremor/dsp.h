@@ -0,0 +1,89 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis 'TREMOR' CODEC SOURCE CODE.   *
+ *                                                                  *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis 'TREMOR' SOURCE CODE IS (C) COPYRIGHT 1994-2002    *
+ * BY THE Xiph.Org FOUNDATION http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: runtime selected inverse MDCT, windowing and overlap/add
+
+ The SIMD versions produce exactly the same output as the C ones:
+ every MULT31/MULT32 is done at full 64 bit precision per lane and
+ only the order of the (wrapping, hence associative) adds changes.
+
+ ********************************************************************/
+
+#ifndef _V_DSP_H_
+#define _V_DSP_H_
+
+#include "ivorbiscodec.h"
+#include "misc.h"
+
+/* CPU features the SIMD paths need */
+#define VORBIS_CPU_SSE2 (1<<0)
+#define VORBIS_CPU_NEON (1<<1)
+
+typedef struct vorbis_dsp_vtable{
+  /* mdct_backward stages; T is the sin/cos table to walk */
+  void (*mdct_presymmetry)(ogg_int32_t *in,ogg_int32_t *out,int n,int step,
+                           LOOKUP_T *T);
+  void (*mdct_butterfly_generic)(ogg_int32_t *x,int points,int step,
+                                 LOOKUP_T *T);
+  void (*mdct_bitreverse)(ogg_int32_t *x,int n,int step,int shift,
+                          LOOKUP_T *T);
+  /* rotate stage for step>=2, ie no table interpolation */
+  void (*mdct_postrotate)(ogg_int32_t *out,int n,int step,LOOKUP_T *T);
+
+  void (*apply_window)(ogg_int32_t *d,const void *window[2],
+                       long *blocksizes,int lW,int W,int nW);
+  void (*overlap_add)(ogg_int32_t *pcm,const ogg_int32_t *p,int n);
+} vorbis_dsp_vtable;
+
+extern ogg_uint32_t _vorbis_cpu_flags(void);
+extern void _vorbis_dsp_init(vorbis_dsp_vtable *vt,ogg_uint32_t cpu_flags);
+
+/* C implementations */
+extern void mdct_presymmetry_c(ogg_int32_t *in,ogg_int32_t *out,int n,
+                               int step,LOOKUP_T *T);
+extern void mdct_butterfly_generic_c(ogg_int32_t *x,int points,int step,
+                                     LOOKUP_T *T);
+extern void mdct_bitreverse_c(ogg_int32_t *x,int n,int step,int shift,
+                              LOOKUP_T *T);
+extern void mdct_postrotate_c(ogg_int32_t *out,int n,int step,LOOKUP_T *T);
+extern void _vorbis_overlap_add_c(ogg_int32_t *pcm,const ogg_int32_t *p,int n);
+
+#if !defined(_LOW_ACCURACY_)
+extern void mdct_presymmetry_sse2(ogg_int32_t *in,ogg_int32_t *out,int n,
+                                  int step,LOOKUP_T *T);
+extern void mdct_butterfly_generic_sse2(ogg_int32_t *x,int points,int step,
+                                        LOOKUP_T *T);
+extern void mdct_bitreverse_sse2(ogg_int32_t *x,int n,int step,int shift,
+                                 LOOKUP_T *T);
+extern void mdct_postrotate_sse2(ogg_int32_t *out,int n,int step,
+                                 LOOKUP_T *T);
+extern void _vorbis_apply_window_sse2(ogg_int32_t *d,const void *window[2],
+                                      long *blocksizes,int lW,int W,int nW);
+extern void _vorbis_overlap_add_sse2(ogg_int32_t *pcm,const ogg_int32_t *p,
+                                     int n);
+
+extern void mdct_presymmetry_neon(ogg_int32_t *in,ogg_int32_t *out,int n,
+                                  int step,LOOKUP_T *T);
+extern void mdct_butterfly_generic_neon(ogg_int32_t *x,int points,int step,
+                                        LOOKUP_T *T);
+extern void mdct_bitreverse_neon(ogg_int32_t *x,int n,int step,int shift,
+                                 LOOKUP_T *T);
+extern void mdct_postrotate_neon(ogg_int32_t *out,int n,int step,
+                                 LOOKUP_T *T);
+extern void _vorbis_apply_window_neon(ogg_int32_t *d,const void *window[2],
+                                      long *blocksizes,int lW,int W,int nW);
+extern void _vorbis_overlap_add_neon(ogg_int32_t *pcm,const ogg_int32_t *p,
+                                     int n);
+#endif
+
+#endif
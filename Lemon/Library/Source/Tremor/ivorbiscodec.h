@@ -178,6 +178,18 @@ extern int      vorbis_synthesis_pcmout(vorbis_dsp_state *v,ogg_int32_t ***pcm);
 extern int      vorbis_synthesis_read(vorbis_dsp_state *v,int samples);
 extern long     vorbis_packet_blocksize(vorbis_info *vi,ogg_packet *op);
 
+/* Vorbis PRIMITIVES: memory ****************************************/
+
+/* Where the codec gets its heap memory from.  calloc is malloc plus a
+   clear.  Set it before any stream is opened; NULL restores stdlib. */
+typedef struct vorbis_allocator{
+  void *(*malloc_func)(size_t bytes);
+  void *(*realloc_func)(void *ptr,size_t bytes);
+  void  (*free_func)(void *ptr);
+} vorbis_allocator;
+
+extern void     vorbis_set_allocator(const vorbis_allocator *allocator);
+
 /* Vorbis ERRORS and return codes ***********************************/
 
 #define OV_FALSE      -1  
@@ -37,6 +37,7 @@
 #include "misc.h"
 #include "mdct.h"
 #include "mdct_lookup.h"
+#include "dsp.h"
 
 
 /* 8 point butterfly (in place) */
@@ -145,9 +146,9 @@ STIN void mdct_butterfly_32(DATA_TYPE *x){
 }
 
 /* N/stage point generic N stage butterfly (in place, 2 register) */
-STIN void mdct_butterfly_generic(DATA_TYPE *x,int points,int step){
+void mdct_butterfly_generic_c(DATA_TYPE *x,int points,int step,LOOKUP_T *T){
 
-  LOOKUP_T *T   = sincos_lookup0;
+  LOOKUP_T *T0  = T;
   DATA_TYPE *x1        = x + points      - 8;
   DATA_TYPE *x2        = x + (points>>1) - 8;
   REG_TYPE   r0;
@@ -171,7 +172,7 @@ STIN void mdct_butterfly_generic(DATA_TYPE *x,int points,int step){
     XPROD31( r1, r0, T[0], T[1], &x2[0], &x2[1] ); T+=step;
 
     x1-=8; x2-=8;
-  }while(T<sincos_lookup0+1024);
+  }while(T<T0+1024);
   do{
     r0 = x1[6] - x2[6]; x1[6] += x2[6];
     r1 = x1[7] - x2[7]; x1[7] += x2[7];
@@ -190,7 +191,7 @@ STIN void mdct_butterfly_generic(DATA_TYPE *x,int points,int step){
     XNPROD31( r0, r1, T[0], T[1], &x2[0], &x2[1] ); T-=step;
 
     x1-=8; x2-=8;
-  }while(T>sincos_lookup0);
+  }while(T>T0);
   do{
     r0 = x2[6] - x1[6]; x1[6] += x2[6];
     r1 = x2[7] - x1[7]; x1[7] += x2[7];
@@ -209,7 +210,7 @@ STIN void mdct_butterfly_generic(DATA_TYPE *x,int points,int step){
     XPROD31( r0, r1, T[0], T[1], &x2[0], &x2[1] ); T+=step;
 
     x1-=8; x2-=8;
-  }while(T<sincos_lookup0+1024);
+  }while(T<T0+1024);
   do{
     r0 = x1[6] - x2[6]; x1[6] += x2[6];
     r1 = x2[7] - x1[7]; x1[7] += x2[7];
@@ -228,17 +229,19 @@ STIN void mdct_butterfly_generic(DATA_TYPE *x,int points,int step){
     XNPROD31( r1, r0, T[0], T[1], &x2[0], &x2[1] ); T-=step;
 
     x1-=8; x2-=8;
-  }while(T>sincos_lookup0);
+  }while(T>T0);
 }
 
-STIN void mdct_butterflies(DATA_TYPE *x,int points,int shift){
+STIN void mdct_butterflies(const vorbis_dsp_vtable *vt,
+                            DATA_TYPE *x,int points,int shift){
 
   int stages=8-shift;
   int i,j;
   
   for(i=0;--stages>0;i++){
     for(j=0;j<(1<<i);j++)
-      mdct_butterfly_generic(x+(points>>i)*j,points>>i,4<<(i+shift));
+      vt->mdct_butterfly_generic(x+(points>>i)*j,points>>i,4<<(i+shift),
+                                 sincos_lookup0);
   }
 
   for(j=0;j<points;j+=32)
@@ -252,12 +255,11 @@ STIN int bitrev12(int x){
   return bitrev[x>>8]|(bitrev[(x&0x0f0)>>4]<<4)|(((int)bitrev[x&0x00f])<<8);
 }
 
-STIN void mdct_bitreverse(DATA_TYPE *x,int n,int step,int shift){
+void mdct_bitreverse_c(DATA_TYPE *x,int n,int step,int shift,LOOKUP_T *T){
 
   int          bit   = 0;
   DATA_TYPE   *w0    = x;
   DATA_TYPE   *w1    = x = w0+(n>>1);
-  LOOKUP_T    *T = (step>=4)?(sincos_lookup0+(step>>1)):sincos_lookup1;
   LOOKUP_T    *Ttop  = T+1024;
   DATA_TYPE    r2;
 
@@ -337,25 +339,17 @@ STIN void mdct_bitreverse(DATA_TYPE *x,int n,int step,int shift){
   }while(w0<w1);
 }
 
-void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out){
+/* the two rotations ahead of the butterflies */
+void mdct_presymmetry_c(DATA_TYPE *in,DATA_TYPE *out,int n,int step,
+                        LOOKUP_T *T){
   int n2=n>>1;
   int n4=n>>2;
+  LOOKUP_T *T0=T;
   DATA_TYPE *iX;
   DATA_TYPE *oX;
-  LOOKUP_T *T;
-  LOOKUP_T *V;
-  int shift;
-  int step;
-
-  for (shift=6;!(n&(1<<shift));shift++);
-  shift=13-shift;
-  step=2<<shift;
-   
-  /* rotate */
 
   iX            = in+n2-7;
   oX            = out+n2+n4;
-  T             = sincos_lookup0;
 
   do{
     oX-=4;
@@ -372,7 +366,7 @@ void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out){
 
   iX            = in+n2-8;
   oX            = out+n2+n4;
-  T             = sincos_lookup0;
+  T             = T0;
 
   do{
     T+=step; XNPROD31( iX[6], iX[4], T[0], T[1], &oX[0], &oX[1] );
@@ -386,9 +380,48 @@ void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out){
     iX-=8;
     oX+=4;
   }while(iX>=in);
+}
+
+/* rotate + window for step>=2, where the table needs no interpolation */
+void mdct_postrotate_c(DATA_TYPE *out,int n,int step,LOOKUP_T *T){
+  int n2=n>>1;
+  int n4=n>>2;
+  DATA_TYPE *oX1=out+n2+n4;
+  DATA_TYPE *oX2=out+n2+n4;
+  DATA_TYPE *iX =out;
+
+  do{
+    oX1-=4;
+    XPROD31( iX[0], -iX[1], T[0], T[1], &oX1[3], &oX2[0] ); T+=step;
+    XPROD31( iX[2], -iX[3], T[0], T[1], &oX1[2], &oX2[1] ); T+=step;
+    XPROD31( iX[4], -iX[5], T[0], T[1], &oX1[1], &oX2[2] ); T+=step;
+    XPROD31( iX[6], -iX[7], T[0], T[1], &oX1[0], &oX2[3] ); T+=step;
+    oX2+=4;
+    iX+=8;
+  }while(iX<oX1);
+}
+
+void mdct_backward(const vorbis_dsp_vtable *vt,int n,
+                   DATA_TYPE *in,DATA_TYPE *out){
+  int n2=n>>1;
+  int n4=n>>2;
+  DATA_TYPE *iX;
+  LOOKUP_T *T;
+  LOOKUP_T *V;
+  int shift;
+  int step;
 
-  mdct_butterflies(out+n2,n2,shift);
-  mdct_bitreverse(out,n,step,shift);
+  for (shift=6;!(n&(1<<shift));shift++);
+  shift=13-shift;
+  step=2<<shift;
+   
+  /* rotate */
+
+  vt->mdct_presymmetry(in,out,n,step,sincos_lookup0);
+
+  mdct_butterflies(vt,out+n2,n2,shift);
+  vt->mdct_bitreverse(out,n,step,shift,
+                      (step>=4)?(sincos_lookup0+(step>>1)):sincos_lookup1);
 
   /* rotate + window */
 
@@ -396,23 +429,14 @@ void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out){
   {
     DATA_TYPE *oX1=out+n2+n4;
     DATA_TYPE *oX2=out+n2+n4;
-    DATA_TYPE *iX =out;
+    iX =out;
 
     switch(step) {
       default: {
         T=(step>=4)?(sincos_lookup0+(step>>1)):sincos_lookup1;
-        do{
-          oX1-=4;
-	  XPROD31( iX[0], -iX[1], T[0], T[1], &oX1[3], &oX2[0] ); T+=step;
-	  XPROD31( iX[2], -iX[3], T[0], T[1], &oX1[2], &oX2[1] ); T+=step;
-	  XPROD31( iX[4], -iX[5], T[0], T[1], &oX1[1], &oX2[2] ); T+=step;
-	  XPROD31( iX[6], -iX[7], T[0], T[1], &oX1[0], &oX2[3] ); T+=step;
-	  oX2+=4;
-	  iX+=8;
-	}while(iX<oX1);
+        vt->mdct_postrotate(out,n,step,T);
 	break;
       }
-
       case 1: {
         /* linear interpolation between table values: offset=0.5, step=1 */
 	REG_TYPE  t0,t1,v0,v1;
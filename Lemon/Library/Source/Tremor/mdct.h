@@ -20,6 +20,7 @@
 
 #include "ivorbiscodec.h"
 #include "misc.h"
+#include "dsp.h"
 
 #define DATA_TYPE ogg_int32_t
 #define REG_TYPE  register ogg_int32_t
@@ -35,7 +36,8 @@
 #endif
 
 extern void mdct_forward(int n, DATA_TYPE *in, DATA_TYPE *out);
-extern void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out);
+extern void mdct_backward(const vorbis_dsp_vtable *vt,int n,
+                          DATA_TYPE *in, DATA_TYPE *out);
 
 #endif
 
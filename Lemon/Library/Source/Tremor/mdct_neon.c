@@ -0,0 +1,147 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis 'TREMOR' CODEC SOURCE CODE.   *
+ *                                                                  *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis 'TREMOR' SOURCE CODE IS (C) COPYRIGHT 1994-2002    *
+ * BY THE Xiph.Org FOUNDATION http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: NEON inverse MDCT, windowing and overlap/add
+
+ ********************************************************************/
+
+#include <string.h>
+#include "dsp.h"
+#include "window.h"
+
+#if !defined(_LOW_ACCURACY_) && (defined(__arm__) || defined(__aarch64__) || \
+  defined(_M_ARM) || defined(_M_ARM64))
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+
+typedef int32x4_t v4;
+
+#define SIMD_FN(name) name##_neon
+
+STIN v4 v4_load(const ogg_int32_t *p){
+  return vld1q_s32(p);
+}
+
+STIN void v4_store(ogg_int32_t *p,v4 v){
+  vst1q_s32(p,v);
+}
+
+STIN v4 v4_load2x2(const ogg_int32_t *p,const ogg_int32_t *q){
+  return vcombine_s32(vld1_s32(p),vld1_s32(q));
+}
+
+STIN v4 v4_add(v4 a,v4 b){
+  return vaddq_s32(a,b);
+}
+
+STIN v4 v4_sub(v4 a,v4 b){
+  return vsubq_s32(a,b);
+}
+
+STIN v4 v4_sra1(v4 a){
+  return vshrq_n_s32(a,1);
+}
+
+/* full 64 bit products; vqdmulh would round differently from MULT31 */
+STIN v4 v4_mul32(v4 a,v4 b){
+  int64x2_t lo=vmull_s32(vget_low_s32(a),vget_low_s32(b));
+  int64x2_t hi=vmull_s32(vget_high_s32(a),vget_high_s32(b));
+  return vcombine_s32(vshrn_n_s64(lo,32),vshrn_n_s64(hi,32));
+}
+
+STIN v4 v4_mul31(v4 a,v4 b){
+  return vshlq_n_s32(v4_mul32(a,b),1);
+}
+
+STIN v4 v4_swap_pairs(v4 v){
+  return vrev64q_s32(v);
+}
+
+STIN v4 v4_swap_halves(v4 v){
+  return vcombine_s32(vget_high_s32(v),vget_low_s32(v));
+}
+
+STIN v4 v4_reverse(v4 v){
+  return v4_swap_halves(vrev64q_s32(v));
+}
+
+STIN v4 v4_dup_even(v4 v){
+  return vtrnq_s32(v,v).val[0];
+}
+
+STIN v4 v4_dup_odd(v4 v){
+  return vtrnq_s32(v,v).val[1];
+}
+
+STIN v4 v4_neg(v4 v){
+  return vnegq_s32(v);
+}
+
+static const ogg_int32_t neg_odd_mask[4]={0,-1,0,-1};
+static const ogg_int32_t neg_even_mask[4]={-1,0,-1,0};
+
+STIN v4 v4_neg_odd(v4 v){
+  v4 m=vld1q_s32(neg_odd_mask);
+  return vsubq_s32(veorq_s32(v,m),m);
+}
+
+STIN v4 v4_neg_even(v4 v){
+  v4 m=vld1q_s32(neg_even_mask);
+  return vsubq_s32(veorq_s32(v,m),m);
+}
+
+STIN v4 v4_even(v4 l,v4 h){
+  return vuzpq_s32(l,h).val[0];
+}
+
+STIN v4 v4_odd(v4 l,v4 h){
+  return vuzpq_s32(l,h).val[1];
+}
+
+#include "mdct_simd.h"
+
+#else
+/* ARMv7 built without -mfpu=neon; _vorbis_cpu_flags may still report
+   it, so the entry points exist and run the C code */
+
+void mdct_presymmetry_neon(ogg_int32_t *in,ogg_int32_t *out,int n,int step,
+                           LOOKUP_T *T){
+  mdct_presymmetry_c(in,out,n,step,T);
+}
+
+void mdct_butterfly_generic_neon(ogg_int32_t *x,int points,int step,
+                                 LOOKUP_T *T){
+  mdct_butterfly_generic_c(x,points,step,T);
+}
+
+void mdct_bitreverse_neon(ogg_int32_t *x,int n,int step,int shift,
+                          LOOKUP_T *T){
+  mdct_bitreverse_c(x,n,step,shift,T);
+}
+
+void mdct_postrotate_neon(ogg_int32_t *out,int n,int step,LOOKUP_T *T){
+  mdct_postrotate_c(out,n,step,T);
+}
+
+void _vorbis_apply_window_neon(ogg_int32_t *d,const void *window[2],
+                               long *blocksizes,int lW,int W,int nW){
+  _vorbis_apply_window(d,window,blocksizes,lW,W,nW);
+}
+
+void _vorbis_overlap_add_neon(ogg_int32_t *pcm,const ogg_int32_t *p,int n){
+  _vorbis_overlap_add_c(pcm,p,n);
+}
+
+#endif
+#endif
@@ -0,0 +1,287 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis 'TREMOR' CODEC SOURCE CODE.   *
+ *                                                                  *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis 'TREMOR' SOURCE CODE IS (C) COPYRIGHT 1994-2002    *
+ * BY THE Xiph.Org FOUNDATION http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: 4 lane versions of the mdct.c and window.c kernels
+
+ Included by mdct_sse2.c and mdct_neon.c, which first define SIMD_FN
+ (the name suffix) and these operations on a v4 of 4 ogg_int32_t:
+
+   v4_load/v4_store     unaligned access
+   v4_load2x2(p,q)      { p[0], p[1], q[0], q[1] }
+   v4_add/v4_sub        wrapping, as the C code does
+   v4_sra1              arithmetic shift right by one
+   v4_mul32/v4_mul31    MULT32/MULT31 of each lane, bit exact; the
+                        second operand is a table value, never negative
+   v4_swap_pairs        { 1, 0, 3, 2 }
+   v4_swap_halves       { 2, 3, 0, 1 }
+   v4_reverse           { 3, 2, 1, 0 }
+   v4_dup_even/odd      { 0, 0, 2, 2 } / { 1, 1, 3, 3 }
+   v4_neg/v4_neg_odd/v4_neg_even
+   v4_even/v4_odd(L,H)  even or odd lanes of L then H
+
+ Complex values are kept as (re,im) lane pairs, two per vector. Each
+ XPROD31 becomes two lane-wise multiplies, P by the cosines and Q by the
+ sines, plus a swap and sign flip of one of them. The multiplies see
+ exactly the operands of the C code. The sin/cos table stores (cos,sin)
+ pairs, so loading two table entries and duplicating lanes gives both
+ coefficient vectors.
+
+ ********************************************************************/
+
+void SIMD_FN(mdct_presymmetry)(ogg_int32_t *in,ogg_int32_t *out,int n,
+                               int step,LOOKUP_T *T){
+  int n2=n>>1;
+  int n4=n>>2;
+  LOOKUP_T *T0=T;
+  ogg_int32_t *iX=in+n2-7;
+  ogg_int32_t *oX=out+n2+n4;
+  v4 E,P,Q,C;
+
+  /* { iX[0], iX[2] } pairs with T+step, { iX[4], iX[6] } with T */
+  do{
+    oX-=4;
+    E=v4_even(v4_load(iX),v4_load(iX+4));
+    C=v4_load2x2(T+step,T);
+    P=v4_mul31(E,v4_dup_even(C));
+    Q=v4_mul31(E,v4_dup_odd(C));
+    v4_store(oX,v4_add(P,v4_neg_odd(v4_swap_pairs(Q))));
+    T+=2*step;
+    iX-=8;
+  }while(iX>=in+n4);
+  do{
+    oX-=4;
+    E=v4_even(v4_load(iX),v4_load(iX+4));
+    C=v4_load2x2(T-step,T);
+    P=v4_mul31(E,v4_dup_odd(C));
+    Q=v4_mul31(E,v4_dup_even(C));
+    v4_store(oX,v4_add(P,v4_neg_odd(v4_swap_pairs(Q))));
+    T-=2*step;
+    iX-=8;
+  }while(iX>=in);
+
+  iX=in+n2-8;
+  oX=out+n2+n4;
+  T=T0;
+
+  /* { iX[6], iX[4] } pairs with T+step, { iX[2], iX[0] } with T+2*step */
+  do{
+    E=v4_reverse(v4_even(v4_load(iX),v4_load(iX+4)));
+    C=v4_load2x2(T+step,T+2*step);
+    P=v4_mul31(E,v4_dup_even(C));
+    Q=v4_mul31(E,v4_dup_odd(C));
+    v4_store(oX,v4_add(P,v4_neg_even(v4_swap_pairs(Q))));
+    T+=2*step;
+    iX-=8;
+    oX+=4;
+  }while(iX>=in+n4);
+  do{
+    E=v4_reverse(v4_even(v4_load(iX),v4_load(iX+4)));
+    C=v4_load2x2(T-step,T-2*step);
+    P=v4_mul31(E,v4_dup_odd(C));
+    Q=v4_mul31(E,v4_dup_even(C));
+    v4_store(oX,v4_add(P,v4_neg_even(v4_swap_pairs(Q))));
+    T-=2*step;
+    iX-=8;
+    oX+=4;
+  }while(iX>=in);
+}
+
+void SIMD_FN(mdct_butterfly_generic)(ogg_int32_t *x,int points,int step,
+                                     LOOKUP_T *T){
+  LOOKUP_T *T0=T;
+  ogg_int32_t *x1=x+points-8;
+  ogg_int32_t *x2=x+(points>>1)-8;
+  v4 a0,a1,b0,b1,d0,d1,P,Q,C;
+
+  /* the C code walks the pairs at 6, 4, 2, 0 one table step apart */
+#define BUTTERFLY_LOAD()                              \
+  a0=v4_load(x1);   a1=v4_load(x1+4);                 \
+  b0=v4_load(x2);   b1=v4_load(x2+4);                 \
+  v4_store(x1,v4_add(a0,b0));                         \
+  v4_store(x1+4,v4_add(a1,b1))
+#define BUTTERFLY_MUL(d,s0,s1)                        \
+  C=v4_load2x2(T+(s0),T+(s1));                        \
+  P=v4_mul31(d,v4_dup_even(C));                       \
+  Q=v4_mul31(d,v4_dup_odd(C))
+
+  do{
+    BUTTERFLY_LOAD();
+    d0=v4_neg_odd(v4_sub(a0,b0));
+    d1=v4_neg_odd(v4_sub(a1,b1));
+    BUTTERFLY_MUL(d1,step,0);
+    v4_store(x2+4,v4_add(v4_swap_pairs(P),v4_neg_odd(Q)));
+    BUTTERFLY_MUL(d0,3*step,2*step);
+    v4_store(x2,v4_add(v4_swap_pairs(P),v4_neg_odd(Q)));
+    T+=4*step;
+    x1-=8; x2-=8;
+  }while(T<T0+1024);
+  do{
+    BUTTERFLY_LOAD();
+    d0=v4_sub(a0,b0);
+    d1=v4_sub(a1,b1);
+    BUTTERFLY_MUL(d1,-step,0);
+    v4_store(x2+4,v4_add(P,v4_neg_even(v4_swap_pairs(Q))));
+    BUTTERFLY_MUL(d0,-3*step,-2*step);
+    v4_store(x2,v4_add(P,v4_neg_even(v4_swap_pairs(Q))));
+    T-=4*step;
+    x1-=8; x2-=8;
+  }while(T>T0);
+  do{
+    BUTTERFLY_LOAD();
+    d0=v4_sub(b0,a0);
+    d1=v4_sub(b1,a1);
+    BUTTERFLY_MUL(d1,step,0);
+    v4_store(x2+4,v4_add(P,v4_neg_odd(v4_swap_pairs(Q))));
+    BUTTERFLY_MUL(d0,3*step,2*step);
+    v4_store(x2,v4_add(P,v4_neg_odd(v4_swap_pairs(Q))));
+    T+=4*step;
+    x1-=8; x2-=8;
+  }while(T<T0+1024);
+  do{
+    BUTTERFLY_LOAD();
+    d0=v4_neg_odd(v4_sub(a0,b0));
+    d1=v4_neg_odd(v4_sub(a1,b1));
+    BUTTERFLY_MUL(d1,-step,0);
+    v4_store(x2+4,v4_add(v4_swap_pairs(P),v4_neg_even(Q)));
+    BUTTERFLY_MUL(d0,-3*step,-2*step);
+    v4_store(x2,v4_add(v4_swap_pairs(P),v4_neg_even(Q)));
+    T-=4*step;
+    x1-=8; x2-=8;
+  }while(T>T0);
+
+#undef BUTTERFLY_LOAD
+#undef BUTTERFLY_MUL
+}
+
+static const unsigned char SIMD_FN(bitrev)[16]=
+  {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
+
+STIN int SIMD_FN(bitrev12)(int x){
+  return SIMD_FN(bitrev)[x>>8]|(SIMD_FN(bitrev)[(x&0x0f0)>>4]<<4)|
+    (((int)SIMD_FN(bitrev)[x&0x00f])<<8);
+}
+
+void SIMD_FN(mdct_bitreverse)(ogg_int32_t *x,int n,int step,int shift,
+                              LOOKUP_T *T){
+  int bit=0;
+  ogg_int32_t *w0=x;
+  ogg_int32_t *w1=x=w0+(n>>1);
+  LOOKUP_T *Ttop=T+1024;
+  v4 A,B,S,P,Q,R,H,C;
+
+  /* two C iterations at a time, the first in lanes 0 and 1; A holds
+     x0[0..1] and B x1[0..1] of each */
+#define BITREV_LOAD()                                                 \
+  {                                                                   \
+    int ra=SIMD_FN(bitrev12)(bit++);                                  \
+    int rb=SIMD_FN(bitrev12)(bit++);                                  \
+    A=v4_load2x2(x+((ra^0xfff)>>shift)-1,x+((rb^0xfff)>>shift)-1);    \
+    B=v4_load2x2(x+(ra>>shift),x+(rb>>shift));                        \
+    S=v4_add(B,v4_neg_odd(A));                                        \
+  }
+#define BITREV_STORE()                                                \
+  R=v4_add(P,v4_neg_odd(v4_swap_pairs(Q)));                           \
+  H=v4_sra1(v4_add(v4_swap_pairs(A),v4_neg_odd(v4_swap_pairs(B))));   \
+  w1-=4;                                                              \
+  v4_store(w0,v4_add(H,R));                                           \
+  v4_store(w1,v4_swap_halves(v4_neg_odd(v4_sub(H,R))));               \
+  w0+=4
+
+  do{
+    BITREV_LOAD();
+    C=v4_load2x2(T,T+step);
+    P=v4_mul32(S,v4_dup_odd(C));
+    Q=v4_mul32(S,v4_dup_even(C));
+    T+=2*step;
+    BITREV_STORE();
+  }while(T<Ttop);
+  do{
+    BITREV_LOAD();
+    C=v4_load2x2(T-step,T-2*step);
+    P=v4_mul32(S,v4_dup_even(C));
+    Q=v4_mul32(S,v4_dup_odd(C));
+    T-=2*step;
+    BITREV_STORE();
+  }while(w0<w1);
+
+#undef BITREV_LOAD
+#undef BITREV_STORE
+}
+
+void SIMD_FN(mdct_postrotate)(ogg_int32_t *out,int n,int step,LOOKUP_T *T){
+  int n2=n>>1;
+  int n4=n>>2;
+  ogg_int32_t *oX1=out+n2+n4;
+  ogg_int32_t *oX2=out+n2+n4;
+  ogg_int32_t *iX =out;
+  v4 L,H,E,O,C0,C1,Tc,Ts;
+
+  /* the C loop runs n/16 times and its last pass reads values it has
+     just written itself, so that one stays scalar */
+  for(;iX+16<oX1;iX+=8){
+    oX1-=4;
+    L=v4_load(iX);
+    H=v4_load(iX+4);
+    E=v4_even(L,H);
+    O=v4_neg(v4_odd(L,H));
+    C0=v4_load2x2(T,T+step);
+    C1=v4_load2x2(T+2*step,T+3*step);
+    Tc=v4_even(C0,C1);
+    Ts=v4_odd(C0,C1);
+    v4_store(oX1,v4_reverse(v4_add(v4_mul31(E,Tc),v4_mul31(O,Ts))));
+    v4_store(oX2,v4_sub(v4_mul31(O,Tc),v4_mul31(E,Ts)));
+    T+=4*step;
+    oX2+=4;
+  }
+  oX1-=4;
+  XPROD31( iX[0], -iX[1], T[0], T[1], &oX1[3], &oX2[0] ); T+=step;
+  XPROD31( iX[2], -iX[3], T[0], T[1], &oX1[2], &oX2[1] ); T+=step;
+  XPROD31( iX[4], -iX[5], T[0], T[1], &oX1[1], &oX2[2] ); T+=step;
+  XPROD31( iX[6], -iX[7], T[0], T[1], &oX1[0], &oX2[3] );
+}
+
+void SIMD_FN(_vorbis_apply_window)(ogg_int32_t *d,const void *window_p[2],
+                                   long *blocksizes,int lW,int W,int nW){
+  LOOKUP_T *window[2]={window_p[0],window_p[1]};
+  long n=blocksizes[W];
+  long ln=blocksizes[lW];
+  long rn=blocksizes[nW];
+
+  long leftbegin=n/4-ln/4;
+  long leftend=leftbegin+ln/2;
+
+  long rightbegin=n/2+n/4-rn/4;
+  long rightend=rightbegin+rn/2;
+
+  long i,p;
+
+  /* block sizes are powers of two from 64, so no tails */
+  memset(d,0,leftbegin*sizeof(*d));
+
+  for(i=leftbegin,p=0;i<leftend;i+=4,p+=4)
+    v4_store(d+i,v4_mul31(v4_load(d+i),v4_load(window[lW]+p)));
+
+  for(i=rightbegin,p=rn/2-4;i<rightend;i+=4,p-=4)
+    v4_store(d+i,v4_mul31(v4_load(d+i),v4_reverse(v4_load(window[nW]+p))));
+
+  memset(d+rightend,0,(n-rightend)*sizeof(*d));
+}
+
+void SIMD_FN(_vorbis_overlap_add)(ogg_int32_t *pcm,const ogg_int32_t *p,
+                                  int n){
+  int i;
+  for(i=0;i+4<=n;i+=4)
+    v4_store(pcm+i,v4_add(v4_load(pcm+i),v4_load(p+i)));
+  for(;i<n;i++)
+    pcm[i]+=p[i];
+}
@@ -0,0 +1,152 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis 'TREMOR' CODEC SOURCE CODE.   *
+ *                                                                  *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis 'TREMOR' SOURCE CODE IS (C) COPYRIGHT 1994-2002    *
+ * BY THE Xiph.Org FOUNDATION http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: SSE2 inverse MDCT, windowing and overlap/add
+
+ ********************************************************************/
+
+#include <string.h>
+#include "dsp.h"
+#include "window.h"
+
+#if !defined(_LOW_ACCURACY_) && (defined(_M_X64) || defined(__x86_64__) || \
+  defined(_M_IX86) || defined(__i386__))
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+
+typedef __m128i v4;
+
+#define SIMD_FN(name) name##_sse2
+
+STIN v4 v4_load(const ogg_int32_t *p){
+  return _mm_loadu_si128((const __m128i *)p);
+}
+
+STIN void v4_store(ogg_int32_t *p,v4 v){
+  _mm_storeu_si128((__m128i *)p,v);
+}
+
+STIN v4 v4_load2x2(const ogg_int32_t *p,const ogg_int32_t *q){
+  return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)p),
+                            _mm_loadl_epi64((const __m128i *)q));
+}
+
+STIN v4 v4_add(v4 a,v4 b){
+  return _mm_add_epi32(a,b);
+}
+
+STIN v4 v4_sub(v4 a,v4 b){
+  return _mm_sub_epi32(a,b);
+}
+
+STIN v4 v4_sra1(v4 a){
+  return _mm_srai_epi32(a,1);
+}
+
+/* SSE2 only multiplies unsigned. With b never negative, the signed high
+   half is the unsigned one less b where a is negative */
+STIN v4 v4_mul32(v4 a,v4 b){
+  const v4 odd=_mm_set_epi32(-1,0,-1,0);
+  v4 p0=_mm_mul_epu32(a,b);
+  v4 p1=_mm_mul_epu32(_mm_srli_epi64(a,32),_mm_srli_epi64(b,32));
+  v4 hi=_mm_or_si128(_mm_srli_epi64(p0,32),_mm_and_si128(p1,odd));
+  return _mm_sub_epi32(hi,_mm_and_si128(_mm_srai_epi32(a,31),b));
+}
+
+STIN v4 v4_mul31(v4 a,v4 b){
+  return _mm_slli_epi32(v4_mul32(a,b),1);
+}
+
+STIN v4 v4_swap_pairs(v4 v){
+  return _mm_shuffle_epi32(v,_MM_SHUFFLE(2,3,0,1));
+}
+
+STIN v4 v4_swap_halves(v4 v){
+  return _mm_shuffle_epi32(v,_MM_SHUFFLE(1,0,3,2));
+}
+
+STIN v4 v4_reverse(v4 v){
+  return _mm_shuffle_epi32(v,_MM_SHUFFLE(0,1,2,3));
+}
+
+STIN v4 v4_dup_even(v4 v){
+  return _mm_shuffle_epi32(v,_MM_SHUFFLE(2,2,0,0));
+}
+
+STIN v4 v4_dup_odd(v4 v){
+  return _mm_shuffle_epi32(v,_MM_SHUFFLE(3,3,1,1));
+}
+
+STIN v4 v4_neg(v4 v){
+  return _mm_sub_epi32(_mm_setzero_si128(),v);
+}
+
+STIN v4 v4_neg_odd(v4 v){
+  const v4 m=_mm_set_epi32(-1,0,-1,0);
+  return _mm_sub_epi32(_mm_xor_si128(v,m),m);
+}
+
+STIN v4 v4_neg_even(v4 v){
+  const v4 m=_mm_set_epi32(0,-1,0,-1);
+  return _mm_sub_epi32(_mm_xor_si128(v,m),m);
+}
+
+STIN v4 v4_even(v4 l,v4 h){
+  return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(l),
+                                         _mm_castsi128_ps(h),
+                                         _MM_SHUFFLE(2,0,2,0)));
+}
+
+STIN v4 v4_odd(v4 l,v4 h){
+  return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(l),
+                                         _mm_castsi128_ps(h),
+                                         _MM_SHUFFLE(3,1,3,1)));
+}
+
+#include "mdct_simd.h"
+
+#else
+/* 32 bit x86 built without SSE2; _vorbis_cpu_flags may still report it,
+   so the entry points exist and run the C code */
+
+void mdct_presymmetry_sse2(ogg_int32_t *in,ogg_int32_t *out,int n,int step,
+                           LOOKUP_T *T){
+  mdct_presymmetry_c(in,out,n,step,T);
+}
+
+void mdct_butterfly_generic_sse2(ogg_int32_t *x,int points,int step,
+                                 LOOKUP_T *T){
+  mdct_butterfly_generic_c(x,points,step,T);
+}
+
+void mdct_bitreverse_sse2(ogg_int32_t *x,int n,int step,int shift,
+                          LOOKUP_T *T){
+  mdct_bitreverse_c(x,n,step,shift,T);
+}
+
+void mdct_postrotate_sse2(ogg_int32_t *out,int n,int step,LOOKUP_T *T){
+  mdct_postrotate_c(out,n,step,T);
+}
+
+void _vorbis_apply_window_sse2(ogg_int32_t *d,const void *window[2],
+                               long *blocksizes,int lW,int W,int nW){
+  _vorbis_apply_window(d,window,blocksizes,lW,W,nW);
+}
+
+void _vorbis_overlap_add_sse2(ogg_int32_t *pcm,const ogg_int32_t *p,int n){
+  _vorbis_overlap_add_c(pcm,p,n);
+}
+
+#endif
+#endif
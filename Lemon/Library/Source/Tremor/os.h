@@ -19,6 +19,18 @@
 
 #include <math.h>
 #include <ogg/os_types.h>
+#include "alloc.h"
+
+/* the codec allocates through its own hook and arenas, see alloc.h;
+   libogg's framing buffers stay on stdlib */
+#undef _ogg_malloc
+#undef _ogg_calloc
+#undef _ogg_realloc
+#undef _ogg_free
+#define _ogg_malloc  _vorbis_malloc
+#define _ogg_calloc  _vorbis_calloc
+#define _ogg_realloc _vorbis_realloc
+#define _ogg_free    _vorbis_free
 
 #ifndef _V_IFDEFJAIL_H_
 #  define _V_IFDEFJAIL_H_
@@ -309,7 +309,7 @@ void vorbis_book_clear(codebook *b){
 
   if(b->dec_index)_ogg_free(b->dec_index);
   if(b->dec_codelengths)_ogg_free(b->dec_codelengths);
-  if(b->dec_firsttable)_ogg_free(b->dec_firsttable);
+  if(b->dec_table)_ogg_free(b->dec_table);
 
   memset(b,0,sizeof(*b));
 }
@@ -327,9 +327,68 @@ static int sort32a(const void *a,const void *b){
     (**(ogg_uint32_t **)a<**(ogg_uint32_t **)b);
 }
 
+/* The decode table is a tree of lookup tables, each indexed by the
+   next few bits of the stream (LSb first, so with no bitreverse).  An
+   entry is one of:
+
+     0                       no codeword; only in underpopulated books
+     (index<<6)|length       a codeword of <length> bits in total
+     0x80000000|(at<<4)|bits the next <bits> bits index the table at
+                             dec_table+at
+
+   Codewords up to DEC_TABLEN bits long decode with one lookup and all
+   but the rarest with two.  codelist is sorted by bitreversed word, so
+   the codewords sharing a prefix are always a contiguous run of it. */
+
+#define DEC_TABLEN     10
+#define DEC_SUBTABLEN  6
+#define DEC_TABLE_MAX  (1<<22)
+
+/* fills the <bits> bit table at dec_table+at with codewords lo..hi-1,
+   which share their first <shift> bits, and their subtables after it;
+   with a NULL table it only counts.  Returns the entries needed. */
+static long _make_decode_table(codebook *c,ogg_uint32_t *table,long at,
+			       long lo,long hi,int shift,int bits){
+  long size=1L<<bits,used=size,i=lo;
+  while(i<hi){
+    int length=c->dec_codelengths[i];
+    ogg_uint32_t word=bitreverse(c->codelist[i])>>shift;
+
+    if(length-shift<=bits){
+      if(table){
+	long j;
+	for(j=word;j<size;j+=1L<<(length-shift))
+	  table[at+j]=((ogg_uint32_t)i<<6)|length;
+      }
+      i++;
+    }else{
+      /* a run of longer words with the same <bits> bit prefix goes
+	 into a subtable sized for the longest of them, within reason */
+      ogg_uint32_t prefix=word&(size-1);
+      int maxlength=length,subbits;
+      long end=i+1;
+      while(end<hi &&
+	    ((bitreverse(c->codelist[end])>>shift)&(size-1))==prefix){
+	if(maxlength<c->dec_codelengths[end])
+	  maxlength=c->dec_codelengths[end];
+	end++;
+      }
+      subbits=maxlength-shift-bits;
+      if(subbits>DEC_SUBTABLEN)subbits=DEC_SUBTABLEN;
+      if(table)
+	table[at+prefix]=0x80000000UL|((ogg_uint32_t)(at+used)<<4)|subbits;
+      used+=_make_decode_table(c,table,at+used,i,end,shift+bits,subbits);
+      if(used>DEC_TABLE_MAX)return(used);
+      i=end;
+    }
+  }
+  return(used);
+}
+
 /* decode codebook arrangement is more heavily optimized than encode */
 int vorbis_book_init_decode(codebook *c,const static_codebook *s){
-  int i,j,n=0,tabn;
+  int i,n=0;
+  long tabn;
   int *sortindex;
   memset(c,0,sizeof(*c));
   
@@ -392,50 +451,19 @@ int vorbis_book_init_decode(codebook *c,const static_codebook *s){
       if(s->lengthlist[i]>0)
 	c->dec_codelengths[sortindex[n++]]=s->lengthlist[i];
     
-    c->dec_firsttablen=_ilog(c->used_entries)-4; /* this is magic */
-    if(c->dec_firsttablen<5)c->dec_firsttablen=5;
-    if(c->dec_firsttablen>8)c->dec_firsttablen=8;
-    
-    tabn=1<<c->dec_firsttablen;
-    c->dec_firsttable=(ogg_uint32_t *)_ogg_calloc(tabn,sizeof(*c->dec_firsttable));
     c->dec_maxlength=0;
-    
-    for(i=0;i<n;i++){
+    for(i=0;i<n;i++)
       if(c->dec_maxlength<c->dec_codelengths[i])
 	c->dec_maxlength=c->dec_codelengths[i];
-      if(c->dec_codelengths[i]<=c->dec_firsttablen){
-	ogg_uint32_t orig=bitreverse(c->codelist[i]);
-	for(j=0;j<(1<<(c->dec_firsttablen-c->dec_codelengths[i]));j++)
-	  c->dec_firsttable[orig|(j<<c->dec_codelengths[i])]=i+1;
-      }
-    }
-    
-    /* now fill in 'unused' entries in the firsttable with hi/lo search
-       hints for the non-direct-hits */
-    {
-      ogg_uint32_t mask=0xfffffffeUL<<(31-c->dec_firsttablen);
-      long lo=0,hi=0;
-      
-      for(i=0;i<tabn;i++){
-	ogg_uint32_t word=i<<(32-c->dec_firsttablen);
-	if(c->dec_firsttable[bitreverse(word)]==0){
-	  while((lo+1)<n && c->codelist[lo+1]<=word)lo++;
-	  while(    hi<n && word>=(c->codelist[hi]&mask))hi++;
-	  
-	  /* we only actually have 15 bits per hint to play with here.
-	     In order to overflow gracefully (nothing breaks, efficiency
-	     just drops), encode as the difference from the extremes. */
-	  {
-	    unsigned long loval=lo;
-	    unsigned long hival=n-hi;
-	    
-	    if(loval>0x7fff)loval=0x7fff;
-	    if(hival>0x7fff)hival=0x7fff;
-	    c->dec_firsttable[bitreverse(word)]=
-	      0x80000000UL | (loval<<15) | hival;
-	  }
-	}
-      }
+
+    /* a book much bigger than any real one could need more table
+       than it's worth; it just decodes by bisection */
+    c->dec_tablen=c->dec_maxlength;
+    if(c->dec_tablen>DEC_TABLEN)c->dec_tablen=DEC_TABLEN;
+    tabn=_make_decode_table(c,NULL,0,0,n,0,c->dec_tablen);
+    if(tabn<=DEC_TABLE_MAX){
+      c->dec_table=(ogg_uint32_t *)_ogg_calloc(tabn,sizeof(*c->dec_table));
+      _make_decode_table(c,c->dec_table,0,0,n,0,c->dec_tablen);
     }
   }
 
@@ -27,6 +27,19 @@
 
 #include "os.h"
 #include "misc.h"
+#include "alloc.h"
+
+/* first region of an arena: enough for the setup and decode state of
+   a typical 44.1kHz stream from libvorbis */
+#define OV_ARENA_DEFAULT (256*1024)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define OV_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OV_NEON
+#include <arm_neon.h>
+#endif
 
 /* A 'chained bitstream' is a Vorbis bitstream that contains more than
    one logical bitstream arranged end to end (the only form of Ogg
@@ -61,6 +74,8 @@
 /* read a little more data from the file/pipe into the ogg_sync framer */
 static long _get_data(OggVorbis_File *vf){
   errno=0;
+  /* a file in memory is all in the framer from the start */
+  if(vf->memory)return(0);
   if(!(vf->callbacks.read_func))return(-1);
   if(vf->datasource){
     char *buffer=ogg_sync_buffer(&vf->oy,CHUNKSIZE);
@@ -74,11 +89,17 @@ static long _get_data(OggVorbis_File *vf){
 
 /* save a tiny smidge of verbosity to make the code more readable */
 static int _seek_helper(OggVorbis_File *vf,ogg_int64_t offset){
-  if(vf->datasource){
+  if(vf->memory){
+    if(offset<0 || offset>vf->memory_bytes)return OV_EREAD;
+    vf->offset=offset;
+    vf->page_index_run=0;
+    ogg_sync_wrap(&vf->oy,vf->memory+offset,(long)(vf->memory_bytes-offset));
+  }else if(vf->datasource){
     if(!(vf->callbacks.seek_func)||
        (vf->callbacks.seek_func)(vf->datasource, offset, SEEK_SET) == -1)
       return OV_EREAD;
     vf->offset=offset;
+    vf->page_index_run=0;
     ogg_sync_reset(&vf->oy);
   }else{
     /* shouldn't happen unless someone writes a broken callback */
@@ -89,6 +110,79 @@ static int _seek_helper(OggVorbis_File *vf,ogg_int64_t offset){
 
 /* The read/seek functions track absolute position within the stream */
 
+/* Seek index.  Every page _get_next_page returns since the last
+   _seek_helper was read in sequence, so the index can tell when two of
+   its entries are consecutive granulepos pages; once it has both pages
+   around a target, ov_pcm_seek_page can go straight to the first one
+   instead of bisecting.  Plain playback fills it in front to back. */
+
+static void _page_index_add(OggVorbis_File *vf,ogg_page *og,
+                            ogg_int64_t offset){
+  ogg_int64_t granulepos=ogg_page_granulepos(og);
+  ogg_int64_t run=vf->page_index_run;
+  ov_page_entry *index=vf->page_index;
+  int lo=0,hi=vf->page_index_count,follows;
+
+  if(vf->ready_state<OPENED || !vf->seekable || vf->links!=1 ||
+     !vf->serialnos || granulepos==-1 ||
+     ogg_page_serialno(og)!=vf->serialnos[0])return;
+  vf->page_index_run=offset+1;
+
+  /* entries are in offset order; playback only ever appends */
+  if(hi>0 && index[hi-1].offset<offset)
+    lo=hi;
+  else
+    while(lo<hi){
+      int mid=(lo+hi)>>1;
+      if(index[mid].offset<offset)lo=mid+1;
+      else hi=mid;
+    }
+  follows=(run && lo>0 && index[lo-1].offset+1==run);
+
+  if(lo<vf->page_index_count && index[lo].offset==offset){
+    if(follows)index[lo].follows=1;
+    return;
+  }
+  if(vf->page_index_count==vf->page_index_storage){
+    int storage=vf->page_index_storage?vf->page_index_storage*2:256;
+    index=(ov_page_entry *)_ogg_realloc(index,storage*sizeof(*index));
+    if(!index)return;
+    vf->page_index=index;
+    vf->page_index_storage=storage;
+  }
+  memmove(index+lo+1,index+lo,(vf->page_index_count-lo)*sizeof(*index));
+  index[lo].granulepos=granulepos;
+  index[lo].offset=offset;
+  index[lo].follows=follows;
+  vf->page_index_count++;
+}
+
+/* finds the last page with a granulepos below target, as the bisection
+   in ov_pcm_seek_page would; only if the index also has the page after
+   it, as otherwise another could sit in between */
+static int _page_index_find(OggVorbis_File *vf,ogg_int64_t target,
+                            ov_page_entry *found){
+  ov_page_entry *index=vf->page_index;
+  int lo=0,hi=vf->page_index_count;
+  if(vf->links!=1)return 0;
+  while(lo<hi){
+    int mid=(lo+hi)>>1;
+    if(index[mid].granulepos<target)lo=mid+1;
+    else hi=mid;
+  }
+  if(lo==0 || lo==vf->page_index_count || !index[lo].follows)return 0;
+  *found=index[lo-1];
+  return 1;
+}
+
+static void _page_index_clear(OggVorbis_File *vf){
+  if(vf->page_index)_ogg_free(vf->page_index);
+  vf->page_index=NULL;
+  vf->page_index_count=0;
+  vf->page_index_storage=0;
+  vf->page_index_run=0;
+}
+
 /* from the head of the stream, get the next page.  boundary specifies
    if the function is allowed to fetch more data from the stream (and
    how much) or only use internally buffered data.
@@ -110,8 +204,9 @@ static ogg_int64_t _get_next_page(OggVorbis_File *vf,ogg_page *og,
     more=ogg_sync_pageseek(&vf->oy,og);
 
     if(more<0){
-      /* skipped n bytes */
+      /* skipped n bytes; a page may have been lost with them */
       vf->offset-=more;
+      vf->page_index_run=0;
     }else{
       if(more==0){
         /* send more paramedics */
@@ -126,6 +221,7 @@ static ogg_int64_t _get_next_page(OggVorbis_File *vf,ogg_page *og,
            advance the internal offset past the page end */
         ogg_int64_t ret=vf->offset;
         vf->offset+=more;
+        _page_index_add(vf,og,ret);
         return(ret);
 
       }
@@ -619,7 +715,9 @@ static int _open_seekable2(OggVorbis_File *vf){
   ogg_int64_t pcmoffset = _initial_pcmoffset(vf,vf->vi);
 
   /* we can seek, so set out learning all about this file */
-  if(vf->callbacks.seek_func && vf->callbacks.tell_func){
+  if(vf->memory){
+    vf->offset=vf->end=vf->memory_bytes;
+  }else if(vf->callbacks.seek_func && vf->callbacks.tell_func){
     (vf->callbacks.seek_func)(vf->datasource,0,SEEK_END);
     vf->offset=vf->end=(vf->callbacks.tell_func)(vf->datasource);
   }else{
@@ -867,18 +965,26 @@ static int _fseek64_wrap(FILE *f,ogg_int64_t off,int whence){
 }
 
 static int _ov_open1(void *f,OggVorbis_File *vf,const char *initial,
-                     long ibytes, ov_callbacks callbacks){
+                     long ibytes, ov_callbacks callbacks,
+                     vorbis_arena *arena,
+                     const unsigned char *memory,long memory_bytes){
   int offsettest=((f && callbacks.seek_func)?callbacks.seek_func(f,0,SEEK_CUR):-1);
   ogg_uint32_t *serialno_list=NULL;
   int serialno_list_size=0;
   int ret;
+  vorbis_arena *previous;
 
   memset(vf,0,sizeof(*vf));
   vf->datasource=f;
   vf->callbacks = callbacks;
+  vf->arena=arena;
+  vf->memory=memory;
+  vf->memory_bytes=memory_bytes;
+  previous=_vorbis_arena_enter(arena);
 
   /* init the framing state */
   ogg_sync_init(&vf->oy);
+  if(memory)ogg_sync_wrap(&vf->oy,memory,memory_bytes);
 
   /* perhaps some data was previously read into a buffer for testing
      against other stream types.  Allow initialization from this
@@ -891,7 +997,7 @@ static int _ov_open1(void *f,OggVorbis_File *vf,const char *initial,
   }
 
   /* can we seek? Stevens suggests the seek test was portable */
-  if(offsettest!=-1)vf->seekable=1;
+  if(offsettest!=-1 || memory)vf->seekable=1;
 
   /* No seeking yet; Set up a 'single' (current) logical bitstream
      entry for partial open */
@@ -899,12 +1005,13 @@ static int _ov_open1(void *f,OggVorbis_File *vf,const char *initial,
   vf->vi=_ogg_calloc(vf->links,sizeof(*vf->vi));
   vf->vc=_ogg_calloc(vf->links,sizeof(*vf->vc));
   ogg_stream_init(&vf->os,-1); /* fill in the serialno later */
+  /* pages of a file in memory stay put, so packets can stay on them */
+  if(memory)ogg_stream_set_zerocopy(&vf->os,1);
 
   /* Fetch all BOS pages, store the vorbis header and all seen serial
      numbers, load subsequent vorbis setup headers */
   if((ret=_fetch_headers(vf,vf->vi,vf->vc,&serialno_list,&serialno_list_size,NULL))<0){
     vf->datasource=NULL;
-    ov_clear(vf);
   }else{
     /* serial number list for first link needs to be held somewhere
        for second stage of seekable stream open; this saves having to
@@ -922,6 +1029,8 @@ static int _ov_open1(void *f,OggVorbis_File *vf,const char *initial,
     vf->ready_state=PARTOPEN;
   }
   if(serialno_list)_ogg_free(serialno_list);
+  _vorbis_arena_leave(previous);
+  if(ret<0)ov_clear(vf);
   return(ret);
 }
 
@@ -929,7 +1038,9 @@ static int _ov_open2(OggVorbis_File *vf){
   if(vf->ready_state != PARTOPEN) return OV_EINVAL;
   vf->ready_state=OPENED;
   if(vf->seekable){
+    vorbis_arena *previous=_vorbis_arena_enter(vf->arena);
     int ret=_open_seekable2(vf);
+    _vorbis_arena_leave(previous);
     if(ret){
       vf->datasource=NULL;
       ov_clear(vf);
@@ -945,6 +1056,8 @@ static int _ov_open2(OggVorbis_File *vf){
 /* clear out the OggVorbis_File struct */
 int ov_clear(OggVorbis_File *vf){
   if(vf){
+    vorbis_arena *arena=vf->arena;
+    vorbis_arena *previous=_vorbis_arena_enter(arena);
     vorbis_block_clear(&vf->vb);
     vorbis_dsp_clear(&vf->vd);
     ogg_stream_clear(&vf->os);
@@ -962,10 +1075,13 @@ int ov_clear(OggVorbis_File *vf){
     if(vf->pcmlengths)_ogg_free(vf->pcmlengths);
     if(vf->serialnos)_ogg_free(vf->serialnos);
     if(vf->offsets)_ogg_free(vf->offsets);
+    _page_index_clear(vf);
     ogg_sync_clear(&vf->oy);
     if(vf->datasource && vf->callbacks.close_func)
       (vf->callbacks.close_func)(vf->datasource);
     memset(vf,0,sizeof(*vf));
+    _vorbis_arena_leave(previous);
+    if(arena)_vorbis_arena_destroy(arena);
   }
 #ifdef DEBUG_LEAKS
   _VDBG_dump();
@@ -983,7 +1099,48 @@ int ov_clear(OggVorbis_File *vf){
 
 int ov_open_callbacks(void *f,OggVorbis_File *vf,
     const char *initial,long ibytes,ov_callbacks callbacks){
-  int ret=_ov_open1(f,vf,initial,ibytes,callbacks);
+  int ret=_ov_open1(f,vf,initial,ibytes,callbacks,NULL,NULL,0);
+  if(ret)return ret;
+  return _ov_open2(vf);
+}
+
+/* As ov_open_callbacks, but everything the codec allocates for this
+   file comes out of one region of arena_bytes (0 for a default that
+   fits a typical stream), grown by further regions if need be, and
+   ov_clear releases it all at once.  Saves the heap a great many
+   small allocations per open and close. */
+int ov_open_arena_callbacks(void *f,OggVorbis_File *vf,
+    const char *initial,long ibytes,ov_callbacks callbacks,
+    long arena_bytes){
+  vorbis_arena *arena=_vorbis_arena_create(arena_bytes>0?
+                                           (size_t)arena_bytes:
+                                           OV_ARENA_DEFAULT);
+  int ret;
+  if(!arena)return(OV_EFAULT);
+  ret=_ov_open1(f,vf,initial,ibytes,callbacks,arena,NULL,0);
+  if(ret)return ret;
+  return _ov_open2(vf);
+}
+
+/* Opens a file held in memory, which must stay valid and unchanged
+   until ov_clear.  Rather than being copied through read callbacks,
+   pages are framed where they lie and packets are decoded straight
+   from them; only packets continued across pages are copied.
+   arena_bytes is as for ov_open_arena_callbacks, negative to use the
+   heap. */
+int ov_open_memory(const char *data,long bytes,OggVorbis_File *vf,
+    long arena_bytes){
+  vorbis_arena *arena=NULL;
+  int ret;
+  ov_callbacks callbacks={NULL,NULL,NULL,NULL};
+  if(!data || bytes<0)return(OV_EFAULT);
+  if(arena_bytes>=0){
+    arena=_vorbis_arena_create(arena_bytes>0?(size_t)arena_bytes:
+                               OV_ARENA_DEFAULT);
+    if(!arena)return(OV_EFAULT);
+  }
+  ret=_ov_open1((void *)data,vf,NULL,0,callbacks,arena,
+                (const unsigned char *)data,bytes);
   if(ret)return ret;
   return _ov_open2(vf);
 }
@@ -1018,7 +1175,7 @@ int ov_fopen(const char *path,OggVorbis_File *vf){
 int ov_test_callbacks(void *f,OggVorbis_File *vf,
     const char *initial,long ibytes,ov_callbacks callbacks)
 {
-  return _ov_open1(f,vf,initial,ibytes,callbacks);
+  return _ov_open1(f,vf,initial,ibytes,callbacks,NULL,NULL,0);
 }
 
 int ov_test(FILE *f,OggVorbis_File *vf,const char *initial,long ibytes){
@@ -1182,7 +1339,7 @@ ogg_int64_t ov_time_total(OggVorbis_File *vf,int i){
 
    returns zero on success, nonzero on failure */
 
-int ov_raw_seek(OggVorbis_File *vf,ogg_int64_t pos){
+static int _ov_raw_seek(OggVorbis_File *vf,ogg_int64_t pos){
   ogg_stream_state work_os;
   int ret;
 
@@ -1351,6 +1508,13 @@ int ov_raw_seek(OggVorbis_File *vf,ogg_int64_t pos){
   return OV_EBADLINK;
 }
 
+int ov_raw_seek(OggVorbis_File *vf,ogg_int64_t pos){
+  vorbis_arena *previous=_vorbis_arena_enter(vf->arena);
+  int ret=_ov_raw_seek(vf,pos);
+  _vorbis_arena_leave(previous);
+  return(ret);
+}
+
 /* rescales the number x from the range of [0,from] to [0,to]
    x is in the range [0,from]
    from, to are in the range [1, 1<<62-1] */
@@ -1387,7 +1551,7 @@ ogg_int64_t rescale64(ogg_int64_t x, ogg_int64_t from, ogg_int64_t to){
    Seek to the last [granule marked] page preceding the specified pos
    location, such that decoding past the returned point will quickly
    arrive at the requested position. */
-int ov_pcm_seek_page(OggVorbis_File *vf,ogg_int64_t pos){
+static int _ov_pcm_seek_page(OggVorbis_File *vf,ogg_int64_t pos){
   int link=-1;
   ogg_int64_t result=0;
   ogg_int64_t total=ov_pcm_total(vf,-1);
@@ -1417,8 +1581,14 @@ int ov_pcm_seek_page(OggVorbis_File *vf,ogg_int64_t pos){
     ogg_int64_t endtime = vf->pcmlengths[link*2+1]+begintime;
     ogg_int64_t target=pos-total+begintime;
     ogg_int64_t best=begin;
+    ov_page_entry indexed={0,0,0};
+    int use_index=_page_index_find(vf,target,&indexed);
 
     ogg_page og;
+    if(use_index){
+      best=indexed.offset;
+      begin=end; /* no need to search */
+    }
     while(begin<end){
       ogg_int64_t bisect;
 
@@ -1500,6 +1670,13 @@ int ov_pcm_seek_page(OggVorbis_File *vf,ogg_int64_t pos){
       if(result) goto seek_error;
       result=_get_next_page(vf,&og,-1);
       if(result<0) goto seek_error;
+      if(use_index && (result!=indexed.offset ||
+                       ogg_page_granulepos(&og)!=indexed.granulepos)){
+        /* the index doesn't describe this stream (a stale sidecar);
+           forget it and search properly */
+        _page_index_clear(vf);
+        return ov_pcm_seek_page(vf,pos);
+      }
 
       if(link!=vf->current_link){
         /* Different link; dump entire decode machine */
@@ -1570,10 +1747,17 @@ int ov_pcm_seek_page(OggVorbis_File *vf,ogg_int64_t pos){
   return (int)result;
 }
 
+int ov_pcm_seek_page(OggVorbis_File *vf,ogg_int64_t pos){
+  vorbis_arena *previous=_vorbis_arena_enter(vf->arena);
+  int ret=_ov_pcm_seek_page(vf,pos);
+  _vorbis_arena_leave(previous);
+  return(ret);
+}
+
 /* seek to a sample offset relative to the decompressed pcm stream
    returns zero on success, nonzero on failure */
 
-int ov_pcm_seek(OggVorbis_File *vf,ogg_int64_t pos){
+static int _ov_pcm_seek(OggVorbis_File *vf,ogg_int64_t pos){
   int thisblock,lastblock=0;
   int ret=ov_pcm_seek_page(vf,pos);
   if(ret<0)return(ret);
@@ -1666,6 +1850,13 @@ int ov_pcm_seek(OggVorbis_File *vf,ogg_int64_t pos){
   return 0;
 }
 
+int ov_pcm_seek(OggVorbis_File *vf,ogg_int64_t pos){
+  vorbis_arena *previous=_vorbis_arena_enter(vf->arena);
+  int ret=_ov_pcm_seek(vf,pos);
+  _vorbis_arena_leave(previous);
+  return(ret);
+}
+
 /* seek to a playback time relative to the decompressed pcm stream
    returns zero on success, nonzero on failure */
 int ov_time_seek(OggVorbis_File *vf,ogg_int64_t milliseconds){
@@ -1726,6 +1917,75 @@ int ov_time_seek_page(OggVorbis_File *vf,ogg_int64_t milliseconds){
   }
 }
 
+
+/* The seek index as a flat list of (granulepos, offset) pairs, for
+   saving alongside the file.  A (-1,-1) pair marks a gap: the pages
+   either side of it weren't seen in sequence.  Writes at most count
+   values and returns how many the whole index needs. */
+int ov_page_index_get(OggVorbis_File *vf,ogg_int64_t *pairs,int count){
+  int i,n=0;
+  for(i=0;i<vf->page_index_count;i++){
+    ov_page_entry *e=vf->page_index+i;
+    if(i>0 && !e->follows){
+      if(n+2<=count){
+        pairs[n]=-1;
+        pairs[n+1]=-1;
+      }
+      n+=2;
+    }
+    if(n+2<=count){
+      pairs[n]=e->granulepos;
+      pairs[n+1]=e->offset;
+    }
+    n+=2;
+  }
+  return n;
+}
+
+/* Replaces the seek index with one saved by ov_page_index_get.  It is
+   checked against the stream as seeks use it, and dropped if wrong. */
+static int _ov_page_index_set(OggVorbis_File *vf,const ogg_int64_t *pairs,
+                              int count){
+  int i,n=0,follows=0;
+  if(vf->ready_state<OPENED)return(OV_EINVAL);
+  if(!vf->seekable || vf->links!=1)return(OV_ENOSEEK);
+  if(count<0 || (count&1))return(OV_EINVAL);
+
+  _page_index_clear(vf);
+  if(count==0)return(0);
+  vf->page_index=(ov_page_entry *)_ogg_malloc(count/2*sizeof(ov_page_entry));
+  if(!vf->page_index)return(OV_EFAULT);
+  vf->page_index_storage=count/2;
+
+  for(i=0;i<count;i+=2){
+    ov_page_entry *e=vf->page_index+n;
+    if(pairs[i]==-1 && pairs[i+1]==-1){
+      follows=0;
+      continue;
+    }
+    if(pairs[i]<0 || pairs[i+1]<vf->offsets[0] || pairs[i+1]>=vf->end ||
+       (n>0 && (e[-1].offset>=pairs[i+1] || e[-1].granulepos>pairs[i]))){
+      _page_index_clear(vf);
+      return(OV_EINVAL);
+    }
+    e->granulepos=pairs[i];
+    e->offset=pairs[i+1];
+    e->follows=follows;
+    follows=1;
+    n++;
+  }
+  vf->page_index_count=n;
+  return(0);
+}
+
+int ov_page_index_set(OggVorbis_File *vf,const ogg_int64_t *pairs,
+                      int count){
+  vorbis_arena *previous=_vorbis_arena_enter(vf->arena);
+  int ret=_ov_page_index_set(vf,pairs,count);
+  _vorbis_arena_leave(previous);
+  return(ret);
+}
+
 /* tell the current stream offset cursor.  Note that seek followed by
    tell will likely not give the set offset due to caching */
 ogg_int64_t ov_raw_tell(OggVorbis_File *vf){
@@ -1831,18 +2091,18 @@ vorbis_comment *ov_comment(OggVorbis_File *vf,int link){
 
             *section) set to the logical bitstream number */
 
-long ov_read(OggVorbis_File *vf,char *buffer,int bytes_req,int *bitstream){
-  int i,j;
-
-  ogg_int32_t **pcm;
+/* fetches packets until decoded PCM is available; returns the sample
+   count with *pcm pointing at Tremor's planar fixed point output, or
+   0 at EOF, or an error */
+static long _ov_pcmout(OggVorbis_File *vf,ogg_int32_t ***pcm){
   long samples;
 
   if(vf->ready_state<OPENED)return(OV_EINVAL);
 
   while(1){
     if(vf->ready_state==INITSET){
-      samples=vorbis_synthesis_pcmout(&vf->vd,&pcm);
-      if(samples)break;
+      samples=vorbis_synthesis_pcmout(&vf->vd,pcm);
+      if(samples)return(samples);
     }
 
     /* suck in another packet */
@@ -1855,6 +2115,20 @@ long ov_read(OggVorbis_File *vf,char *buffer,int bytes_req,int *bitstream){
     }
 
   }
+}
+
+static void _ov_consume(OggVorbis_File *vf,long samples,int *bitstream){
+  vorbis_synthesis_read(&vf->vd,samples);
+  vf->pcm_offset+=samples;
+  if(bitstream)*bitstream=vf->current_link;
+}
+
+static long _ov_read(OggVorbis_File *vf,char *buffer,int bytes_req,
+                     int *bitstream){
+  int i,j;
+
+  ogg_int32_t **pcm;
+  long samples=_ov_pcmout(vf,&pcm);
 
   if(samples>0){
 
@@ -1874,11 +2148,110 @@ long ov_read(OggVorbis_File *vf,char *buffer,int bytes_req,int *bitstream){
       }
     }
 
-    vorbis_synthesis_read(&vf->vd,samples);
-    vf->pcm_offset+=samples;
-    if(bitstream)*bitstream=vf->current_link;
+    _ov_consume(vf,samples,bitstream);
     return(samples*2*channels);
   }else{
     return(samples);
   }
 }
+
+long ov_read(OggVorbis_File *vf,char *buffer,int bytes_req,int *bitstream){
+  vorbis_arena *previous=_vorbis_arena_enter(vf->arena);
+  long ret=_ov_read(vf,buffer,bytes_req,bitstream);
+  _vorbis_arena_leave(previous);
+  return(ret);
+}
+
+/* Planar variants of ov_read, for callers that mix or process the audio
+   further and would rather not lose precision and headroom to 16 bit
+   clipping. pcm_channels holds one buffer per channel of the current
+   link (see ov_info), each with room for samples_req samples.
+
+   ov_read_fixed copies Tremor's internal output as is: signed fixed
+   point with 1.0 at OV_FIXED_ONE and no clipping, so peaks above full
+   scale survive. ov_read_float converts the same values to float with
+   1.0 as full scale.
+
+   return values: <0) error/hole in data (OV_HOLE), partial open (OV_EINVAL)
+                   0) EOF
+                   n) number of samples per channel actually returned
+
+            *bitstream) set to the logical bitstream number */
+
+static long _ov_read_fixed(OggVorbis_File *vf,ogg_int32_t **pcm_channels,
+                           int samples_req,int *bitstream){
+  int i;
+
+  ogg_int32_t **pcm;
+  long samples=_ov_pcmout(vf,&pcm);
+
+  if(samples>0){
+    long channels=ov_info(vf,-1)->channels;
+
+    if(samples>samples_req)
+      samples=samples_req;
+
+    for(i=0;i<channels;i++)
+      memcpy(pcm_channels[i],pcm[i],samples*sizeof(**pcm));
+
+    _ov_consume(vf,samples,bitstream);
+  }
+  return(samples);
+}
+
+long ov_read_fixed(OggVorbis_File *vf,ogg_int32_t **pcm_channels,
+                   int samples_req,int *bitstream){
+  vorbis_arena *previous=_vorbis_arena_enter(vf->arena);
+  long ret=_ov_read_fixed(vf,pcm_channels,samples_req,bitstream);
+  _vorbis_arena_leave(previous);
+  return(ret);
+}
+
+static void _ov_fixed_to_float(float *dest,const ogg_int32_t *src,long n){
+  const float scale=1.f/OV_FIXED_ONE;
+  long j=0;
+#if defined(OV_SSE2)
+  {
+    __m128 vscale=_mm_set1_ps(scale);
+    for(;j+4<=n;j+=4){
+      __m128i v=_mm_loadu_si128((const __m128i *)(src+j));
+      _mm_storeu_ps(dest+j,_mm_mul_ps(_mm_cvtepi32_ps(v),vscale));
+    }
+  }
+#elif defined(OV_NEON)
+  /* the fixed point convert does the scaling exactly */
+  for(;j+4<=n;j+=4)
+    vst1q_f32(dest+j,vcvtq_n_f32_s32(vld1q_s32(src+j),OV_FIXED_BITS));
+#endif
+  for(;j<n;j++)
+    dest[j]=src[j]*scale;
+}
+
+static long _ov_read_float(OggVorbis_File *vf,float **pcm_channels,
+                           int samples_req,int *bitstream){
+  int i;
+
+  ogg_int32_t **pcm;
+  long samples=_ov_pcmout(vf,&pcm);
+
+  if(samples>0){
+    long channels=ov_info(vf,-1)->channels;
+
+    if(samples>samples_req)
+      samples=samples_req;
+
+    for(i=0;i<channels;i++)
+      _ov_fixed_to_float(pcm_channels[i],pcm[i],samples);
+
+    _ov_consume(vf,samples,bitstream);
+  }
+  return(samples);
+}
+
+long ov_read_float(OggVorbis_File *vf,float **pcm_channels,
+                   int samples_req,int *bitstream){
+  vorbis_arena *previous=_vorbis_arena_enter(vf->arena);
+  long ret=_ov_read_float(vf,pcm_channels,samples_req,bitstream);
+  _vorbis_arena_leave(previous);
+  return(ret);
+}
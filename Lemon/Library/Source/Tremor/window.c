@@ -19,6 +19,7 @@
 #include <math.h>
 #include "misc.h"
 #include "window.h"
+#include "dsp.h"
 #include "window_lookup.h"
 
 const void *_vorbis_window(int type, int left){
@@ -81,3 +82,9 @@ void _vorbis_apply_window(ogg_int32_t *d,const void *window_p[2],
   for(;i<n;i++)
     d[i]=0;
 }
+
+void _vorbis_overlap_add_c(ogg_int32_t *pcm,const ogg_int32_t *p,int n){
+  int i;
+  for(i=0;i<n;i++)
+    pcm[i]+=p[i];
+}
@@ -105,6 +105,41 @@ void yuv420_2_rgb8888(uint8_t  *dst_ptr,
                 const uint32_t *tables,
                       int32_t   dither);
 
+/* Converts and box-filters down by 1<<shift in both directions, see
+ * yuv420rgb8888scalec.c. shift 0 is the same as yuv420_2_rgb8888. */
+void yuv420_2_rgb8888_scaled(uint8_t  *dst_ptr,
+                       const uint8_t  *y_ptr,
+                       const uint8_t  *u_ptr,
+                       const uint8_t  *v_ptr,
+                             int32_t   width,
+                             int32_t   height,
+                             int32_t   y_span,
+                             int32_t   uv_span,
+                             int32_t   dst_span,
+                       const uint32_t *tables,
+                             int32_t   shift);
+
+/* 4x4 ordered dither matrix (values 0..15) shared by the 16 bit
+ * converters. */
+extern const uint8_t yuv2rgb_dither4x4[16];
+
+/* Converts to R4G4B4A4 taking alpha from a separate 8 bit plane, optionally
+ * remapped through a 256 entry alpha_table. See yuv420rgba4444c.c. */
+void yuv420_2_rgba4444(uint8_t  *dst_ptr,
+                 const uint8_t  *y_ptr,
+                 const uint8_t  *u_ptr,
+                 const uint8_t  *v_ptr,
+                 const uint8_t  *a_ptr,
+                       int32_t   width,
+                       int32_t   height,
+                       int32_t   y_span,
+                       int32_t   uv_span,
+                       int32_t   a_span,
+                       int32_t   dst_span,
+                 const uint32_t *tables,
+                 const uint8_t  *alpha_table,
+                       int32_t   dither);
+
 void yuv422_2_rgb8888(uint8_t  *dst_ptr,
                 const uint8_t  *y_ptr,
                 const uint8_t  *u_ptr,
@@ -0,0 +1,125 @@
+/* YUV-> RGB conversion code, 16 bit output.
+ *
+ * Uses the same packed lookup tables and fixup as yuv420rgb8888c.c, see
+ * the comment there for how they work.
+ *
+ * Each pixel is converted to 8 bit channels first and then reduced to
+ * R5G6B5 (R in the top bits, matching GL_UNSIGNED_SHORT_5_6_5). When
+ * dither is non zero a 4x4 ordered dither is added before truncating, which
+ * hides most of the banding on gradients.
+ */
+
+#include "yuv2rgb.h"
+
+enum
+{
+    YUVLIB_FLAGS         = 0x40080100
+};
+
+#define READUV(U,V) (tables[256 + (U)] + tables[512 + (V)])
+#define READY(Y)    tables[Y]
+#define FIXUP(Y)                 \
+do {                             \
+    int tmp = (Y) & YUVLIB_FLAGS;       \
+    if (tmp != 0)                \
+    {                            \
+        tmp  -= tmp>>8;          \
+        (Y)  |= tmp;             \
+        tmp   = YUVLIB_FLAGS & ~(Y>>1); \
+        (Y)  += tmp>>8;          \
+    }                            \
+} while (0 == 1)
+
+/* Channel positions in a fixed up table sum, as used by the 8888 STORE */
+#define CHAN_R(Y)   (((Y)>>11) & 0xFF)
+#define CHAN_G(Y)   (((Y)>>22) & 0xFF)
+#define CHAN_B(Y)   ((Y) & 0xFF)
+
+#define SAT(X)      ((X) > 255 ? 255 : (X))
+
+/* 4x4 Bayer matrix, 0..15 */
+const uint8_t yuv2rgb_dither4x4[16] =
+{
+     0,  8,  2, 10,
+    12,  4, 14,  6,
+     3, 11,  1,  9,
+    15,  7, 13,  5
+};
+
+#define STORE(Y,D,DSTPTR)   \
+do {                        \
+    uint32_t r = SAT(CHAN_R(Y) + ((D)>>1)); \
+    uint32_t g = SAT(CHAN_G(Y) + ((D)>>2)); \
+    uint32_t b = SAT(CHAN_B(Y) + ((D)>>1)); \
+    (DSTPTR) = (uint16_t)(((r & 0xF8)<<8) | ((g & 0xFC)<<3) | (b>>3)); \
+} while (0 == 1)
+
+/* Undithered: the top bits of each channel can be masked straight out of
+ * the table sum */
+#define STORE_TRUNC(Y,DSTPTR) \
+do {                        \
+    (DSTPTR) = (uint16_t)(((Y>>3) & 0xF800) | ((Y>>19) & 0x07E0) | ((Y>>3) & 0x001F)); \
+} while (0 == 1)
+
+void yuv420_2_rgb565(uint8_t  *dst_ptr_,
+               const uint8_t  *y_ptr,
+               const uint8_t  *u_ptr,
+               const uint8_t  *v_ptr,
+                     int32_t   width,
+                     int32_t   height,
+                     int32_t   y_span,
+                     int32_t   uv_span,
+                     int32_t   dst_span,
+               const uint32_t *tables,
+                     int32_t   dither)
+{
+    int32_t x, y;
+    dst_span >>= 1;
+    for (y = 0; y < height; y++)
+    {
+        uint16_t      *dst = (uint16_t *)(void *)dst_ptr_ + y*dst_span;
+        const uint8_t *ys  = y_ptr + y*y_span;
+        const uint8_t *us  = u_ptr + (y>>1)*uv_span;
+        const uint8_t *vs  = v_ptr + (y>>1)*uv_span;
+        const uint8_t *dith = yuv2rgb_dither4x4 + ((y & 3)<<2);
+        if (dither)
+        {
+            for (x = 0; x + 1 < width; x += 2)
+            {
+                uint32_t uv, y0, y1;
+
+                uv = READUV(us[x>>1], vs[x>>1]);
+                y0 = uv + READY(ys[x]);
+                y1 = uv + READY(ys[x+1]);
+                FIXUP(y0);
+                FIXUP(y1);
+                STORE(y0, dith[x & 3], dst[x]);
+                STORE(y1, dith[(x+1) & 3], dst[x+1]);
+            }
+        }
+        else
+        {
+            for (x = 0; x + 1 < width; x += 2)
+            {
+                uint32_t uv, y0, y1;
+
+                uv = READUV(us[x>>1], vs[x>>1]);
+                y0 = uv + READY(ys[x]);
+                y1 = uv + READY(ys[x+1]);
+                FIXUP(y0);
+                FIXUP(y1);
+                STORE_TRUNC(y0, dst[x]);
+                STORE_TRUNC(y1, dst[x+1]);
+            }
+        }
+        if (x < width)
+        {
+            /* Trailing pix */
+            uint32_t y0;
+
+            y0 = READUV(us[x>>1], vs[x>>1]) + READY(ys[x]);
+            FIXUP(y0);
+            STORE(y0, dither ? dith[x & 3] : 0, dst[x]);
+        }
+    }
+}
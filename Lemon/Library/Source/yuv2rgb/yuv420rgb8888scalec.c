@@ -0,0 +1,215 @@
+/* YUV-> RGB conversion code with integrated downscaling.
+ *
+ * Uses the same packed lookup tables and fixup as yuv420rgb8888c.c, see
+ * the comment there for how they work.
+ *
+ * Each output pixel is a box filter over a (1<<shift)x(1<<shift) block of
+ * luma samples and the matching (1<<(shift-1)) square block of chroma
+ * samples, so a 2x downscale reads each chroma sample exactly once and a
+ * 4x downscale averages 2x2 chroma samples. Averaging happens in YUV
+ * before the table lookup, so the conversion cost drops by the square of
+ * the scale factor as well.
+ *
+ * The output is (width>>shift)x(height>>shift); partial blocks on the
+ * right and bottom edges are dropped.
+ */
+
+#include "yuv2rgb.h"
+
+enum
+{
+    YUVLIB_FLAGS         = 0x40080100
+};
+
+#define READUV(U,V) (tables[256 + (U)] + tables[512 + (V)])
+#define READY(Y)    tables[Y]
+#define FIXUP(Y)                 \
+do {                             \
+    int tmp = (Y) & YUVLIB_FLAGS;       \
+    if (tmp != 0)                \
+    {                            \
+        tmp  -= tmp>>8;          \
+        (Y)  |= tmp;             \
+        tmp   = YUVLIB_FLAGS & ~(Y>>1); \
+        (Y)  += tmp>>8;          \
+    }                            \
+} while (0 == 1)
+
+/* Same channel order and opaque alpha as yuv420_2_rgb8888 */
+#define STORE(Y,DSTPTR)     \
+do {                        \
+    (DSTPTR) = 0xFF000000 | ((Y & 0xFF)<<16) | (0xFF00 & (Y>>14)) | ((0xFF0000 & (Y<<5))>>16);\
+} while (0 == 1)
+
+static void yuv420_2_rgb8888_half(uint32_t       *dst_ptr,
+                            const uint8_t  *y_ptr,
+                            const uint8_t  *u_ptr,
+                            const uint8_t  *v_ptr,
+                                  int32_t   width,
+                                  int32_t   height,
+                                  int32_t   y_span,
+                                  int32_t   uv_span,
+                                  int32_t   dst_span,
+                            const uint32_t *tables)
+{
+    int32_t x;
+    width >>= 1;
+    height >>= 1;
+    while (height-- > 0)
+    {
+        const uint8_t *y0 = y_ptr;
+        const uint8_t *y1 = y_ptr + y_span;
+        for (x = 0; x < width; x++)
+        {
+            uint32_t y, rgb;
+
+            y   = (y0[0] + y0[1] + y1[0] + y1[1] + 2) >> 2;
+            rgb = READUV(u_ptr[x], v_ptr[x]) + READY(y);
+            FIXUP(rgb);
+            STORE(rgb, dst_ptr[x]);
+            y0 += 2;
+            y1 += 2;
+        }
+        dst_ptr += dst_span;
+        y_ptr   += y_span*2;
+        u_ptr   += uv_span;
+        v_ptr   += uv_span;
+    }
+}
+
+static void yuv420_2_rgb8888_quarter(uint32_t       *dst_ptr,
+                               const uint8_t  *y_ptr,
+                               const uint8_t  *u_ptr,
+                               const uint8_t  *v_ptr,
+                                     int32_t   width,
+                                     int32_t   height,
+                                     int32_t   y_span,
+                                     int32_t   uv_span,
+                                     int32_t   dst_span,
+                               const uint32_t *tables)
+{
+    int32_t x;
+    width >>= 2;
+    height >>= 2;
+    while (height-- > 0)
+    {
+        const uint8_t *y0 = y_ptr;
+        const uint8_t *u0 = u_ptr;
+        const uint8_t *v0 = v_ptr;
+        for (x = 0; x < width; x++)
+        {
+            const uint8_t *y1 = y0 + y_span;
+            const uint8_t *y2 = y1 + y_span;
+            const uint8_t *y3 = y2 + y_span;
+            uint32_t y, u, v, rgb;
+
+            y   = y0[0] + y0[1] + y0[2] + y0[3] +
+                  y1[0] + y1[1] + y1[2] + y1[3] +
+                  y2[0] + y2[1] + y2[2] + y2[3] +
+                  y3[0] + y3[1] + y3[2] + y3[3];
+            u   = u0[0] + u0[1] + u0[uv_span] + u0[uv_span + 1];
+            v   = v0[0] + v0[1] + v0[uv_span] + v0[uv_span + 1];
+            rgb = READUV((u + 2) >> 2, (v + 2) >> 2) + READY((y + 8) >> 4);
+            FIXUP(rgb);
+            STORE(rgb, dst_ptr[x]);
+            y0 += 4;
+            u0 += 2;
+            v0 += 2;
+        }
+        dst_ptr += dst_span;
+        y_ptr   += y_span*4;
+        u_ptr   += uv_span*2;
+        v_ptr   += uv_span*2;
+    }
+}
+
+/* Generic version for larger factors */
+static void yuv420_2_rgb8888_box(uint32_t       *dst_ptr,
+                           const uint8_t  *y_ptr,
+                           const uint8_t  *u_ptr,
+                           const uint8_t  *v_ptr,
+                                 int32_t   width,
+                                 int32_t   height,
+                                 int32_t   y_span,
+                                 int32_t   uv_span,
+                                 int32_t   dst_span,
+                           const uint32_t *tables,
+                                 int32_t   shift)
+{
+    int32_t box   = 1 << shift;
+    int32_t cbox  = box >> 1;
+    int32_t yround = 1 << (2*shift - 1);
+    int32_t cround = 1 << (2*shift - 3);
+    int32_t x, i, j;
+    width >>= shift;
+    height >>= shift;
+    while (height-- > 0)
+    {
+        for (x = 0; x < width; x++)
+        {
+            const uint8_t *ys = y_ptr + x*box;
+            const uint8_t *us = u_ptr + x*cbox;
+            const uint8_t *vs = v_ptr + x*cbox;
+            uint32_t ysum = 0, usum = 0, vsum = 0, rgb;
+
+            for (j = 0; j < box; j++)
+            {
+                for (i = 0; i < box; i++)
+                    ysum += ys[i];
+                ys += y_span;
+            }
+            for (j = 0; j < cbox; j++)
+            {
+                for (i = 0; i < cbox; i++)
+                {
+                    usum += us[i];
+                    vsum += vs[i];
+                }
+                us += uv_span;
+                vs += uv_span;
+            }
+            rgb = READUV((usum + cround) >> (2*shift - 2), (vsum + cround) >> (2*shift - 2)) +
+                  READY((ysum + yround) >> (2*shift));
+            FIXUP(rgb);
+            STORE(rgb, dst_ptr[x]);
+        }
+        dst_ptr += dst_span;
+        y_ptr   += y_span << shift;
+        u_ptr   += uv_span << (shift - 1);
+        v_ptr   += uv_span << (shift - 1);
+    }
+}
+
+void yuv420_2_rgb8888_scaled(uint8_t  *dst_ptr,
+                       const uint8_t  *y_ptr,
+                       const uint8_t  *u_ptr,
+                       const uint8_t  *v_ptr,
+                             int32_t   width,
+                             int32_t   height,
+                             int32_t   y_span,
+                             int32_t   uv_span,
+                             int32_t   dst_span,
+                       const uint32_t *tables,
+                             int32_t   shift)
+{
+    if (shift == 0)
+    {
+        yuv420_2_rgb8888(dst_ptr, y_ptr, u_ptr, v_ptr, width, height,
+                         y_span, uv_span, dst_span, tables, 0);
+    }
+    else if (shift == 1)
+    {
+        yuv420_2_rgb8888_half((uint32_t *)(void *)dst_ptr, y_ptr, u_ptr, v_ptr,
+                              width, height, y_span, uv_span, dst_span >> 2, tables);
+    }
+    else if (shift == 2)
+    {
+        yuv420_2_rgb8888_quarter((uint32_t *)(void *)dst_ptr, y_ptr, u_ptr, v_ptr,
+                                 width, height, y_span, uv_span, dst_span >> 2, tables);
+    }
+    else
+    {
+        yuv420_2_rgb8888_box((uint32_t *)(void *)dst_ptr, y_ptr, u_ptr, v_ptr,
+                             width, height, y_span, uv_span, dst_span >> 2, tables, shift);
+    }
+}
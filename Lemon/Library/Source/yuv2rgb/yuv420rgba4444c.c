@@ -0,0 +1,84 @@
+/* YUV-> RGBA conversion code, 16 bit output with a separate alpha plane.
+ *
+ * Uses the same packed lookup tables and fixup as yuv420rgb8888c.c, see
+ * the comment there for how they work.
+ *
+ * Alpha videos are stored as a second stream whose luma is the alpha
+ * channel. a_ptr points to that luma plane; alpha_table (256 entries, may
+ * be NULL) remaps it before packing, e.g. to saturate near-opaque values.
+ * Output is R4G4B4A4 with R in the top bits, matching
+ * GL_UNSIGNED_SHORT_4_4_4_4. When dither is non zero the colour channels
+ * get a 4x4 ordered dither; alpha is never dithered, so edges stay stable.
+ */
+
+#include "yuv2rgb.h"
+
+enum
+{
+    YUVLIB_FLAGS         = 0x40080100
+};
+
+#define READUV(U,V) (tables[256 + (U)] + tables[512 + (V)])
+#define READY(Y)    tables[Y]
+#define FIXUP(Y)                 \
+do {                             \
+    int tmp = (Y) & YUVLIB_FLAGS;       \
+    if (tmp != 0)                \
+    {                            \
+        tmp  -= tmp>>8;          \
+        (Y)  |= tmp;             \
+        tmp   = YUVLIB_FLAGS & ~(Y>>1); \
+        (Y)  += tmp>>8;          \
+    }                            \
+} while (0 == 1)
+
+#define CHAN_R(Y)   (((Y)>>11) & 0xFF)
+#define CHAN_G(Y)   (((Y)>>22) & 0xFF)
+#define CHAN_B(Y)   ((Y) & 0xFF)
+
+#define SAT(X)      ((X) > 255 ? 255 : (X))
+
+#define STORE(Y,A,D,DSTPTR) \
+do {                        \
+    uint32_t r = SAT(CHAN_R(Y) + (D)); \
+    uint32_t g = SAT(CHAN_G(Y) + (D)); \
+    uint32_t b = SAT(CHAN_B(Y) + (D)); \
+    (DSTPTR) = (uint16_t)(((r & 0xF0)<<8) | ((g & 0xF0)<<4) | (b & 0xF0) | ((A)>>4)); \
+} while (0 == 1)
+
+void yuv420_2_rgba4444(uint8_t  *dst_ptr_,
+                 const uint8_t  *y_ptr,
+                 const uint8_t  *u_ptr,
+                 const uint8_t  *v_ptr,
+                 const uint8_t  *a_ptr,
+                       int32_t   width,
+                       int32_t   height,
+                       int32_t   y_span,
+                       int32_t   uv_span,
+                       int32_t   a_span,
+                       int32_t   dst_span,
+                 const uint32_t *tables,
+                 const uint8_t  *alpha_table,
+                       int32_t   dither)
+{
+    int32_t x, y;
+    dst_span >>= 1;
+    for (y = 0; y < height; y++)
+    {
+        uint16_t      *dst = (uint16_t *)(void *)dst_ptr_ + y*dst_span;
+        const uint8_t *ys  = y_ptr + y*y_span;
+        const uint8_t *us  = u_ptr + (y>>1)*uv_span;
+        const uint8_t *vs  = v_ptr + (y>>1)*uv_span;
+        const uint8_t *as  = a_ptr + y*a_span;
+        const uint8_t *dith = yuv2rgb_dither4x4 + ((y & 3)<<2);
+        for (x = 0; x < width; x++)
+        {
+            uint32_t rgb, a;
+
+            rgb = READUV(us[x>>1], vs[x>>1]) + READY(ys[x]);
+            FIXUP(rgb);
+            a = alpha_table ? alpha_table[as[x]] : as[x];
+            STORE(rgb, a, dither ? dith[x & 3] : 0, dst[x]);
+        }
+    }
+}
@@ -93,6 +93,16 @@ namespace Lime
 			PlatformAudioSystem.StopGroup(group, fadeoutTime);
 		}
 
+		/// <summary>
+		/// Decodes short sounds ahead of time, e.g. while loading a level,
+		/// so that playing them later doesn't decode anything. Takes the same
+		/// paths as Play and blocks until the sounds are decoded.
+		/// </summary>
+		public static void Prewarm(IEnumerable<string> paths)
+		{
+			PlatformAudioSystem.Prewarm(paths);
+		}
+
 		public static void Update()
 		{
 			PlatformAudioSystem.Update();
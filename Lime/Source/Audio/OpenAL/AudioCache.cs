@@ -4,9 +4,24 @@ using System.Collections.Generic;
 using System.ComponentModel;
 using System.IO;
 using System.Linq;
+using System.Runtime.InteropServices;
 
 namespace Lime
 {
+	/// <summary>
+	/// Stream over a cached sample. Decoders may read Data directly instead
+	/// of going through the stream.
+	/// </summary>
+	internal class SampleStream : MemoryStream
+	{
+		public readonly byte[] Data;
+
+		public SampleStream(byte[] data) : base(data, false)
+		{
+			Data = data;
+		}
+	}
+
 	internal class AudioCache
 	{
 		class CachedSample
@@ -17,10 +32,15 @@ namespace Lime
 
 		public const int MaxCachedSampleSize = 256 * 1024;
 		public const int MaxCacheSize = 4 * 1024 * 1024;
+		// Short Ogg sounds are also kept decoded, so replaying them costs no
+		// decode at all. The budget is in bytes of 16 bit PCM.
+		public const int MaxPcmCachedSampleSize = 64 * 1024;
+		public const int MaxPcmCacheSize = 8 * 1024 * 1024;
 		public int CacheSize { get { return CalcCacheSize(); } }
 
 		private readonly List<CachedSample> samples = new List<CachedSample>();
 		private readonly object sync = new object();
+		private readonly IntPtr pcmCache = Lemon.Api.OggPcmCacheCreate(MaxPcmCacheSize);
 
 		private int CalcCacheSize()
 		{
@@ -68,20 +88,128 @@ namespace Lime
 					var memStream = new MemoryStream((int)stream.Length);
 					stream.CopyTo(memStream);
 					memStream.Position = 0;
+					var data = memStream.GetBuffer();
 					Cleanup();
 					lock (sync) {
 						if (samples.FindIndex(i => i.Path == path) < 0) {
 							samples.Add(new CachedSample {
-								Data = memStream.GetBuffer(),
+								Data = data,
 								Path = path
 							});
 						}
 					}
+					if (data.Length <= MaxPcmCachedSampleSize && OggDecoder.IsOggStream(memStream)) {
+						CachePcm(path, data);
+					}
 				}
 			};
 			bw.RunWorkerAsync();
 		}
 
+		private void CachePcm(string path, byte[] data)
+		{
+			var handle = GCHandle.Alloc(data, GCHandleType.Pinned);
+			try {
+				var entry = Lemon.Api.OggPcmCacheInsert(pcmCache, path, handle.AddrOfPinnedObject(), data.Length);
+				if (entry != IntPtr.Zero) {
+					Lemon.Api.OggPcmRelease(entry);
+				}
+			} finally {
+				handle.Free();
+			}
+		}
+
+		/// <summary>
+		/// Decodes the given sounds into the PCM cache at once, spreading the
+		/// work over all cores. Meant for level loading, so that the first
+		/// play of each sound is already a cache hit. Sounds that are not Ogg,
+		/// are too big for the PCM cache or are already cached are skipped.
+		/// </summary>
+		public void Prewarm(IEnumerable<string> paths)
+		{
+			var keys = new List<string>();
+			var handles = new List<GCHandle>();
+			try {
+				foreach (var path in paths) {
+					if (keys.Contains(path) || IsPcmCached(path)) {
+						continue;
+					}
+					var data = ReadPcmCandidate(path);
+					if (data != null) {
+						keys.Add(path);
+						handles.Add(GCHandle.Alloc(data, GCHandleType.Pinned));
+					}
+				}
+				if (keys.Count == 0) {
+					return;
+				}
+				var items = new Lemon.Api.OggBatchItem[keys.Count];
+				for (int i = 0; i < items.Length; i++) {
+					items[i].Data = handles[i].AddrOfPinnedObject();
+					items[i].Length = ((byte[])handles[i].Target).Length;
+				}
+				Lemon.Api.OggDecodeBatch(items, items.Length, 0);
+				for (int i = 0; i < items.Length; i++) {
+					var item = items[i];
+					if (item.Error != 0) {
+						Logger.Write("Error decoding audio file '{0}': {1}", keys[i], item.Error);
+						continue;
+					}
+					// The cache takes over the decoded buffer
+					var entry = Lemon.Api.OggPcmCacheAdopt(pcmCache, keys[i], item.Pcm, item.Size, item.Channels, item.Frequency);
+					Lemon.Api.OggPcmRelease(entry);
+				}
+			} finally {
+				foreach (var handle in handles) {
+					handle.Free();
+				}
+			}
+		}
+
+		private bool IsPcmCached(string path)
+		{
+			var entry = Lemon.Api.OggPcmCacheAcquire(pcmCache, path);
+			if (entry == IntPtr.Zero) {
+				return false;
+			}
+			Lemon.Api.OggPcmRelease(entry);
+			return true;
+		}
+
+		private static byte[] ReadPcmCandidate(string path)
+		{
+			if (!AssetBundle.Current.FileExists(path)) {
+				Logger.Write("Missing audio file '{0}'", path);
+				return null;
+			}
+			using (var stream = AssetBundle.Current.OpenFileLocalized(path)) {
+				if (stream.Length > MaxPcmCachedSampleSize) {
+					return null;
+				}
+				var data = new byte[stream.Length];
+				int read = 0;
+				while (read < data.Length) {
+					int n = stream.Read(data, read, data.Length - read);
+					if (n <= 0) {
+						return null;
+					}
+					read += n;
+				}
+				var isOgg = data.Length >= 4 && data[0] == 'O' && data[1] == 'g' && data[2] == 'g' && data[3] == 'S';
+				return isOgg ? data : null;
+			}
+		}
+
+		/// <summary>
+		/// Returns a decoder over the already decoded samples, or null if the
+		/// sound isn't in the PCM cache.
+		/// </summary>
+		public IAudioDecoder OpenCachedPcm(string path)
+		{
+			var entry = Lemon.Api.OggPcmCacheAcquire(pcmCache, path);
+			return entry != IntPtr.Zero ? new CachedPcmDecoder(entry) : null;
+		}
+
 		private void Cleanup()
 		{
 			while (CalcCacheSize() > MaxCacheSize) {
@@ -106,7 +234,7 @@ namespace Lime
 					if (sample.Path == path) {
 						samples.RemoveAt(i);
 						samples.Add(sample);
-						return new MemoryStream(sample.Data);
+						return new SampleStream(sample.Data);
 					}
 				}
 			}
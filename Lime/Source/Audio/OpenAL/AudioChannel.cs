@@ -162,6 +162,9 @@ namespace Lime
 				this.looping = looping;
 				this.decoder?.Dispose();
 				this.decoder = decoder;
+				if (looping) {
+					(decoder as OggDecoder)?.EnableLooping();
+				}
 			}
 			DetachBuffers();
 			if (Sound != null) {
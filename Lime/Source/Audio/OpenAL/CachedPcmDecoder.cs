@@ -0,0 +1,105 @@
+#if OPENAL
+using System;
+
+namespace Lime
+{
+	/// <summary>
+	/// Plays a sound from the native decoded PCM cache. The samples are shared
+	/// with every other channel playing the same sound, so this decoder only
+	/// copies memory.
+	/// </summary>
+	internal class CachedPcmDecoder : IAudioDecoder
+	{
+		IntPtr entry;
+		readonly IntPtr data;
+		readonly int size;
+		readonly AudioFormat format;
+		readonly int frequency;
+		readonly int blockSize;
+		int position;
+
+		// Takes ownership of a view returned by OggPcmCacheAcquire/Insert
+		public CachedPcmDecoder(IntPtr entry)
+		{
+			this.entry = entry;
+			data = Lemon.Api.OggPcmGetData(entry);
+			size = Lemon.Api.OggPcmGetSize(entry);
+			var channels = Lemon.Api.OggPcmGetChannels(entry);
+			if (channels > 2) {
+				Lemon.Api.OggPcmRelease(entry);
+				this.entry = IntPtr.Zero;
+				throw new Lime.Exception("Channel count must be either 1 or 2");
+			}
+			format = channels == 1 ? AudioFormat.Mono16 : AudioFormat.Stereo16;
+			blockSize = channels * 2;
+			frequency = Lemon.Api.OggPcmGetFrequency(entry);
+		}
+
+		public AudioFormat GetFormat()
+		{
+			return format;
+		}
+
+		public int GetFrequency()
+		{
+			return frequency;
+		}
+
+		public int GetCompressedSize()
+		{
+			return size;
+		}
+
+		public void Rewind()
+		{
+			position = 0;
+		}
+
+		public int GetBlockSize()
+		{
+			return blockSize;
+		}
+
+		public int ReadBlocks(IntPtr buffer, int startIndex, int blockCount)
+		{
+			ThrowIfDisposed();
+			int count = Math.Min(blockCount, (size - position) / blockSize);
+			int bytes = count * blockSize;
+			unsafe {
+				// Offsets are only block aligned, MemoryCopy handles that on every architecture
+				var src = (byte*)data + position;
+				var dst = (byte*)buffer + startIndex * blockSize;
+				Buffer.MemoryCopy(src, dst, bytes, bytes);
+			}
+			position += bytes;
+			return count;
+		}
+
+		private void ThrowIfDisposed()
+		{
+			if (entry == IntPtr.Zero) {
+				throw new ObjectDisposedException(GetType().Name);
+			}
+		}
+
+		~CachedPcmDecoder()
+		{
+			Release();
+		}
+
+		public void Dispose()
+		{
+			Release();
+			GC.SuppressFinalize(this);
+		}
+
+		private void Release()
+		{
+			if (entry != IntPtr.Zero) {
+				Lemon.Api.OggPcmRelease(entry);
+				entry = IntPtr.Zero;
+			}
+		}
+	}
+}
+#endif
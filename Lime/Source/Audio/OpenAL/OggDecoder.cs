@@ -21,9 +21,18 @@ namespace Lime
 		IntPtr oggFile;
 		int bitstream;
 		int handle;
+		// Set when decoding straight from a cached sample
+		GCHandle pinnedData;
 		readonly Lemon.Api.FileSystem fileSystem;
 		static readonly StreamMap streamMap = new StreamMap();
 
+		/// <summary>
+		/// Whether decoders created from now on verify only the first page checksum after an open or seek, taking the
+		/// rest as read. Saves a pass over every page, but a damaged page gets decoded instead of dropped, so it is off
+		/// by default and only meant for sounds from the game's own asset bundles.
+		/// </summary>
+		public static bool TrustedInput;
+
 		public static int GetCurrentStreamsCount()
 		{
 			return streamMap.GetCurrentStreamsCount();
@@ -32,17 +41,37 @@ namespace Lime
 		public OggDecoder(Stream stream)
 		{
 			this.stream = stream;
-			fileSystem = new Lemon.Api.FileSystem {
-				ReadFunc = OggRead, CloseFunc = OggClose,
-				SeekFunc = OggSeek, TellFunc = OggTell
-			};
-			handle = streamMap.Allocate(stream);
 			oggFile = Lemon.Api.OggCreate();
-			if (Lemon.Api.OggOpen(handle, oggFile, fileSystem) < 0) {
-				throw new Lime.Exception("Failed to open OGG/Vorbis file");
-			}
-			if (Lemon.Api.OggGetChannels(oggFile) > 2) {
-				throw new Lime.Exception("Channel count must be either 1 or 2");
+			// Sounds come and go all session long; keep each decoder's
+			// allocations together so closing one doesn't fragment the heap
+			Lemon.Api.OggSetArena(oggFile, 0);
+			Lemon.Api.OggSetTrusted(oggFile, TrustedInput ? 1 : 0);
+			try {
+				var sampleStream = stream as SampleStream;
+				if (sampleStream != null && sampleStream.Position == 0) {
+					// The whole file is in memory: let the native side read it
+					// directly instead of calling back into managed code
+					pinnedData = GCHandle.Alloc(sampleStream.Data, GCHandleType.Pinned);
+					if (Lemon.Api.OggOpenMemory(pinnedData.AddrOfPinnedObject(), sampleStream.Data.Length, oggFile) < 0) {
+						throw new Lime.Exception("Failed to open OGG/Vorbis file");
+					}
+				} else {
+					fileSystem = new Lemon.Api.FileSystem {
+						ReadFunc = OggRead, CloseFunc = OggClose,
+						SeekFunc = OggSeek, TellFunc = OggTell
+					};
+					handle = streamMap.Allocate(stream);
+					if (Lemon.Api.OggOpen(handle, oggFile, fileSystem) < 0) {
+						throw new Lime.Exception("Failed to open OGG/Vorbis file");
+					}
+				}
+				if (Lemon.Api.OggGetChannels(oggFile) > 2) {
+					throw new Lime.Exception("Channel count must be either 1 or 2");
+				}
+			} catch {
+				// Nobody gets to dispose a decoder whose constructor threw
+				ReleaseNativeResources();
+				throw;
 			}
 		}
 
@@ -81,6 +110,74 @@ namespace Lime
 			Lemon.Api.OggResetToBeginning(oggFile);
 		}
 
+		// Loops seamlessly from the file's LOOPSTART/LOOPEND (or LOOPLENGTH)
+		// comments, or over the whole file without them. ReadBlocks then
+		// never runs dry, so Rewind is never needed. Costs the voice a block
+		// of the loop start decoded up front (32 KB for stereo), and a second
+		// native decoder once playback first nears the loop end, kept until
+		// the decoder is disposed.
+		public void EnableLooping()
+		{
+			ThrowIfDisposed();
+			if (Lemon.Api.OggSetLoopFromComments(oggFile) <= 0) {
+				Lemon.Api.OggSetLoop(oggFile, 0, 0);
+			}
+		}
+
+		// Loops seamlessly between the given samples; end 0 means the end of the file.
+		public void SetLoopPoints(long start, long end)
+		{
+			ThrowIfDisposed();
+			if (Lemon.Api.OggSetLoop(oggFile, start, end) < 0) {
+				throw new Lime.Exception("Invalid loop points");
+			}
+		}
+
+		public void SeekTime(double seconds)
+		{
+			ThrowIfDisposed();
+			if (Lemon.Api.OggSeekTime(oggFile, seconds) < 0) {
+				throw new Lime.Exception("Seek error");
+			}
+		}
+
+		public void SeekPcm(long sample)
+		{
+			ThrowIfDisposed();
+			if (Lemon.Api.OggSeekPcm(oggFile, sample) < 0) {
+				throw new Lime.Exception("Seek error");
+			}
+		}
+
+		public long GetPcmPosition()
+		{
+			ThrowIfDisposed();
+			return Lemon.Api.OggTellPcm(oggFile);
+		}
+
+		public long GetPcmLength()
+		{
+			ThrowIfDisposed();
+			return Lemon.Api.OggGetPcmLength(oggFile);
+		}
+
+		// The page index that makes seeks cheap, built up while playing and
+		// seeking. Save it next to the track to have fast seeks from the start
+		// next time.
+		public long[] GetPageIndex()
+		{
+			ThrowIfDisposed();
+			var pairs = new long[Lemon.Api.OggGetPageIndex(oggFile, null, 0)];
+			Lemon.Api.OggGetPageIndex(oggFile, pairs, pairs.Length);
+			return pairs;
+		}
+
+		public bool SetPageIndex(long[] pairs)
+		{
+			ThrowIfDisposed();
+			return Lemon.Api.OggSetPageIndex(oggFile, pairs, pairs.Length) == 0;
+		}
+
 		public int GetBlockSize()
 		{
 			return 1;
@@ -98,6 +195,10 @@ namespace Lime
 					throw new Lime.Exception("Read error");
 				}
 				if (read == 0) {
+					// After the samples are out, so a wrap in the next read costs no seek
+					if (Lemon.Api.OggPrimeLoop(oggFile) < 0) {
+						throw new Lime.Exception("Read error");
+					}
 					return actualCount;
 				}
 				actualCount += read;
@@ -168,19 +269,26 @@ namespace Lime
 					}
 				}
 
-				if (oggFile != IntPtr.Zero) {
-					Lemon.Api.OggDispose(oggFile);
-					oggFile = IntPtr.Zero;
-				}
-				if (handle != 0) {
-					streamMap.Release(handle);
-					handle = 0;
-				}
-
+				ReleaseNativeResources();
 				disposedValue = true;
 			}
 		}
 
+		private void ReleaseNativeResources()
+		{
+			if (oggFile != IntPtr.Zero) {
+				Lemon.Api.OggDispose(oggFile);
+				oggFile = IntPtr.Zero;
+			}
+			if (pinnedData.IsAllocated) {
+				pinnedData.Free();
+			}
+			if (handle != 0) {
+				streamMap.Release(handle);
+				handle = 0;
+			}
+		}
+
 		~OggDecoder()
 		{
 			Dispose(false);
@@ -294,6 +294,13 @@ namespace Lime
 			}
 		}
 
+		public static void Prewarm(IEnumerable<string> paths)
+		{
+#if !TANGERINE
+			cache.Prewarm(paths.Select(path => path + ".sound"));
+#endif // TANGERINE
+		}
+
 		private static Sound LoadSoundToChannel(AudioChannel channel, PlayParameters parameters, float fadeinTime)
 		{
 			if (context == null) {
@@ -308,6 +315,9 @@ namespace Lime
 #else
 				path += ".sound";
 #endif // TANGERINE
+				decoder = cache.OpenCachedPcm(path);
+			}
+			if (decoder == null) {
 				var stream = cache.OpenStream(path);
 				if (stream == null) {
 					AudioMissing?.Invoke(path);
@@ -3,9 +3,29 @@ using System.Runtime.InteropServices;
 
 namespace Lime
 {
+	/// <summary>
+	/// Software decoder for the ETC, EAC, BC1-BC5 and LDR ASTC texture formats, used when the GPU can't sample them.
+	/// </summary>
 	internal unsafe class Etc2Decoder
 	{
-		const Int32 ETC2_MODE_ALLOWED_ALL = 0x1F;
+		// Texture types from texgenpack.h
+		const Int32 TEXTURE_TYPE_ETC1 = 0x0100;
+		const Int32 TEXTURE_TYPE_ETC2_RGB8 = 0x0101;
+		const Int32 TEXTURE_TYPE_ETC2_EAC = 0x0162;
+		const Int32 TEXTURE_TYPE_ETC2_PUNCHTHROUGH = 0x0123;
+		const Int32 TEXTURE_TYPE_R11_EAC = 0x0400;
+		const Int32 TEXTURE_TYPE_RG11_EAC = 0x0440;
+		const Int32 TEXTURE_TYPE_DXT1 = 0x0200;
+		const Int32 TEXTURE_TYPE_DXT1A = 0x0223;
+		const Int32 TEXTURE_TYPE_DXT3 = 0x0261;
+		const Int32 TEXTURE_TYPE_DXT5 = 0x0262;
+		const Int32 TEXTURE_TYPE_RGTC1 = 0x0001;
+		const Int32 TEXTURE_TYPE_RGTC2 = 0x0041;
+		const Int32 TEXTURE_TYPE_RGBA_ASTC_4X4 = 0x8000;
+		const Int32 TEXTURE_TYPE_ASTC_BIT = 0x8000;
+		const Int32 TEXTURE_TYPE_UNCOMPRESSED_RGBA8 = 0x2021;
+		const Int32 TEXTURE_TYPE_UNCOMPRESSED_RG8 = 0x2001;
+		const Int32 TEXTURE_TYPE_UNCOMPRESSED_R8 = 0x2002;
 
 #if iOS
 		const string Dll = "__Internal";
@@ -14,46 +34,378 @@ namespace Lime
 #endif
 
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
-		static extern Int32 draw_block4x4_etc2_eac(byte* bitstring, uint* image_buffer, Int32 flags);
+		static extern Int32 decode_etc_texture_to_format(
+			byte* src, byte* dst, Int32 width, Int32 height, Int32 pitch, Int32 format, Int32 dstFormat, Int32 threads);
 
 		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
-		static extern Int32 draw_block4x4_etc2_rgb8(byte* bitstring, uint* image_buffer, Int32 flags);
+		static extern Int32 decode_bc_texture_to_format(
+			byte* src, byte* dst, Int32 width, Int32 height, Int32 pitch, Int32 format, Int32 dstFormat, Int32 threads);
 
-		public static void Decode(byte[] etcData, IntPtr rgba8Data, int width, int height, Format format)
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		static extern Int32 decode_astc_texture(
+			byte* src, byte* dst, Int32 width, Int32 height, Int32 pitch, Int32 format, Int32 threads);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		static extern Int32 transcode_texture_to_bc(
+			byte* src, byte* dst, Int32 width, Int32 height, Int32 format, Int32 threads);
+
+		[StructLayout(LayoutKind.Sequential)]
+		struct DecodeJobLevel
+		{
+			public byte* Src;
+			public byte* Dst;
+			public Int32 Width;
+			public Int32 Height;
+			public Int32 Pitch;
+		}
+
+		[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+		delegate void DecodeJobFunction(IntPtr data, Int32 level, Int32 result);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		static extern IntPtr start_decode_job(
+			DecodeJobLevel* levels, Int32 levelCount, Int32 format, Int32 dstFormat, Int32 threads,
+			DecodeJobFunction callback, IntPtr data);
+
+		[DllImport(Dll, CallingConvention = CallingConvention.Cdecl)]
+		static extern void cancel_decode_job(IntPtr job);
+
+		public static bool IsSupported(Format format)
+		{
+			return GetTextureType(format) != 0;
+		}
+
+		/// <summary>
+		/// Returns the single or dual channel format EAC and BC4/BC5 textures can be decoded to instead of
+		/// R8G8B8A8_UNorm, or R8G8B8A8_UNorm for the other formats.
+		/// </summary>
+		public static Format GetCompactDecodedFormat(Format format)
+		{
+			switch (format) {
+				case Format.EAC_R11_UNorm_Block:
+				case Format.BC4_UNorm_Block:
+					return Format.R8_UNorm;
+				case Format.EAC_R11G11_UNorm_Block:
+				case Format.BC5_UNorm_Block:
+					return Format.R8G8_UNorm;
+				default:
+					return Format.R8G8B8A8_UNorm;
+			}
+		}
+
+		public static void Decode(byte[] compressedData, IntPtr rgba8Data, int width, int height, Format format)
+		{
+			Decode(compressedData, rgba8Data, width, height, format, Format.R8G8B8A8_UNorm);
+		}
+
+		/// <summary>
+		/// Decodes a whole mip level to dstFormat, which is either R8G8B8A8_UNorm
+		/// or GetCompactDecodedFormat(format).
+		/// </summary>
+		public static void Decode(byte[] compressedData, IntPtr dstData, int width, int height, Format format, Format dstFormat)
 		{
-			if (format != Format.ETC2_R8G8B8A8_UNorm_Block &&
-				format != Format.ETC2_R8G8B8_UNorm_Block &&
-				format != Format.ETC1_R8G8B8_UNorm_Block
-			) {
+			var textureType = GetTextureType(format);
+			if (textureType == 0) {
 				throw new ArgumentException("Invalid format");
 			}
-			if ((width & 3) != 0 || (height & 3) != 0) {
-				throw new ArgumentException("Texture dimensions should be multiple of 4");
-			}
-			var bytesPerBlock = format.GetSize();
-			uint* decodedBlock = stackalloc uint[16];  
-			fixed (byte* fixedEtcData = &etcData[0]) {
-				var etcDataPtr = (IntPtr)fixedEtcData;
-				for (int i = 0; i < height / 4; i++) {
-					for (int j = 0; j < width / 4; j++) {
-						if (format == Format.ETC2_R8G8B8A8_UNorm_Block) {
-							draw_block4x4_etc2_eac((byte*)etcDataPtr, decodedBlock, ETC2_MODE_ALLOWED_ALL);
-						} else {
-							draw_block4x4_etc2_rgb8((byte*)etcDataPtr, decodedBlock, ETC2_MODE_ALLOWED_ALL);
-						}
-						int t = 0;
-						uint* rgba8DataPtr = (uint*)rgba8Data + (i * 4 * width + j * 4);
-						for (int y = 0; y < 4; y++) {
-							*rgba8DataPtr++ = decodedBlock[t++];
-							*rgba8DataPtr++ = decodedBlock[t++];
-							*rgba8DataPtr++ = decodedBlock[t++];
-							*rgba8DataPtr++ = decodedBlock[t++];
-							rgba8DataPtr += width - 4;
+			var dstTextureType = GetDecodedTextureType(format, dstFormat);
+			if (dstTextureType == 0) {
+				throw new ArgumentException("Invalid destination format");
+			}
+			CheckDataLength(compressedData, width, height, format);
+			// Partial edge blocks are clipped natively, so the 2x2 and 1x1 mip levels decode too.
+			fixed (byte* fixedCompressedData = &compressedData[0]) {
+				var pitch = width * dstFormat.GetSize();
+				if ((textureType & TEXTURE_TYPE_ASTC_BIT) != 0) {
+					decode_astc_texture(fixedCompressedData, (byte*)dstData, width, height, pitch, textureType, 0);
+				} else if (IsBCTextureType(textureType)) {
+					decode_bc_texture_to_format(
+						fixedCompressedData, (byte*)dstData, width, height, pitch, textureType, dstTextureType, 0);
+				} else {
+					decode_etc_texture_to_format(
+						fixedCompressedData, (byte*)dstData, width, height, pitch, textureType, dstTextureType, 0);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Returns the BC format Transcode turns a format into, or Format.Undefined if it can't be transcoded.
+		/// </summary>
+		public static Format GetTranscodedFormat(Format format)
+		{
+			switch (format) {
+				case Format.ETC1_R8G8B8_UNorm_Block:
+				case Format.ETC2_R8G8B8_UNorm_Block:
+					return Format.BC1_RGB_UNorm_Block;
+				case Format.ETC2_R8G8B8A1_UNorm_Block:
+					return Format.BC1_RGBA_UNorm_Block;
+				case Format.ETC2_R8G8B8A8_UNorm_Block:
+					return Format.BC3_UNorm_Block;
+				case Format.EAC_R11_UNorm_Block:
+					return Format.BC4_UNorm_Block;
+				case Format.EAC_R11G11_UNorm_Block:
+					return Format.BC5_UNorm_Block;
+				default:
+					return (GetTextureType(format) & TEXTURE_TYPE_ASTC_BIT) != 0 ? Format.BC3_UNorm_Block : Format.Undefined;
+			}
+		}
+
+		/// <summary>
+		/// Transcodes a whole mip level to GetTranscodedFormat(format) blocks. Each block is decoded and quickly
+		/// re-encoded, which keeps the texture compressed on GPUs that only sample BC formats.
+		/// </summary>
+		public static void Transcode(byte[] compressedData, IntPtr bcData, int width, int height, Format format)
+		{
+			var textureType = GetTextureType(format);
+			if (GetTranscodedFormat(format) == Format.Undefined) {
+				throw new ArgumentException("Invalid format");
+			}
+			CheckDataLength(compressedData, width, height, format);
+			fixed (byte* fixedCompressedData = &compressedData[0]) {
+				if (transcode_texture_to_bc(fixedCompressedData, (byte*)bcData, width, height, textureType, 0) == 0) {
+					throw new OutOfMemoryException();
+				}
+			}
+		}
+
+		/// <summary>
+		/// Decodes or transcodes the mip levels of a texture on a background thread, smallest level first, so
+		/// that a low resolution version is available long before the whole texture.
+		/// The jobs of all textures share one thread, which always takes the smallest level left.
+		/// </summary>
+		public class DecodeJob : IDisposable
+		{
+			// Kept in a field, so the delegate outlives the native jobs calling it.
+			private static readonly DecodeJobFunction callback = OnDecodeJobCallback;
+
+			private readonly GCHandle[] pinnedLevels;
+			private readonly IntPtr[] decodedLevels;
+			private readonly Action<DecodeJob, int> levelDecoded;
+			private readonly Action<DecodeJob> finished;
+			private GCHandle handle;
+			private IntPtr nativeJob;
+			private int failedLevelCount;
+			private bool disposed;
+
+			/// <summary>
+			/// The format of the decoded levels, either a format Decode produces or GetTranscodedFormat(Format).
+			/// </summary>
+			public Format DecodedFormat { get; }
+			public int LevelCount => decodedLevels.Length;
+			public bool Succeeded => failedLevelCount == 0;
+
+			private DecodeJob(
+				int levelCount, Format decodedFormat, Action<DecodeJob, int> levelDecoded, Action<DecodeJob> finished)
+			{
+				DecodedFormat = decodedFormat;
+				pinnedLevels = new GCHandle[levelCount];
+				decodedLevels = new IntPtr[levelCount];
+				this.levelDecoded = levelDecoded;
+				this.finished = finished;
+			}
+
+			/// <summary>
+			/// Starts decoding the mip levels of a width x height texture, levels[0] being the biggest one.
+			/// levelDecoded is called from the decoding thread as each level is ready, finished once all of them are
+			/// (or have failed, see Succeeded). Neither is called once the job is disposed.
+			/// Returns null if the background thread can't be started, the levels should be decoded in place then.
+			/// </summary>
+			public static DecodeJob Start(
+				byte[][] levels, int width, int height, Format format, Format decodedFormat,
+				Action<DecodeJob, int> levelDecoded, Action<DecodeJob> finished)
+			{
+				var textureType = GetTextureType(format);
+				if (textureType == 0) {
+					throw new ArgumentException("Invalid format");
+				}
+				var transcode = decodedFormat == GetTranscodedFormat(format);
+				var dstTextureType = transcode ? GetTextureType(decodedFormat) : GetDecodedTextureType(format, decodedFormat);
+				if (dstTextureType == 0) {
+					throw new ArgumentException("Invalid destination format");
+				}
+				var job = new DecodeJob(levels.Length, decodedFormat, levelDecoded, finished);
+				var nativeLevels = stackalloc DecodeJobLevel[levels.Length];
+				var started = false;
+				try {
+					for (var level = 0; level < levels.Length; level++) {
+						GraphicsUtility.CalculateMipLevelSize(level, width, height, out var levelWidth, out var levelHeight);
+						CheckDataLength(levels[level], levelWidth, levelHeight, format);
+						job.pinnedLevels[level] = GCHandle.Alloc(levels[level], GCHandleType.Pinned);
+						job.decodedLevels[level] = Marshal.AllocHGlobal(
+							GraphicsUtility.CalculateImageDataSize(decodedFormat, levelWidth, levelHeight));
+						nativeLevels[level] = new DecodeJobLevel {
+							Src = (byte*)job.pinnedLevels[level].AddrOfPinnedObject(),
+							Dst = (byte*)job.decodedLevels[level],
+							Width = levelWidth,
+							Height = levelHeight,
+							Pitch = levelWidth * decodedFormat.GetSize()
+						};
+					}
+					job.handle = GCHandle.Alloc(job);
+					// Callbacks may come before start_decode_job returns, the lock holds back the last one.
+					lock (job) {
+						job.nativeJob = start_decode_job(
+							nativeLevels, levels.Length, textureType, dstTextureType, 0,
+							callback, GCHandle.ToIntPtr(job.handle));
+						started = job.nativeJob != IntPtr.Zero;
+					}
+				} finally {
+					if (!started) {
+						if (job.handle.IsAllocated) {
+							job.handle.Free();
 						}
-						etcDataPtr += bytesPerBlock;
+						job.FreeLevels();
+					}
+				}
+				return started ? job : null;
+			}
+
+			/// <summary>
+			/// Returns the decoded data of a level, valid until the job is disposed.
+			/// </summary>
+			public IntPtr GetLevelData(int level)
+			{
+				if (disposed) {
+					throw new ObjectDisposedException(GetType().Name);
+				}
+				return decodedLevels[level];
+			}
+
+			/// <summary>
+			/// Cancels the levels not decoded yet and frees the decoded data, now or as soon as the decoding thread
+			/// lets go of it.
+			/// </summary>
+			public void Dispose()
+			{
+				lock (this) {
+					if (disposed) {
+						return;
+					}
+					disposed = true;
+					if (nativeJob != IntPtr.Zero) {
+						cancel_decode_job(nativeJob);
+					} else {
+						FreeLevels();
 					}
 				}
 			}
+
+			private void FreeLevels()
+			{
+				for (var level = 0; level < decodedLevels.Length; level++) {
+					if (pinnedLevels[level].IsAllocated) {
+						pinnedLevels[level].Free();
+					}
+					if (decodedLevels[level] != IntPtr.Zero) {
+						Marshal.FreeHGlobal(decodedLevels[level]);
+						decodedLevels[level] = IntPtr.Zero;
+					}
+				}
+			}
+
+#if iOS
+			[ObjCRuntime.MonoPInvokeCallback(typeof(DecodeJobFunction))]
+#endif
+			private static void OnDecodeJobCallback(IntPtr data, Int32 level, Int32 result)
+			{
+				var job = (DecodeJob)GCHandle.FromIntPtr(data).Target;
+				if (level >= 0) {
+					if (result == 0) {
+						job.failedLevelCount++;
+					} else if (!job.disposed) {
+						job.levelDecoded?.Invoke(job, level);
+					}
+					return;
+				}
+				// The native job is gone after this call.
+				bool disposed;
+				lock (job) {
+					job.nativeJob = IntPtr.Zero;
+					job.handle.Free();
+					disposed = job.disposed;
+					if (disposed) {
+						job.FreeLevels();
+					}
+				}
+				if (!disposed) {
+					job.finished?.Invoke(job);
+				}
+			}
+		}
+
+		private static Int32 GetDecodedTextureType(Format format, Format dstFormat)
+		{
+			if (dstFormat == Format.R8G8B8A8_UNorm) {
+				return TEXTURE_TYPE_UNCOMPRESSED_RGBA8;
+			} else if (dstFormat == Format.R8_UNorm && GetCompactDecodedFormat(format) == Format.R8_UNorm) {
+				return TEXTURE_TYPE_UNCOMPRESSED_R8;
+			} else if (dstFormat == Format.R8G8_UNorm && GetCompactDecodedFormat(format) == Format.R8G8_UNorm) {
+				return TEXTURE_TYPE_UNCOMPRESSED_RG8;
+			}
+			return 0;
+		}
+
+		private static void CheckDataLength(byte[] compressedData, int width, int height, Format format)
+		{
+			if (compressedData.Length < GraphicsUtility.CalculateImageDataSize(format, width, height)) {
+				throw new ArgumentException("Not enough texture data");
+			}
+		}
+
+		private static Int32 GetTextureType(Format format)
+		{
+			switch (format) {
+				case Format.ETC1_R8G8B8_UNorm_Block:
+					return TEXTURE_TYPE_ETC1;
+				case Format.ETC2_R8G8B8_UNorm_Block:
+					return TEXTURE_TYPE_ETC2_RGB8;
+				case Format.ETC2_R8G8B8A1_UNorm_Block:
+					return TEXTURE_TYPE_ETC2_PUNCHTHROUGH;
+				case Format.ETC2_R8G8B8A8_UNorm_Block:
+					return TEXTURE_TYPE_ETC2_EAC;
+				case Format.EAC_R11_UNorm_Block:
+					return TEXTURE_TYPE_R11_EAC;
+				case Format.EAC_R11G11_UNorm_Block:
+					return TEXTURE_TYPE_RG11_EAC;
+				case Format.BC1_RGB_UNorm_Block:
+					return TEXTURE_TYPE_DXT1;
+				case Format.BC1_RGBA_UNorm_Block:
+					return TEXTURE_TYPE_DXT1A;
+				case Format.BC2_UNorm_Block:
+					return TEXTURE_TYPE_DXT3;
+				case Format.BC3_UNorm_Block:
+					return TEXTURE_TYPE_DXT5;
+				case Format.BC4_UNorm_Block:
+					return TEXTURE_TYPE_RGTC1;
+				case Format.BC5_UNorm_Block:
+					return TEXTURE_TYPE_RGTC2;
+				case Format.ASTC_4x4_UNorm_Block:
+				case Format.ASTC_5x4_UNorm_Block:
+				case Format.ASTC_5x5_UNorm_Block:
+				case Format.ASTC_6x5_UNorm_Block:
+				case Format.ASTC_6x6_UNorm_Block:
+				case Format.ASTC_8x5_UNorm_Block:
+				case Format.ASTC_8x6_UNorm_Block:
+				case Format.ASTC_8x8_UNorm_Block:
+				case Format.ASTC_10x5_UNorm_Block:
+				case Format.ASTC_10x6_UNorm_Block:
+				case Format.ASTC_10x8_UNorm_Block:
+				case Format.ASTC_10x10_UNorm_Block:
+				case Format.ASTC_12x10_UNorm_Block:
+				case Format.ASTC_12x12_UNorm_Block:
+					// The texgenpack ASTC types follow the same footprint order.
+					return TEXTURE_TYPE_RGBA_ASTC_4X4 + (format - Format.ASTC_4x4_UNorm_Block);
+				default:
+					return 0;
+			}
+		}
+
+		private static bool IsBCTextureType(Int32 textureType)
+		{
+			return
+				textureType == TEXTURE_TYPE_DXT1 || textureType == TEXTURE_TYPE_DXT1A ||
+				textureType == TEXTURE_TYPE_DXT3 || textureType == TEXTURE_TYPE_DXT5 ||
+				textureType == TEXTURE_TYPE_RGTC1 || textureType == TEXTURE_TYPE_RGTC2;
 		}
 	}
 }
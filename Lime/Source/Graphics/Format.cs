@@ -49,14 +49,32 @@ namespace Lime
 		BC1_RGBA_UNorm_Block,
 		BC2_UNorm_Block,
 		BC3_UNorm_Block,
+		BC4_UNorm_Block,
+		BC5_UNorm_Block,
 		ETC1_R8G8B8_UNorm_Block,
 		ETC2_R8G8B8_UNorm_Block,
 		ETC2_R8G8B8A1_UNorm_Block,
 		ETC2_R8G8B8A8_UNorm_Block,
+		EAC_R11_UNorm_Block,
+		EAC_R11G11_UNorm_Block,
 		PVRTC1_2Bpp_UNorm_Block,
 		PVRTC1_4Bpp_UNorm_Block,
 		PVRTC2_2Bpp_UNorm_Block,
-		PVRTC2_4Bpp_UNorm_Block
+		PVRTC2_4Bpp_UNorm_Block,
+		ASTC_4x4_UNorm_Block,
+		ASTC_5x4_UNorm_Block,
+		ASTC_5x5_UNorm_Block,
+		ASTC_6x5_UNorm_Block,
+		ASTC_6x6_UNorm_Block,
+		ASTC_8x5_UNorm_Block,
+		ASTC_8x6_UNorm_Block,
+		ASTC_8x8_UNorm_Block,
+		ASTC_10x5_UNorm_Block,
+		ASTC_10x6_UNorm_Block,
+		ASTC_10x8_UNorm_Block,
+		ASTC_10x10_UNorm_Block,
+		ASTC_12x10_UNorm_Block,
+		ASTC_12x12_UNorm_Block
 	}
 
 	[Flags]
@@ -128,15 +146,19 @@ namespace Lime
 					return 2;
 				case Format.BC1_RGB_UNorm_Block:
 				case Format.BC1_RGBA_UNorm_Block:
+				case Format.BC4_UNorm_Block:
 					return 8;
 				case Format.BC2_UNorm_Block:
 				case Format.BC3_UNorm_Block:
+				case Format.BC5_UNorm_Block:
 					return 16;
 				case Format.ETC1_R8G8B8_UNorm_Block:
 				case Format.ETC2_R8G8B8_UNorm_Block:
 				case Format.ETC2_R8G8B8A1_UNorm_Block:
+				case Format.EAC_R11_UNorm_Block:
 					return 8;
 				case Format.ETC2_R8G8B8A8_UNorm_Block:
+				case Format.EAC_R11G11_UNorm_Block:
 					return 16;
 				case Format.PVRTC1_2Bpp_UNorm_Block:
 				case Format.PVRTC1_4Bpp_UNorm_Block:
@@ -144,6 +166,21 @@ namespace Lime
 				case Format.PVRTC2_2Bpp_UNorm_Block:
 				case Format.PVRTC2_4Bpp_UNorm_Block:
 					return 8;
+				case Format.ASTC_4x4_UNorm_Block:
+				case Format.ASTC_5x4_UNorm_Block:
+				case Format.ASTC_5x5_UNorm_Block:
+				case Format.ASTC_6x5_UNorm_Block:
+				case Format.ASTC_6x6_UNorm_Block:
+				case Format.ASTC_8x5_UNorm_Block:
+				case Format.ASTC_8x6_UNorm_Block:
+				case Format.ASTC_8x8_UNorm_Block:
+				case Format.ASTC_10x5_UNorm_Block:
+				case Format.ASTC_10x6_UNorm_Block:
+				case Format.ASTC_10x8_UNorm_Block:
+				case Format.ASTC_10x10_UNorm_Block:
+				case Format.ASTC_12x10_UNorm_Block:
+				case Format.ASTC_12x12_UNorm_Block:
+					return 16;
 				default:
 					throw new ArgumentException(nameof(format));
 			}
@@ -156,10 +193,14 @@ namespace Lime
 				case Format.BC1_RGBA_UNorm_Block:
 				case Format.BC2_UNorm_Block:
 				case Format.BC3_UNorm_Block:
+				case Format.BC4_UNorm_Block:
+				case Format.BC5_UNorm_Block:
 				case Format.ETC1_R8G8B8_UNorm_Block:
 				case Format.ETC2_R8G8B8_UNorm_Block:
 				case Format.ETC2_R8G8B8A1_UNorm_Block:
 				case Format.ETC2_R8G8B8A8_UNorm_Block:
+				case Format.EAC_R11_UNorm_Block:
+				case Format.EAC_R11G11_UNorm_Block:
 					width = height = 4;
 					break;
 				case Format.PVRTC1_2Bpp_UNorm_Block:
@@ -178,6 +219,62 @@ namespace Lime
 					width = 4;
 					height = 4;
 					break;
+				case Format.ASTC_4x4_UNorm_Block:
+					width = 4;
+					height = 4;
+					break;
+				case Format.ASTC_5x4_UNorm_Block:
+					width = 5;
+					height = 4;
+					break;
+				case Format.ASTC_5x5_UNorm_Block:
+					width = 5;
+					height = 5;
+					break;
+				case Format.ASTC_6x5_UNorm_Block:
+					width = 6;
+					height = 5;
+					break;
+				case Format.ASTC_6x6_UNorm_Block:
+					width = 6;
+					height = 6;
+					break;
+				case Format.ASTC_8x5_UNorm_Block:
+					width = 8;
+					height = 5;
+					break;
+				case Format.ASTC_8x6_UNorm_Block:
+					width = 8;
+					height = 6;
+					break;
+				case Format.ASTC_8x8_UNorm_Block:
+					width = 8;
+					height = 8;
+					break;
+				case Format.ASTC_10x5_UNorm_Block:
+					width = 10;
+					height = 5;
+					break;
+				case Format.ASTC_10x6_UNorm_Block:
+					width = 10;
+					height = 6;
+					break;
+				case Format.ASTC_10x8_UNorm_Block:
+					width = 10;
+					height = 8;
+					break;
+				case Format.ASTC_10x10_UNorm_Block:
+					width = 10;
+					height = 10;
+					break;
+				case Format.ASTC_12x10_UNorm_Block:
+					width = 12;
+					height = 10;
+					break;
+				case Format.ASTC_12x12_UNorm_Block:
+					width = 12;
+					height = 12;
+					break;
 				default:
 					width = height = 1;
 					break;
@@ -191,14 +288,32 @@ namespace Lime
 				case Format.BC1_RGBA_UNorm_Block:
 				case Format.BC2_UNorm_Block:
 				case Format.BC3_UNorm_Block:
+				case Format.BC4_UNorm_Block:
+				case Format.BC5_UNorm_Block:
 				case Format.ETC1_R8G8B8_UNorm_Block:
 				case Format.ETC2_R8G8B8_UNorm_Block:
 				case Format.ETC2_R8G8B8A1_UNorm_Block:
 				case Format.ETC2_R8G8B8A8_UNorm_Block:
+				case Format.EAC_R11_UNorm_Block:
+				case Format.EAC_R11G11_UNorm_Block:
 				case Format.PVRTC1_2Bpp_UNorm_Block:
 				case Format.PVRTC1_4Bpp_UNorm_Block:
 				case Format.PVRTC2_2Bpp_UNorm_Block:
 				case Format.PVRTC2_4Bpp_UNorm_Block:
+				case Format.ASTC_4x4_UNorm_Block:
+				case Format.ASTC_5x4_UNorm_Block:
+				case Format.ASTC_5x5_UNorm_Block:
+				case Format.ASTC_6x5_UNorm_Block:
+				case Format.ASTC_6x6_UNorm_Block:
+				case Format.ASTC_8x5_UNorm_Block:
+				case Format.ASTC_8x6_UNorm_Block:
+				case Format.ASTC_8x8_UNorm_Block:
+				case Format.ASTC_10x5_UNorm_Block:
+				case Format.ASTC_10x6_UNorm_Block:
+				case Format.ASTC_10x8_UNorm_Block:
+				case Format.ASTC_10x10_UNorm_Block:
+				case Format.ASTC_12x10_UNorm_Block:
+				case Format.ASTC_12x12_UNorm_Block:
 					return true;
 				default:
 					return false;
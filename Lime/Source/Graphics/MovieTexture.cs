@@ -3,6 +3,14 @@ using System.IO;
 
 namespace Lime
 {
+	public enum MovieTextureFormat
+	{
+		RGBA8,
+		// R5G6B5 for opaque videos and R4G4B4A4 for videos with an alpha
+		// stream; half the memory and upload bandwidth of RGBA8.
+		Packed16,
+	}
+
 	public class MovieTexture : Texture2D
 	{
 		Stream rgbStream;
@@ -10,11 +18,16 @@ namespace Lime
 		OgvDecoder rgbDecoder;
 		OgvDecoder alphaDecoder;
 		Color4[] pixels;
+		ushort[] packedPixels;
 		double gameTime;
 		double videoTime;
 		string path;
 
 		public bool Looped { get; set; }
+		// 1, 2, 4 or 8; see OgvDecoder.Downscale. Takes effect on the next Play()
+		public int Downscale { get; set; } = 1;
+		// Takes effect on the next Play(). Packed16 requires Downscale 1, Play() throws otherwise
+		public MovieTextureFormat OutputFormat { get; set; } = MovieTextureFormat.RGBA8;
 		public bool Paused { get; private set; }
 		public bool Stopped { get; private set; }
 		public string Path { get { return path; } set { SetPath(value); } }
@@ -35,19 +48,29 @@ namespace Lime
 			if (Path == null) {
 				throw new ArgumentException();
 			}
+			// Checked before anything is opened, rather than failing on the first decoded frame
+			if (OutputFormat == MovieTextureFormat.Packed16 && Downscale != 1) {
+				throw new InvalidOperationException("Packed16 output requires Downscale 1");
+			}
 			Stop();
 			rgbStream = AssetBundle.Current.OpenFile(Path + ".ogv");
-			rgbDecoder = new OgvDecoder(rgbStream);
+			rgbDecoder = new OgvDecoder(rgbStream) { Downscale = Downscale };
 			foreach (var i in new string[] { "_alpha.ogv", "_Alpha.ogv" }) {
 				if (AssetBundle.Current.FileExists(Path + i)) {
 					alphaStream = AssetBundle.Current.OpenFile(Path + i);
-					alphaDecoder = new OgvDecoder(alphaStream);
+					alphaDecoder = new OgvDecoder(alphaStream) { Downscale = Downscale };
 					break;
 				}
 			}
 			this.ImageSize = rgbDecoder.FrameSize;
 			this.SurfaceSize = ImageSize;
-			pixels = new Color4[ImageSize.Width * ImageSize.Height];
+			if (OutputFormat == MovieTextureFormat.Packed16) {
+				pixels = null;
+				packedPixels = new ushort[ImageSize.Width * ImageSize.Height];
+			} else {
+				packedPixels = null;
+				pixels = new Color4[ImageSize.Width * ImageSize.Height];
+			}
 		}
 
 		public void Play()
@@ -120,6 +143,16 @@ namespace Lime
 				if (videoTime >= gameTime)
 					break;
 			}
+			if (packedPixels != null) {
+				if (alphaDecoder != null) {
+					rgbDecoder.FillTextureRGBA4444(packedPixels, ImageSize.Width, ImageSize.Height, alphaDecoder);
+					LoadImage(packedPixels, ImageSize.Width, ImageSize.Height, Format.R4G4B4A4_UNorm_Pack16);
+				} else {
+					rgbDecoder.FillTextureRGB565(packedPixels, ImageSize.Width, ImageSize.Height);
+					LoadImage(packedPixels, ImageSize.Width, ImageSize.Height, Format.R5G6B5_UNorm_Pack16);
+				}
+				return;
+			}
 			rgbDecoder.FillTextureRGBX8(pixels, ImageSize.Width, ImageSize.Height);
 			if (alphaDecoder != null) {
 				alphaDecoder.FillTextureAlpha(pixels, ImageSize.Width, ImageSize.Height);
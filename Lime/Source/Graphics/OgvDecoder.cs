@@ -10,6 +10,33 @@ using ObjCRuntime;
 
 namespace Lime
 {
+	/// <summary>
+	/// Decode figures for the last frame, see OgvDecoder.StatsEnabled.
+	/// Times are in milliseconds.
+	/// </summary>
+	public struct OgvFrameStats
+	{
+		// Bytes pulled from the stream while demuxing the frame
+		public int BytesRead;
+		public int PacketBytes;
+		public int CodedFragments;
+		public int TotalFragments;
+		public bool Keyframe;
+		// The packet had no coded blocks and repeats the previous frame
+		public bool Dupframe;
+		public double ReadMs;
+		public double UnpackMs;
+		public double DcUnpredictMs;
+		public double ReconMs;
+		public double LoopFilterMs;
+		public double PostprocessMs;
+		// Time spent in the FillTexture* calls made for this frame
+		public double ConvertMs;
+
+		public float CodedRatio => TotalFragments > 0 ? (float)CodedFragments / TotalFragments : 0;
+		public double DecodeMs => ReadMs + UnpackMs + DcUnpredictMs + ReconMs + LoopFilterMs + PostprocessMs;
+	}
+
 	public class OgvDecoder : IDisposable
 	{
 		const byte MinAlphaThreshold = 45;
@@ -21,8 +48,88 @@ namespace Lime
 		Lemon.Api.FileSystem fileSystem;
 		IntPtr ogvHandle;
 		static readonly StreamMap streamMap = new StreamMap();
+		// Reuses native decoders (and their frame buffers) between short clips.
+		// The native pool locks itself, and only around taking and returning a
+		// decoder, so reading the headers through the stream callbacks doesn't
+		// hold up other decoders. poolLock only guards creating it.
+		const int PoolCapacity = 4;
+		static readonly object poolLock = new object();
+		static IntPtr pool;
+
+		/// <summary>
+		/// Whether decoders created from now on verify only the first page checksum after an open or seek, as
+		/// OggDecoder.TrustedInput does for sounds. Off by default, only meant for videos from the game's own asset
+		/// bundles.
+		/// </summary>
+		public static bool TrustedInput;
 
+		int scaleShift;
+		bool statsEnabled;
+		System.Diagnostics.Stopwatch convertStopwatch;
+
+		// Size of the output written by FillTexture*, i.e. SourceFrameSize / Downscale
 		public Size FrameSize { get; private set; }
+		public Size SourceFrameSize { get; private set; }
+
+		// Decode-and-convert at 1/2, 1/4 or 1/8 of the encoded size, for videos
+		// that are displayed much smaller than they were authored.
+		public int Downscale
+		{
+			get { return 1 << scaleShift; }
+			set
+			{
+				switch (value) {
+					case 1: scaleShift = 0; break;
+					case 2: scaleShift = 1; break;
+					case 4: scaleShift = 2; break;
+					case 8: scaleShift = 3; break;
+					default: throw new ArgumentException("Downscale must be 1, 2, 4 or 8");
+				}
+				FrameSize = new Size(SourceFrameSize.Width >> scaleShift, SourceFrameSize.Height >> scaleShift);
+			}
+		}
+
+		// Collects OgvFrameStats for every decoded frame. Cheap enough for
+		// production builds, but still off by default.
+		public bool StatsEnabled
+		{
+			get { return statsEnabled; }
+			set
+			{
+				if (Lemon.Api.OgvEnableStats(ogvHandle, value ? 1 : 0) != 0) {
+					throw new Lime.Exception("Failed to toggle Ogv decoder statistics");
+				}
+				statsEnabled = value;
+				convertStopwatch = value ? new System.Diagnostics.Stopwatch() : null;
+			}
+		}
+
+		public OgvFrameStats FrameStats
+		{
+			get
+			{
+				if (!statsEnabled) {
+					return new OgvFrameStats();
+				}
+				Lemon.Api.OgvFrameStats s;
+				Lemon.Api.OgvGetFrameStats(ogvHandle, out s);
+				return new OgvFrameStats {
+					BytesRead = s.BytesRead,
+					PacketBytes = s.PacketBytes,
+					CodedFragments = s.CodedFragments,
+					TotalFragments = s.TotalFragments,
+					Keyframe = s.Keyframe != 0,
+					Dupframe = s.Dupframe != 0,
+					ReadMs = s.ReadMs,
+					UnpackMs = s.UnpackMs,
+					DcUnpredictMs = s.DcUnpredictMs,
+					ReconMs = s.ReconMs,
+					LoopFilterMs = s.LoopFilterMs,
+					PostprocessMs = s.PostprocessMs,
+					ConvertMs = convertStopwatch.Elapsed.TotalMilliseconds
+				};
+			}
+		}
 
 		public OgvDecoder(Stream stream)
 		{
@@ -33,12 +140,19 @@ namespace Lime
 			};
 			streamHandle = streamMap.Allocate(stream);
 
-			ogvHandle = Lemon.Api.OgvCreate(streamHandle, fileSystem);
+			lock (poolLock) {
+				if (pool == IntPtr.Zero) {
+					pool = Lemon.Api.OgvPoolCreate(PoolCapacity);
+				}
+			}
+			ogvHandle = Lemon.Api.OgvCreatePooled(pool, streamHandle, fileSystem);
 			if (ogvHandle.ToInt32() == 0) {
 				throw new Lime.Exception("Failed to open Ogv/Theora file");
 			}
-			FrameSize = new Size(Lemon.Api.OgvGetVideoWidth(ogvHandle),
+			Lemon.Api.OgvSetTrusted(ogvHandle, TrustedInput ? 1 : 0);
+			SourceFrameSize = new Size(Lemon.Api.OgvGetVideoWidth(ogvHandle),
 				Lemon.Api.OgvGetVideoHeight(ogvHandle));
+			FrameSize = SourceFrameSize;
 		}
 
 		public void Dispose()
@@ -51,9 +165,26 @@ namespace Lime
 
 		public bool DecodeFrame()
 		{
+			if (statsEnabled) {
+				convertStopwatch.Reset();
+			}
 			return Lemon.Api.OgvDecodeFrame(ogvHandle) == 0;
 		}
 
+		private void BeginConvert()
+		{
+			if (statsEnabled) {
+				convertStopwatch.Start();
+			}
+		}
+
+		private void EndConvert()
+		{
+			if (statsEnabled) {
+				convertStopwatch.Stop();
+			}
+		}
+
 		public double GetPlaybackTime()
 		{
 			return Lemon.Api.OgvGetPlaybackTime(ogvHandle);
@@ -69,14 +200,75 @@ namespace Lime
 			var yPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 0);
 			var uPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 1);
 			var vPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 2);
+			BeginConvert();
 			unsafe {
 				fixed (Color4* p = &pixels[0]) {
-					Lemon.Api.DecodeRGBX8((IntPtr)p, 
+					if (scaleShift == 0) {
+						Lemon.Api.DecodeRGBX8((IntPtr)p,
+							yPlane.Data, uPlane.Data, vPlane.Data,
+							yPlane.Width, yPlane.Height, yPlane.Stride, uPlane.Stride,
+							width * 4, 0);
+					} else {
+						Lemon.Api.DecodeRGBX8Scaled((IntPtr)p,
+							yPlane.Data, uPlane.Data, vPlane.Data,
+							yPlane.Width, yPlane.Height, yPlane.Stride, uPlane.Stride,
+							width * 4, scaleShift);
+					}
+				}
+			}
+			EndConvert();
+		}
+
+		// R5G6B5 with ordered dithering. Only available at Downscale 1.
+		public void FillTextureRGB565(ushort[] pixels, int width, int height)
+		{
+			CheckUnscaled();
+			var yPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 0);
+			var uPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 1);
+			var vPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 2);
+			BeginConvert();
+			unsafe {
+				fixed (ushort* p = &pixels[0]) {
+					Lemon.Api.DecodeRGB565((IntPtr)p,
 						yPlane.Data, uPlane.Data, vPlane.Data,
 						yPlane.Width, yPlane.Height, yPlane.Stride, uPlane.Stride,
-						width * 4, 0);
+						width * 2, 1);
+				}
+			}
+			EndConvert();
+		}
+
+		// R4G4B4A4 with colour from this decoder and alpha from the luma of
+		// alphaDecoder, saturated the same way as FillTextureAlpha.
+		public void FillTextureRGBA4444(ushort[] pixels, int width, int height, OgvDecoder alphaDecoder)
+		{
+			CheckUnscaled();
+			var yPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 0);
+			var uPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 1);
+			var vPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 2);
+			var aPlane = Lemon.Api.OgvGetBuffer(alphaDecoder.ogvHandle, 0);
+			if (aPlane.Width < yPlane.Width || aPlane.Height < yPlane.Height) {
+				throw new ArgumentException(
+					string.Format("Alpha size: {0}x{1}; Video size: {2}x{3}", aPlane.Width, aPlane.Height, yPlane.Width, yPlane.Height));
+			}
+			BeginConvert();
+			unsafe {
+				fixed (byte* alphaTablePtr = &alphaSaturateTable[0])
+				fixed (ushort* p = &pixels[0]) {
+					Lemon.Api.DecodeRGBA4444((IntPtr)p,
+						yPlane.Data, uPlane.Data, vPlane.Data, aPlane.Data,
+						yPlane.Width, yPlane.Height, yPlane.Stride, uPlane.Stride, aPlane.Stride,
+						width * 2, (IntPtr)alphaTablePtr, 1);
 				}
 			}
+			EndConvert();
+		}
+
+		private void CheckUnscaled()
+		{
+			if (scaleShift != 0) {
+				throw new InvalidOperationException("16 bit output doesn't support Downscale");
+			}
 		}
 
 		static readonly byte[] alphaSaturateTable = InitAlphaTable();
@@ -99,10 +291,16 @@ namespace Lime
 		public void FillTextureAlpha(Color4[] pixels, int width, int height)
 		{
 			var yPlane = Lemon.Api.OgvGetBuffer(ogvHandle, 0);
-			if (yPlane.Width != width || yPlane.Height != height) {
+			if (yPlane.Width >> scaleShift != width || yPlane.Height >> scaleShift != height) {
 				throw new ArgumentException(
 					string.Format("YPlane size: {0}x{1}; Texture size: {2}x{3}", yPlane.Width, yPlane.Height, width, height));
 			}
+			BeginConvert();
+			if (scaleShift != 0) {
+				FillTextureAlphaScaled(pixels, width, height, yPlane);
+				EndConvert();
+				return;
+			}
 			unsafe {
 				fixed (byte* alphaTablePtr = &alphaSaturateTable[0])
 				fixed (Color4* pixelsPtr = &pixels[0]) {
@@ -116,6 +314,34 @@ namespace Lime
 					}
 				}
 			}
+			EndConvert();
+		}
+
+		private void FillTextureAlphaScaled(Color4[] pixels, int width, int height, Lemon.Api.TheoraImagePlane yPlane)
+		{
+			int box = 1 << scaleShift;
+			int boxShift = 2 * scaleShift;
+			int round = 1 << (boxShift - 1);
+			unsafe {
+				fixed (byte* alphaTablePtr = &alphaSaturateTable[0])
+				fixed (Color4* pixelsPtr = &pixels[0]) {
+					for (int i = 0; i < height; i++) {
+						var rowPtr = (byte*)yPlane.Data.ToPointer() + (i << scaleShift) * yPlane.Stride;
+						var linePtr = pixelsPtr + i * width;
+						for (int j = 0; j < width; j++) {
+							int sum = 0;
+							var boxPtr = rowPtr + (j << scaleShift);
+							for (int y = 0; y < box; y++) {
+								for (int x = 0; x < box; x++) {
+									sum += boxPtr[x];
+								}
+								boxPtr += yPlane.Stride;
+							}
+							linePtr[j].A = alphaTablePtr[(sum + round) >> boxShift];
+						}
+					}
+				}
+			}
 		}
 
 #if iOS
@@ -35,6 +35,11 @@ namespace Lime.Graphics.Platform.OpenGL
 			const All CompressedRgb8Etc2 = (All)37492;
 			const All CompressedRgb8PunchthroughAlpha1Etc2 = (All)37494;
 			const All CompressedRgba8Etc2Eac = (All)37496;
+			const All CompressedR11Eac = (All)37488;
+			const All CompressedRg11Eac = (All)37490;
+			const All CompressedRedRgtc1 = (All)36283;
+			const All CompressedRgRgtc2 = (All)36285;
+			const All CompressedRgbaAstc4x4 = (All)37808;
 			const All R8 = (All)33321;
 			const All RG8 = (All)33323;
 			glInternalFormat = 0;
@@ -104,6 +109,12 @@ namespace Lime.Graphics.Platform.OpenGL
 				case Format.BC3_UNorm_Block:
 					glInternalFormat = All.CompressedRgbaS3tcDxt5Ext;
 					break;
+				case Format.BC4_UNorm_Block:
+					glInternalFormat = CompressedRedRgtc1;
+					break;
+				case Format.BC5_UNorm_Block:
+					glInternalFormat = CompressedRgRgtc2;
+					break;
 				case Format.ETC1_R8G8B8_UNorm_Block:
 					if (ctx.SupportsEtc2) {
 						glInternalFormat = CompressedRgb8Etc2;
@@ -120,6 +131,12 @@ namespace Lime.Graphics.Platform.OpenGL
 				case Format.ETC2_R8G8B8A8_UNorm_Block:
 					glInternalFormat = CompressedRgba8Etc2Eac;
 					break;
+				case Format.EAC_R11_UNorm_Block:
+					glInternalFormat = CompressedR11Eac;
+					break;
+				case Format.EAC_R11G11_UNorm_Block:
+					glInternalFormat = CompressedRg11Eac;
+					break;
 				case Format.PVRTC1_2Bpp_UNorm_Block:
 					glInternalFormat = All.CompressedRgbaPvrtc2Bppv1Img;
 					break;
@@ -132,6 +149,23 @@ namespace Lime.Graphics.Platform.OpenGL
 				case Format.PVRTC2_4Bpp_UNorm_Block:
 					glInternalFormat = All.CompressedRgbaPvrtc4Bppv2Img;
 					break;
+				case Format.ASTC_4x4_UNorm_Block:
+				case Format.ASTC_5x4_UNorm_Block:
+				case Format.ASTC_5x5_UNorm_Block:
+				case Format.ASTC_6x5_UNorm_Block:
+				case Format.ASTC_6x6_UNorm_Block:
+				case Format.ASTC_8x5_UNorm_Block:
+				case Format.ASTC_8x6_UNorm_Block:
+				case Format.ASTC_8x8_UNorm_Block:
+				case Format.ASTC_10x5_UNorm_Block:
+				case Format.ASTC_10x6_UNorm_Block:
+				case Format.ASTC_10x8_UNorm_Block:
+				case Format.ASTC_10x10_UNorm_Block:
+				case Format.ASTC_12x10_UNorm_Block:
+				case Format.ASTC_12x12_UNorm_Block:
+					// The ASTC internal formats follow the same footprint order as the Format values.
+					glInternalFormat = CompressedRgbaAstc4x4 + (format - Format.ASTC_4x4_UNorm_Block);
+					break;
 				default:
 					throw new ArgumentException(nameof(format));
 			}
@@ -65,10 +65,12 @@ namespace Lime.Graphics.Platform.OpenGL
 		internal bool SupportsDxt1;
 		internal bool SupportsDxt3;
 		internal bool SupportsDxt5;
+		internal bool SupportsRgtc;
 		internal bool SupportsPvrtc1;
 		internal bool SupportsPvrtc2;
 		internal bool SupportsEtc1;
 		internal bool SupportsEtc2;
+		internal bool SupportsAstc;
 		internal int GLMajorVersion;
 		internal int GLMinorVersion;
 		internal bool ESProfile;
@@ -180,10 +182,14 @@ namespace Lime.Graphics.Platform.OpenGL
 			SupportsDxt1 = supportsS3tc || glExtensions.Contains("GL_EXT_texture_compression_dxt1");
 			SupportsDxt3 = supportsS3tc || glExtensions.Contains("GL_ANGLE_texture_compression_dxt3");
 			SupportsDxt5 = supportsS3tc || glExtensions.Contains("GL_ANGLE_texture_compression_dxt5");
+			SupportsRgtc = (!ESProfile && GLMajorVersion >= 3) || glExtensions.Contains("GL_ARB_texture_compression_rgtc") ||
+				glExtensions.Contains("GL_EXT_texture_compression_rgtc");
 			SupportsPvrtc1 = glExtensions.Contains("GL_IMG_texture_compression_pvrtc");
 			SupportsPvrtc2 = glExtensions.Contains("GL_IMG_texture_compression_pvrtc2");
 			SupportsEtc1 = glExtensions.Contains("GL_OES_compressed_ETC1_RGB8_texture");
 			SupportsEtc2 = (ESProfile && GLMajorVersion >= 3) || glExtensions.Contains("GL_ARB_ES3_compatibility");
+			SupportsAstc = (ESProfile && (GLMajorVersion > 3 || GLMajorVersion == 3 && GLMinorVersion >= 2)) ||
+				glExtensions.Contains("GL_KHR_texture_compression_astc_ldr");
 			SupportsInternalFormatBgra8 = ESProfile && glExtensions.Contains("GL_EXT_texture_format_BGRA8888");
 			SupportsExternalFormatBgra8 = SupportsInternalFormatBgra8 || !ESProfile || glExtensions.Contains("GL_APPLE_texture_format_BGRA8888");
 			GL.GetInteger(GetPName.MaxCombinedTextureImageUnits, out var maxTextureSlots);
@@ -848,6 +854,12 @@ namespace Lime.Graphics.Platform.OpenGL
 						features |= FormatFeatures.Sample;
 					}
 					break;
+				case Format.BC4_UNorm_Block:
+				case Format.BC5_UNorm_Block:
+					if (SupportsRgtc) {
+						features |= FormatFeatures.Sample;
+					}
+					break;
 				case Format.ETC1_R8G8B8_UNorm_Block:
 					if (SupportsEtc1 || SupportsEtc2) {
 						features |= FormatFeatures.Sample;
@@ -856,6 +868,8 @@ namespace Lime.Graphics.Platform.OpenGL
 				case Format.ETC2_R8G8B8_UNorm_Block:
 				case Format.ETC2_R8G8B8A1_UNorm_Block:
 				case Format.ETC2_R8G8B8A8_UNorm_Block:
+				case Format.EAC_R11_UNorm_Block:
+				case Format.EAC_R11G11_UNorm_Block:
 					if (SupportsEtc2) {
 						features |= FormatFeatures.Sample;
 					}
@@ -872,6 +886,24 @@ namespace Lime.Graphics.Platform.OpenGL
 						features |= FormatFeatures.Sample;
 					}
 					break;
+				case Format.ASTC_4x4_UNorm_Block:
+				case Format.ASTC_5x4_UNorm_Block:
+				case Format.ASTC_5x5_UNorm_Block:
+				case Format.ASTC_6x5_UNorm_Block:
+				case Format.ASTC_6x6_UNorm_Block:
+				case Format.ASTC_8x5_UNorm_Block:
+				case Format.ASTC_8x6_UNorm_Block:
+				case Format.ASTC_8x8_UNorm_Block:
+				case Format.ASTC_10x5_UNorm_Block:
+				case Format.ASTC_10x6_UNorm_Block:
+				case Format.ASTC_10x8_UNorm_Block:
+				case Format.ASTC_10x10_UNorm_Block:
+				case Format.ASTC_12x10_UNorm_Block:
+				case Format.ASTC_12x12_UNorm_Block:
+					if (SupportsAstc) {
+						features |= FormatFeatures.Sample;
+					}
+					break;
 			}
 			return features;
 		}
@@ -97,6 +97,10 @@ namespace Lime.Graphics.Platform.Vulkan
 					return SharpVulkan.Format.Bc2UNormBlock;
 				case Format.BC3_UNorm_Block:
 					return SharpVulkan.Format.Bc3UNormBlock;
+				case Format.BC4_UNorm_Block:
+					return SharpVulkan.Format.Bc4UNormBlock;
+				case Format.BC5_UNorm_Block:
+					return SharpVulkan.Format.Bc5UNormBlock;
 				case Format.ETC1_R8G8B8_UNorm_Block:
 				case Format.ETC2_R8G8B8_UNorm_Block:
 					return SharpVulkan.Format.Etc2R8G8B8UNormBlock;
@@ -104,6 +108,10 @@ namespace Lime.Graphics.Platform.Vulkan
 					return SharpVulkan.Format.Etc2R8G8B8A1UNormBlock;
 				case Format.ETC2_R8G8B8A8_UNorm_Block:
 					return SharpVulkan.Format.Etc2R8G8B8A8UNormBlock;
+				case Format.EAC_R11_UNorm_Block:
+					return SharpVulkan.Format.EacR11UNormBlock;
+				case Format.EAC_R11G11_UNorm_Block:
+					return SharpVulkan.Format.EacR11G11UNormBlock;
 				case Format.PVRTC1_2Bpp_UNorm_Block:
 					return SharpVulkan.Format.Pvrtc12BppUNormBlock;
 				case Format.PVRTC1_4Bpp_UNorm_Block:
@@ -112,6 +120,34 @@ namespace Lime.Graphics.Platform.Vulkan
 					return SharpVulkan.Format.Pvrtc22BppUNormBlock;
 				case Format.PVRTC2_4Bpp_UNorm_Block:
 					return SharpVulkan.Format.Pvrtc24BppUNormBlock;
+				case Format.ASTC_4x4_UNorm_Block:
+					return SharpVulkan.Format.Astc4X4UNormBlock;
+				case Format.ASTC_5x4_UNorm_Block:
+					return SharpVulkan.Format.Astc5X4UNormBlock;
+				case Format.ASTC_5x5_UNorm_Block:
+					return SharpVulkan.Format.Astc5X5UNormBlock;
+				case Format.ASTC_6x5_UNorm_Block:
+					return SharpVulkan.Format.Astc6X5UNormBlock;
+				case Format.ASTC_6x6_UNorm_Block:
+					return SharpVulkan.Format.Astc6X6UNormBlock;
+				case Format.ASTC_8x5_UNorm_Block:
+					return SharpVulkan.Format.Astc8X5UNormBlock;
+				case Format.ASTC_8x6_UNorm_Block:
+					return SharpVulkan.Format.Astc8X6UNormBlock;
+				case Format.ASTC_8x8_UNorm_Block:
+					return SharpVulkan.Format.Astc8X8UNormBlock;
+				case Format.ASTC_10x5_UNorm_Block:
+					return SharpVulkan.Format.Astc10X5UNormBlock;
+				case Format.ASTC_10x6_UNorm_Block:
+					return SharpVulkan.Format.Astc10X6UNormBlock;
+				case Format.ASTC_10x8_UNorm_Block:
+					return SharpVulkan.Format.Astc10X8UNormBlock;
+				case Format.ASTC_10x10_UNorm_Block:
+					return SharpVulkan.Format.Astc10X10UNormBlock;
+				case Format.ASTC_12x10_UNorm_Block:
+					return SharpVulkan.Format.Astc12X10UNormBlock;
+				case Format.ASTC_12x12_UNorm_Block:
+					return SharpVulkan.Format.Astc12X12UNormBlock;
 				default:
 					throw new ArgumentException(nameof(format));
 			}
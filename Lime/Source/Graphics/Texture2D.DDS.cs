@@ -1,6 +1,7 @@
 #if (MAC || WIN)
 using System;
 using System.IO;
+using System.Runtime.InteropServices;
 using Lime.Graphics.Platform;
 
 namespace Lime
@@ -12,6 +13,10 @@ namespace Lime
 			DXT1 = ('D' | ('X' << 8) | ('T' << 16) | ('1' << 24)),
 			DXT3 = ('D' | ('X' << 8) | ('T' << 16) | ('3' << 24)),
 			DXT5 = ('D' | ('X' << 8) | ('T' << 16) | ('5' << 24)),
+			ATI1 = ('A' | ('T' << 8) | ('I' << 16) | ('1' << 24)),
+			BC4U = ('B' | ('C' << 8) | ('4' << 16) | ('U' << 24)),
+			ATI2 = ('A' | ('T' << 8) | ('I' << 16) | ('2' << 24)),
+			BC5U = ('B' | ('C' << 8) | ('5' << 16) | ('U' << 24)),
 		}
 
 		[Flags]
@@ -80,6 +85,14 @@ namespace Lime
 					case DDSFourCC.DXT5:
 						format = Format.BC3_UNorm_Block;
 						break;
+					case DDSFourCC.ATI1:
+					case DDSFourCC.BC4U:
+						format = Format.BC4_UNorm_Block;
+						break;
+					case DDSFourCC.ATI2:
+					case DDSFourCC.BC5U:
+						format = Format.BC5_UNorm_Block;
+						break;
 					default:
 						throw new InvalidDataException("Unsupported texture format");
 				}
@@ -89,12 +102,34 @@ namespace Lime
 			if (mipMapCount > 1 && mipMapCount != GraphicsUtility.CalculateMipLevelCount(width, height)) {
 				throw new NotSupportedException();
 			}
-			Action deferredCommands = () => EnsurePlatformTexture(format, width, height, mipMapCount > 1);
+			var bcFormat = Etc2Decoder.IsSupported(format);
+			Action deferredCommands = CancelDecodeJob;
 			MemoryUsed = 0;
 			for (int level = 0; level < mipMapCount; level++) {
 				var levelCopy = level;
 				var buffer = ReadTextureData(reader, GraphicsUtility.CalculateMipLevelDataSize(levelCopy, format, width, height));
-				deferredCommands += () => platformTexture.SetData(levelCopy, buffer);
+				GraphicsUtility.CalculateMipLevelSize(levelCopy, width, height, out var levelWidth, out var levelHeight);
+				deferredCommands += () => {
+					var formatFeatures = PlatformRenderer.Context.GetFormatFeatures(format);
+					if (bcFormat && (formatFeatures & FormatFeatures.Sample) == 0) {
+						// No S3TC/RGTC support, decode to R8/R8G8 (BC4/BC5) or R8G8B8A8 in software.
+						var decodedFormat = Etc2Decoder.GetCompactDecodedFormat(format);
+						if ((PlatformRenderer.Context.GetFormatFeatures(decodedFormat) & FormatFeatures.Sample) == 0) {
+							decodedFormat = Format.R8G8B8A8_UNorm;
+						}
+						var decodedData = Marshal.AllocHGlobal(levelWidth * levelHeight * decodedFormat.GetSize());
+						try {
+							Etc2Decoder.Decode(buffer, decodedData, levelWidth, levelHeight, format, decodedFormat);
+							EnsurePlatformTexture(decodedFormat, width, height, mipMapCount > 1);
+							platformTexture.SetData(levelCopy, decodedData);
+						} finally {
+							Marshal.FreeHGlobal(decodedData);
+						}
+					} else {
+						EnsurePlatformTexture(format, width, height, mipMapCount > 1);
+						platformTexture.SetData(levelCopy, buffer);
+					}
+				};
 			}
 			Window.Current.InvokeOnRendering(deferredCommands);
 		}
@@ -41,44 +41,170 @@ namespace Lime
 			if (pixelDepth != 0) {
 				throw new InvalidDataException("3D Textures are not supported");
 			}
-			if ((pixelWidth & 3) != 0 || (pixelHeight & 3) != 0) {
-				throw new InvalidDataException("Texture dimensions should multiple of 4");
-			}
 			if (numberOfMipmapLevels > 1 && numberOfMipmapLevels != GraphicsUtility.CalculateMipLevelCount(pixelWidth, pixelHeight)) {
 				throw new InvalidDataException();
 			}
 			var format = ConvertGLFormat(glInternalFormat, glBaseInternalFormat, glFormat, glType);
-			var etcFormat =
-				format == Format.ETC1_R8G8B8_UNorm_Block ||
-				format == Format.ETC2_R8G8B8_UNorm_Block ||
-				format == Format.ETC2_R8G8B8A1_UNorm_Block ||
-				format == Format.ETC2_R8G8B8A8_UNorm_Block;
+			// ASTC edge blocks are clipped to the image, whatever the footprint, so any size is valid.
+			var astcFormat = format >= Format.ASTC_4x4_UNorm_Block && format <= Format.ASTC_12x12_UNorm_Block;
+			if (!astcFormat && ((pixelWidth & 3) != 0 || (pixelHeight & 3) != 0)) {
+				throw new InvalidDataException("Texture dimensions should multiple of 4");
+			}
+			var etcFormat = Etc2Decoder.IsSupported(format);
 			SurfaceSize = ImageSize = new Size(pixelWidth, pixelHeight);
-			Action deferredCommands = null;
+			var levels = new byte[numberOfMipmapLevels][];
 			for (int level = 0; level < numberOfMipmapLevels; level++) {
-				var levelCopy = level;
 				var dataLength = reader.ReadInt32();
-				var data = ReadTextureData(reader, dataLength);
-				GraphicsUtility.CalculateMipLevelSize(levelCopy, pixelWidth, pixelHeight, out var levelWidth, out var levelHeight);
-				MemoryUsed = 0;
-				deferredCommands += () => {
-					var formatFeatures = PlatformRenderer.Context.GetFormatFeatures(format);
-					if (etcFormat && (formatFeatures & FormatFeatures.Sample) == 0) {
-						var rgba8Data = Marshal.AllocHGlobal(levelWidth * levelHeight * 4);
-						try {
-							Etc2Decoder.Decode(data, rgba8Data, levelWidth, levelHeight, format);
-							EnsurePlatformTexture(Format.R8G8B8A8_UNorm, pixelWidth, pixelHeight, numberOfMipmapLevels > 1);
-							platformTexture.SetData(levelCopy, rgba8Data);
-						} finally {
-							Marshal.FreeHGlobal(rgba8Data);
-						}
+				levels[level] = ReadTextureData(reader, dataLength);
+			}
+			MemoryUsed = 0;
+			Window.Current.InvokeOnRendering(() => {
+				CancelDecodeJob();
+				var formatFeatures = PlatformRenderer.Context.GetFormatFeatures(format);
+				if (!etcFormat || (formatFeatures & FormatFeatures.Sample) != 0) {
+					EnsurePlatformTexture(format, pixelWidth, pixelHeight, numberOfMipmapLevels > 1);
+					for (int level = 0; level < numberOfMipmapLevels; level++) {
+						platformTexture.SetData(level, levels[level]);
+					}
+					return;
+				}
+				var decodedFormat = GetDecodedFormat(format);
+				if (DecodeInBackground) {
+					decodeJob = Etc2Decoder.DecodeJob.Start(
+						levels, pixelWidth, pixelHeight, format, decodedFormat, OnLevelDecoded,
+						job => OnDecodeJobFinished(job, levels, format));
+					if (decodeJob != null) {
+						return;
+					}
+				}
+				DecodeLevels(levels, format, decodedFormat);
+			});
+		}
+
+		/// <summary>
+		/// Returns the format an ETC, EAC or ASTC texture the GPU can't sample is decoded or transcoded to.
+		/// </summary>
+		private static Format GetDecodedFormat(Format format)
+		{
+			// Where the GPU samples BC formats, transcoding keeps the texture compressed.
+			var transcodedFormat = TranscodeToBC ? Etc2Decoder.GetTranscodedFormat(format) : Format.Undefined;
+			if (
+				transcodedFormat != Format.Undefined &&
+				(PlatformRenderer.Context.GetFormatFeatures(transcodedFormat) & FormatFeatures.Sample) != 0
+			) {
+				return transcodedFormat;
+			}
+			// Single and dual channel EAC textures stay R8/R8G8 where those can be sampled.
+			var decodedFormat = Etc2Decoder.GetCompactDecodedFormat(format);
+			if ((PlatformRenderer.Context.GetFormatFeatures(decodedFormat) & FormatFeatures.Sample) == 0) {
+				decodedFormat = Format.R8G8B8A8_UNorm;
+			}
+			return decodedFormat;
+		}
+
+		// Called from the decoding thread.
+		private void OnLevelDecoded(Etc2Decoder.DecodeJob job, int level)
+		{
+			// The smallest levels come first, so a preview is there once its biggest level is.
+			if (level == GetDecodePreviewLevel(job.LevelCount)) {
+				Window.Current.InvokeOnRendering(() => UploadDecodedLevels(job, level));
+			}
+		}
+
+		/// <summary>
+		/// Decodes or transcodes all mip levels to decodedFormat in place and makes the platform texture hold them.
+		/// The levels go through one buffer. The platform texture is only replaced once the biggest level is decoded,
+		/// so it stays as it was if there is no memory for that.
+		/// </summary>
+		private void DecodeLevels(byte[][] levels, Format format, Format decodedFormat)
+		{
+			var width = SurfaceSize.Width;
+			var height = SurfaceSize.Height;
+			var decodedData = Marshal.AllocHGlobal(GraphicsUtility.CalculateImageDataSize(decodedFormat, width, height));
+			try {
+				for (int level = 0; level < levels.Length; level++) {
+					GraphicsUtility.CalculateMipLevelSize(level, width, height, out var levelWidth, out var levelHeight);
+					if (decodedFormat == Etc2Decoder.GetTranscodedFormat(format)) {
+						Etc2Decoder.Transcode(levels[level], decodedData, levelWidth, levelHeight, format);
 					} else {
-						EnsurePlatformTexture(format, pixelWidth, pixelHeight, numberOfMipmapLevels > 1);
-						platformTexture.SetData(levelCopy, data);
+						Etc2Decoder.Decode(levels[level], decodedData, levelWidth, levelHeight, format, decodedFormat);
+					}
+					if (level == 0) {
+						EnsurePlatformTexture(decodedFormat, width, height, levels.Length > 1);
 					}
-				};
+					platformTexture.SetData(level, decodedData);
+				}
+			} finally {
+				Marshal.FreeHGlobal(decodedData);
+			}
+		}
+
+		// Called from the decoding thread. A job only fails when memory runs out; the levels are then decoded in place
+		// once the job has freed its buffers, and if memory runs out again the levels uploaded so far are kept.
+		private void OnDecodeJobFinished(Etc2Decoder.DecodeJob job, byte[][] levels, Format format)
+		{
+			Window.Current.InvokeOnRendering(() => {
+				if (decodeJob != job) {
+					return;
+				}
+				if (job.Succeeded) {
+					UploadDecodedLevels(job, 0);
+					CancelDecodeJob();
+					return;
+				}
+				var decodedFormat = job.DecodedFormat;
+				CancelDecodeJob();
+				try {
+					DecodeLevels(levels, format, decodedFormat);
+				} catch (OutOfMemoryException) {
+					Console.WriteLine(
+						"Out of memory decoding a {0}x{1} {2} texture, keeping its lower resolution levels",
+						SurfaceSize.Width, SurfaceSize.Height, format);
+				}
+			});
+		}
+
+		/// <summary>
+		/// Returns the biggest mip level not above DecodePreviewSize, or -1 if the texture is no bigger than that or
+		/// has no such level.
+		/// </summary>
+		private int GetDecodePreviewLevel(int levelCount)
+		{
+			for (int level = 0; level < levelCount; level++) {
+				GraphicsUtility.CalculateMipLevelSize(level, SurfaceSize.Width, SurfaceSize.Height, out var levelWidth, out var levelHeight);
+				if (Math.Max(levelWidth, levelHeight) <= DecodePreviewSize) {
+					return level > 0 ? level : -1;
+				}
+			}
+			return -1;
+		}
+
+		/// <summary>
+		/// Makes the platform texture hold the decoded mip levels from firstLevel down. The texture coordinates are
+		/// normalized, so a platform texture made from a smaller level renders as a lower resolution texture.
+		/// </summary>
+		private void UploadDecodedLevels(Etc2Decoder.DecodeJob job, int firstLevel)
+		{
+			if (decodeJob != job) {
+				return;
+			}
+			GraphicsUtility.CalculateMipLevelSize(firstLevel, SurfaceSize.Width, SurfaceSize.Height, out var width, out var height);
+			EnsurePlatformTexture(job.DecodedFormat, width, height, job.LevelCount - firstLevel > 1);
+			for (int level = firstLevel; level < job.LevelCount; level++) {
+				platformTexture.SetData(level - firstLevel, job.GetLevelData(level));
+			}
+		}
+
+		/// <summary>
+		/// Drops the background decode of a previous KTX image, if any, so its levels can't land on the new one.
+		/// Every loader calls this on the render thread before it touches the platform texture.
+		/// </summary>
+		private void CancelDecodeJob()
+		{
+			if (decodeJob != null) {
+				decodeJob.Dispose();
+				decodeJob = null;
 			}
-			Window.Current.InvokeOnRendering(deferredCommands);
 		}
 
 		private static Format ConvertGLFormat(int glInternalFormat, int glBaseInternalFormat, int glFormat, int glType)
@@ -87,6 +213,10 @@ namespace Lime
 			const int GL_COMPRESSED_RGB8_ETC2 = 0x9274;
 			const int GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 = 0x9276;
 			const int GL_COMPRESSED_RGBA8_ETC2_EAC = 0x9278;
+			const int GL_COMPRESSED_R11_EAC = 0x9270;
+			const int GL_COMPRESSED_RG11_EAC = 0x9272;
+			const int GL_COMPRESSED_RGBA_ASTC_4x4_KHR = 0x93B0;
+			const int GL_COMPRESSED_RGBA_ASTC_12x12_KHR = 0x93BD;
 			const int GL_RGB = 0x1907;
 			const int GL_RGBA = 0x1908;
 			const int GL_UNSIGNED_BYTE = 0x1401;
@@ -106,6 +236,16 @@ namespace Lime
 			if (glInternalFormat == GL_COMPRESSED_RGBA8_ETC2_EAC) {
 				return Format.ETC2_R8G8B8A8_UNorm_Block;
 			}
+			if (glInternalFormat == GL_COMPRESSED_R11_EAC) {
+				return Format.EAC_R11_UNorm_Block;
+			}
+			if (glInternalFormat == GL_COMPRESSED_RG11_EAC) {
+				return Format.EAC_R11G11_UNorm_Block;
+			}
+			if (glInternalFormat >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR && glInternalFormat <= GL_COMPRESSED_RGBA_ASTC_12x12_KHR) {
+				// The ASTC footprints are in the same order as the Format values.
+				return Format.ASTC_4x4_UNorm_Block + (glInternalFormat - GL_COMPRESSED_RGBA_ASTC_4x4_KHR);
+			}
 			if (glBaseInternalFormat == GL_RGB && glFormat == GL_RGB && glType == GL_UNSIGNED_BYTE) {
 				return Format.R8G8B8_UNorm;
 			}
@@ -95,7 +95,10 @@ namespace Lime
 			if (numMipmaps > 1 && numMipmaps != GraphicsUtility.CalculateMipLevelCount(width, height)) {
 				throw new NotSupportedException();
 			}
-			Action deferredCommands = () => EnsurePlatformTexture(format, width, height, numMipmaps > 1);
+			Action deferredCommands = () => {
+				CancelDecodeJob();
+				EnsurePlatformTexture(format, width, height, numMipmaps > 1);
+			};
 			MemoryUsed = 0;
 			for (int level = 0; level < numMipmaps; level++) {
 				var levelCopy = level;
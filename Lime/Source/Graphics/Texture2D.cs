@@ -14,6 +14,25 @@ namespace Lime
 
 		public static bool IsStubTextureTransparent;
 
+		/// <summary>
+		/// Whether ETC, EAC and ASTC textures the GPU can't sample are transcoded to BC formats where those can be
+		/// sampled, instead of being decoded to uncompressed pixels. Uses a quarter to an eighth of the memory at some
+		/// loss of quality.
+		/// </summary>
+		public static bool TranscodeToBC = true;
+
+		/// <summary>
+		/// Whether ETC, EAC and ASTC textures the GPU can't sample are decoded on a background thread instead of the
+		/// render thread. The texture is missing until its mip levels up to DecodePreviewSize are decoded, then
+		/// renders at that resolution until the rest are.
+		/// </summary>
+		public static bool DecodeInBackground = true;
+
+		/// <summary>
+		/// The size of the biggest mip level shown while the bigger ones are decoded in the background.
+		/// </summary>
+		public static int DecodePreviewSize = 128;
+
 		private static readonly string[] AffordableTextureFileExtensions = {
 #if iOS || ANDROID
 			".pvr", ".jpg"
@@ -23,6 +42,7 @@ namespace Lime
 		};
 
 		private IPlatformTexture2D platformTexture;
+		private Etc2Decoder.DecodeJob decodeJob;
 		public OpacityMask OpacityMask { get; private set; }
 		public Size ImageSize { get; protected set; }
 		public Size SurfaceSize { get; protected set; }
@@ -217,6 +237,7 @@ namespace Lime
 			uvRect = new Rectangle(0, 0, 1, 1);
 
 			Window.Current.InvokeOnRendering(() => {
+				CancelDecodeJob();
 				EnsurePlatformTexture(Format.R8G8B8A8_UNorm, width, height, false);
 				platformTexture.SetData(0, pixels);
 			});
@@ -235,6 +256,26 @@ namespace Lime
 			uvRect = new Rectangle(0, 0, 1, 1);
 
 			Window.Current.InvokeOnRendering(() => {
+				CancelDecodeJob();
+				EnsurePlatformTexture(format, width, height, false);
+				platformTexture.SetData(0, pixels);
+			});
+		}
+
+		/// <summary>
+		/// Create texture from 16 bit packed pixels (R5G6B5, R4G4B4A4 or R5G5B5A1)
+		/// </summary>
+		internal void LoadImage(ushort[] pixels, int width, int height, Format format)
+		{
+			IsStubTexture = false;
+
+			MemoryUsed = format.GetSize() * width * height;
+			ImageSize = new Size(width, height);
+			SurfaceSize = ImageSize;
+			uvRect = new Rectangle(0, 0, 1, 1);
+
+			Window.Current.InvokeOnRendering(() => {
+				CancelDecodeJob();
 				EnsurePlatformTexture(format, width, height, false);
 				platformTexture.SetData(0, pixels);
 			});
@@ -268,6 +309,13 @@ namespace Lime
 				});
 				platformTexture = null;
 			}
+			if (decodeJob != null) {
+				var decodeJobCopy = decodeJob;
+				Window.Current.InvokeOnRendering(() => {
+					decodeJobCopy.Dispose();
+				});
+				decodeJob = null;
+			}
 			base.Dispose();
 		}
 